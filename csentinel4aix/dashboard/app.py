@@ -1902,6 +1902,64 @@ def init_db():
     conn.close()
 
 
+# ============================================================
+# Watch-mode Deltas
+# ============================================================
+
+LISTENER_KEY = ('protocol', 'address', 'port', 'pid')
+CONNECTION_KEY = ('protocol', 'local_addr', 'local_port',
+                  'remote_addr', 'remote_port', 'state', 'pid')
+
+
+def _patch_list(items, added, removed, key):
+    """Drop removed entries and append added ones, matching on key fields."""
+    gone = {tuple(e.get(k) for k in key) for e in removed}
+    kept = [e for e in items if tuple(e.get(k) for k in key) not in gone]
+    return kept + list(added)
+
+
+def apply_fingerprint_delta(base, delta):
+    """Rebuild a full fingerprint from the last stored one and a delta.
+
+    Returns None if the delta does not follow base (a document was
+    missed); the agent's next keyframe brings the host back in sync.
+    """
+    if not base or base.get('sequence') != delta.get('base_sequence'):
+        return None
+
+    data = dict(base)
+    for key in ('sentinel_version', 'sequence', 'probe_time', 'probe_duration_ms',
+                'probe_errors', 'system', 'process_summary', 'config_hash_cache',
+                'audit_summary'):
+        if key in delta:
+            data[key] = delta[key]
+    data['type'] = 'delta'
+    data.pop('base_sequence', None)
+
+    # Config files are keyed by path; changed entries replace the old ones
+    changed = delta.get('config_files_changed', [])
+    removed = {c.get('path') for c in changed}
+    removed.update(delta.get('config_files_removed', []))
+    data['config_files'] = [c for c in base.get('config_files', [])
+                            if c.get('path') not in removed] + changed
+
+    network = dict(base.get('network', {}))
+    delta_net = delta.get('network', {})
+    for key, value in delta_net.items():
+        if not key.endswith(('_added', '_removed')):
+            network[key] = value
+    network['listeners'] = _patch_list(network.get('listeners', []),
+                                       delta_net.get('listeners_added', []),
+                                       delta_net.get('listeners_removed', []),
+                                       LISTENER_KEY)
+    network['connections'] = _patch_list(network.get('connections', []),
+                                         delta_net.get('connections_added', []),
+                                         delta_net.get('connections_removed', []),
+                                         CONNECTION_KEY)
+    data['network'] = network
+    return data
+
+
 # ============================================================
 # API Endpoints
 # ============================================================
@@ -1920,6 +1978,26 @@ def ingest_fingerprint():
         conn = get_db()
         cur = conn.cursor()
         
+        # Watch-mode deltas are applied on top of the host's last document
+        if data.get('type') == 'delta':
+            cur.execute('''
+                SELECT f.data FROM fingerprints f
+                JOIN hosts h ON h.id = f.host_id
+                WHERE h.hostname = %s
+                ORDER BY f.captured_at DESC
+                LIMIT 1
+            ''', (hostname,))
+            row = cur.fetchone()
+            base = row['data'] if row else None
+            if isinstance(base, str):
+                base = json.loads(base)
+            data = apply_fingerprint_delta(base, data)
+            if data is None:
+                cur.close()
+                conn.close()
+                return jsonify({'error': 'Delta does not follow the last stored '
+                                         'fingerprint; waiting for a keyframe'}), 409
+        
         # Upsert host
         cur.execute('''
             INSERT INTO hosts (hostname, last_seen) 
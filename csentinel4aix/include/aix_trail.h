@@ -0,0 +1,78 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * aix_trail.h - Reader for AIX binary audit bins and trails
+ *
+ * /audit/bin1 and /audit/bin2 are the bins auditbin writes in turn, and
+ * /audit/trail the bins it has already appended. Each bin is a bin
+ * header, aud_rec records, and a tail header once closed. Files are read
+ * in the big-endian layout of <sys/audit.h>, so trails copied from an
+ * AIX host can be read anywhere.
+ */
+
+#ifndef SENTINEL_AIX_TRAIL_H
+#define SENTINEL_AIX_TRAIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define AIX_TRAIL_MAX_FILES 4
+
+/* One audit record */
+typedef struct {
+    char event[17];                     /* "USER_Login", "PROC_Execute", ... */
+    int  result;                        /* 0 = AUDIT_OK */
+    uint32_t ruid;
+    uint32_t luid;                      /* Login uid */
+    char name[33];                      /* Program name */
+    int32_t pid;
+    int32_t ppid;
+    time_t time;
+    int32_t ntime;                      /* Nanoseconds */
+    const unsigned char *tail;          /* Event-specific data */
+    uint32_t tail_len;
+} aix_audit_record_t;
+
+typedef void (*aix_audit_record_fn)(const aix_audit_record_t *rec, void *ctx);
+
+/* Where reading stopped in one file */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;                       /* 0: not read yet */
+    int64_t  head_time;                 /* bin_time of its first bin */
+    uint64_t offset;                    /* Just past the last whole record */
+    uint64_t bin_left;                  /* Bytes left in the current bin */
+} aix_trail_file_cursor_t;
+
+/*
+ * Per-file positions, plus the newest record passed on: a record that
+ * moves from a bin to the trail is not passed on twice.
+ */
+typedef struct {
+    aix_trail_file_cursor_t files[AIX_TRAIL_MAX_FILES];
+    int64_t seen_time;
+    int32_t seen_ntime;
+} aix_trail_cursor_t;
+
+/*
+ * Pass the records of the files at paths written since the cursor to
+ * fn, oldest file first, stopping after max_records (0: no limit); the
+ * next read continues from there. With no cursor, records from since
+ * onwards are passed. Files must stay in the same positions in paths
+ * between reads. Returns the number of records, or -1 if none of the
+ * files could be read.
+ */
+long aix_trail_read(const char *const *paths, int count, aix_trail_cursor_t *cursor,
+                    time_t since, long max_records, aix_audit_record_fn fn, void *ctx);
+
+bool load_aix_trail_cursor(aix_trail_cursor_t *cursor);
+bool save_aix_trail_cursor(const aix_trail_cursor_t *cursor);
+
+#endif /* SENTINEL_AIX_TRAIL_H */
@@ -0,0 +1,69 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * alert.h - Webhook alerting for critical findings
+ *
+ * Alerts are queued and posted together: one Slack-compatible payload
+ * whose "attachments" array holds every alert queued since the last
+ * post, sent over a kept-alive connection to the webhook.
+ */
+
+#ifndef SENTINEL_ALERT_H
+#define SENTINEL_ALERT_H
+
+#include <time.h>
+
+#include "sentinel.h"
+
+/* Alerts per post; a full queue is posted before taking more */
+#define ALERT_QUEUE_MAX 32
+
+/* Alert severity levels */
+typedef enum {
+    ALERT_INFO = 0,
+    ALERT_WARNING = 1,
+    ALERT_CRITICAL = 2
+} alert_severity_t;
+
+/* Alert structure */
+typedef struct {
+    alert_severity_t severity;
+    char hostname[256];
+    char title[256];
+    char message[2048];         /* One finding per line */
+    time_t timestamp;
+    int zombie_count;
+    int unusual_ports;
+    int config_changes;
+    double memory_percent;
+    double load_avg;
+} alert_t;
+
+int alert_create_from_analysis(alert_t *alert, const fingerprint_t *fp,
+                               const quick_analysis_t *analysis,
+                               alert_severity_t severity);
+void alert_print(const alert_t *alert);
+int alert_should_send(alert_severity_t severity, int on_critical, int on_warning);
+
+/* Queue an alert for url; returns 0, or -1 for a URL that cannot be used */
+int alert_queue_webhook(const char *url, const alert_t *alert);
+
+/*
+ * Post everything queued in one request. Returns the HTTP status, 0 if
+ * nothing was queued, or -1; on failure the alerts stay queued.
+ */
+int alert_flush_webhooks(void);
+
+/* Queue and post at once */
+int alert_send_webhook(const char *url, const alert_t *alert);
+
+/* Post what is queued, then close the connection */
+void alert_webhook_close(void);
+
+#endif /* SENTINEL_ALERT_H */
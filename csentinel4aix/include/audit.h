@@ -160,6 +160,53 @@ typedef struct {
     float avg_shell_spawns;
 } audit_baseline_t;
 
+/* ============================================================
+ * Raw Log Reader (audit_log.c)
+ * ============================================================
+ * Reads /var/log/audit/audit.log in-process, once per probe. The
+ * cursor remembers where the last read stopped, so only records
+ * written since are parsed.
+ */
+
+#define AUDIT_LOG_PATH "/var/log/audit/audit.log"
+
+/* One record (one line of the log) */
+typedef struct {
+    char type[32];                      /* "SYSCALL", "PATH", "USER_AUTH", ... */
+    time_t time;                        /* msg=audit(TIME.MSEC:SERIAL) */
+    int  msec;
+    unsigned long serial;               /* Shared by the records of one event */
+    const char *fields;                 /* "key=value ..." after the header */
+} audit_record_t;
+
+typedef void (*audit_record_fn)(const audit_record_t *rec, void *ctx);
+
+/* Position in the log, persisted in the state directory */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;                       /* 0: no cursor */
+    uint64_t offset;                    /* Just past the last whole record read */
+} audit_log_cursor_t;
+
+/*
+ * Pass each record after the cursor to fn and move the cursor to the
+ * end. With no cursor for this file, records from since onwards are
+ * passed. Returns the number of records, or -1 if the log is unreadable.
+ */
+long audit_log_read(const char *path, audit_log_cursor_t *cursor, time_t since,
+                    audit_record_fn fn, void *ctx);
+
+/* Value of key= in a record, quotes removed; false if absent */
+bool audit_record_field(const audit_record_t *rec, const char *key,
+                        char *out, size_t outsize);
+
+/* As above for strings auditd may log hex-encoded (name, comm, exe, acct) */
+bool audit_record_string(const audit_record_t *rec, const char *key,
+                         char *out, size_t outsize);
+
+bool load_audit_cursor(audit_log_cursor_t *cursor);
+bool save_audit_cursor(const audit_log_cursor_t *cursor);
+
 /* ============================================================
  * Function Prototypes
  * ============================================================ */
@@ -167,11 +214,20 @@ typedef struct {
 /* Main probe function */
 audit_summary_t* probe_audit(int window_seconds);
 
+/*
+ * Summarise the records of the log at path after cursor (see
+ * audit_log_read) into summary, in one pass. Returns the number of
+ * records read, or -1.
+ */
+long audit_scan_log(const char *path, audit_log_cursor_t *cursor, time_t since,
+                    audit_summary_t *summary);
+
 /* Cleanup */
 void free_audit_summary(audit_summary_t *summary);
 
-/* JSON output */
-void audit_to_json(const audit_summary_t *summary, char *buf, size_t bufsize);
+/* JSON output: writes "audit_summary" into the writer's open object */
+struct json_writer;
+void audit_json_member(struct json_writer *w, const audit_summary_t *summary);
 
 /* Baseline management */
 bool load_audit_baseline(audit_baseline_t *baseline);
@@ -0,0 +1,44 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fleet.h - Similarity matrix and drift clusters across many hosts
+ *
+ * Hosts whose signatures are at least `threshold` similar are linked,
+ * and each connected group is a cluster. The member most similar to
+ * the rest of its cluster is the reference the others are reported
+ * against.
+ */
+
+#ifndef SENTINEL_FLEET_H
+#define SENTINEL_FLEET_H
+
+#include "fpdiff.h"
+
+#define FLEET_DEFAULT_THRESHOLD 0.75
+
+typedef struct {
+    int host_count;
+    float *similarity;          /* host_count x host_count, row-major */
+    int *cluster;               /* Cluster of each host */
+    int cluster_count;          /* Numbered largest first */
+    int *cluster_size;
+    int *reference;             /* Reference host of each cluster */
+} fleet_t;
+
+/* Matrix rows run on the worker pool (workpool_set_jobs). Returns 0 or -1 */
+int fleet_cluster(fleet_t *f, const fpdiff_signature_t *sigs, int host_count,
+                  double threshold);
+
+void fleet_free(fleet_t *f);
+
+static inline float fleet_similarity(const fleet_t *f, int a, int b) {
+    return f->similarity[(size_t)a * f->host_count + b];
+}
+
+#endif /* SENTINEL_FLEET_H */
@@ -0,0 +1,192 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fpbin.h - Compact binary fingerprint format
+ *
+ * An archive is a file of back-to-back records, one per capture, so
+ * watch mode can append a fingerprint every tick. A record is:
+ *
+ *   header     "CSFP", u16 version, u16 section count, u32 record
+ *              length, u32 reserved (little-endian, 16 bytes)
+ *   directory  per section: u32 id, u32 offset, u32 length
+ *   sections   in any order; unknown ids are skipped
+ *
+ * The string section is a table of NUL-terminated strings, each stored
+ * once per record; offset 0 is "". Every other section is a table:
+ * a varint row count and column count, then per column an encoding
+ * byte, a varint byte length and the values. Integers are LEB128
+ * varints, signed ones zigzagged, and sorted-ish columns such as pids
+ * and timestamps store the difference from the previous row. Columns
+ * are only ever appended, so older readers ignore new ones and newer
+ * readers see zeros for columns an older writer did not have.
+ *
+ * The reader maps the file and hands out pointers into it: strings in
+ * a decoded fingerprint point into the mapping, and column cursors
+ * scan one field across all rows without decoding the rest.
+ */
+
+#ifndef SENTINEL_FPBIN_H
+#define SENTINEL_FPBIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sentinel.h"
+
+#define FPBIN_MAGIC "CSFP"
+#define FPBIN_VERSION 1
+#define FPBIN_HEADER_SIZE 16
+#define FPBIN_DIR_ENTRY_SIZE 12
+
+/* Section ids */
+typedef enum {
+    FPBIN_SEC_META = 1,             /* One row of system-wide fields */
+    FPBIN_SEC_STRINGS,
+    FPBIN_SEC_PROCESSES,
+    FPBIN_SEC_CONFIGS,
+    FPBIN_SEC_LISTENERS,
+    FPBIN_SEC_CONNECTIONS,
+    FPBIN_SEC_MAX
+} fpbin_section_t;
+
+/* Column encodings */
+typedef enum {
+    FPBIN_ENC_UVARINT = 1,
+    FPBIN_ENC_SVARINT,              /* Zigzag */
+    FPBIN_ENC_DELTA,                /* Zigzag difference from the previous row */
+    FPBIN_ENC_STRING,               /* Varint offset into the string section */
+    FPBIN_ENC_BYTE,                 /* One raw byte per row */
+    FPBIN_ENC_DIGEST                /* Tag byte: 0 empty, 32 + raw SHA256, 1 + string */
+} fpbin_encoding_t;
+
+/* Columns, per section, in file order */
+enum {
+    FPBIN_META_HOSTNAME, FPBIN_META_KERNEL, FPBIN_META_BOOT_TIME, FPBIN_META_PROBE_TIME,
+    FPBIN_META_LOAD1, FPBIN_META_LOAD5, FPBIN_META_LOAD15,     /* x1000 */
+    FPBIN_META_TOTAL_RAM, FPBIN_META_FREE_RAM, FPBIN_META_UPTIME,
+    FPBIN_META_PROBE_US, FPBIN_META_PROBE_ERRORS,
+    FPBIN_META_CACHE_HITS, FPBIN_META_CACHE_MISSES, FPBIN_META_PROCS_UNLISTED,
+    FPBIN_META_NET_BACKEND, FPBIN_META_NET_LISTENING, FPBIN_META_NET_ESTABLISHED,
+    FPBIN_META_NET_UNUSUAL, FPBIN_META_NET_INDEX_US, FPBIN_META_NET_LOOKUP_US,
+    FPBIN_META_COLUMNS
+};
+
+enum {
+    FPBIN_PROC_PID, FPBIN_PROC_PPID, FPBIN_PROC_NAME, FPBIN_PROC_STATE,
+    FPBIN_PROC_RSS, FPBIN_PROC_VSIZE, FPBIN_PROC_START_TIME, FPBIN_PROC_FDS,
+    FPBIN_PROC_THREADS, FPBIN_PROC_CPU,                         /* CPU x100 */
+    FPBIN_PROC_AGE, FPBIN_PROC_STUCK,
+    FPBIN_PROC_COLUMNS
+};
+
+enum {
+    FPBIN_CFG_PATH, FPBIN_CFG_SIZE, FPBIN_CFG_MTIME, FPBIN_CFG_CTIME,
+    FPBIN_CFG_MODE, FPBIN_CFG_OWNER, FPBIN_CFG_GROUP, FPBIN_CFG_CHECKSUM,
+    FPBIN_CFG_COLUMNS
+};
+
+enum {
+    FPBIN_LSN_PROTOCOL, FPBIN_LSN_ADDR, FPBIN_LSN_PORT, FPBIN_LSN_STATE,
+    FPBIN_LSN_INODE, FPBIN_LSN_PID, FPBIN_LSN_PROCESS,
+    FPBIN_LSN_COLUMNS
+};
+
+enum {
+    FPBIN_CONN_PROTOCOL, FPBIN_CONN_LOCAL_ADDR, FPBIN_CONN_LOCAL_PORT,
+    FPBIN_CONN_REMOTE_ADDR, FPBIN_CONN_REMOTE_PORT, FPBIN_CONN_STATE,
+    FPBIN_CONN_INODE, FPBIN_CONN_PID, FPBIN_CONN_PROCESS,
+    FPBIN_CONN_COLUMNS
+};
+
+/* ============================================================
+ * Writing
+ * ============================================================ */
+
+/* Encode one record (caller must free *out). Returns 0 or -1 */
+int fpbin_encode(const fingerprint_t *fp, unsigned char **out, size_t *len);
+
+/*
+ * Append one record to an archive, creating it if needed. Appenders hold
+ * a write lock on the file; a record left torn at the end by a crash is
+ * cut off first.
+ */
+int fpbin_append(const char *path, const fingerprint_t *fp);
+
+/* ============================================================
+ * Reading
+ * ============================================================ */
+
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    int mapped;                 /* munmap() on close */
+} fpbin_file_t;
+
+typedef struct {
+    const unsigned char *data;
+    size_t len;
+} fpbin_span_t;
+
+/* One record; every pointer is into the file */
+typedef struct {
+    unsigned version;
+    size_t offset;                          /* Within the file */
+    size_t size;
+    fpbin_span_t sections[FPBIN_SEC_MAX];   /* Indexed by id; len 0 if absent */
+} fpbin_record_t;
+
+/* Scans one column of one section */
+typedef struct {
+    const fpbin_record_t *record;
+    const unsigned char *p;
+    const unsigned char *end;
+    int encoding;               /* 0 if the column is absent: yields zeros */
+    int64_t prev;               /* FPBIN_ENC_DELTA running value */
+    int error;
+} fpbin_cursor_t;
+
+/* Does this look like a binary fingerprint? */
+int fpbin_detect(const void *data, size_t size);
+
+/* Map an archive read-only. Returns 0, or -1 with errno set */
+int fpbin_open(fpbin_file_t *f, const char *path);
+
+/* Read from memory instead; data must outlive the file */
+void fpbin_open_memory(fpbin_file_t *f, const void *data, size_t size);
+void fpbin_close(fpbin_file_t *f);
+
+/*
+ * Step through records: start with *offset = 0. Returns 1 with rec
+ * filled in, 0 at the end of the file, -1 if the record is corrupt.
+ */
+int fpbin_next_record(const fpbin_file_t *f, size_t *offset, fpbin_record_t *rec);
+
+/* Rows in a table section (0 if absent or corrupt) */
+int fpbin_rows(const fpbin_record_t *r, fpbin_section_t section);
+
+/* Start a cursor on a column. Returns -1 for a corrupt section */
+int fpbin_column(const fpbin_record_t *r, fpbin_section_t section, int column,
+                 fpbin_cursor_t *c);
+
+/* Next value; strings and checksums come back as "" when absent */
+int64_t fpbin_next_int(fpbin_cursor_t *c);
+const char* fpbin_next_string(fpbin_cursor_t *c);
+void fpbin_next_checksum(fpbin_cursor_t *c, char hex[65]);
+
+/* String table entry, or "" for an out-of-range offset */
+const char* fpbin_string(const fpbin_record_t *r, uint64_t offset);
+
+/*
+ * Rebuild a fingerprint from a record. Arrays are allocated in fp's
+ * arena but strings point into the file, which must stay open until
+ * fingerprint_free(). Returns 0 or -1.
+ */
+int fpbin_decode(const fpbin_record_t *r, fingerprint_t *fp);
+
+#endif /* SENTINEL_FPBIN_H */
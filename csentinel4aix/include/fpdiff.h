@@ -0,0 +1,99 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fpdiff.h - Structural diff between two fingerprints
+ *
+ * Unlike delta.c, which tracks one host from tick to tick by pid,
+ * this compares fingerprints that may come from different hosts, so
+ * entries are matched on keys that mean the same thing on both:
+ *
+ *   processes  name plus the names of its parents ("init>sshd>sshd");
+ *              several processes can share a key, so counts are compared
+ *   listeners  protocol, address and port
+ *   configs    path
+ *
+ * Both sides go into one hash table keyed on that text, so a diff is
+ * linear in the size of the two fingerprints.
+ */
+
+#ifndef SENTINEL_FPDIFF_H
+#define SENTINEL_FPDIFF_H
+
+#include <stdint.h>
+
+#include "sentinel.h"
+#include "json_writer.h"
+
+/* Parents followed when building a process key */
+#define FPDIFF_CHAIN_DEPTH 8
+
+typedef enum {
+    FPDIFF_SYSTEM = 0,
+    FPDIFF_PROCESS,
+    FPDIFF_LISTENER,
+    FPDIFF_CONFIG
+} fpdiff_section_t;
+
+typedef enum {
+    FPDIFF_CHANGED = 0,         /* Same key, field differs */
+    FPDIFF_ADDED,               /* Only in b */
+    FPDIFF_REMOVED              /* Only in a */
+} fpdiff_kind_t;
+
+typedef struct {
+    fpdiff_section_t section;
+    fpdiff_kind_t kind;
+    const char *key;            /* Field name for FPDIFF_SYSTEM */
+    const char *field;          /* What differs; NULL when added/removed */
+    const char *value_a;        /* "" on the side an entry is missing from */
+    const char *value_b;
+    double percent;             /* Numeric fields, else 0 */
+    int is_numeric;
+    int is_significant;         /* Worthy of highlighting */
+} fpdiff_item_t;
+
+typedef struct {
+    fpdiff_item_t *items;       /* System fields first, then processes, listeners, configs */
+    int count;
+    int capacity;
+    int significant;
+    arena_t arena;              /* Owns items and every string in them */
+} fpdiff_t;
+
+/* Compare a against b. Returns 0, or -1 if out of memory */
+int fpdiff_compare(fpdiff_t *d, const fingerprint_t *a, const fingerprint_t *b);
+
+void fpdiff_free(fpdiff_t *d);
+
+const char* fpdiff_section_name(fpdiff_section_t section);
+const char* fpdiff_kind_name(fpdiff_kind_t kind);
+
+/* One object: {"a": ..., "b": ..., "differences": n, "items": [...]} */
+void fpdiff_write_json(json_writer_t *w, const fpdiff_t *d,
+                       const char *name_a, const char *name_b);
+
+/*
+ * What a host runs, as a set of hashed keys: process keys, listener
+ * keys and config paths, but not contents. Hosts in the same role
+ * share most keys however far their configs have drifted; the drift
+ * itself is what fpdiff_compare() reports. Comparing two signatures
+ * is a merge, so a fleet's similarity matrix costs microseconds per
+ * pair.
+ */
+typedef struct {
+    uint64_t *hashes;           /* Sorted, unique; allocated in the caller's arena */
+    int count;
+} fpdiff_signature_t;
+
+int fpdiff_signature(arena_t *a, const fingerprint_t *fp, fpdiff_signature_t *sig);
+
+/* Jaccard similarity: shared keys over all keys, 1.0 for identical sets */
+double fpdiff_similarity(const fpdiff_signature_t *a, const fpdiff_signature_t *b);
+
+#endif /* SENTINEL_FPDIFF_H */
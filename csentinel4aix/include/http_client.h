@@ -0,0 +1,66 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * http_client.h - Minimal HTTP/1.1 client for webhooks
+ *
+ * One client posts to one URL over a keep-alive connection that is
+ * reused between requests. A connection the server has since closed is
+ * noticed before the next request, and a request that fails on a reused
+ * connection is sent once more on a fresh one, but only when the server
+ * cannot have taken it: the request could not be written, or the server
+ * closed without a byte of response. After a timeout it is not resent,
+ * so a server that handled it does not see it twice. Responses are read
+ * to the end (Content-Length, chunked, or until close) so the connection
+ * stays usable; only the status code is kept.
+ *
+ * https:// needs OpenSSL, which the build uses whenever it finds it
+ * (make OPENSSL=0 leaves it out); the server's certificate is verified
+ * against the system trust store.
+ */
+
+#ifndef SENTINEL_HTTP_CLIENT_H
+#define SENTINEL_HTTP_CLIENT_H
+
+#include <stddef.h>
+
+#define HTTP_TIMEOUT_MS     5000
+#define HTTP_BUF_SIZE       16384
+
+typedef struct {
+    char host[256];
+    int port;
+    char path[1024];
+    int tls;
+    int fd;                     /* -1 when not connected */
+    void *ssl;                  /* SSL * with OpenSSL */
+    void *ssl_ctx;              /* SSL_CTX *, kept across connections */
+
+    char buf[HTTP_BUF_SIZE];    /* Response bytes read ahead */
+    size_t buf_pos;
+    size_t buf_len;
+    int response_started;       /* This request got a response byte */
+    int peer_closed;            /* ... or the server closed (EOF, reset) */
+
+    /* Counters */
+    unsigned long requests;
+    unsigned long connects;
+    unsigned long failures;
+} http_client_t;
+
+/* Parse http://host[:port]/path or https://...; returns 0, or -1 */
+int http_client_init(http_client_t *c, const char *url);
+
+/* POST body; returns the HTTP status code, or -1 if there was no response */
+int http_client_post(http_client_t *c, const char *content_type,
+                     const char *body, size_t len);
+
+/* Close the connection and free TLS state */
+void http_client_close(http_client_t *c);
+
+#endif /* SENTINEL_HTTP_CLIENT_H */
@@ -0,0 +1,61 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * json_reader.h - Parse JSON documents into a tree
+ *
+ * The counterpart of json_writer.h, for tools that read fingerprints
+ * back: sentinel-diff and sentinel-fpconv. Every node and decoded
+ * string lives in the caller's arena, so a document is released with
+ * one arena_free().
+ */
+
+#ifndef SENTINEL_JSON_READER_H
+#define SENTINEL_JSON_READER_H
+
+#include <stddef.h>
+
+#include "sentinel.h"
+
+#define JSON_READER_MAX_DEPTH 64
+
+typedef enum {
+    JSON_NULL = 0,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} json_type_t;
+
+typedef struct json_value json_value_t;
+
+struct json_value {
+    json_type_t type;
+    const char *key;            /* Member name, when inside an object */
+    double number;              /* JSON_NUMBER; JSON_BOOL is 0 or 1 */
+    const char *string;         /* JSON_STRING, unescaped */
+    json_value_t *child;        /* First member or element */
+    json_value_t *next;         /* Next sibling */
+    int count;                  /* Members or elements */
+};
+
+/*
+ * Parse len bytes of text. Returns the root, or NULL on a syntax error,
+ * in which case *error_offset (if given) is where parsing stopped.
+ */
+json_value_t* json_parse(arena_t *a, const char *text, size_t len, size_t *error_offset);
+
+/* Object member by name, or NULL if obj is not an object or lacks it */
+const json_value_t* json_member(const json_value_t *obj, const char *key);
+
+/* Typed access with a fallback for missing or mistyped values */
+double json_as_number(const json_value_t *v, double fallback);
+const char* json_as_string(const json_value_t *v, const char *fallback);
+
+#endif /* SENTINEL_JSON_READER_H */
@@ -0,0 +1,87 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * json_writer.h - Streaming JSON output
+ *
+ * Documents are written member by member through a fixed-size buffer
+ * that is flushed to a file descriptor, a FILE*, a growing string or a
+ * callback (such as a sanitize stream).
+ * The writer tracks nesting, so callers never emit commas, quotes or
+ * indentation themselves and sections compose as real nested members.
+ *
+ * Output is pretty-printed with two-space indentation. Containers
+ * opened with the _inline variants stay on one line, which is how
+ * short arrays such as load_average are written.
+ */
+
+#ifndef SENTINEL_JSON_WRITER_H
+#define SENTINEL_JSON_WRITER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define JSON_WRITER_BUF_SIZE  8192
+#define JSON_WRITER_MAX_DEPTH 32
+
+typedef enum {
+    JSON_SINK_FD = 0,
+    JSON_SINK_FILE,
+    JSON_SINK_MEMORY,
+    JSON_SINK_CALLBACK
+} json_sink_t;
+
+/* Callback sink; returns 0, or -1 on a write error */
+typedef int (*json_sink_fn)(void *ctx, const char *data, size_t len);
+
+typedef struct json_writer {
+    char buf[JSON_WRITER_BUF_SIZE];
+    size_t len;
+    json_sink_t sink;
+    int fd;
+    FILE *file;
+    char *mem;                  /* JSON_SINK_MEMORY: document so far */
+    size_t mem_len;
+    size_t mem_cap;
+    json_sink_fn callback;      /* JSON_SINK_CALLBACK */
+    void *callback_ctx;
+    int error;                  /* Sticky; checked by json_writer_finish() */
+    int depth;
+    int members[JSON_WRITER_MAX_DEPTH];     /* Written so far at each level */
+    int inline_depth;           /* Level where one-line output began, 0 if none */
+} json_writer_t;
+
+/* Sinks */
+void json_writer_fd(json_writer_t *w, int fd);
+void json_writer_file(json_writer_t *w, FILE *f);
+void json_writer_memory(json_writer_t *w);
+void json_writer_callback(json_writer_t *w, json_sink_fn fn, void *ctx);
+
+/* Flush what is buffered; returns 0, or -1 if any write failed */
+int json_writer_finish(json_writer_t *w);
+
+/* Memory sink: finish and hand over the document (caller must free) */
+char* json_writer_take(json_writer_t *w);
+
+/* Containers; key is NULL for the root and for array elements */
+void json_object_begin(json_writer_t *w, const char *key);
+void json_object_begin_inline(json_writer_t *w, const char *key);
+void json_object_end(json_writer_t *w);
+void json_array_begin(json_writer_t *w, const char *key);
+void json_array_begin_inline(json_writer_t *w, const char *key);
+void json_array_end(json_writer_t *w);
+
+/* Values */
+void json_string(json_writer_t *w, const char *key, const char *value);
+void json_int(json_writer_t *w, const char *key, long long value);
+void json_uint(json_writer_t *w, const char *key, unsigned long long value);
+void json_double(json_writer_t *w, const char *key, double value, int decimals);
+void json_bool(json_writer_t *w, const char *key, int value);
+void json_null(json_writer_t *w, const char *key);
+
+#endif /* SENTINEL_JSON_WRITER_H */
@@ -0,0 +1,103 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * log_writer.h - Buffered, self-rotating line log
+ *
+ * Lines are gathered in a userspace buffer and written together (group
+ * commit): when the buffer is full, when the oldest buffered line is
+ * older than flush_ms at the next append, or on log_writer_flush().
+ *
+ * After a commit the log rotates if it has reached max_bytes or its
+ * segment is older than max_age_s: PATH is renamed to PATH.1 (older
+ * segments shift to PATH.2 ... PATH.keep, the oldest is removed) and a
+ * new PATH is opened. With compression, rotated segments become
+ * PATH.N.gz; that needs a build with zlib (make ZLIB=1). Compression
+ * runs in a background thread, so only the renames are on the caller's
+ * path; the next rotation and log_writer_close() wait for it.
+ */
+
+#ifndef SENTINEL_LOG_WRITER_H
+#define SENTINEL_LOG_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#define LOG_WRITER_BUFFER       (64 * 1024)
+#define LOG_WRITER_FLUSH_MS     1000
+#define LOG_WRITER_MAX_BYTES    (100ULL * 1024 * 1024)
+#define LOG_WRITER_KEEP         4
+#define LOG_WRITER_MAX_KEEP     99
+
+/* When to fsync() */
+typedef enum {
+    LOG_FSYNC_NEVER = 0,
+    LOG_FSYNC_ROTATE,           /* Before a segment is rotated away */
+    LOG_FSYNC_COMMIT            /* After every group commit */
+} log_fsync_t;
+
+typedef struct {
+    size_t buffer_size;
+    int flush_ms;
+    log_fsync_t fsync;
+    uint64_t max_bytes;         /* 0: no size rotation */
+    int max_age_s;              /* 0: no age rotation */
+    int keep;                   /* Rotated segments kept */
+    int compress;               /* gzip rotated segments */
+} log_writer_opts_t;
+
+typedef struct {
+    char path[512];
+    int fd;
+    log_writer_opts_t opts;
+
+    char *buf;
+    size_t len;
+    int64_t first_ms;           /* When the oldest buffered line came in */
+
+    uint64_t size;              /* Bytes written to this segment */
+    time_t segment_start;
+
+    /* Background compression of the last rotated segment */
+    pthread_t compressor;
+    int compressing;
+    int compress_rc;            /* Set by the compressor, read after the join */
+    char compress_src[600];
+
+    /* Counters */
+    unsigned long lines;
+    unsigned long commits;      /* write() batches */
+    unsigned long fsyncs;
+    unsigned long rotations;
+    unsigned long errors;
+} log_writer_t;
+
+/* Defaults: 64 KB buffer, 1 s, fsync on rotate, 100 MB segments, keep 4 */
+void log_writer_defaults(log_writer_opts_t *opts);
+
+/*
+ * Apply "size=MB,age=HOURS,keep=N,gzip,fsync=never|rotate|commit,flush=MS"
+ * on top of opts. Returns 0, or -1 on an unknown or malformed item.
+ */
+int log_writer_parse_opts(log_writer_opts_t *opts, const char *spec);
+
+/* Open (appending) PATH; opts may be NULL for the defaults. Returns 0, or -1 */
+int log_writer_open(log_writer_t *w, const char *path, const log_writer_opts_t *opts);
+
+/* Add one line (a newline is appended). Returns 0, or -1 on a write error */
+int log_writer_append(log_writer_t *w, const char *line, size_t len);
+
+/* Write what is buffered now, rotating if due */
+int log_writer_flush(log_writer_t *w);
+
+/* Flush and close */
+void log_writer_close(log_writer_t *w);
+
+#endif /* SENTINEL_LOG_WRITER_H */
@@ -0,0 +1,95 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * metrics.h - Prometheus/OpenMetrics exporter
+ *
+ * The exporter loop captures on its own schedule and renders the result
+ * once into a page; the server answers every scrape of /metrics from the
+ * current page, so scrapes cost the same however many scrapers there are
+ * and never trigger a probe. Pages are reference counted: publishing a
+ * new one does not disturb responses still being sent from the old.
+ *
+ * One server thread multiplexes all connections with poll(), keeps them
+ * alive between scrapes and drops those idle for METRICS_IDLE_MS.
+ */
+
+#ifndef SENTINEL_METRICS_H
+#define SENTINEL_METRICS_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "sentinel.h"
+#ifndef _AIX
+#include "audit.h"
+#endif
+
+#define METRICS_MAX_CONNS       64
+#define METRICS_REQUEST_MAX     4096
+#define METRICS_IDLE_MS         30000
+
+/* A rendered /metrics body */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    int failed;                 /* An append ran out of memory */
+    int refs;                   /* Under the server's lock once published */
+} metrics_page_t;
+
+/* What a page is rendered from; fp is required, NULL members are left out */
+typedef struct {
+    const fingerprint_t *fp;
+    const quick_analysis_t *analysis;
+    const deviation_report_t *deviations;   /* NULL: no baseline */
+#ifdef _AIX
+    const aix_audit_summary_t *audit;
+#else
+    const audit_summary_t *audit;
+#endif
+    int status;                 /* EXIT_OK, EXIT_WARNINGS or EXIT_CRITICAL */
+    unsigned long refreshes;
+} metrics_input_t;
+
+/* Render in OpenMetrics text (also valid Prometheus 0.0.4); NULL on failure */
+metrics_page_t *metrics_render(const metrics_input_t *in);
+
+/* Free a page that was never published */
+void metrics_page_free(metrics_page_t *page);
+
+typedef struct {
+    int listen_fd;
+    int wake[2];                /* Written to stop the server thread */
+    pthread_t thread;
+    int running;
+    void *conns;                /* Connection table, server thread only */
+    char addr[128];             /* As given, for messages */
+
+    pthread_mutex_t lock;
+    metrics_page_t *page;       /* NULL until the first publish */
+
+    /* Counters, server thread only */
+    unsigned long scrapes;
+    unsigned long connections;
+    unsigned long rejected;     /* Over METRICS_MAX_CONNS */
+} metrics_server_t;
+
+/*
+ * Listen on "[HOST]:PORT" (":9464" for every address) and start the
+ * server thread. Returns 0, or -1 with a message on stderr.
+ */
+int metrics_server_start(metrics_server_t *s, const char *listen_addr);
+
+/* Make page the one scrapes are served from; the server takes ownership */
+void metrics_server_publish(metrics_server_t *s, metrics_page_t *page);
+
+/* Stop the thread, close every connection and free the page */
+void metrics_server_stop(metrics_server_t *s);
+
+#endif /* SENTINEL_METRICS_H */
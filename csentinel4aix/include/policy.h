@@ -53,10 +53,27 @@ typedef struct {
  * - Privilege escalation attempts
  * - Write operations vs read-only
  * 
+ * All rules are checked in one pass over the command (see policy.c);
+ * where several match, the checks above take precedence in order.
+ * 
  * Returns: policy_result_t with decision and explanation
  */
 policy_result_t policy_check_command(const char *command);
 
+/*
+ * Check many commands, e.g. a replayed shell history, on the worker
+ * pool (workpool_set_jobs() in sentinel.h).
+ * 
+ * results[i] is what policy_check_command(commands[i]) would give.
+ * Audit entries are recorded as commands finish, so their order
+ * across workers is not the input order. Rules and mode must not
+ * change during the call.
+ * 
+ * Returns: 0, or -1 on bad arguments or if the rules cannot be compiled
+ */
+int policy_check_batch(const char *const *commands, int count,
+                       policy_result_t *results);
+
 /*
  * Check if a file path is safe to recommend for modification.
  * 
@@ -81,7 +98,7 @@ typedef enum {
     RULE_WARN_COMMAND       /* Allow but warn */
 } rule_type_t;
 
-/* Add a custom rule at runtime */
+/* Add a custom rule at runtime; -1 if full or the rules cannot be recompiled */
 int policy_add_rule(rule_type_t type, const char *pattern, 
                     risk_level_t risk, const char *reason);
 
@@ -105,7 +122,11 @@ typedef struct {
 /* Enable/disable audit logging */
 void policy_set_audit(int enabled);
 
-/* Get recent audit entries (returns count, fills buffer) */
+/*
+ * Get recent audit entries, oldest first (returns count, fills buffer).
+ * Safe while other threads are checking commands: each entry copied
+ * is whole, and ones being written at that moment are left out.
+ */
 int policy_get_audit_log(audit_entry_t *entries, int max_entries);
 
 /* ============================================================
@@ -125,7 +146,7 @@ void policy_set_mode(policy_mode_t mode);
 /* Get current mode */
 policy_mode_t policy_get_mode(void);
 
-/* Initialize policy engine with defaults */
+/* Initialize policy engine with defaults and compile the built-in rules */
 int policy_init(void);
 
 /* Cleanup */
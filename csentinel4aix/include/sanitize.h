@@ -66,6 +66,21 @@ int sanitize_string(char *str, size_t max_len, sanitize_flags_t flags);
 int sanitize_string_copy(const char *input, char *output, 
                          size_t out_size, sanitize_flags_t flags);
 
+/*
+ * Sanitize a string to a newly allocated buffer.
+ * 
+ * The buffer is sized to fit every redaction, so nothing is skipped
+ * for lack of space. Input need not be NUL-terminated.
+ * 
+ * @param input       Input text
+ * @param len         Length of input in bytes
+ * @param flags       What to sanitize
+ * @param redactions  Set to the number of redactions (may be NULL)
+ * @return            Sanitized copy (caller frees), or NULL on error
+ */
+char* sanitize_alloc(const char *input, size_t len, 
+                     sanitize_flags_t flags, int *redactions);
+
 /*
  * Sanitize JSON content.
  * 
@@ -79,6 +94,56 @@ int sanitize_string_copy(const char *input, char *output,
  */
 int sanitize_json(char *json, size_t max_len, sanitize_flags_t flags);
 
+/* ============================================================
+ * Streaming Sanitization
+ * ============================================================ */
+
+/* Input held back while waiting for a safe place to cut */
+#define SANITIZE_STREAM_HOLD 65536
+
+/* Where sanitized output goes; returns 0, or -1 on a write error */
+typedef int (*sanitize_sink_fn)(void *ctx, const char *data, size_t len);
+
+typedef struct sanitize_stream sanitize_stream_t;
+
+/*
+ * Start a stream that sanitizes whatever is written to it and passes
+ * the result to sink, in constant memory.
+ * 
+ * Text is held back only until the next whitespace that no pattern
+ * spans, so the output is exactly what sanitize_alloc() would give
+ * for the whole input. Only a run of SANITIZE_STREAM_HOLD bytes with
+ * no such whitespace is cut elsewhere (see sanitize_stream_forced_cuts),
+ * and a redaction spanning that cut can be missed.
+ * 
+ * Patterns must not change while a stream is open.
+ * 
+ * @param flags     What to sanitize
+ * @param sink      Receives sanitized output
+ * @param ctx       Passed to sink
+ * @return          Stream, or NULL on error
+ */
+sanitize_stream_t* sanitize_stream_new(sanitize_flags_t flags,
+                                       sanitize_sink_fn sink, void *ctx);
+
+/*
+ * Sanitize a chunk; chunks may split words, patterns or lines anywhere.
+ * 
+ * @return          0, or -1 if anything has failed so far
+ */
+int sanitize_stream_write(sanitize_stream_t *stream, const char *chunk, size_t len);
+
+/*
+ * Sanitize and pass on everything held back.
+ * 
+ * @return          Total redactions made, or -1 if anything failed
+ */
+int sanitize_stream_finish(sanitize_stream_t *stream);
+
+int sanitize_stream_forced_cuts(const sanitize_stream_t *stream);
+
+void sanitize_stream_free(sanitize_stream_t *stream);
+
 /* ============================================================
  * Pattern Management
  * ============================================================ */
@@ -143,6 +208,9 @@ void sanitize_get_stats(sanitize_stats_t *stats);
 
 /*
  * Initialize sanitizer with default patterns.
+ * 
+ * All patterns are compiled into one automaton here; patterns added
+ * later are compiled on the next sanitization.
  */
 int sanitize_init(void);
 
@@ -0,0 +1,57 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * sanitize_scan.h - Candidate pre-filter for the sanitizer's word scan
+ *
+ * A word can only be an IP address or a home directory if it holds a
+ * trigger: a '.' or ':' next to a hex digit, or a '/' followed by 'h',
+ * 'U' or 'r'. The sanitizer validates only the words around triggers;
+ * the skip kernels find them a vector at a time.
+ */
+
+#ifndef SENTINEL_SANITIZE_SCAN_H
+#define SENTINEL_SANITIZE_SCAN_H
+
+#include <stddef.h>
+
+typedef enum {
+    SANITIZE_SCAN_AUTO = 0,
+    SANITIZE_SCAN_SCALAR,       /* Byte at a time */
+    SANITIZE_SCAN_SSE2,         /* x86, 16 bytes at a time */
+    SANITIZE_SCAN_AVX2,         /* x86, 32 bytes at a time */
+    SANITIZE_SCAN_VSX,          /* POWER8, 16 bytes at a time */
+    SANITIZE_SCAN_COUNT
+} sanitize_scan_t;
+
+/* Backend selection - AUTO picks the widest available */
+int sanitize_scan_available(sanitize_scan_t scan);
+int sanitize_set_scan(sanitize_scan_t scan);
+sanitize_scan_t sanitize_get_scan(void);
+const char* sanitize_scan_name(sanitize_scan_t scan);
+
+/* Index of the first trigger at or after from, or len */
+size_t sanitize_next_candidate(const char *s, size_t from, size_t len);
+
+/* ============================================================
+ * Kernels (sanitize_simd.c)
+ * ============================================================
+ * Each returns an index no later than the first trigger at or after
+ * from: past every vector known to hold none. Bytes a vector cannot
+ * cover (the first and last few) are left to the scalar check.
+ */
+
+size_t sanitize_skip_sse2(const char *s, size_t from, size_t len);
+size_t sanitize_skip_avx2(const char *s, size_t from, size_t len);
+size_t sanitize_skip_vsx(const char *s, size_t from, size_t len);
+
+int sanitize_cpu_has_sse2(void);
+int sanitize_cpu_has_avx2(void);
+int sanitize_vsx_built(void);          /* sanitize_simd.c built with -mcpu=power8 */
+
+#endif /* SENTINEL_SANITIZE_SCAN_H */
@@ -22,11 +22,53 @@
 /* Version and limits */
 #define SENTINEL_VERSION "0.6.0"
 #define MAX_PATH_LEN 4096
-#define MAX_PROCS 1024
 #define MAX_FDS_PER_PROC 256
 #define MAX_CONFIG_FILES 256
-#define MAX_LISTENERS 128
-#define MAX_CONNECTIONS 256
+
+/* ============================================================
+ * Arena Allocator - Per-capture Memory
+ * ============================================================
+ * A fingerprint's arrays and strings all live in its arena and are
+ * released together. Strings are interned, so a process name seen
+ * a thousand times is stored once.
+ */
+
+typedef struct arena_block arena_block_t;
+
+typedef struct {
+    arena_block_t *head;        /* Most recent block first */
+    void *last_alloc;           /* Lets arena_grow() extend in place */
+    size_t last_size;
+    size_t bytes_used;
+    size_t bytes_reserved;
+    const char **intern_slots;  /* Open-addressed intern table */
+    size_t intern_size;
+    size_t intern_count;
+} arena_t;
+
+void arena_init(arena_t *a);
+void* arena_alloc(arena_t *a, size_t size);
+void* arena_grow(arena_t *a, void *array, size_t elem_size, int count, int *capacity);
+const char* arena_intern(arena_t *a, const char *s);
+const char* arena_intern_n(arena_t *a, const char *s, size_t len);
+void arena_free(arena_t *a);
+
+/* ============================================================
+ * Worker Pool - Parallel Capture (--jobs)
+ * ============================================================
+ * workpool_for() runs fn for each index across the configured jobs.
+ * Callers give every index its own output slot and merge in index
+ * order, so results do not depend on the job count. One job (the
+ * default) runs inline with no threads. Batches from different threads
+ * run one after another; a call from inside fn runs inline.
+ */
+
+typedef void (*workpool_fn)(int index, void *ctx);
+
+void workpool_set_jobs(int jobs);       /* <= 0 means one per online CPU */
+int workpool_jobs(void);
+int workpool_for(int count, workpool_fn fn, void *ctx);
+void workpool_shutdown(void);
 
 /* ============================================================
  * Core Data Structures - The "System Fingerprint"
@@ -51,7 +93,7 @@ typedef struct {
 typedef struct {
     pid_t pid;
     pid_t ppid;
-    char name[256];
+    const char *name;           /* Interned */
     char state;                 /* R, S, D, Z, T, etc. */
     uint64_t rss_bytes;         /* Resident memory */
     uint64_t vsize_bytes;       /* Virtual memory */
@@ -74,7 +116,7 @@ typedef struct {
 
 /* Config file metadata - for drift detection */
 typedef struct {
-    char path[MAX_PATH_LEN];
+    const char *path;           /* Interned */
     uint64_t size;
     time_t mtime;
     time_t ctime;
@@ -86,48 +128,61 @@ typedef struct {
 
 /* Network listener - for detecting unexpected open ports */
 typedef struct {
-    char protocol[8];           /* tcp, tcp6, udp, udp6 */
-    char local_addr[64];        /* IP address */
+    const char *protocol;       /* tcp, tcp6, udp, udp6 */
+    const char *local_addr;     /* IP address */
     uint16_t local_port;
-    char state[16];             /* LISTEN, ESTABLISHED, etc. */
+    const char *state;          /* LISTEN, ESTABLISHED, etc. */
+    unsigned long inode;        /* Socket inode (Linux) */
     pid_t pid;                  /* Process owning this socket */
-    char process_name[256];     /* Name of owning process */
+    const char *process_name;   /* Name of owning process */
 } net_listener_t;
 
 /* Network connection - for detecting suspicious connections */
 typedef struct {
-    char protocol[8];
-    char local_addr[64];
+    const char *protocol;
+    const char *local_addr;
     uint16_t local_port;
-    char remote_addr[64];
+    const char *remote_addr;
     uint16_t remote_port;
-    char state[16];
+    const char *state;
+    unsigned long inode;
     pid_t pid;
-    char process_name[256];
+    const char *process_name;
 } net_connection_t;
 
-/* Network summary */
+/* Network summary - arrays live in the fingerprint's arena */
 typedef struct {
-    net_listener_t listeners[MAX_LISTENERS];
+    net_listener_t *listeners;
     int listener_count;
-    net_connection_t connections[MAX_CONNECTIONS];
+    int listener_capacity;
+    net_connection_t *connections;
     int connection_count;
+    int connection_capacity;
     int total_established;
     int total_listening;
     int unusual_port_count;     /* Ports not in common list */
+    char backend[16];           /* netlink, procfs or netstat */
+    /* Socket owner attribution cost */
+    double owner_index_ms;      /* Building the inode -> pid index */
+    double owner_lookup_ms;     /* Resolving every socket through it */
 } network_info_t;
 
-/* The complete system fingerprint */
+/* The complete system fingerprint - release with fingerprint_free() */
 typedef struct {
     system_info_t system;
-    process_info_t processes[MAX_PROCS];
+    process_info_t *processes;
     int process_count;
-    config_file_t configs[MAX_CONFIG_FILES];
+    config_file_t *configs;
     int config_count;
     network_info_t network;
     /* Metadata about the probe itself */
     double probe_duration_ms;
     int probe_errors;
+    int config_cache_hits;      /* Checksums reused from the hash cache */
+    int config_cache_misses;    /* Files that had to be rehashed */
+    int processes_unlisted;     /* In total_count but not in processes (JSON input) */
+    /* Owns every array and string above */
+    arena_t arena;
 } fingerprint_t;
 
 /* ============================================================
@@ -137,22 +192,129 @@ typedef struct {
 /* Initialize a fingerprint structure */
 int fingerprint_init(fingerprint_t *fp);
 
+/* Release everything a fingerprint owns */
+void fingerprint_free(fingerprint_t *fp);
+
+/* Deep copy into dst, which gets its own arena */
+int fingerprint_copy(fingerprint_t *dst, const fingerprint_t *src);
+
 /* Probe system basics: hostname, kernel, memory, load */
 int probe_system_info(system_info_t *info);
 
 /* Probe running processes from /proc */
-int probe_processes(process_info_t *procs, int max_procs, int *count);
+int probe_processes(arena_t *arena, process_info_t **procs, int *count);
 
-/* Probe specific config files for drift detection */
-int probe_config_files(const char **paths, int path_count, 
-                       config_file_t *configs, int *config_count);
+/* Probe specific config files for drift detection; checksums of
+ * unchanged files come from the hash cache (hit/miss counts optional) */
+int probe_config_files(arena_t *arena, const char **paths, int path_count,
+                       config_file_t **configs, int *config_count,
+                       int *cache_hits, int *cache_misses);
 
 /* Full fingerprint capture */
 int capture_fingerprint(fingerprint_t *fp, const char **config_paths, 
                         int config_path_count);
 
-/* Probe network state */
-int probe_network(network_info_t *net);
+/* Subsystems for capture_fingerprint_partial() */
+#define FP_PROBE_SYSTEM     0x01
+#define FP_PROBE_PROCESSES  0x02
+#define FP_PROBE_CONFIGS    0x04
+#define FP_PROBE_NETWORK    0x08    /* Caller probes; not carried over from prev */
+
+/* Capture probing only probe_mask; other subsystems are copied from prev */
+int capture_fingerprint_partial(fingerprint_t *fp, const fingerprint_t *prev,
+                                unsigned probe_mask, const char **config_paths,
+                                int config_path_count);
+
+/* ============================================================
+ * Event-driven Watch Mode
+ * ============================================================
+ * watch_wait() blocks until something changes or timeout_ms has passed
+ * since the last resync (WATCH_EVENT_RESYNC), however busy the sources.
+ * Linux uses inotify on the config files' directories and the netlink
+ * process connector; elsewhere, or when neither source can be opened,
+ * watch mode falls back to polling.
+ */
+
+#define WATCH_EVENT_CONFIG   0x01
+#define WATCH_EVENT_PROCESS  0x02
+#define WATCH_EVENT_RESYNC   0x04
+
+typedef struct {
+    unsigned events;            /* WATCH_EVENT_* */
+    int process_events;         /* exec + exit notifications coalesced */
+    const char *config_changed; /* Per config path: nonzero if touched */
+} watch_result_t;
+
+int watch_init(const char **paths, int count);     /* Returns active WATCH_EVENT_* sources */
+unsigned watch_wait(int timeout_ms, watch_result_t *result);
+void watch_close(void);
+
+/* Probe network state; arrays and strings are allocated from arena */
+int probe_network(arena_t *arena, network_info_t *net);
+
+/* Network probe backends (Linux); AIX always parses netstat */
+typedef enum {
+    NET_BACKEND_AUTO = 0,       /* netlink, falling back to procfs */
+    NET_BACKEND_NETLINK,        /* NETLINK_INET_DIAG only */
+    NET_BACKEND_PROCFS          /* /proc/net text files only */
+} net_backend_t;
+
+int probe_network_with(arena_t *arena, network_info_t *net, net_backend_t backend);
+
+/* Probe network state into a captured fingerprint, accounting its cost */
+int probe_fingerprint_network(fingerprint_t *fp);
+
+/* ============================================================
+ * Process Table Snapshot - One /proc Walk per Probe Cycle
+ * ============================================================
+ * Each pid's stat/psinfo and fd directory is read exactly once.
+ * The prober, network probe and audit process-chain builder look
+ * processes up through these views instead of re-walking /proc.
+ */
+
+#define PROC_SNAP_SOCKETS 0x01  /* Also index socket inodes per pid */
+
+typedef struct {
+    process_info_t info;
+    int has_sockets;            /* Owns at least one socket fd */
+    int first_child;            /* Index into procs, -1 if none */
+    int next_sibling;           /* Index into procs, -1 if none */
+} proc_entry_t;
+
+typedef struct {
+    unsigned long inode;
+    pid_t pid;
+} proc_socket_t;
+
+typedef struct {
+    proc_entry_t *procs;
+    int count;
+    int capacity;
+    int *pid_index;             /* Open-addressed pid -> procs index */
+    int pid_index_size;
+    proc_socket_t *sockets;     /* (inode, pid) pairs in /proc order */
+    int socket_count;
+    int socket_capacity;
+    unsigned flags;
+    time_t capture_time;
+    arena_t names;              /* Interned process names */
+} proc_snapshot_t;
+
+/* Capture a standalone snapshot (release with proc_snapshot_free) */
+int proc_snapshot_capture(proc_snapshot_t *snap, unsigned flags);
+void proc_snapshot_free(proc_snapshot_t *snap);
+
+/* Indexed views */
+const proc_entry_t* proc_snapshot_find(const proc_snapshot_t *snap, pid_t pid);
+const proc_entry_t* proc_snapshot_first_child(const proc_snapshot_t *snap, pid_t ppid);
+const proc_entry_t* proc_snapshot_next_sibling(const proc_snapshot_t *snap,
+                                               const proc_entry_t *entry);
+
+/* Shared snapshot for the current probe cycle */
+void proc_snapshot_request(unsigned flags);
+const proc_snapshot_t* proc_snapshot_refresh(void);
+const proc_snapshot_t* proc_snapshot_current(void);
+void proc_snapshot_release(void);
 
 /* ============================================================
  * Serialization - Convert to JSON for LLM
@@ -161,15 +323,69 @@ int probe_network(network_info_t *net);
 /* Serialize fingerprint to JSON string (caller must free) */
 char* fingerprint_to_json(const fingerprint_t *fp);
 
+/*
+ * Rebuild a fingerprint from fingerprint_to_json() output (or a watch
+ * keyframe). JSON lists only notable processes and rounded figures, so
+ * this is lossy; the rest are counted in processes_unlisted. Returns 0,
+ * or -1 if the text is not a fingerprint document.
+ */
+int fingerprint_from_json(fingerprint_t *fp, const char *json, size_t len);
+
+/*
+ * Write a fingerprint's members into the writer's open object (see
+ * json_writer.h); callers add their own members, such as audit, after.
+ * sequence > 0 tags the document as a watch-mode keyframe.
+ */
+struct json_writer;
+void fingerprint_json_members(struct json_writer *w, const fingerprint_t *fp,
+                              unsigned long sequence);
+
+/* ============================================================
+ * Delta Fingerprints - Watch Mode JSON
+ * ============================================================
+ * Watch mode numbers its documents. A keyframe is the full JSON plus
+ * "type" and "sequence"; a delta carries the summary sections and
+ * only the entries that changed since document base_sequence. A
+ * consumer that misses a sequence waits for the next keyframe.
+ */
+
+typedef struct {
+    const fingerprint_t *prev;
+    const fingerprint_t *cur;
+    int changes;                    /* Total entries below */
+    int *started;                   /* Indices into cur->processes */
+    int started_count;
+    int *exited;                    /* Indices into prev->processes */
+    int exited_count;
+    int *configs_changed;           /* New or modified, into cur->configs */
+    int configs_changed_count;
+    int *configs_removed;           /* Into prev->configs */
+    int configs_removed_count;
+    int *listeners_added;           /* Into cur->network.listeners */
+    int listeners_added_count;
+    int *listeners_removed;         /* Into prev->network.listeners */
+    int listeners_removed_count;
+    int *connections_added;         /* Into cur->network.connections */
+    int connections_added_count;
+    int *connections_removed;       /* Into prev->network.connections */
+    int connections_removed_count;
+    arena_t arena;
+} fingerprint_delta_t;
+
+/* Compare two captures; prev and cur must outlive the delta */
+int fingerprint_delta(fingerprint_delta_t *d, const fingerprint_t *prev,
+                      const fingerprint_t *cur);
+void fingerprint_delta_free(fingerprint_delta_t *d);
+
+/* Delta document members, as fingerprint_json_members() */
+void fingerprint_delta_json_members(struct json_writer *w, const fingerprint_delta_t *d,
+                                    unsigned long sequence, unsigned long base_sequence);
+
 /* ============================================================
  * Sanitization - Strip sensitive data before sending to LLM
  * ============================================================ */
 
-/* Redact IPs, usernames, and other PII from a string */
-int sanitize_string(char *str, int max_len);
-
-/* Sanitize entire fingerprint in place */
-int sanitize_fingerprint(fingerprint_t *fp);
+/* See sanitize.h; JSON output is streamed through it with -Z */
 
 /* ============================================================
  * Analysis Helpers - Deterministic Pre-checks
@@ -268,6 +484,23 @@ int baseline_compare(const baseline_t *b, const fingerprint_t *fp,
 void baseline_print_report(const baseline_t *b, const deviation_report_t *report);
 void baseline_print_info(const baseline_t *b);
 
+/* State directory shared by the baseline and caches */
+void sentinel_state_dir(char *path, size_t path_size);
+int sentinel_ensure_state_dir(void);
+
+/* ============================================================
+ * Config Hash Cache
+ * ============================================================
+ * SHA256 of config files keyed by (dev, inode, size, mtime, ctime),
+ * persisted in the state directory so unchanged files skip rehashing.
+ */
+
+int hash_cache_load(void);
+int hash_cache_lookup(const struct stat *st, char *out, size_t out_size);
+void hash_cache_store(const struct stat *st, const char *checksum, time_t now);
+int hash_cache_save(void);
+void hash_cache_free(void);
+
 /* ============================================================
  * Configuration
  * ============================================================ */
@@ -313,7 +546,7 @@ typedef struct {
 
 /* Probe AIX audit subsystem - defined in aix_audit.c */
 int probe_aix_audit(aix_audit_summary_t *summary, time_t since);
-int aix_audit_to_json(const aix_audit_summary_t *summary, char *buf, size_t buf_size);
+void aix_audit_json_member(struct json_writer *w, const aix_audit_summary_t *summary);
 aix_audit_summary_t* get_aix_audit_summary(void);
 int check_auth_audit_config(void);
 
@@ -347,9 +580,13 @@ typedef enum {
     SIEM_EVT_FINGERPRINT
 } siem_event_type_t;
 
-/* Initialize SIEM module */
-int siem_init(const char *syslog_host, int syslog_port, const char *format,
-              const char *logfile, const char *alert_email, int threshold);
+/*
+ * Initialize SIEM module; syslog_tcp selects TCP (octet-counted) over UDP,
+ * logfile_opts the log file's rotation and commit policy (log_writer.h)
+ */
+int siem_init(const char *syslog_host, int syslog_port, int syslog_tcp, const char *format,
+              const char *logfile, const char *logfile_opts,
+              const char *alert_email, int threshold);
 
 /* Cleanup SIEM module */
 void siem_cleanup(void);
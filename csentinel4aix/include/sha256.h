@@ -0,0 +1,67 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * sha256.h - SHA256 backends and batch hashing
+ *
+ * sha256_file() and sha256_string() (declared in sentinel.h) use the
+ * best backend for this CPU. Multi-buffer backends hash several files
+ * at once through sha256_file_batch(); single-stream backends hash
+ * them one after another.
+ */
+
+#ifndef SENTINEL_SHA256_H
+#define SENTINEL_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_MAX_LANES 8
+
+typedef enum {
+    SHA256_BACKEND_AUTO = 0,
+    SHA256_BACKEND_GENERIC,     /* Portable reference implementation */
+    SHA256_BACKEND_SHANI,       /* x86 SHA extensions, one stream */
+    SHA256_BACKEND_AVX2,        /* x86 AVX2, 8 streams at once */
+    SHA256_BACKEND_POWER8,      /* POWER8 vshasigmaw, 4 streams at once */
+    SHA256_BACKEND_COUNT
+} sha256_backend_t;
+
+/* Backend selection - AUTO picks the fastest available */
+int sha256_backend_available(sha256_backend_t backend);
+int sha256_set_backend(sha256_backend_t backend);
+sha256_backend_t sha256_get_backend(void);
+const char* sha256_backend_name(sha256_backend_t backend);
+int sha256_batch_size(void);            /* Streams hashed together (1 = single-stream) */
+
+/* Hash n files; out[i] receives the hex digest or "error". Returns the error count */
+int sha256_file_batch(const char **paths, int n, char **out);
+
+/* Hash n in-memory buffers into 32-byte digests */
+void sha256_buffers(const uint8_t **data, const size_t *len, int n, uint8_t (*digest)[32]);
+
+/* ============================================================
+ * Kernels (sha256.c, sha256_simd.c)
+ * ============================================================
+ * Single-stream kernels update state[8] over consecutive blocks.
+ * Lane kernels take one block per lane; state is word-major,
+ * state[word * lanes + lane].
+ */
+
+extern const uint32_t sha256_K[64];
+
+void sha256_blocks_generic(uint32_t state[8], const uint8_t *data, size_t blocks);
+void sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t blocks);
+void sha256_lanes_avx2(uint32_t *state, const uint8_t *const *blocks);
+void sha256_lanes_power8(uint32_t *state, const uint8_t *const *blocks);
+
+int sha256_cpu_has_shani(void);
+int sha256_cpu_has_avx2(void);
+int sha256_power8_built(void);          /* sha256_simd.c built with -mcpu=power8 */
+
+#endif /* SENTINEL_SHA256_H */
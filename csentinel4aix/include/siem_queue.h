@@ -0,0 +1,89 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * siem_queue.h - Asynchronous SIEM emission with a disk spool
+ *
+ * Probes push formatted messages into a bounded ring and return at once;
+ * a sender thread drains the ring in batches through a send callback.
+ * Messages the collector does not take are appended to a spool file and
+ * replayed, oldest first, before anything newer once it is back. A push
+ * that finds the ring full (the sender stuck on a slow collector) moves
+ * the ring to the spool first, so a burst overflows to disk rather than
+ * being dropped. The spool outlives the process, so a restart picks up
+ * where it left off.
+ */
+
+#ifndef SENTINEL_SIEM_QUEUE_H
+#define SENTINEL_SIEM_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define SIEM_QUEUE_SLOTS        512
+#define SIEM_QUEUE_MSG_MAX      4096
+#define SIEM_QUEUE_BATCH        64
+#define SIEM_QUEUE_RETRY_MS     500
+#define SIEM_SPOOL_MAX          (64 * 1024 * 1024)
+
+/*
+ * Deliver count messages in order. Returns how many were delivered; the
+ * rest (a collector that is down) are spooled and offered again later.
+ */
+typedef int (*siem_send_fn)(void *ctx, const char *const *msgs,
+                            const size_t *lens, int count);
+
+typedef struct {
+    unsigned long queued;       /* Accepted by siem_queue_push() */
+    unsigned long sent;         /* Delivered, including replayed from the spool */
+    unsigned long spooled;      /* Written to the spool */
+    unsigned long dropped;      /* Too long, or ring full with no room in the spool */
+} siem_queue_stats_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+    int running;
+    int stop;
+
+    /* Ring of SIEM_QUEUE_SLOTS messages */
+    char *slots;
+    size_t *lens;
+    unsigned head;
+    unsigned count;
+
+    /* Spool: frames "LEN SP MSG"; those before spool_read are delivered */
+    pthread_mutex_t spool_lock; /* Taken after lock, never before it */
+    char spool_path[512];
+    int spool_fd;
+    int spool_broken;           /* A torn frame could not be cut off: append no more */
+    uint64_t spool_read;
+    uint64_t spool_size;
+
+    siem_send_fn send;
+    void *ctx;
+    siem_queue_stats_t stats;
+} siem_queue_t;
+
+/*
+ * Start the sender thread. spool_path may be NULL for no spool (undelivered
+ * messages are then dropped). Returns 0, or -1.
+ */
+int siem_queue_start(siem_queue_t *q, const char *spool_path, siem_send_fn send, void *ctx);
+
+/* Queue one message without blocking. Returns 0, or -1 if it was dropped */
+int siem_queue_push(siem_queue_t *q, const char *msg, size_t len);
+
+/* Deliver or spool what is queued, then stop the sender thread */
+void siem_queue_stop(siem_queue_t *q);
+
+void siem_queue_get_stats(siem_queue_t *q, siem_queue_stats_t *stats);
+
+#endif /* SENTINEL_SIEM_QUEUE_H */
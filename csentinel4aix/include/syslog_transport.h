@@ -0,0 +1,84 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * syslog_transport.h - Long-lived connection to a syslog collector
+ *
+ * Messages are queued and written together by syslog_transport_flush(),
+ * over one connection kept open between flushes. Over TCP each message
+ * is framed by octet counting (RFC 6587: "LEN SP MSG"), so a batch is
+ * one write; over UDP each is one datagram on a connected socket.
+ *
+ * The host is resolved when first needed and again after a connection
+ * fails. Failed connections are retried with exponential backoff, and
+ * queued messages wait (up to SYSLOG_MAX_PENDING bytes) meanwhile.
+ */
+
+#ifndef SENTINEL_SYSLOG_TRANSPORT_H
+#define SENTINEL_SYSLOG_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#define SYSLOG_MAX_PENDING          (1024 * 1024)
+#define SYSLOG_CONNECT_TIMEOUT_MS   3000
+#define SYSLOG_BACKOFF_MIN_MS       500
+#define SYSLOG_BACKOFF_MAX_MS       60000
+
+typedef struct {
+    char host[256];
+    int port;
+    int tcp;
+    int fd;                         /* -1 when not connected */
+
+    struct sockaddr_storage addr;   /* Resolved address */
+    socklen_t addr_len;             /* 0: resolve before connecting */
+
+    char *pending;                  /* Queued frames */
+    size_t pending_len;
+    size_t pending_cap;
+    size_t sent;                    /* Bytes of pending written on this connection */
+
+    int64_t retry_at_ms;            /* No connection attempt before this */
+    int backoff_ms;
+
+    /* Counters */
+    unsigned long connects;
+    unsigned long connect_failures;
+    unsigned long messages;
+    unsigned long refused;          /* Not queued: queue full or out of memory */
+    unsigned long dropped;          /* Cut by a failed connection part way through */
+} syslog_transport_t;
+
+/* tcp: 1 for TCP with octet counting, 0 for UDP. Returns 0, or -1 */
+int syslog_transport_init(syslog_transport_t *t, const char *host, int port, int tcp);
+
+/*
+ * Queue one message; flushed automatically once 64 KB are queued.
+ * Returns 0, or -1 if it was refused (the caller still has it).
+ */
+int syslog_transport_send(syslog_transport_t *t, const char *msg, size_t len);
+
+/*
+ * Write everything queued, connecting first if needed. Returns 0, or -1
+ * if messages are still queued (the collector is down or backing off).
+ */
+int syslog_transport_flush(syslog_transport_t *t);
+
+/* Messages queued and not yet sent */
+unsigned long syslog_transport_pending(const syslog_transport_t *t);
+
+/* Forget the queued messages, e.g. once they are saved elsewhere */
+void syslog_transport_discard(syslog_transport_t *t);
+
+/* Flush what can be sent now, then close and free the queue */
+void syslog_transport_close(syslog_transport_t *t);
+
+#endif /* SENTINEL_SYSLOG_TRANSPORT_H */
@@ -10,7 +10,8 @@
  * aix_audit.c - AIX native audit subsystem integration
  *
  * This module reads AIX audit trail files and extracts security-relevant
- * events for analysis. It uses the native AIX audit binary format.
+ * events for analysis. It uses the native AIX audit binary format, read
+ * in-process by aix_trail.c from where the previous probe stopped.
  */
 
 #ifdef _AIX
@@ -25,10 +26,13 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/audit.h>
+#include <pwd.h>
 
 #include "sentinel.h"
+#include "json_writer.h"
+#include "aix_trail.h"
 
-/* Maximum events to process per probe */
+/* Maximum events to process per probe; the rest wait for the next one */
 #define MAX_AUDIT_EVENTS 10000
 
 /* Audit trail paths - use different names to avoid conflict with sys/audit.h */
@@ -124,184 +128,131 @@ static event_category_t categorize_event(const char *event, int status_ok) {
     return EVT_OTHER;
 }
 
-/* Parse a single line from auditpr output */
-static int parse_auditpr_line(const char *line, parsed_event_t *event) {
-    if (!line || !event) return -1;
-
-    /* Skip header lines */
-    if (strncmp(line, "event", 5) == 0 || strncmp(line, "---", 3) == 0) {
-        return -1;
-    }
-
-    /* Skip continuation lines (start with whitespace) */
-    if (line[0] == ' ' || line[0] == '\t') {
-        return -1;
+/* Name of a login uid, as auditpr prints it */
+static void login_name(uid_t uid, char *out, size_t outsize) {
+    struct passwd *pw = getpwuid(uid);
+    if (pw && pw->pw_name) {
+        snprintf(out, outsize, "%s", pw->pw_name);
+    } else {
+        snprintf(out, outsize, "%u", (unsigned)uid);
     }
+}
 
+/* Fill an event from a trail record */
+static void parse_trail_record(const aix_audit_record_t *rec, parsed_event_t *event) {
     memset(event, 0, sizeof(*event));
 
-    /* Parse: event login status time command wpar */
-    /* Example: USER_SU root OK Thu Jan 22 14:11:38 2026 su Global */
-
-    char status[16] = {0};
-    char month[8] = {0};
-    char day_name[8] = {0};
-    int day, year, hour, min, sec;
-    char wpar[32] = {0};
-
-    int parsed = sscanf(line, "%31s %63s %15s %7s %7s %d %d:%d:%d %d %63s %31s",
-                        event->event_name,
-                        event->login_user,
-                        status,
-                        day_name,
-                        month,
-                        &day,
-                        &hour, &min, &sec,
-                        &year,
-                        event->command,
-                        wpar);
-
-    if (parsed < 11) return -1;
-
-    /* Parse status */
-    event->status_ok = (strcmp(status, "OK") == 0);
-
-    /* Convert time (simplified - use current year's month mapping) */
-    struct tm tm = {0};
-    tm.tm_year = year - 1900;
-    tm.tm_mday = day;
-    tm.tm_hour = hour;
-    tm.tm_min = min;
-    tm.tm_sec = sec;
-
-    /* Month conversion */
-    const char *months[] = {"Jan","Feb","Mar","Apr","May","Jun",
-                            "Jul","Aug","Sep","Oct","Nov","Dec"};
-    for (int i = 0; i < 12; i++) {
-        if (strcmp(month, months[i]) == 0) {
-            tm.tm_mon = i;
-            break;
-        }
-    }
-    event->timestamp = mktime(&tm);
-
-    /* Categorize */
+    snprintf(event->event_name, sizeof(event->event_name), "%s", rec->event);
+    snprintf(event->command, sizeof(event->command), "%s", rec->name);
+    event->timestamp = rec->time;
+    event->status_ok = (rec->result == 0);   /* AUDIT_OK */
+    event->pid = (pid_t)rec->pid;
+    event->ruid = (uid_t)rec->ruid;
+    event->luid = (uid_t)rec->luid;
     event->category = categorize_event(event->event_name, event->status_ok);
 
-    return 0;
+    /* Only failed logins report the user */
+    if (event->category == EVT_AUTH_FAILURE) {
+        login_name(event->luid, event->login_user, sizeof(event->login_user));
+    }
 }
 
-/* Read audit events using auditpr (reliable cross-version method) */
-static int read_audit_events_auditpr(aix_audit_summary_t *summary, time_t since) {
-    if (!summary) return -1;
+typedef struct {
+    aix_audit_summary_t *summary;
+    int consecutive_failures;
+} trail_pass_t;
+
+/* Count one record into the summary */
+static void on_trail_record(const aix_audit_record_t *rec, void *ctx) {
+    trail_pass_t *pass = ctx;
+    aix_audit_summary_t *summary = pass->summary;
+    parsed_event_t event;
+
+    parse_trail_record(rec, &event);
+    summary->total_events++;
+
+    /* Categorize and count */
+    switch (event.category) {
+        case EVT_AUTH_SUCCESS:
+            summary->auth_success++;
+            pass->consecutive_failures = 0;
+            break;
 
-    /* Try reading from bin files first, then trail */
-    const char *audit_files[] = {AIX_AUDIT_BIN1, AIX_AUDIT_BIN2, AIX_AUDIT_TRAIL_PATH};
-    int events_processed = 0;
+        case EVT_AUTH_FAILURE:
+            summary->auth_failures++;
+            pass->consecutive_failures++;
 
-    for (int f = 0; f < 3 && events_processed < MAX_AUDIT_EVENTS; f++) {
-        struct stat st;
-        if (stat(audit_files[f], &st) != 0 || st.st_size == 0) {
-            continue;
-        }
+            /* Brute force detection: 5+ consecutive failures */
+            if (pass->consecutive_failures >= 5) {
+                summary->brute_force_detected = 1;
+                snprintf(summary->last_failed_user, sizeof(summary->last_failed_user),
+                         "%s", event.login_user);
+            }
+            break;
 
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), "/usr/sbin/auditpr -v < %s 2>/dev/null", audit_files[f]);
+        case EVT_SU_SUCCESS:
+            summary->su_success++;
+            /* Check if it's sudo */
+            if (strstr(event.command, "sudo") != NULL) {
+                summary->sudo_count++;
+            }
+            break;
+
+        case EVT_SU_FAILURE:
+            summary->su_failures++;
+            break;
 
-        FILE *fp = popen(cmd, "r");
-        if (!fp) continue;
+        case EVT_PASSWORD_CHANGE:
+            /* Password changes are notable */
+            break;
 
-        char line[512];
-        parsed_event_t event;
-        int consecutive_failures = 0;
-        char last_failed_user[64] = {0};
+        case EVT_SENSITIVE_READ:
+            summary->sensitive_reads++;
+            break;
 
-        while (fgets(line, sizeof(line), fp) && events_processed < MAX_AUDIT_EVENTS) {
-            /* Remove newline */
-            size_t len = strlen(line);
-            if (len > 0 && line[len-1] == '\n') line[len-1] = '\0';
+        case EVT_SENSITIVE_WRITE:
+            summary->sensitive_writes++;
+            break;
 
-            if (parse_auditpr_line(line, &event) != 0) {
-                continue;
+        case EVT_FILE_ACCESS:
+            if (!event.status_ok) {
+                summary->file_access_denied++;
             }
+            break;
 
-            /* Skip events older than 'since' */
-            if (since > 0 && event.timestamp < since) {
-                continue;
+        case EVT_FILE_MODIFY:
+            if (!event.status_ok) {
+                summary->file_access_denied++;
             }
+            break;
 
-            events_processed++;
-            summary->total_events++;
-
-            /* Categorize and count */
-            switch (event.category) {
-                case EVT_AUTH_SUCCESS:
-                    summary->auth_success++;
-                    consecutive_failures = 0;
-                    break;
-
-                case EVT_AUTH_FAILURE:
-                    summary->auth_failures++;
-                    consecutive_failures++;
-                    strncpy(last_failed_user, event.login_user, sizeof(last_failed_user)-1);
-
-                    /* Brute force detection: 5+ consecutive failures */
-                    if (consecutive_failures >= 5) {
-                        summary->brute_force_detected = 1;
-                        strncpy(summary->last_failed_user, last_failed_user,
-                                sizeof(summary->last_failed_user)-1);
-                    }
-                    break;
-
-                case EVT_SU_SUCCESS:
-                    summary->su_success++;
-                    /* Check if it's sudo */
-                    if (strstr(event.command, "sudo") != NULL) {
-                        summary->sudo_count++;
-                    }
-                    break;
-
-                case EVT_SU_FAILURE:
-                    summary->su_failures++;
-                    break;
-
-                case EVT_PASSWORD_CHANGE:
-                    /* Password changes are notable */
-                    break;
-
-                case EVT_SENSITIVE_READ:
-                    summary->sensitive_reads++;
-                    break;
-
-                case EVT_SENSITIVE_WRITE:
-                    summary->sensitive_writes++;
-                    break;
-
-                case EVT_FILE_ACCESS:
-                    if (!event.status_ok) {
-                        summary->file_access_denied++;
-                    }
-                    break;
-
-                case EVT_FILE_MODIFY:
-                    if (!event.status_ok) {
-                        summary->file_access_denied++;
-                    }
-                    break;
-
-                case EVT_PROCESS_EXEC:
-                    summary->process_execs++;
-                    break;
-
-                default:
-                    break;
-            }
-        }
+        case EVT_PROCESS_EXEC:
+            summary->process_execs++;
+            break;
 
-        pclose(fp);
+        default:
+            break;
     }
+}
 
-    return events_processed;
+/*
+ * Read the records written since the last probe from the trail and both
+ * bins. The cursor is only saved once the records are counted.
+ */
+static int read_audit_events(aix_audit_summary_t *summary, time_t since) {
+    if (!summary) return -1;
+
+    const char *audit_files[] = {AIX_AUDIT_TRAIL_PATH, AIX_AUDIT_BIN1, AIX_AUDIT_BIN2};
+    aix_trail_cursor_t cursor;
+    trail_pass_t pass = { summary, 0 };
+
+    load_aix_trail_cursor(&cursor);
+    long events = aix_trail_read(audit_files, 3, &cursor, since, MAX_AUDIT_EVENTS,
+                                 on_trail_record, &pass);
+    if (events < 0) return 0;   /* No readable bins: nothing to count */
+
+    save_aix_trail_cursor(&cursor);
+    return (int)events;
 }
 
 /* Calculate risk score based on audit events */
@@ -369,7 +320,7 @@ int probe_aix_audit(aix_audit_summary_t *summary, time_t since) {
     }
 
     /* Read and process audit events */
-    int events = read_audit_events_auditpr(summary, since);
+    int events = read_audit_events(summary, since);
     if (events < 0) {
         return -1;
     }
@@ -380,59 +331,46 @@ int probe_aix_audit(aix_audit_summary_t *summary, time_t since) {
     return 0;
 }
 
-/* Serialize AIX audit summary to JSON buffer */
-int aix_audit_to_json(const aix_audit_summary_t *summary, char *buf, size_t buf_size) {
-    if (!summary || !buf || buf_size == 0) return -1;
-
-    int written = snprintf(buf, buf_size,
-        "  \"audit_summary\": {\n"
-        "    \"enabled\": %s,\n"
-        "    \"platform\": \"AIX\",\n"
-        "    \"total_events\": %d,\n"
-        "    \"authentication\": {\n"
-        "      \"successes\": %d,\n"
-        "      \"failures\": %d,\n"
-        "      \"brute_force_detected\": %s%s%s\n"
-        "    },\n"
-        "    \"privilege_escalation\": {\n"
-        "      \"su_success\": %d,\n"
-        "      \"su_failures\": %d,\n"
-        "      \"sudo_count\": %d\n"
-        "    },\n"
-        "    \"file_access\": {\n"
-        "      \"sensitive_reads\": %d,\n"
-        "      \"sensitive_writes\": %d,\n"
-        "      \"access_denied\": %d\n"
-        "    },\n"
-        "    \"risk_score\": %d,\n"
-        "    \"risk_level\": \"%s\"\n"
-        "  }",
-        summary->enabled ? "true" : "false",
-        summary->total_events,
-        summary->auth_success,
-        summary->auth_failures,
-        summary->brute_force_detected ? "true" : "false",
-        summary->brute_force_detected && summary->last_failed_user[0] ?
-            ",\n      \"last_failed_user\": \"" : "",
-        summary->brute_force_detected && summary->last_failed_user[0] ?
-            summary->last_failed_user : "",
-        summary->su_success,
-        summary->su_failures,
-        summary->sudo_count,
-        summary->sensitive_reads,
-        summary->sensitive_writes,
-        summary->file_access_denied,
-        summary->risk_score,
-        summary->risk_level
-    );
-
-    /* Fix: close the quote if we added last_failed_user */
-    if (summary->brute_force_detected && summary->last_failed_user[0]) {
-        /* We need to add the closing quote - this is a simplified approach */
-        /* In production, use proper JSON builder */
+/* Write the AIX audit summary as the "audit_summary" member of the open object */
+void aix_audit_json_member(json_writer_t *w, const aix_audit_summary_t *summary) {
+    json_object_begin(w, "audit_summary");
+    json_bool(w, "enabled", summary->enabled);
+    json_string(w, "platform", "AIX");
+
+    if (!summary->enabled) {
+        /* Audit not enabled - show instructions */
+        json_string(w, "message", "AIX audit subsystem not enabled");
+        json_string(w, "enable_instructions", "/usr/sbin/audit start");
+        json_object_end(w);
+        return;
     }
 
-    return (written > 0 && (size_t)written < buf_size) ? 0 : -1;
+    json_int(w, "total_events", summary->total_events);
+
+    json_object_begin(w, "authentication");
+    json_int(w, "successes", summary->auth_success);
+    json_int(w, "failures", summary->auth_failures);
+    json_bool(w, "brute_force_detected", summary->brute_force_detected);
+    if (summary->brute_force_detected && summary->last_failed_user[0]) {
+        json_string(w, "last_failed_user", summary->last_failed_user);
+    }
+    json_object_end(w);
+
+    json_object_begin(w, "privilege_escalation");
+    json_int(w, "su_success", summary->su_success);
+    json_int(w, "su_failures", summary->su_failures);
+    json_int(w, "sudo_count", summary->sudo_count);
+    json_object_end(w);
+
+    json_object_begin(w, "file_access");
+    json_int(w, "sensitive_reads", summary->sensitive_reads);
+    json_int(w, "sensitive_writes", summary->sensitive_writes);
+    json_int(w, "access_denied", summary->file_access_denied);
+    json_object_end(w);
+
+    json_int(w, "risk_score", summary->risk_score);
+    json_string(w, "risk_level", summary->risk_level);
+    json_object_end(w);
 }
 
 /* Get global audit summary pointer (for integration with main.c) */
@@ -487,11 +425,9 @@ int probe_aix_audit(aix_audit_summary_t *summary, time_t since) {
     return -1;  /* Not supported */
 }
 
-int aix_audit_to_json(const aix_audit_summary_t *summary, char *buf, size_t buf_size) {
+void aix_audit_json_member(struct json_writer *w, const aix_audit_summary_t *summary) {
+    (void)w;
     (void)summary;
-    (void)buf;
-    (void)buf_size;
-    return -1;
 }
 
 aix_audit_summary_t* get_aix_audit_summary(void) {
@@ -0,0 +1,428 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * aix_trail.c - In-process reader for AIX audit bins and trails
+ *
+ * A bin is a header (struct aud_bin), then records, each a struct
+ * aud_rec followed by ah_length bytes of event data, then a tail header
+ * once auditbin closes it. A closed bin's header gives the length of its
+ * records; a bin still being written has 0 there and runs to the end of
+ * the file. Bins packed by auditbin's compression are skipped.
+ *
+ * On AIX the field offsets come from <sys/audit.h>; elsewhere the 64-bit
+ * AIX layout below is used, so a captured trail can be read on Linux.
+ * Fields are big-endian either way.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "sentinel.h"
+#include "aix_trail.h"
+
+#ifdef _AIX
+#include <sys/audit.h>
+#endif
+
+#define TRAIL_READ_BLOCK (256 * 1024)
+
+/* bin_left of a bin still being written */
+#define BIN_OPEN UINT64_MAX
+
+#define AIX_TRAIL_CURSOR_FILENAME "aix_audit_cursor.dat"
+#define AIX_TRAIL_CURSOR_MAGIC    "SNTLXCUR"
+#define AIX_TRAIL_CURSOR_VERSION  1
+
+/* ============================================================
+ * Record Layout
+ * ============================================================ */
+
+#ifndef AUD_BIN_MAGIC
+#define AUD_BIN_MAGIC 0xf0f0
+#endif
+#ifndef AUD_REC_MAGIC
+#define AUD_REC_MAGIC 0xf0f0
+#endif
+#ifndef AUD_TAIL
+#define AUD_TAIL 1
+#endif
+
+typedef struct {
+    unsigned at;
+    unsigned size;
+} field_t;
+
+typedef struct {
+    unsigned size;
+    field_t magic, tail, len, plen, time;
+} bin_layout_t;
+
+typedef struct {
+    unsigned size;
+    field_t magic, length, event, result, ruid, luid, name, pid, ppid, time, ntime;
+} rec_layout_t;
+
+#ifdef _AIX
+#define FIELD(type, member) { offsetof(struct type, member), sizeof(((struct type *)0)->member) }
+
+static const bin_layout_t bin_layout = {
+    sizeof(struct aud_bin),
+    FIELD(aud_bin, bin_magic), FIELD(aud_bin, bin_tail), FIELD(aud_bin, bin_len),
+    FIELD(aud_bin, bin_plen), FIELD(aud_bin, bin_time)
+};
+
+static const rec_layout_t rec_layout = {
+    sizeof(struct aud_rec),
+    FIELD(aud_rec, ah_magic), FIELD(aud_rec, ah_length), FIELD(aud_rec, ah_event),
+    FIELD(aud_rec, ah_result), FIELD(aud_rec, ah_ruid), FIELD(aud_rec, ah_luid),
+    FIELD(aud_rec, ah_name), FIELD(aud_rec, ah_pid), FIELD(aud_rec, ah_ppid),
+    FIELD(aud_rec, ah_time), FIELD(aud_rec, ah_ntime)
+};
+#else
+/* 64-bit AIX: 32-byte bin header, 96-byte record header */
+static const bin_layout_t bin_layout = {
+    32, { 0, 2 }, { 4, 2 }, { 8, 4 }, { 12, 4 }, { 16, 8 }
+};
+
+static const rec_layout_t rec_layout = {
+    96, { 0, 2 }, { 2, 2 }, { 4, 16 }, { 20, 2 }, { 24, 4 }, { 28, 4 },
+    { 32, 32 }, { 64, 4 }, { 68, 4 }, { 80, 8 }, { 88, 4 }
+};
+#endif
+
+static uint64_t get_u(const unsigned char *p, field_t f) {
+    uint64_t v = 0;
+    for (unsigned i = 0; i < f.size; i++) v = (v << 8) | p[f.at + i];
+    return v;
+}
+
+static int64_t get_s(const unsigned char *p, field_t f) {
+    uint64_t v = get_u(p, f);
+    if (f.size < 8 && (v >> (f.size * 8 - 1)) & 1) v |= ~(uint64_t)0 << (f.size * 8);
+    return (int64_t)v;
+}
+
+static void get_str(const unsigned char *p, field_t f, char *out, size_t outsize) {
+    size_t n = 0;
+    while (n < f.size && n < outsize - 1 && p[f.at + n]) {
+        out[n] = (char)p[f.at + n];
+        n++;
+    }
+    out[n] = '\0';
+}
+
+static bool is_bin_header(const unsigned char *p) {
+    uint64_t tail = get_u(p, bin_layout.tail);
+    return get_u(p, bin_layout.magic) == AUD_BIN_MAGIC && (tail == 0 || tail == AUD_TAIL);
+}
+
+/* A record header has the magic and a non-empty event name */
+static bool is_record(const unsigned char *p) {
+    if (get_u(p, rec_layout.magic) != AUD_REC_MAGIC) return false;
+
+    const unsigned char *event = p + rec_layout.event.at;
+    if (!event[0]) return false;
+    for (unsigned i = 0; i < rec_layout.event.size && event[i]; i++) {
+        if (!isalnum(event[i]) && event[i] != '_') return false;
+    }
+    return true;
+}
+
+/* ============================================================
+ * Reading
+ * ============================================================ */
+
+typedef struct {
+    int fd;
+    uint64_t size;
+    unsigned char *buf;
+    size_t start;                   /* Unread bytes are buf[start, have) */
+    size_t have;
+    uint64_t pos;                   /* File offset of buf[start] */
+} trail_buf_t;
+
+/* The next n bytes, or NULL if the file ends first */
+static const unsigned char* tb_need(trail_buf_t *b, size_t n) {
+    if (b->have - b->start >= n) return b->buf + b->start;
+    if (n > TRAIL_READ_BLOCK) return NULL;
+
+    memmove(b->buf, b->buf + b->start, b->have - b->start);
+    b->have -= b->start;
+    b->start = 0;
+    while (b->have < n) {
+        ssize_t got = read(b->fd, b->buf + b->have, TRAIL_READ_BLOCK - b->have);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return NULL;
+        b->have += (size_t)got;
+    }
+    return b->buf;
+}
+
+static void tb_consume(trail_buf_t *b, size_t n) {
+    b->start += n;
+    b->pos += n;
+}
+
+static bool tb_skip(trail_buf_t *b, uint64_t n) {
+    if (b->have - b->start >= n) {
+        tb_consume(b, (size_t)n);
+        return true;
+    }
+    if (b->pos + n > b->size || lseek(b->fd, (off_t)(b->pos + n), SEEK_SET) < 0) {
+        return false;
+    }
+    b->start = b->have = 0;
+    b->pos += n;
+    return true;
+}
+
+typedef struct {
+    time_t since;
+    int64_t seen_time;
+    int32_t seen_ntime;
+    long count;
+    long max;
+    aix_audit_record_fn fn;
+    void *ctx;
+} trail_pass_t;
+
+/* Pass on a record unless an earlier read (or another file) already did */
+static void deliver(trail_pass_t *pass, const unsigned char *p) {
+    aix_audit_record_t rec;
+    int64_t t = get_s(p, rec_layout.time);
+    int32_t nt = (int32_t)get_s(p, rec_layout.ntime);
+
+    if (pass->seen_time == 0) {
+        if (t < (int64_t)pass->since) return;
+    } else if (t < pass->seen_time || (t == pass->seen_time && nt <= pass->seen_ntime)) {
+        return;
+    }
+
+    get_str(p, rec_layout.event, rec.event, sizeof(rec.event));
+    rec.result = (int)get_u(p, rec_layout.result);
+    rec.ruid = (uint32_t)get_u(p, rec_layout.ruid);
+    rec.luid = (uint32_t)get_u(p, rec_layout.luid);
+    get_str(p, rec_layout.name, rec.name, sizeof(rec.name));
+    rec.pid = (int32_t)get_s(p, rec_layout.pid);
+    rec.ppid = (int32_t)get_s(p, rec_layout.ppid);
+    rec.time = (time_t)t;
+    rec.ntime = nt;
+    rec.tail_len = (uint32_t)get_u(p, rec_layout.length);
+    rec.tail = p + rec_layout.size;
+
+    pass->fn(&rec, pass->ctx);
+    pass->count++;
+    pass->seen_time = t;
+    pass->seen_ntime = nt;
+}
+
+/* Read one file from its cursor until it ends, is malformed, or max is reached */
+static void read_file(trail_buf_t *b, aix_trail_file_cursor_t *fc, trail_pass_t *pass) {
+    uint64_t left = fc->bin_left;
+
+    while (!pass->max || pass->count < pass->max) {
+        const unsigned char *p;
+
+        if (left == 0 || left == BIN_OPEN) {
+            /* A bin header, or the tail ending the open bin */
+            p = tb_need(b, bin_layout.size);
+            if (!p) break;
+            if (left == 0 || (!is_record(p) && is_bin_header(p))) {
+                if (!is_bin_header(p)) break;
+                uint64_t len = get_u(p, bin_layout.len);
+                uint64_t plen = get_u(p, bin_layout.plen);
+                if (get_u(p, bin_layout.tail) == AUD_TAIL) {
+                    tb_consume(b, bin_layout.size);
+                    left = 0;
+                } else if (plen != 0 && plen != len) {
+                    /* Packed: only auditpr can unpack it */
+                    if (!tb_skip(b, bin_layout.size + plen)) break;
+                    left = 0;
+                } else {
+                    tb_consume(b, bin_layout.size);
+                    left = len ? len : BIN_OPEN;
+                }
+                continue;
+            }
+        }
+
+        p = tb_need(b, rec_layout.size);
+        if (!p) break;
+        uint64_t size = rec_layout.size + get_u(p, rec_layout.length);
+        if (!is_record(p) || (left != BIN_OPEN && size > left)) {
+            /* Resume at the next bin, if this one says where it is */
+            if (left == BIN_OPEN || !tb_skip(b, left)) break;
+            left = 0;
+            continue;
+        }
+        p = tb_need(b, (size_t)size);
+        if (!p) break;
+
+        deliver(pass, p);
+        tb_consume(b, (size_t)size);
+        if (left != BIN_OPEN) left -= size;
+    }
+
+    fc->offset = b->pos;
+    fc->bin_left = left;
+}
+
+typedef struct {
+    int index;
+    int fd;
+    struct stat st;
+    int64_t head_time;
+} trail_file_t;
+
+long aix_trail_read(const char *const *paths, int count, aix_trail_cursor_t *cursor,
+                    time_t since, long max_records, aix_audit_record_fn fn, void *ctx) {
+    if (!paths || !cursor || !fn) return -1;
+    if (count > AIX_TRAIL_MAX_FILES) count = AIX_TRAIL_MAX_FILES;
+
+    /* Open each file and read the time of its first bin */
+    trail_file_t files[AIX_TRAIL_MAX_FILES];
+    int opened = 0;
+    for (int i = 0; i < count; i++) {
+        trail_file_t *f = &files[opened];
+        unsigned char head[256];
+
+        f->fd = open(paths[i], O_RDONLY);
+        if (f->fd < 0) continue;
+        if (fstat(f->fd, &f->st) != 0 || bin_layout.size > sizeof(head) ||
+            pread(f->fd, head, bin_layout.size, 0) != (ssize_t)bin_layout.size ||
+            !is_bin_header(head)) {
+            close(f->fd);
+            continue;
+        }
+        f->index = i;
+        f->head_time = get_s(head, bin_layout.time);
+        opened++;
+    }
+    if (opened == 0) return -1;
+
+    /* Oldest first: the trail, then the bin auditbin filled before the other */
+    for (int i = 1; i < opened; i++) {
+        trail_file_t f = files[i];
+        int j = i;
+        for (; j > 0 && files[j - 1].head_time > f.head_time; j--) files[j] = files[j - 1];
+        files[j] = f;
+    }
+
+    trail_pass_t pass = {
+        since, cursor->seen_time, cursor->seen_ntime, 0, max_records, fn, ctx
+    };
+    trail_buf_t b;
+    b.buf = malloc(TRAIL_READ_BLOCK);
+    if (!b.buf) {
+        for (int i = 0; i < opened; i++) close(files[i].fd);
+        return -1;
+    }
+
+    for (int i = 0; i < opened; i++) {
+        trail_file_t *f = &files[i];
+        aix_trail_file_cursor_t *fc = &cursor->files[f->index];
+
+        /* A bin auditbin has started over has a new first header */
+        if (fc->dev != (uint64_t)f->st.st_dev || fc->ino != (uint64_t)f->st.st_ino ||
+            fc->head_time != f->head_time || fc->offset > (uint64_t)f->st.st_size) {
+            fc->dev = (uint64_t)f->st.st_dev;
+            fc->ino = (uint64_t)f->st.st_ino;
+            fc->head_time = f->head_time;
+            fc->offset = 0;
+            fc->bin_left = 0;
+        }
+
+        b.fd = f->fd;
+        b.size = (uint64_t)f->st.st_size;
+        b.start = b.have = 0;
+        b.pos = fc->offset;
+        if (lseek(f->fd, (off_t)fc->offset, SEEK_SET) >= 0) {
+            read_file(&b, fc, &pass);
+        }
+        close(f->fd);
+    }
+    free(b.buf);
+
+    cursor->seen_time = pass.seen_time;
+    cursor->seen_ntime = pass.seen_ntime;
+    return pass.count;
+}
+
+/* ============================================================
+ * Cursor Persistence
+ * ============================================================ */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    aix_trail_cursor_t cursor;
+} aix_trail_cursor_file_t;
+
+static void get_cursor_path(char *path, size_t path_size) {
+    char dir[256];
+    sentinel_state_dir(dir, sizeof(dir));
+    snprintf(path, path_size, "%s/%s", dir, AIX_TRAIL_CURSOR_FILENAME);
+}
+
+bool load_aix_trail_cursor(aix_trail_cursor_t *cursor) {
+    char path[MAX_PATH_LEN];
+    aix_trail_cursor_file_t file;
+
+    memset(cursor, 0, sizeof(*cursor));
+    get_cursor_path(path, sizeof(path));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    size_t got = fread(&file, sizeof(file), 1, fp);
+    fclose(fp);
+
+    if (got != 1 || memcmp(file.magic, AIX_TRAIL_CURSOR_MAGIC, 8) != 0 ||
+        file.version != AIX_TRAIL_CURSOR_VERSION) {
+        return false;
+    }
+    *cursor = file.cursor;
+    return true;
+}
+
+bool save_aix_trail_cursor(const aix_trail_cursor_t *cursor) {
+    char path[MAX_PATH_LEN];
+    char tmp[MAX_PATH_LEN + 8];
+    aix_trail_cursor_file_t file;
+
+    if (sentinel_ensure_state_dir() != 0) return false;
+    get_cursor_path(path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    memset(&file, 0, sizeof(file));
+    memcpy(file.magic, AIX_TRAIL_CURSOR_MAGIC, 8);
+    file.version = AIX_TRAIL_CURSOR_VERSION;
+    file.cursor = *cursor;
+
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(&file, sizeof(file), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
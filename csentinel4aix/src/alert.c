@@ -15,32 +15,29 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
-#include "sentinel.h"
-
-/* Alert severity levels */
-typedef enum {
-    ALERT_INFO = 0,
-    ALERT_WARNING = 1,
-    ALERT_CRITICAL = 2
-} alert_severity_t;
-
-/* Alert structure */
-typedef struct {
-    alert_severity_t severity;
-    char hostname[256];
-    char title[256];
-    char message[2048];
-    time_t timestamp;
-    int zombie_count;
-    int unusual_ports;
-    int config_changes;
-    double memory_percent;
-    double load_avg;
-} alert_t;
-
-/* Build alert message as JSON for webhook */
-static void build_alert_json(const alert_t *alert, char *buf, size_t buf_size) {
+#include "alert.h"
+#include "http_client.h"
+#include "json_writer.h"
+
+/* Webhook queue: alerts waiting for the next post to url */
+static struct {
+    char url[512];
+    http_client_t http;
+    int ready;                  /* http set up for url */
+    int use_curl;               /* https:// in a build without TLS */
+    alert_t queue[ALERT_QUEUE_MAX];
+    int count;
+} g_webhook = { .http = { .fd = -1 } };
+
+/* One alert as a Slack attachment */
+static void write_attachment(json_writer_t *w, const alert_t *alert) {
     const char *severity_str = "info";
     const char *color = "#36a64f";  /* Green */
     
@@ -57,59 +54,221 @@ static void build_alert_json(const alert_t *alert, char *buf, size_t buf_size) {
             break;
     }
     
-    /* Format timestamp */
-    char time_buf[64];
-    struct tm *tm = gmtime(&alert->timestamp);
-    strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", tm);
-    
-    /* Build Slack-compatible webhook payload */
-    snprintf(buf, buf_size,
-        "{"
-        "\"attachments\": [{"
-            "\"color\": \"%s\","
-            "\"title\": \"🛡️ C-Sentinel Alert: %s\","
-            "\"text\": \"%s\","
-            "\"fields\": ["
-                "{\"title\": \"Hostname\", \"value\": \"%s\", \"short\": true},"
-                "{\"title\": \"Severity\", \"value\": \"%s\", \"short\": true},"
-                "{\"title\": \"Zombies\", \"value\": \"%d\", \"short\": true},"
-                "{\"title\": \"Unusual Ports\", \"value\": \"%d\", \"short\": true},"
-                "{\"title\": \"Memory\", \"value\": \"%.1f%%\", \"short\": true},"
-                "{\"title\": \"Load\", \"value\": \"%.2f\", \"short\": true}"
-            "],"
-            "\"footer\": \"C-Sentinel\","
-            "\"ts\": %ld"
-        "}]"
-        "}",
-        color,
-        alert->title,
-        alert->message,
-        alert->hostname,
-        severity_str,
-        alert->zombie_count,
-        alert->unusual_ports,
-        alert->memory_percent,
-        alert->load_avg,
-        (long)alert->timestamp
-    );
+    char title[320];
+    char value[32];
+    snprintf(title, sizeof(title), "🛡️ C-Sentinel Alert: %s", alert->title);
+    
+    json_object_begin(w, NULL);
+    json_string(w, "color", color);
+    json_string(w, "title", title);
+    json_string(w, "text", alert->message);
+    
+    json_array_begin(w, "fields");
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Hostname");
+    json_string(w, "value", alert->hostname);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Severity");
+    json_string(w, "value", severity_str);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Zombies");
+    snprintf(value, sizeof(value), "%d", alert->zombie_count);
+    json_string(w, "value", value);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Unusual Ports");
+    snprintf(value, sizeof(value), "%d", alert->unusual_ports);
+    json_string(w, "value", value);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Memory");
+    snprintf(value, sizeof(value), "%.1f%%", alert->memory_percent);
+    json_string(w, "value", value);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_object_begin(w, NULL);
+    json_string(w, "title", "Load");
+    snprintf(value, sizeof(value), "%.2f", alert->load_avg);
+    json_string(w, "value", value);
+    json_bool(w, "short", 1);
+    json_object_end(w);
+    json_array_end(w);
+    
+    json_string(w, "footer", "C-Sentinel");
+    json_int(w, "ts", (long long)alert->timestamp);
+    json_object_end(w);
 }
 
-/* Send webhook using curl (simple approach - no libcurl dependency) */
-int alert_send_webhook(const char *url, const alert_t *alert) {
+/* Slack-compatible payload carrying every queued alert (caller must free) */
+static char* build_webhook_json(const alert_t *alerts, int count) {
+    json_writer_t w;
+    json_writer_memory(&w);
+    
+    json_object_begin_inline(&w, NULL);
+    json_array_begin(&w, "attachments");
+    for (int i = 0; i < count; i++) {
+        write_attachment(&w, &alerts[i]);
+    }
+    json_array_end(&w);
+    json_object_end(&w);
+    
+    return json_writer_take(&w);
+}
+
+#ifndef HAVE_OPENSSL
+/*
+ * https:// without TLS built in: hand the payload to curl as before, but
+ * with an argv and the body on a pipe, so nothing passes through a shell.
+ * Returns the HTTP status, or -1.
+ */
+static int curl_post(const char *url, const char *json, size_t len) {
+    int in[2], out[2];
+    char code[16];
+    size_t got = 0;
+    int wstatus;
+
+    if (pipe(in) != 0) return -1;
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        char *argv[] = {
+            "curl", "-s", "-o", "/dev/null", "-w", "%{http_code}",
+            "--connect-timeout", "5", "--max-time", "10",
+            "-X", "POST", "-H", "Content-Type: application/json",
+            "--data-binary", "@-", (char *)url, NULL
+        };
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        if (null_fd >= 0) dup2(null_fd, STDERR_FILENO);
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        execvp("curl", argv);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    if (pid < 0) {
+        close(in[1]);
+        close(out[0]);
+        return -1;
+    }
+
+    /* SIGPIPE is ignored (alert_queue_webhook): a curl that died gives EPIPE */
+    while (len > 0) {
+        ssize_t n = write(in[1], json, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        json += n;
+        len -= (size_t)n;
+    }
+    close(in[1]);
+
+    for (;;) {
+        ssize_t n = read(out[0], code + got, sizeof(code) - 1 - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+        if (got == sizeof(code) - 1) break;
+    }
+    code[got] = '\0';
+    close(out[0]);
+
+    while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR) {}
+
+    /* "000" when curl never got a response */
+    int status = atoi(code);
+    return status > 0 ? status : -1;
+}
+#endif
+
+int alert_flush_webhooks(void) {
+    if (g_webhook.count == 0) return 0;
+    
+    char *json = build_webhook_json(g_webhook.queue, g_webhook.count);
+    if (!json) return -1;
+    
+    int status;
+#ifndef HAVE_OPENSSL
+    if (g_webhook.use_curl) {
+        status = curl_post(g_webhook.url, json, strlen(json));
+    } else
+#endif
+    status = http_client_post(&g_webhook.http, "application/json", json, strlen(json));
+    free(json);
+    
+    /* Anything but a server error is final: retrying a 4xx cannot help */
+    if (status > 0 && status < 500) {
+        g_webhook.count = 0;
+    }
+    return status;
+}
+
+int alert_queue_webhook(const char *url, const alert_t *alert) {
     if (!url || !url[0]) {
         return -1;  /* No webhook configured */
     }
     
-    char json[4096];
-    build_alert_json(alert, json, sizeof(json));
-    
-    /* Build curl command */
-    char cmd[8192];
-    snprintf(cmd, sizeof(cmd),
-        "curl -s -X POST -H 'Content-Type: application/json' -d '%s' '%s' >/dev/null 2>&1",
-        json, url);
+    if (!g_webhook.ready || strcmp(url, g_webhook.url) != 0) {
+        alert_webhook_close();
+        if (http_client_init(&g_webhook.http, url) != 0) {
+#ifndef HAVE_OPENSSL
+            if (strncmp(url, "https://", 8) == 0 && strlen(url) < sizeof(g_webhook.url)) {
+                fprintf(stderr, "Webhook: built without TLS support, posting through curl\n");
+                signal(SIGPIPE, SIG_IGN);
+                g_webhook.use_curl = 1;
+            } else
+#endif
+            {
+                fprintf(stderr, "Webhook: cannot use %s\n", url);
+                return -1;
+            }
+        }
+        snprintf(g_webhook.url, sizeof(g_webhook.url), "%s", url);
+        g_webhook.ready = 1;
+    }
     
-    return system(cmd);
+    if (g_webhook.count == ALERT_QUEUE_MAX) {
+        alert_flush_webhooks();
+    }
+    if (g_webhook.count == ALERT_QUEUE_MAX) {
+        /* Unreachable or still failing with 5xx: make room by dropping the oldest */
+        memmove(g_webhook.queue, g_webhook.queue + 1,
+                (ALERT_QUEUE_MAX - 1) * sizeof(alert_t));
+        g_webhook.count--;
+    }
+    g_webhook.queue[g_webhook.count++] = *alert;
+    return 0;
+}
+
+/* Send webhook over the kept-alive connection, with anything still queued */
+int alert_send_webhook(const char *url, const alert_t *alert) {
+    if (alert_queue_webhook(url, alert) != 0) {
+        return -1;
+    }
+    return alert_flush_webhooks();
+}
+
+void alert_webhook_close(void) {
+    if (!g_webhook.ready) return;
+    alert_flush_webhooks();
+    http_client_close(&g_webhook.http);
+    g_webhook.count = 0;
+    g_webhook.ready = 0;
+    g_webhook.use_curl = 0;
 }
 
 /* Create alert from fingerprint and analysis */
@@ -145,29 +304,29 @@ int alert_create_from_analysis(alert_t *alert, const fingerprint_t *fp,
     size_t remaining = sizeof(alert->message);
     int written;
     
-    written = snprintf(p, remaining, "Issues detected:\\n");
+    written = snprintf(p, remaining, "Issues detected:\n");
     p += written; remaining -= written;
     
     if (analysis->zombie_process_count > 0) {
-        written = snprintf(p, remaining, "• %d zombie process(es)\\n", 
+        written = snprintf(p, remaining, "• %d zombie process(es)\n", 
                           analysis->zombie_process_count);
         p += written; remaining -= written;
     }
     
     if (analysis->unusual_listeners > 0) {
-        written = snprintf(p, remaining, "• %d unusual listening port(s)\\n",
+        written = snprintf(p, remaining, "• %d unusual listening port(s)\n",
                           analysis->unusual_listeners);
         p += written; remaining -= written;
     }
     
     if (analysis->config_permission_issues > 0) {
-        written = snprintf(p, remaining, "• %d config permission issue(s)\\n",
+        written = snprintf(p, remaining, "• %d config permission issue(s)\n",
                           analysis->config_permission_issues);
         p += written; remaining -= written;
     }
     
     if (analysis->high_fd_process_count > 5) {
-        written = snprintf(p, remaining, "• %d high FD process(es)\\n",
+        written = snprintf(p, remaining, "• %d high FD process(es)\n",
                           analysis->high_fd_process_count);
         p += written; remaining -= written;
     }
@@ -200,13 +359,13 @@ void alert_print(const alert_t *alert) {
     printf("Time: %s", ctime(&alert->timestamp));
     printf("\n");
     
-    /* Print message with newlines converted */
+    /* Print message one finding per line */
     printf("Details:\n");
     char *msg = strdup(alert->message);
-    char *line = strtok(msg, "\\n");
+    char *line = strtok(msg, "\n");
     while (line) {
         if (line[0]) printf("  %s\n", line);
-        line = strtok(NULL, "\\n");
+        line = strtok(NULL, "\n");
     }
     free(msg);
     
@@ -0,0 +1,197 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * arena.c - Per-capture arena allocator with string interning
+ *
+ * Everything a fingerprint owns (process, config and socket arrays
+ * plus every string they point at) is carved out of one arena, so
+ * memory tracks what was actually found and arena_free() releases
+ * it all at once. Repeated strings - process names, protocols,
+ * addresses - are interned and stored once.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "sentinel.h"
+
+#define ARENA_BLOCK_SIZE   (64 * 1024)
+#define ARENA_ALIGN        16
+#define INTERN_INITIAL     256
+
+struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+};
+
+/* ============================================================
+ * Block Allocation
+ * ============================================================ */
+
+void arena_init(arena_t *a) {
+    memset(a, 0, sizeof(*a));
+}
+
+static size_t align_pad(const unsigned char *p) {
+    return (size_t)(-(uintptr_t)p) & (ARENA_ALIGN - 1);
+}
+
+static arena_block_t* arena_new_block(arena_t *a, size_t min_size) {
+    size_t size = ARENA_BLOCK_SIZE;
+    if (min_size + ARENA_ALIGN > size) size = min_size + ARENA_ALIGN;
+
+    arena_block_t *blk = malloc(sizeof(arena_block_t) + size);
+    if (!blk) return NULL;
+
+    blk->size = size;
+    blk->used = 0;
+    blk->next = a->head;
+    a->head = blk;
+    a->bytes_reserved += size;
+    return blk;
+}
+
+/* Zero-filled, 16-byte aligned allocation */
+void* arena_alloc(arena_t *a, size_t size) {
+    if (size == 0) size = 1;
+
+    arena_block_t *blk = a->head;
+    size_t pad = blk ? align_pad(blk->data + blk->used) : 0;
+
+    if (!blk || blk->used + pad + size > blk->size) {
+        blk = arena_new_block(a, size);
+        if (!blk) return NULL;
+        pad = align_pad(blk->data);
+    }
+
+    void *p = blk->data + blk->used + pad;
+    blk->used += pad + size;
+    a->bytes_used += size;
+    a->last_alloc = p;
+    a->last_size = size;
+
+    memset(p, 0, size);
+    return p;
+}
+
+/*
+ * Grow an arena-backed array to hold at least one more element.
+ * The most recent allocation is extended in place when the block
+ * has room; otherwise the contents move to a new, doubled array.
+ */
+void* arena_grow(arena_t *a, void *array, size_t elem_size, int count, int *capacity) {
+    if (count < *capacity) return array;
+
+    int new_cap = *capacity ? *capacity * 2 : 16;
+    size_t old_bytes = (size_t)*capacity * elem_size;
+    size_t new_bytes = (size_t)new_cap * elem_size;
+
+    arena_block_t *blk = a->head;
+    if (array && array == a->last_alloc && a->last_size == old_bytes && blk &&
+        (unsigned char *)array + new_bytes <= blk->data + blk->size) {
+        memset((unsigned char *)array + old_bytes, 0, new_bytes - old_bytes);
+        blk->used += new_bytes - old_bytes;
+        a->bytes_used += new_bytes - old_bytes;
+        a->last_size = new_bytes;
+        *capacity = new_cap;
+        return array;
+    }
+
+    void *grown = arena_alloc(a, new_bytes);
+    if (!grown) return NULL;
+    if (array && count > 0) {
+        memcpy(grown, array, (size_t)count * elem_size);
+    }
+    *capacity = new_cap;
+    return grown;
+}
+
+void arena_free(arena_t *a) {
+    arena_block_t *blk = a->head;
+    while (blk) {
+        arena_block_t *next = blk->next;
+        free(blk);
+        blk = next;
+    }
+    free(a->intern_slots);
+    memset(a, 0, sizeof(*a));
+}
+
+/* ============================================================
+ * String Interning
+ * ============================================================ */
+
+static uint32_t intern_hash(const char *s, size_t len) {
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int intern_resize(arena_t *a, size_t new_size) {
+    const char **slots = calloc(new_size, sizeof(const char *));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < a->intern_size; i++) {
+        const char *s = a->intern_slots[i];
+        if (!s) continue;
+        size_t slot = intern_hash(s, strlen(s)) & (new_size - 1);
+        while (slots[slot]) slot = (slot + 1) & (new_size - 1);
+        slots[slot] = s;
+    }
+
+    free(a->intern_slots);
+    a->intern_slots = slots;
+    a->intern_size = new_size;
+    return 0;
+}
+
+const char* arena_intern_n(arena_t *a, const char *s, size_t len) {
+    if (!s) return "";
+
+    /* Keep the load factor under 3/4 */
+    if ((a->intern_count + 1) * 4 > a->intern_size * 3) {
+        size_t new_size = a->intern_size ? a->intern_size * 2 : INTERN_INITIAL;
+        if (intern_resize(a, new_size) != 0) {
+            /* Out of table space - still hand back a stable copy */
+            char *copy = arena_alloc(a, len + 1);
+            if (!copy) return "";
+            memcpy(copy, s, len);
+            return copy;
+        }
+    }
+
+    size_t mask = a->intern_size - 1;
+    size_t slot = intern_hash(s, len) & mask;
+    while (a->intern_slots[slot]) {
+        const char *cur = a->intern_slots[slot];
+        if (strncmp(cur, s, len) == 0 && cur[len] == '\0') {
+            return cur;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    char *copy = arena_alloc(a, len + 1);
+    if (!copy) return "";
+    memcpy(copy, s, len);
+
+    a->intern_slots[slot] = copy;
+    a->intern_count++;
+    return copy;
+}
+
+const char* arena_intern(arena_t *a, const char *s) {
+    return arena_intern_n(a, s, s ? strlen(s) : 0);
+}
@@ -9,8 +9,9 @@
  *
  * audit.c - Auditd log parsing and summarisation
  * 
- * Uses ausearch for reliable event extraction, then summarises
- * for semantic analysis by LLMs.
+ * Reads new audit.log records in-process (audit_log.c), feeds every
+ * consumer from that one pass, then summarises for semantic analysis
+ * by LLMs.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -34,160 +35,12 @@
 /* EMA smoothing factor - 0.2 means recent data weighted 20% */
 #define EMA_ALPHA 0.2f
 
+/* With no baseline or cursor, look back this far (ausearch's "recent") */
+#define AUDIT_RECENT_SECONDS 600
+
 /* Salt for username hashing (generated once, stored in config) */
 static char username_salt[32] = "sentinel_default_salt";
 
-/* Global timestamp string for ausearch queries - set once per probe */
-static char g_ausearch_ts[64] = "today";
-
-/* ============================================================
- * Time Window Management
- * ============================================================ */
-
-/*
- * Format a timestamp for ausearch -ts option
- * ausearch uses locale-dependent date format (check with: date '+%x')
- * Time format is always HH:MM:SS in 24-hour format
- */
-static void format_ausearch_timestamp(time_t ts, char *buf, size_t bufsize) {
-    if (ts <= 0) {
-        snprintf(buf, bufsize, "recent");
-        return;
-    }
-    
-    struct tm *tm = localtime(&ts);
-    if (!tm) {
-        snprintf(buf, bufsize, "recent");
-        return;
-    }
-    
-    /* Use strftime with %x for locale-aware date format */
-    char datebuf[32];
-    strftime(datebuf, sizeof(datebuf), "%x", tm);
-    
-    snprintf(buf, bufsize, "%s %02d:%02d:%02d",
-             datebuf,
-             tm->tm_hour,
-             tm->tm_min,
-             tm->tm_sec);
-}
-
-
-/* ============================================================
- * Event Context Cache - correlate SYSCALL and PATH records
- * ============================================================ */
-#define MAX_AUDIT_EVENTS 256
-
-typedef struct {
-    int event_id;
-    pid_t pid;
-    pid_t ppid;                         /* Parent PID - key for chain building */
-    char comm[32];
-    char exe[256];
-    bool used;
-} audit_event_ctx_t;
-
-static audit_event_ctx_t event_ctx[MAX_AUDIT_EVENTS];
-static int event_ctx_count = 0;
-
-/* Extract event ID from audit line: msg=audit(1767386347.120:631) -> 631 */
-static int extract_event_id(const char *line) {
-    const char *p = strstr(line, "msg=audit(");
-    if (!p) return -1;
-    
-    p = strchr(p, ':');
-    if (!p) return -1;
-    
-    return atoi(p + 1);
-}
-
-/* Find or create context slot for an event ID */
-static audit_event_ctx_t* get_event_ctx(int event_id) {
-    /* Look for existing */
-    for (int i = 0; i < event_ctx_count; i++) {
-        if (event_ctx[i].used && event_ctx[i].event_id == event_id) {
-            return &event_ctx[i];
-        }
-    }
-    
-    /* Create new if space */
-    if (event_ctx_count >= MAX_AUDIT_EVENTS) {
-        return NULL;
-    }
-    
-    audit_event_ctx_t *ctx = &event_ctx[event_ctx_count++];
-    memset(ctx, 0, sizeof(*ctx));
-    ctx->event_id = event_id;
-    ctx->used = true;
-    return ctx;
-}
-
-/* Clear event context cache */
-static void clear_event_ctx(void) {
-    memset(event_ctx, 0, sizeof(event_ctx));
-    event_ctx_count = 0;
-}
-
-/* Parse SYSCALL records to build event context (pid, ppid, comm, exe) */
-static void parse_syscall_context(int window_seconds) {
-    char cmd[512];
-    char line[2048];
-    FILE *fp;
-    
-    (void)window_seconds;
-    
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -m SYSCALL -ts '%s' --format raw 2>/dev/null", g_ausearch_ts);
-    
-    fp = popen(cmd, "r");
-    if (!fp) return;
-    
-    while (fgets(line, sizeof(line), fp)) {
-        int event_id = extract_event_id(line);
-        if (event_id < 0) continue;
-        
-        audit_event_ctx_t *ctx = get_event_ctx(event_id);
-        if (!ctx) continue;
-        
-        /* Extract pid */
-        char *pid_str = strstr(line, " pid=");
-        if (pid_str) {
-            ctx->pid = atoi(pid_str + 5);
-        }
-        
-        /* Extract ppid - KEY FOR CHAIN BUILDING */
-        char *ppid_str = strstr(line, " ppid=");
-        if (ppid_str) {
-            ctx->ppid = atoi(ppid_str + 6);
-        }
-        
-        /* Extract comm="..." */
-        char *comm = strstr(line, " comm=\"");
-        if (comm) {
-            comm += 7;
-            int i = 0;
-            while (*comm && *comm != '"' && i < 31) {
-                ctx->comm[i++] = *comm++;
-            }
-            ctx->comm[i] = '\0';
-        }
-        
-        /* Extract exe="..." */
-        char *exe = strstr(line, " exe=\"");
-        if (exe) {
-            exe += 6;
-            int i = 0;
-            while (*exe && *exe != '"' && i < 255) {
-                ctx->exe[i++] = *exe++;
-            }
-            ctx->exe[i] = '\0';
-        }
-    }
-    
-    pclose(fp);
-}
-
-
 /*
  * Hash a username for privacy-preserving output
  * Output format: "user_xxxx" where xxxx is first 4 chars of hash
@@ -238,288 +91,263 @@ static hashed_user_t* find_or_add_user(audit_summary_t *summary, const char *use
 }
 
 
-/*
- * Parse ausearch output for authentication events
- * Looks for: type=USER_AUTH ... res=failed
+/* ============================================================
+ * Record Pass - every consumer fed from one read of the log
+ * ============================================================
+ * A PATH record means something only with its event's SYSCALL
+ * (key, comm, ppid) and EXECVE records, which the kernel logs just
+ * before it. The pass keeps the last few events that matter and
+ * looks PATH records up among them.
  */
-static void parse_auth_events(audit_summary_t *summary, int window_seconds) {
-    char cmd[512];
-    char line[2048];
-    FILE *fp;
-    
-    (void)window_seconds;
-    
-    /* Use raw format for stable parsing */
-    snprintf(cmd, sizeof(cmd), 
-             "ausearch -m USER_AUTH -ts '%s' --format raw 2>/dev/null | grep -E 'res=(success|failed)' | tail -100 2>/dev/null",
-             g_ausearch_ts);
-    
-    fp = popen(cmd, "r");
-    if (!fp) {
-        return;
-    }
-    
-    while (fgets(line, sizeof(line), fp)) {
-        /* Check result */
-        if (strstr(line, "res=failed")) {
-            summary->auth_failures++;
-            
-            /* Extract username from acct="..." (raw format has quotes) */
-            char *acct = strstr(line, "acct=\"");
-            if (acct) {
-                acct += 6;
-                char username[64] = {0};
-                int i = 0;
-                while (*acct && *acct != '"' && i < 63) {
-                    username[i++] = *acct++;
-                }
-                username[i] = '\0';
-                
-                if (strlen(username) > 0) {
-                    hashed_user_t *user = find_or_add_user(summary, username);
-                    if (user) {
-                        user->count++;
-                    }
-                }
-            }
-        } else if (strstr(line, "res=success")) {
-            summary->auth_successes++;
+
+#define AUTH_TAIL       100         /* Latest auth results counted */
+#define RECENT_EVENTS   64
+
+#define EVENT_IDENTITY  0x01        /* SYSCALL with key "identity" */
+#define EVENT_EXECVE    0x02        /* Has an EXECVE record */
+
+typedef struct {
+    time_t time;
+    unsigned long serial;
+    int flags;
+    pid_t ppid;
+    char comm[32];
+} audit_event_t;
+
+typedef struct {
+    bool failed;
+    char acct[64];
+} auth_result_t;
+
+typedef struct {
+    audit_summary_t *summary;
+    audit_event_t recent[RECENT_EVENTS];
+    int recent_next;
+    auth_result_t auth[AUTH_TAIL];
+    long auth_count;
+} audit_pass_t;
+
+/* The recent event a record belongs to, optionally adding it */
+static audit_event_t* find_event(audit_pass_t *pass, const audit_record_t *rec, bool create) {
+    for (int i = 0; i < RECENT_EVENTS; i++) {
+        audit_event_t *ev = &pass->recent[(pass->recent_next - 1 - i + RECENT_EVENTS) % RECENT_EVENTS];
+        if (ev->flags && ev->serial == rec->serial && ev->time == rec->time) {
+            return ev;
         }
     }
+    if (!create) return NULL;
     
-    pclose(fp);
-    
-    /* Detect brute force: >5 failures in the window */
-    summary->brute_force_detected = (summary->auth_failures > 5);
+    audit_event_t *ev = &pass->recent[pass->recent_next];
+    pass->recent_next = (pass->recent_next + 1) % RECENT_EVENTS;
+    memset(ev, 0, sizeof(*ev));
+    ev->time = rec->time;
+    ev->serial = rec->serial;
+    return ev;
 }
 
+/* A rule may carry several keys, separated by 0x01 */
+static bool has_key(const char *keys, const char *key) {
+    size_t len = strlen(key);
+    for (const char *k = keys; *k; ) {
+        size_t n = strcspn(k, "\x01");
+        if (n == len && strncmp(k, key, len) == 0) return true;
+        k += n;
+        if (*k) k++;
+    }
+    return false;
+}
 
-/*
- * Parse sudo/privilege escalation events
- */
-static void parse_priv_events(audit_summary_t *summary, int window_seconds) {
-    char cmd[512];
-    char line[1024];
-    FILE *fp;
-    
-    (void)window_seconds;
-    
-    /* Count sudo usage - raw format has exe="/usr/bin/sudo" with quotes */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -m USER_CMD -ts '%s' --format raw 2>/dev/null | grep -c 'exe=\"/usr/bin/sudo\"' 2>/dev/null",
-             g_ausearch_ts);
+/* SYSCALL records of watched identity files give the process context */
+static void on_syscall(audit_pass_t *pass, const audit_record_t *rec) {
+    char keys[128];
+    char value[32];
     
-    fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(line, sizeof(line), fp)) {
-            summary->sudo_count = atoi(line);
-        }
-        pclose(fp);
+    if (!audit_record_string(rec, "key", keys, sizeof(keys)) || !has_key(keys, "identity")) {
+        return;
     }
     
-    /* Count su usage */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -m USER_CMD -ts '%s' --format raw 2>/dev/null | grep -c 'exe=\"/usr/bin/su\"' 2>/dev/null",
-             g_ausearch_ts);
-    
-    fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(line, sizeof(line), fp)) {
-            summary->su_count = atoi(line);
-        }
-        pclose(fp);
+    audit_event_t *ev = find_event(pass, rec, true);
+    ev->flags |= EVENT_IDENTITY;
+    if (audit_record_field(rec, "ppid", value, sizeof(value))) {
+        ev->ppid = atoi(value);
     }
+    audit_record_string(rec, "comm", ev->comm, sizeof(ev->comm));
 }
 
-
-/*
- * Parse sensitive file access events (from our watch rules)
- */
-static void parse_file_events(audit_summary_t *summary, int window_seconds) {
-    char cmd[512];
-    char line[2048];
-    FILE *fp;
-    
-    (void)window_seconds;
-    
-    /* Identity files (actual file access) - these have nametype=NORMAL */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -k identity -ts '%s' --format raw 2>/dev/null | grep 'type=PATH' | grep 'nametype=NORMAL' 2>/dev/null",
-             g_ausearch_ts);
-    
-    fp = popen(cmd, "r");
-    if (!fp) {
+/* Record a watched identity file, with the process chain that touched it */
+static void add_sensitive_file(audit_summary_t *summary, const char *path,
+                               const audit_event_t *ev) {
+    size_t pathlen = strlen(path);
+    if (pathlen <= 5 || path[pathlen-1] == '/' ||
+        summary->sensitive_file_count >= MAX_AUDIT_FILES) {
         return;
     }
     
-    while (fgets(line, sizeof(line), fp)) {
-        /* Get event ID for correlation with SYSCALL context */
-        int event_id = extract_event_id(line);
-        audit_event_ctx_t *ctx = NULL;
-        if (event_id >= 0) {
-            ctx = get_event_ctx(event_id);
+    /* Check if we already have this file */
+    for (int j = 0; j < summary->sensitive_file_count; j++) {
+        if (strcmp(summary->sensitive_files[j].path, path) == 0) {
+            summary->sensitive_files[j].count++;
+            return;
         }
+    }
+    
+    file_access_t *fa = &summary->sensitive_files[summary->sensitive_file_count++];
+    memset(fa, 0, sizeof(*fa));
+    snprintf(fa->path, sizeof(fa->path), "%s", path);
+    strcpy(fa->access_type, "write");
+    fa->count = 1;
+    
+    /* Attach process info from SYSCALL context */
+    if (ev->comm[0]) {
+        strncpy(fa->process, ev->comm, sizeof(fa->process) - 1);
         
-        /* Look for name="..." in raw format */
-        char *name = strstr(line, "name=\"");
-        if (!name) continue;
+        /* Build process chain:
+         * 1. First entry is the audited process (from audit log, process may be dead)
+         * 2. Then walk from ppid (parent is likely still alive)
+         */
+        process_chain_t *chain = &fa->chain;
+        memset(chain, 0, sizeof(*chain));
         
-        name += 6;
+        /* First hop: audited process name from audit log */
+        strncpy(chain->names[0], ev->comm, sizeof(chain->names[0]) - 1);
+        chain->depth = 1;
         
-        char path[AUDIT_PATH_LEN] = {0};
-        int i = 0;
-        while (*name && *name != '"' && i < AUDIT_PATH_LEN - 1) {
-            path[i++] = *name++;
+        /* Continue from ppid (parent should still exist) */
+        if (ev->ppid > 1) {
+            build_process_chain(ev->ppid, chain);
         }
-        path[i] = '\0';
         
-        size_t pathlen = strlen(path);
-        if (pathlen > 5 && path[pathlen-1] != '/' && 
-            summary->sensitive_file_count < MAX_AUDIT_FILES) {
-            
-            /* Check if we already have this file */
-            bool found = false;
-            for (int j = 0; j < summary->sensitive_file_count; j++) {
-                if (strcmp(summary->sensitive_files[j].path, path) == 0) {
-                    summary->sensitive_files[j].count++;
-                    found = true;
-                    break;
-                }
-            }
-            
-            if (!found) {
-                file_access_t *fa = &summary->sensitive_files[summary->sensitive_file_count++];
-                memset(fa, 0, sizeof(*fa));
-                strncpy(fa->path, path, sizeof(fa->path) - 1);
-                strcpy(fa->access_type, "write");
-                fa->count = 1;
-                
-                /* Attach process info from SYSCALL context */
-                if (ctx && ctx->comm[0]) {
-                    strncpy(fa->process, ctx->comm, sizeof(fa->process) - 1);
-                    
-                    /* Build process chain:
-                     * 1. First entry is the audited process (from audit log, process may be dead)
-                     * 2. Then walk from ppid (parent is likely still alive)
-                     */
-                    process_chain_t *chain = &fa->chain;
-                    memset(chain, 0, sizeof(*chain));
-                    
-                    /* First hop: audited process name from audit log */
-                    strncpy(chain->names[0], ctx->comm, sizeof(chain->names[0]) - 1);
-                    chain->depth = 1;
-                    
-                    /* Continue from ppid (parent should still exist) */
-                    if (ctx->ppid > 1) {
-                        build_process_chain(ctx->ppid, chain);
-                    }
-                    
-                    /* Check for suspicious process chains */
-                    const char *reason = NULL;
-                    if (is_suspicious_chain(chain, &reason)) {
-                        fa->suspicious = true;
-                        summary->suspicious_exec_count++;
-                    }
-                }
-                
-                /* Also mark shadow/sudoers file access as suspicious */
-                if (strstr(path, "shadow") || strstr(path, "sudoers")) {
-                    fa->suspicious = true;
-                }
-            }
+        /* Check for suspicious process chains */
+        const char *reason = NULL;
+        if (is_suspicious_chain(chain, &reason)) {
+            fa->suspicious = true;
+            summary->suspicious_exec_count++;
         }
     }
     
-    pclose(fp);
+    /* Also mark shadow/sudoers file access as suspicious */
+    if (strstr(path, "shadow") || strstr(path, "sudoers")) {
+        fa->suspicious = true;
+    }
 }
 
-
 /*
- * Check for executions from suspicious locations (/tmp, /dev/shm)
+ * PATH records: identity file access (nametype=NORMAL), and for
+ * executions, binaries run from /tmp or /dev/shm and shells
  */
-static void parse_exec_events(audit_summary_t *summary, int window_seconds) {
-    char cmd[512];
-    char line[1024];
-    FILE *fp;
+static void on_path(audit_pass_t *pass, const audit_record_t *rec) {
+    audit_summary_t *summary = pass->summary;
+    char path[AUDIT_PATH_LEN];
+    char nametype[16];
     
-    (void)window_seconds;
+    audit_event_t *ev = find_event(pass, rec, false);
+    if (!ev || !audit_record_string(rec, "name", path, sizeof(path))) return;
     
-    /* Look for execve syscalls with paths in /tmp or /dev/shm */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -sc execve -ts '%s' -i 2>/dev/null | grep -E 'name=(/tmp/|/dev/shm/)' 2>/dev/null",
-             g_ausearch_ts);
+    if (ev->flags & EVENT_EXECVE) {
+        if (strncmp(path, "/tmp/", 5) == 0) summary->tmp_executions++;
+        if (strncmp(path, "/dev/shm/", 9) == 0) summary->devshm_executions++;
+        if (strstr(path, "/bin/sh") || strstr(path, "/bin/bash")) summary->shell_spawns++;
+    }
     
-    fp = popen(cmd, "r");
-    if (!fp) {
-        return;
+    if ((ev->flags & EVENT_IDENTITY) &&
+        audit_record_field(rec, "nametype", nametype, sizeof(nametype)) &&
+        strcmp(nametype, "NORMAL") == 0) {
+        add_sensitive_file(summary, path, ev);
+    }
+}
+
+/* USER_AUTH: only the latest AUTH_TAIL results count */
+static void on_user_auth(audit_pass_t *pass, const audit_record_t *rec) {
+    bool failed = strstr(rec->fields, "res=failed") != NULL;
+    if (!failed && !strstr(rec->fields, "res=success")) return;
+    
+    auth_result_t *auth = &pass->auth[pass->auth_count++ % AUTH_TAIL];
+    auth->failed = failed;
+    auth->acct[0] = '\0';
+    if (failed && audit_record_string(rec, "acct", auth->acct, sizeof(auth->acct)) &&
+        strcmp(auth->acct, "?") == 0) {
+        auth->acct[0] = '\0';
     }
+}
+
+static void finish_auth(audit_pass_t *pass) {
+    audit_summary_t *summary = pass->summary;
+    long first = pass->auth_count > AUTH_TAIL ? pass->auth_count - AUTH_TAIL : 0;
     
-    while (fgets(line, sizeof(line), fp)) {
-        /* Check path location */
-        if (strstr(line, "/tmp/")) {
-            summary->tmp_executions++;
+    for (long i = first; i < pass->auth_count; i++) {
+        const auth_result_t *auth = &pass->auth[i % AUTH_TAIL];
+        if (!auth->failed) {
+            summary->auth_successes++;
+            continue;
         }
-        if (strstr(line, "/dev/shm/")) {
-            summary->devshm_executions++;
+        
+        summary->auth_failures++;
+        if (auth->acct[0]) {
+            hashed_user_t *user = find_or_add_user(summary, auth->acct);
+            if (user) {
+                user->count++;
+            }
         }
     }
     
-    pclose(fp);
-    
-    /* Count shell spawns */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -sc execve -ts '%s' -i 2>/dev/null | grep -cE 'name=.*/bin/(ba)?sh' 2>/dev/null",
-             g_ausearch_ts);
+    /* Detect brute force: >5 failures in the window */
+    summary->brute_force_detected = (summary->auth_failures > 5);
+}
+
+/* One callback for every record type the summary uses */
+static void on_record(const audit_record_t *rec, void *ctx) {
+    audit_pass_t *pass = ctx;
+    audit_summary_t *summary = pass->summary;
+    const char *type = rec->type;
+    
+    if (strcmp(type, "SYSCALL") == 0) {
+        on_syscall(pass, rec);
+    } else if (strcmp(type, "EXECVE") == 0) {
+        find_event(pass, rec, true)->flags |= EVENT_EXECVE;
+    } else if (strcmp(type, "PATH") == 0) {
+        on_path(pass, rec);
+    } else if (strcmp(type, "USER_AUTH") == 0) {
+        on_user_auth(pass, rec);
+    } else if (strcmp(type, "USER_CMD") == 0) {
+        /* Raw format quotes exe, so "su" does not match "sudo" */
+        if (strstr(rec->fields, "exe=\"/usr/bin/sudo\"")) summary->sudo_count++;
+        if (strstr(rec->fields, "exe=\"/usr/bin/su\"")) summary->su_count++;
+    } else if (strcmp(type, "AVC") == 0) {
+        if (strstr(rec->fields, "denied")) summary->selinux_avc_denials++;
+    } else if (strcmp(type, "APPARMOR_DENIED") == 0) {
+        summary->apparmor_denials++;
+    }
+}
+
+long audit_scan_log(const char *path, audit_log_cursor_t *cursor, time_t since,
+                    audit_summary_t *summary) {
+    audit_pass_t *pass = calloc(1, sizeof(*pass));
+    if (!pass) return -1;
+    pass->summary = summary;
     
-    fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(line, sizeof(line), fp)) {
-            summary->shell_spawns = atoi(line);
-        }
-        pclose(fp);
+    long count = audit_log_read(path, cursor, since, on_record, pass);
+    if (count >= 0) {
+        finish_auth(pass);
     }
+    
+    free(pass);
+    return count;
 }
 
 
 /*
- * Check SELinux/AppArmor status
+ * Check SELinux status
  */
 static void check_security_framework(audit_summary_t *summary) {
     FILE *fp;
     char line[256];
-    char cmd[512];
     
-    /* Check SELinux */
     fp = fopen("/sys/fs/selinux/enforce", "r");
     if (fp) {
         if (fgets(line, sizeof(line), fp)) {
             summary->selinux_enforcing = (atoi(line) == 1);
         }
         fclose(fp);
-        
-        /* Count AVC denials */
-        snprintf(cmd, sizeof(cmd),
-                 "ausearch -m AVC -ts '%s' 2>/dev/null | grep -c 'denied' 2>/dev/null",
-                 g_ausearch_ts);
-        fp = popen(cmd, "r");
-        if (fp) {
-            if (fgets(line, sizeof(line), fp)) {
-                summary->selinux_avc_denials = atoi(line);
-            }
-            pclose(fp);
-        }
-    }
-    
-    /* Check AppArmor */
-    snprintf(cmd, sizeof(cmd),
-             "ausearch -m APPARMOR_DENIED -ts '%s' 2>/dev/null | wc -l 2>/dev/null",
-             g_ausearch_ts);
-    fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(line, sizeof(line), fp)) {
-            summary->apparmor_denials = atoi(line);
-        }
-        pclose(fp);
     }
 }
 
@@ -936,7 +764,7 @@ audit_summary_t* probe_audit(int window_seconds) {
     summary->capture_time = time(NULL);
     
     /* Check if auditd is available */
-    if (access("/var/log/audit/audit.log", R_OK) != 0) {
+    if (access(AUDIT_LOG_PATH, R_OK) != 0) {
         summary->enabled = false;
         return summary;
     }
@@ -945,30 +773,22 @@ audit_summary_t* probe_audit(int window_seconds) {
     audit_baseline_t baseline = {0};
     bool has_baseline = load_audit_baseline(&baseline);
     
-    /* Set global timestamp for ausearch queries
-     * Use last probe time if available, otherwise use 'recent' (10 mins)
+    /* Records after the cursor are new. Without one (first run, or the
+     * log rotated more than once), take those since the last probe,
+     * or the last ten minutes.
      */
+    time_t since = time(NULL) - AUDIT_RECENT_SECONDS;
     if (has_baseline && baseline.updated > 0) {
-        format_ausearch_timestamp(baseline.updated, g_ausearch_ts, sizeof(g_ausearch_ts));
-    } else {
-        /* First run or no baseline - use 'recent' (last 10 minutes) */
-        strcpy(g_ausearch_ts, "recent");
+        since = baseline.updated;
     }
     
-    /* Build SYSCALL context first (for process correlation) */
-    clear_event_ctx();
-    parse_syscall_context(window_seconds);
-    
-    /* Parse various event types */
-    parse_auth_events(summary, window_seconds);
-    parse_priv_events(summary, window_seconds);
-    parse_file_events(summary, window_seconds);
-    parse_exec_events(summary, window_seconds);
+    audit_log_cursor_t cursor;
+    load_audit_cursor(&cursor);
+    if (audit_scan_log(AUDIT_LOG_PATH, &cursor, since, summary) >= 0) {
+        save_audit_cursor(&cursor);
+    }
     check_security_framework(summary);
     
-    /* Clean up event context */
-    clear_event_ctx();
-    
     /* Detect anomalies using baseline */
     if (has_baseline) {
         detect_anomalies(summary, &baseline);
@@ -12,153 +12,130 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <stdarg.h>
 #include "../include/audit.h"
-
-/* Helper to append to buffer safely */
-static int buf_append(char *buf, size_t bufsize, size_t *pos, const char *fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    int written = vsnprintf(buf + *pos, bufsize - *pos, fmt, args);
-    va_end(args);
-    if (written > 0 && *pos + written < bufsize) {
-        *pos += written;
-        return written;
-    }
-    return 0;
-}
-
+#include "../include/json_writer.h"
 
 /*
- * Output audit summary as JSON
+ * Output audit summary as the "audit_summary" member of the open object
  */
-void audit_to_json(const audit_summary_t *summary, char *buf, size_t bufsize) {
-    size_t pos = 0;
-    
-    buf_append(buf, bufsize, &pos, "  \"audit_summary\": {\n");
-    buf_append(buf, bufsize, &pos, "    \"enabled\": %s,\n", summary->enabled ? "true" : "false");
-    buf_append(buf, bufsize, &pos, "    \"period_seconds\": %d,\n", summary->period_seconds);
+void audit_json_member(json_writer_t *w, const audit_summary_t *summary) {
+    json_object_begin(w, "audit_summary");
+    json_bool(w, "enabled", summary->enabled);
+    json_int(w, "period_seconds", summary->period_seconds);
     
     if (!summary->enabled) {
-        buf_append(buf, bufsize, &pos, "    \"error\": \"auditd not available or not readable\"\n");
-        buf_append(buf, bufsize, &pos, "  }");
+        json_string(w, "error", "auditd not available or not readable");
+        json_object_end(w);
         return;
     }
     
     /* Authentication section */
-    buf_append(buf, bufsize, &pos, "    \"authentication\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"failures\": %d,\n", summary->auth_failures);
+    json_object_begin(w, "authentication");
+    json_int(w, "failures", summary->auth_failures);
     
     /* Hashed usernames */
-    buf_append(buf, bufsize, &pos, "      \"failure_users_hashed\": [");
+    json_array_begin_inline(w, "failure_users_hashed");
     for (int i = 0; i < summary->failure_user_count; i++) {
-        buf_append(buf, bufsize, &pos, "%s\"%s\"", 
-                  i > 0 ? ", " : "", summary->failure_users[i].hash);
+        json_string(w, NULL, summary->failure_users[i].hash);
     }
-    buf_append(buf, bufsize, &pos, "],\n");
+    json_array_end(w);
     
-    buf_append(buf, bufsize, &pos, "      \"baseline_avg\": %.2f,\n", summary->auth_baseline_avg);
-    buf_append(buf, bufsize, &pos, "      \"deviation_pct\": %.1f,\n", summary->auth_deviation_pct);
-    buf_append(buf, bufsize, &pos, "      \"brute_force_detected\": %s\n", 
-              summary->brute_force_detected ? "true" : "false");
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_double(w, "baseline_avg", summary->auth_baseline_avg, 2);
+    json_double(w, "deviation_pct", summary->auth_deviation_pct, 1);
+    json_bool(w, "brute_force_detected", summary->brute_force_detected);
+    json_object_end(w);
     
     /* Privilege escalation section */
-    buf_append(buf, bufsize, &pos, "    \"privilege_escalation\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"sudo_count\": %d,\n", summary->sudo_count);
-    buf_append(buf, bufsize, &pos, "      \"sudo_baseline_avg\": %.2f,\n", summary->sudo_baseline_avg);
-    buf_append(buf, bufsize, &pos, "      \"sudo_deviation_pct\": %.1f,\n", summary->sudo_deviation_pct);
-    buf_append(buf, bufsize, &pos, "      \"su_count\": %d,\n", summary->su_count);
-    buf_append(buf, bufsize, &pos, "      \"setuid_executions\": %d,\n", summary->setuid_executions);
-    buf_append(buf, bufsize, &pos, "      \"capability_changes\": %d\n", summary->capability_changes);
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_object_begin(w, "privilege_escalation");
+    json_int(w, "sudo_count", summary->sudo_count);
+    json_double(w, "sudo_baseline_avg", summary->sudo_baseline_avg, 2);
+    json_double(w, "sudo_deviation_pct", summary->sudo_deviation_pct, 1);
+    json_int(w, "su_count", summary->su_count);
+    json_int(w, "setuid_executions", summary->setuid_executions);
+    json_int(w, "capability_changes", summary->capability_changes);
+    json_object_end(w);
     
     /* File integrity section */
-    buf_append(buf, bufsize, &pos, "    \"file_integrity\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"permission_changes\": %d,\n", summary->permission_changes);
-    buf_append(buf, bufsize, &pos, "      \"ownership_changes\": %d,\n", summary->ownership_changes);
-    buf_append(buf, bufsize, &pos, "      \"sensitive_file_access\": [\n");
+    json_object_begin(w, "file_integrity");
+    json_int(w, "permission_changes", summary->permission_changes);
+    json_int(w, "ownership_changes", summary->ownership_changes);
+    json_array_begin(w, "sensitive_file_access");
     
     for (int i = 0; i < summary->sensitive_file_count; i++) {
         const file_access_t *fa = &summary->sensitive_files[i];
-        buf_append(buf, bufsize, &pos, "        {\n");
-        buf_append(buf, bufsize, &pos, "          \"path\": \"%s\",\n", fa->path);
-        buf_append(buf, bufsize, &pos, "          \"access\": \"%s\",\n", fa->access_type);
-        buf_append(buf, bufsize, &pos, "          \"count\": %d,\n", fa->count);
-        buf_append(buf, bufsize, &pos, "          \"process\": \"%s\",\n", fa->process);
+        json_object_begin(w, NULL);
+        json_string(w, "path", fa->path);
+        json_string(w, "access", fa->access_type);
+        json_int(w, "count", fa->count);
+        json_string(w, "process", fa->process);
         
         /* Process chain array */
-        buf_append(buf, bufsize, &pos, "          \"process_chain\": [");
+        json_array_begin_inline(w, "process_chain");
         for (int j = 0; j < fa->chain.depth; j++) {
-            buf_append(buf, bufsize, &pos, "%s\"%s\"", 
-                      j > 0 ? ", " : "", fa->chain.names[j]);
+            json_string(w, NULL, fa->chain.names[j]);
         }
-        buf_append(buf, bufsize, &pos, "],\n");
+        json_array_end(w);
         
-        buf_append(buf, bufsize, &pos, "          \"suspicious\": %s\n", fa->suspicious ? "true" : "false");
-        buf_append(buf, bufsize, &pos, "        }%s\n", 
-                  i < summary->sensitive_file_count - 1 ? "," : "");
+        json_bool(w, "suspicious", fa->suspicious);
+        json_object_end(w);
     }
     
-    buf_append(buf, bufsize, &pos, "      ]\n");
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_array_end(w);
+    json_object_end(w);
     
     /* Process activity section */
-    buf_append(buf, bufsize, &pos, "    \"process_activity\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"tmp_executions\": %d,\n", summary->tmp_executions);
-    buf_append(buf, bufsize, &pos, "      \"devshm_executions\": %d,\n", summary->devshm_executions);
-    buf_append(buf, bufsize, &pos, "      \"shell_spawns\": %d,\n", summary->shell_spawns);
-    buf_append(buf, bufsize, &pos, "      \"cron_executions\": %d,\n", summary->cron_executions);
-    buf_append(buf, bufsize, &pos, "      \"suspicious_exec_count\": %d\n", summary->suspicious_exec_count);
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_object_begin(w, "process_activity");
+    json_int(w, "tmp_executions", summary->tmp_executions);
+    json_int(w, "devshm_executions", summary->devshm_executions);
+    json_int(w, "shell_spawns", summary->shell_spawns);
+    json_int(w, "cron_executions", summary->cron_executions);
+    json_int(w, "suspicious_exec_count", summary->suspicious_exec_count);
+    json_object_end(w);
     
     /* Security framework section */
-    buf_append(buf, bufsize, &pos, "    \"security_framework\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"selinux_enforcing\": %s,\n", 
-              summary->selinux_enforcing ? "true" : "false");
-    buf_append(buf, bufsize, &pos, "      \"selinux_avc_denials\": %d,\n", summary->selinux_avc_denials);
-    buf_append(buf, bufsize, &pos, "      \"apparmor_denials\": %d\n", summary->apparmor_denials);
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_object_begin(w, "security_framework");
+    json_bool(w, "selinux_enforcing", summary->selinux_enforcing);
+    json_int(w, "selinux_avc_denials", summary->selinux_avc_denials);
+    json_int(w, "apparmor_denials", summary->apparmor_denials);
+    json_object_end(w);
     
     /* Anomalies section */
-    buf_append(buf, bufsize, &pos, "    \"anomalies\": [\n");
+    json_array_begin(w, "anomalies");
     for (int i = 0; i < summary->anomaly_count; i++) {
         const audit_anomaly_t *a = &summary->anomalies[i];
-        buf_append(buf, bufsize, &pos, "      {\n");
-        buf_append(buf, bufsize, &pos, "        \"type\": \"%s\",\n", a->type);
-        buf_append(buf, bufsize, &pos, "        \"description\": \"%s\",\n", a->description);
-        buf_append(buf, bufsize, &pos, "        \"severity\": \"%s\",\n", a->severity);
-        buf_append(buf, bufsize, &pos, "        \"current\": %.1f,\n", a->current_value);
-        buf_append(buf, bufsize, &pos, "        \"baseline_avg\": %.2f,\n", a->baseline_avg);
-        buf_append(buf, bufsize, &pos, "        \"deviation_pct\": %.1f\n", a->deviation_pct);
-        buf_append(buf, bufsize, &pos, "      }%s\n",
-                  i < summary->anomaly_count - 1 ? "," : "");
+        json_object_begin(w, NULL);
+        json_string(w, "type", a->type);
+        json_string(w, "description", a->description);
+        json_string(w, "severity", a->severity);
+        json_double(w, "current", a->current_value, 1);
+        json_double(w, "baseline_avg", a->baseline_avg, 2);
+        json_double(w, "deviation_pct", a->deviation_pct, 1);
+        json_object_end(w);
     }
-    buf_append(buf, bufsize, &pos, "    ],\n");
+    json_array_end(w);
     
     /* Learning/confidence status */
-    buf_append(buf, bufsize, &pos, "    \"learning\": {\n");
-    buf_append(buf, bufsize, &pos, "      \"sample_count\": %d,\n", summary->baseline_sample_count);
-    buf_append(buf, bufsize, &pos, "      \"confidence\": \"%s\"\n", 
-              summary->baseline_sample_count < 5 ? "low" :
-              summary->baseline_sample_count < 20 ? "medium" : "high");
-    buf_append(buf, bufsize, &pos, "    },\n");
+    json_object_begin(w, "learning");
+    json_int(w, "sample_count", summary->baseline_sample_count);
+    json_string(w, "confidence",
+                summary->baseline_sample_count < 5 ? "low" :
+                summary->baseline_sample_count < 20 ? "medium" : "high");
+    json_object_end(w);
     
     /* Risk factors section */
-    buf_append(buf, bufsize, &pos, "    \"risk_factors\": [\n");
+    json_array_begin(w, "risk_factors");
     for (int i = 0; i < summary->risk_factor_count; i++) {
         const risk_factor_t *rf = &summary->risk_factors[i];
-        buf_append(buf, bufsize, &pos, "      {\n");
-        buf_append(buf, bufsize, &pos, "        \"reason\": \"%s\",\n", rf->reason);
-        buf_append(buf, bufsize, &pos, "        \"weight\": %d\n", rf->weight);
-        buf_append(buf, bufsize, &pos, "      }%s\n",
-                  i < summary->risk_factor_count - 1 ? "," : "");
+        json_object_begin(w, NULL);
+        json_string(w, "reason", rf->reason);
+        json_int(w, "weight", rf->weight);
+        json_object_end(w);
     }
-    buf_append(buf, bufsize, &pos, "    ],\n");
+    json_array_end(w);
     
     /* Risk assessment */
-    buf_append(buf, bufsize, &pos, "    \"risk_score\": %d,\n", summary->risk_score);
-    buf_append(buf, bufsize, &pos, "    \"risk_level\": \"%s\"\n", summary->risk_level);
+    json_int(w, "risk_score", summary->risk_score);
+    json_string(w, "risk_level", summary->risk_level);
     
-    buf_append(buf, bufsize, &pos, "  }");
+    json_object_end(w);
 }
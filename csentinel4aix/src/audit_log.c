@@ -0,0 +1,323 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * audit_log.c - In-process reader for the raw auditd log
+ *
+ * Each line of audit.log is one record:
+ *
+ *   [node=NAME ]type=TYPE msg=audit(SECONDS.MILLIS:SERIAL): key=value ...
+ *
+ * The file is read in large blocks and every record is handed to one
+ * callback, so a probe reads the log once however many consumers it
+ * has. A cursor (the file's device, inode and the offset after the
+ * last whole record) lets the next probe start where this one stopped;
+ * when auditd has rotated the log since, the rest of the old file is
+ * read from audit.log.1 first.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/audit.h"
+
+/* auditd records are at most a few KB; a longer line is skipped */
+#define AUDIT_READ_BLOCK (256 * 1024)
+
+#define AUDIT_CURSOR_FILENAME "audit_cursor.dat"
+#define AUDIT_CURSOR_MAGIC    "SNTLACUR"
+#define AUDIT_CURSOR_VERSION  1
+
+/* ============================================================
+ * Record Parsing
+ * ============================================================ */
+
+/* Split a line into its header and fields; false if it is not a record */
+static bool parse_record(char *line, audit_record_t *rec) {
+    char *p = line;
+    char *end;
+
+    if (strncmp(p, "node=", 5) == 0) {
+        p = strchr(p, ' ');
+        if (!p) return false;
+        p++;
+    }
+
+    if (strncmp(p, "type=", 5) != 0) return false;
+    p += 5;
+    size_t n = strcspn(p, " ");
+    if (n == 0 || n >= sizeof(rec->type)) return false;
+    memcpy(rec->type, p, n);
+    rec->type[n] = '\0';
+    p += n;
+
+    if (strncmp(p, " msg=audit(", 11) != 0) return false;
+    p += 11;
+    rec->time = (time_t)strtol(p, &end, 10);
+    if (end == p || *end != '.') return false;
+    p = end + 1;
+    rec->msec = (int)strtol(p, &end, 10);
+    if (end == p || *end != ':') return false;
+    p = end + 1;
+    rec->serial = strtoul(p, &end, 10);
+    if (end == p || *end != ')') return false;
+    p = end + 1;
+
+    if (*p == ':') p++;
+    while (*p == ' ') p++;
+    rec->fields = p;
+    return true;
+}
+
+/* Start of key's value, or NULL; keys may follow a space, a quote or 0x1d */
+static const char* find_field(const char *fields, const char *key) {
+    size_t klen = strlen(key);
+
+    for (const char *p = fields; (p = strstr(p, key)) != NULL; p += klen) {
+        if (p[klen] != '=') continue;
+        if (p == fields || p[-1] == ' ' || p[-1] == '\'' || p[-1] == '\x1d') {
+            return p + klen + 1;
+        }
+    }
+    return NULL;
+}
+
+/* Copy a value, quoted or bare; returns its length before truncation */
+static size_t copy_value(const char *v, char *out, size_t outsize, bool *quoted) {
+    size_t n;
+
+    *quoted = (*v == '"');
+    if (*quoted) {
+        v++;
+        n = strcspn(v, "\"");
+    } else {
+        n = strcspn(v, " '\x1d");
+    }
+
+    size_t copy = n < outsize - 1 ? n : outsize - 1;
+    memcpy(out, v, copy);
+    out[copy] = '\0';
+    return n;
+}
+
+bool audit_record_field(const audit_record_t *rec, const char *key,
+                        char *out, size_t outsize) {
+    if (!rec || !key || !out || outsize == 0) return false;
+
+    const char *v = find_field(rec->fields, key);
+    if (!v) return false;
+
+    bool quoted;
+    copy_value(v, out, outsize, &quoted);
+    return true;
+}
+
+static int hex_value(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (unsigned char)toupper(c);
+    return (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+}
+
+bool audit_record_string(const audit_record_t *rec, const char *key,
+                         char *out, size_t outsize) {
+    if (!rec || !key || !out || outsize == 0) return false;
+
+    const char *v = find_field(rec->fields, key);
+    if (!v) return false;
+
+    bool quoted;
+    size_t n = copy_value(v, out, outsize, &quoted);
+    if (quoted || n < 2 || n % 2 != 0 || n >= outsize) return true;
+
+    /* Strings with spaces or odd bytes are logged as bare hex */
+    for (size_t i = 0; i < n; i++) {
+        if (hex_value((unsigned char)out[i]) < 0) return true;
+    }
+    for (size_t i = 0; i < n / 2; i++) {
+        out[i] = (char)(hex_value((unsigned char)out[2 * i]) * 16 +
+                        hex_value((unsigned char)out[2 * i + 1]));
+    }
+    out[n / 2] = '\0';
+    return true;
+}
+
+/* ============================================================
+ * Reading
+ * ============================================================ */
+
+/*
+ * Pass every record from offset up to the last whole line to fn.
+ * Returns the offset after that line, or -1 on a read error.
+ */
+static off_t read_records(int fd, off_t offset, time_t since,
+                          audit_record_fn fn, void *ctx, long *count) {
+    if (lseek(fd, offset, SEEK_SET) < 0) return -1;
+
+    char *buf = malloc(AUDIT_READ_BLOCK);
+    if (!buf) return -1;
+
+    size_t have = 0;
+    off_t pos = offset;             /* File offset of buf[0] */
+    bool skipping = false;          /* In the rest of an overlong line */
+
+    for (;;) {
+        ssize_t got = read(fd, buf + have, AUDIT_READ_BLOCK - have);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            free(buf);
+            return -1;
+        }
+        if (got == 0) break;
+        have += (size_t)got;
+
+        size_t start = 0;
+        char *nl;
+        while ((nl = memchr(buf + start, '\n', have - start)) != NULL) {
+            *nl = '\0';
+            audit_record_t rec;
+            if (!skipping && parse_record(buf + start, &rec) && rec.time >= since) {
+                fn(&rec, ctx);
+                (*count)++;
+            }
+            skipping = false;
+            start = (size_t)(nl - buf) + 1;
+        }
+
+        pos += (off_t)start;
+        memmove(buf, buf + start, have - start);
+        have -= start;
+        if (have == AUDIT_READ_BLOCK) {
+            pos += (off_t)have;
+            have = 0;
+            skipping = true;
+        }
+    }
+
+    free(buf);
+    return pos;
+}
+
+long audit_log_read(const char *path, audit_log_cursor_t *cursor, time_t since,
+                    audit_record_fn fn, void *ctx) {
+    if (!path || !cursor || !fn) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    long count = 0;
+    off_t start = 0;
+    bool same_file = cursor->dev == (uint64_t)st.st_dev &&
+                     cursor->ino == (uint64_t)st.st_ino;
+
+    if (same_file && cursor->offset <= (uint64_t)st.st_size) {
+        /* Everything past the cursor is new */
+        start = (off_t)cursor->offset;
+        since = 0;
+    } else if (!same_file && cursor->ino != 0) {
+        /* Rotated: finish the old file if it is still audit.log.1 */
+        char rotated[MAX_PATH_LEN];
+        snprintf(rotated, sizeof(rotated), "%s.1", path);
+
+        int old = open(rotated, O_RDONLY);
+        struct stat ost;
+        if (old >= 0 && fstat(old, &ost) == 0 &&
+            cursor->dev == (uint64_t)ost.st_dev &&
+            cursor->ino == (uint64_t)ost.st_ino &&
+            cursor->offset <= (uint64_t)ost.st_size &&
+            read_records(old, (off_t)cursor->offset, 0, fn, ctx, &count) >= 0) {
+            since = 0;
+        }
+        if (old >= 0) close(old);
+    }
+
+    off_t end = read_records(fd, start, since, fn, ctx, &count);
+    close(fd);
+    if (end < 0) return -1;
+
+    cursor->dev = (uint64_t)st.st_dev;
+    cursor->ino = (uint64_t)st.st_ino;
+    cursor->offset = (uint64_t)end;
+    return count;
+}
+
+/* ============================================================
+ * Cursor Persistence
+ * ============================================================ */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    audit_log_cursor_t cursor;
+} audit_cursor_file_t;
+
+static void get_cursor_path(char *path, size_t path_size) {
+    char dir[256];
+    sentinel_state_dir(dir, sizeof(dir));
+    snprintf(path, path_size, "%s/%s", dir, AUDIT_CURSOR_FILENAME);
+}
+
+bool load_audit_cursor(audit_log_cursor_t *cursor) {
+    char path[MAX_PATH_LEN];
+    audit_cursor_file_t file;
+
+    memset(cursor, 0, sizeof(*cursor));
+    get_cursor_path(path, sizeof(path));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    size_t got = fread(&file, sizeof(file), 1, fp);
+    fclose(fp);
+
+    if (got != 1 || memcmp(file.magic, AUDIT_CURSOR_MAGIC, 8) != 0 ||
+        file.version != AUDIT_CURSOR_VERSION) {
+        return false;
+    }
+    *cursor = file.cursor;
+    return true;
+}
+
+bool save_audit_cursor(const audit_log_cursor_t *cursor) {
+    char path[MAX_PATH_LEN];
+    char tmp[MAX_PATH_LEN + 8];
+    audit_cursor_file_t file;
+
+    if (sentinel_ensure_state_dir() != 0) return false;
+    get_cursor_path(path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    memset(&file, 0, sizeof(file));
+    memcpy(file.magic, AUDIT_CURSOR_MAGIC, 8);
+    file.version = AUDIT_CURSOR_VERSION;
+    file.cursor = *cursor;
+
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(&file, sizeof(file), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+
+    /* Renamed into place, so a crash never leaves half a cursor */
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
@@ -28,8 +28,8 @@
 
 /* Note: baseline_t and deviation_report_t are defined in sentinel.h */
 
-/* Get baseline directory path */
-static void get_baseline_dir(char *path, size_t path_size) {
+/* Get state directory path (baseline, caches) */
+void sentinel_state_dir(char *path, size_t path_size) {
     struct stat st;
     
     /* If /var/lib/sentinel exists and is writable, use it (system service mode) */
@@ -52,14 +52,14 @@ static void get_baseline_dir(char *path, size_t path_size) {
 /* Get baseline file path */
 static void get_baseline_path(char *path, size_t path_size) {
     char dir[256];
-    get_baseline_dir(dir, sizeof(dir));
+    sentinel_state_dir(dir, sizeof(dir));
     snprintf(path, path_size, "%s/%s", dir, BASELINE_FILENAME);
 }
 
-/* Ensure baseline directory exists */
-static int ensure_baseline_dir(void) {
+/* Ensure state directory exists */
+int sentinel_ensure_state_dir(void) {
     char dir[512];
-    get_baseline_dir(dir, sizeof(dir));
+    sentinel_state_dir(dir, sizeof(dir));
     
     struct stat st;
     if (stat(dir, &st) == 0) {
@@ -102,7 +102,7 @@ int baseline_load(baseline_t *b) {
 
 /* Save baseline to disk */
 int baseline_save(const baseline_t *b) {
-    if (ensure_baseline_dir() != 0) {
+    if (sentinel_ensure_state_dir() != 0) {
         return -1;
     }
     
@@ -186,10 +186,10 @@ int baseline_learn(baseline_t *b, const fingerprint_t *fp) {
             /* Update existing - keep the checksum (first seen is "correct") */
         } else {
             /* Add new */
-            strncpy(b->expected_configs[b->expected_config_count].path, 
-                    cfg->path, 255);
-            strncpy(b->expected_configs[b->expected_config_count].checksum,
-                    cfg->checksum, 64);
+            snprintf(b->expected_configs[b->expected_config_count].path,
+                     sizeof(b->expected_configs[0].path), "%s", cfg->path);
+            snprintf(b->expected_configs[b->expected_config_count].checksum,
+                     sizeof(b->expected_configs[0].checksum), "%s", cfg->checksum);
             b->expected_config_count++;
         }
     }
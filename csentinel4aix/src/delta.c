@@ -0,0 +1,224 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * delta.c - What changed between two fingerprints
+ *
+ * Watch mode emits a full keyframe every so often and, in between,
+ * only the processes, config files, listeners and connections that
+ * appeared, disappeared or changed since the previous tick. Both
+ * sides are sorted on their identity key and merged, so a tick costs
+ * O(n log n) however much churn there is.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sentinel.h"
+
+typedef int (*delta_cmp_fn)(const void *a, const void *b);
+
+/* ============================================================
+ * Identity Keys
+ * ============================================================ */
+
+static int cmp_str(const char *a, const char *b) {
+    return strcmp(a ? a : "", b ? b : "");
+}
+
+/*
+ * pid alone is not enough: a recycled pid is a different process. The
+ * name is left out because kernel workers rename themselves constantly;
+ * an exec without fork shows up in the next keyframe.
+ */
+static int cmp_process(const void *x, const void *y) {
+    const process_info_t *a = x, *b = y;
+    if (a->pid != b->pid) return a->pid < b->pid ? -1 : 1;
+    if (a->start_time != b->start_time) return a->start_time < b->start_time ? -1 : 1;
+    return 0;
+}
+
+static int cmp_config(const void *x, const void *y) {
+    const config_file_t *a = x, *b = y;
+    return cmp_str(a->path, b->path);
+}
+
+static int config_changed(const void *x, const void *y) {
+    const config_file_t *a = x, *b = y;
+    return a->size != b->size || a->mtime != b->mtime ||
+           a->permissions != b->permissions || a->owner != b->owner ||
+           a->group != b->group || strcmp(a->checksum, b->checksum) != 0;
+}
+
+static int cmp_listener(const void *x, const void *y) {
+    const net_listener_t *a = x, *b = y;
+    int r;
+    if (a->local_port != b->local_port) return a->local_port < b->local_port ? -1 : 1;
+    if ((r = cmp_str(a->protocol, b->protocol)) != 0) return r;
+    if ((r = cmp_str(a->local_addr, b->local_addr)) != 0) return r;
+    if (a->pid != b->pid) return a->pid < b->pid ? -1 : 1;
+    return 0;
+}
+
+/* State is part of the key: ESTABLISHED -> CLOSE_WAIT is a remove + add */
+static int cmp_connection(const void *x, const void *y) {
+    const net_connection_t *a = x, *b = y;
+    int r;
+    if (a->local_port != b->local_port) return a->local_port < b->local_port ? -1 : 1;
+    if (a->remote_port != b->remote_port) return a->remote_port < b->remote_port ? -1 : 1;
+    if ((r = cmp_str(a->protocol, b->protocol)) != 0) return r;
+    if ((r = cmp_str(a->local_addr, b->local_addr)) != 0) return r;
+    if ((r = cmp_str(a->remote_addr, b->remote_addr)) != 0) return r;
+    if ((r = cmp_str(a->state, b->state)) != 0) return r;
+    if (a->pid != b->pid) return a->pid < b->pid ? -1 : 1;
+    return 0;
+}
+
+/* ============================================================
+ * Sorted Merge
+ * ============================================================ */
+
+#define ELEM(base, size, i) ((const char *)(base) + (size_t)(i) * (size))
+
+/* Stable merge sort of element indices (qsort has no context argument) */
+static void sort_indices(int *idx, int *tmp, int n, const void *base, size_t size,
+                         delta_cmp_fn cmp) {
+    if (n < 2) return;
+    int mid = n / 2;
+    sort_indices(idx, tmp, mid, base, size, cmp);
+    sort_indices(idx + mid, tmp, n - mid, base, size, cmp);
+
+    int i = 0, j = mid, k = 0;
+    while (i < mid && j < n) {
+        if (cmp(ELEM(base, size, idx[j]), ELEM(base, size, idx[i])) < 0) {
+            tmp[k++] = idx[j++];
+        } else {
+            tmp[k++] = idx[i++];
+        }
+    }
+    while (i < mid) tmp[k++] = idx[i++];
+    while (j < n) tmp[k++] = idx[j++];
+    memcpy(idx, tmp, n * sizeof(int));
+}
+
+static int* sorted_indices(arena_t *a, int *tmp, const void *base, int count,
+                           size_t size, delta_cmp_fn cmp) {
+    int *idx = arena_alloc(a, (count > 0 ? count : 1) * sizeof(int));
+    if (!idx) return NULL;
+    for (int i = 0; i < count; i++) idx[i] = i;
+    sort_indices(idx, tmp, count, base, size, cmp);
+    return idx;
+}
+
+/*
+ * Entries only in cur go to added (as cur indices), entries only in
+ * prev to removed (as prev indices). With a changed() test, matching
+ * keys whose contents differ are reported as added too.
+ */
+static int diff_sets(arena_t *a, const void *prev, int prev_count,
+                     const void *cur, int cur_count, size_t size,
+                     delta_cmp_fn cmp, delta_cmp_fn changed,
+                     int **added, int *added_count,
+                     int **removed, int *removed_count) {
+    int max = prev_count > cur_count ? prev_count : cur_count;
+    int *tmp = malloc((max > 0 ? max : 1) * sizeof(int));
+    if (!tmp) return -1;
+
+    int *p = sorted_indices(a, tmp, prev, prev_count, size, cmp);
+    int *c = sorted_indices(a, tmp, cur, cur_count, size, cmp);
+    free(tmp);
+
+    *added = arena_alloc(a, (cur_count > 0 ? cur_count : 1) * sizeof(int));
+    *removed = arena_alloc(a, (prev_count > 0 ? prev_count : 1) * sizeof(int));
+    char *mark = calloc((size_t)prev_count + cur_count + 1, 1);
+    if (!p || !c || !*added || !*removed || !mark) {
+        free(mark);
+        return -1;
+    }
+    char *prev_mark = mark, *cur_mark = mark + prev_count;
+
+    int i = 0, j = 0;
+    while (i < prev_count || j < cur_count) {
+        int r;
+        if (i == prev_count) r = 1;
+        else if (j == cur_count) r = -1;
+        else r = cmp(ELEM(prev, size, p[i]), ELEM(cur, size, c[j]));
+
+        if (r < 0) {
+            prev_mark[p[i++]] = 1;
+        } else if (r > 0) {
+            cur_mark[c[j++]] = 1;
+        } else {
+            if (changed && changed(ELEM(prev, size, p[i]), ELEM(cur, size, c[j]))) {
+                cur_mark[c[j]] = 1;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    /* Report in capture order rather than key order */
+    *added_count = *removed_count = 0;
+    for (int k = 0; k < cur_count; k++) {
+        if (cur_mark[k]) (*added)[(*added_count)++] = k;
+    }
+    for (int k = 0; k < prev_count; k++) {
+        if (prev_mark[k]) (*removed)[(*removed_count)++] = k;
+    }
+    free(mark);
+    return 0;
+}
+
+/* ============================================================
+ * Public Interface
+ * ============================================================ */
+
+int fingerprint_delta(fingerprint_delta_t *d, const fingerprint_t *prev,
+                      const fingerprint_t *cur) {
+    memset(d, 0, sizeof(*d));
+    arena_init(&d->arena);
+    d->prev = prev;
+    d->cur = cur;
+
+    if (diff_sets(&d->arena, prev->processes, prev->process_count,
+                  cur->processes, cur->process_count, sizeof(process_info_t),
+                  cmp_process, NULL,
+                  &d->started, &d->started_count,
+                  &d->exited, &d->exited_count) != 0 ||
+        diff_sets(&d->arena, prev->configs, prev->config_count,
+                  cur->configs, cur->config_count, sizeof(config_file_t),
+                  cmp_config, config_changed,
+                  &d->configs_changed, &d->configs_changed_count,
+                  &d->configs_removed, &d->configs_removed_count) != 0 ||
+        diff_sets(&d->arena, prev->network.listeners, prev->network.listener_count,
+                  cur->network.listeners, cur->network.listener_count, sizeof(net_listener_t),
+                  cmp_listener, NULL,
+                  &d->listeners_added, &d->listeners_added_count,
+                  &d->listeners_removed, &d->listeners_removed_count) != 0 ||
+        diff_sets(&d->arena, prev->network.connections, prev->network.connection_count,
+                  cur->network.connections, cur->network.connection_count,
+                  sizeof(net_connection_t), cmp_connection, NULL,
+                  &d->connections_added, &d->connections_added_count,
+                  &d->connections_removed, &d->connections_removed_count) != 0) {
+        fingerprint_delta_free(d);
+        return -1;
+    }
+
+    d->changes = d->started_count + d->exited_count +
+                 d->configs_changed_count + d->configs_removed_count +
+                 d->listeners_added_count + d->listeners_removed_count +
+                 d->connections_added_count + d->connections_removed_count;
+    return 0;
+}
+
+void fingerprint_delta_free(fingerprint_delta_t *d) {
+    if (!d) return;
+    arena_free(&d->arena);
+    memset(d, 0, sizeof(*d));
+}
@@ -13,223 +13,128 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
+#include <errno.h>
 
-/* ============================================================
- * Simple JSON Value Extraction
- * 
- * Note: This is intentionally simple - not a full JSON parser.
- * It extracts string and numeric values by key for comparison.
- * ============================================================ */
-
-/* Find a string value in JSON (returns pointer to start of value, not including quotes) */
-static const char* json_find_string(const char *json, const char *key) {
-    char search[256];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-    
-    const char *found = strstr(json, search);
-    if (!found) return NULL;
-    
-    found += strlen(search);
-    while (*found && (*found == ' ' || *found == '\t')) found++;
-    
-    if (*found == '"') return found + 1;
-    return NULL;
-}
-
-/* Extract a string value (caller provides buffer) */
-static int json_get_string(const char *json, const char *key, 
-                           char *buf, size_t buf_size) {
-    const char *start = json_find_string(json, key);
-    if (!start) return -1;
-    
-    size_t i = 0;
-    while (start[i] && start[i] != '"' && i < buf_size - 1) {
-        buf[i] = start[i];
-        i++;
-    }
-    buf[i] = '\0';
-    return 0;
-}
-
-/* Find a numeric value in JSON */
-static int json_get_number(const char *json, const char *key, double *value) {
-    char search[256];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-    
-    const char *found = strstr(json, search);
-    if (!found) return -1;
-    
-    found += strlen(search);
-    while (*found && (*found == ' ' || *found == '\t')) found++;
-    
-    if (*found == '"') return -1;  /* It's a string, not a number */
-    
-    *value = atof(found);
-    return 0;
-}
+#include "sentinel.h"
+#include "fpbin.h"
+#include "fpdiff.h"
+#include "fleet.h"
 
 /* ============================================================
  * Diff Report Generation
  * ============================================================ */
 
-typedef struct {
-    char field[64];
-    char value_a[256];
-    char value_b[256];
-    double numeric_a;
-    double numeric_b;
-    double diff_percent;
-    int is_numeric;
-    int is_significant;  /* Worthy of highlighting */
-} diff_item_t;
-
-#define MAX_DIFFS 100
-static diff_item_t diffs[MAX_DIFFS];
-static int diff_count = 0;
-
-static void add_string_diff(const char *field, const char *a, const char *b) {
-    if (diff_count >= MAX_DIFFS) return;
-    if (strcmp(a, b) == 0) return;  /* No difference */
-    
-    diff_item_t *d = &diffs[diff_count++];
-    strncpy(d->field, field, sizeof(d->field) - 1);
-    strncpy(d->value_a, a, sizeof(d->value_a) - 1);
-    strncpy(d->value_b, b, sizeof(d->value_b) - 1);
-    d->is_numeric = 0;
-    d->is_significant = 1;
-}
-
-static void add_numeric_diff(const char *field, double a, double b, double threshold) {
-    if (diff_count >= MAX_DIFFS) return;
-    
-    double diff = fabs(a - b);
-    double avg = (fabs(a) + fabs(b)) / 2.0;
-    double percent = (avg > 0) ? (diff / avg * 100.0) : 0.0;
-    
-    if (percent < threshold) return;  /* Below significance threshold */
-    
-    diff_item_t *d = &diffs[diff_count++];
-    strncpy(d->field, field, sizeof(d->field) - 1);
-    snprintf(d->value_a, sizeof(d->value_a), "%.2f", a);
-    snprintf(d->value_b, sizeof(d->value_b), "%.2f", b);
-    d->numeric_a = a;
-    d->numeric_b = b;
-    d->diff_percent = percent;
-    d->is_numeric = 1;
-    d->is_significant = (percent > 10.0);  /* >10% is significant */
-}
+static const char *section_titles[] = {
+    "System", "Processes", "Listeners", "Config Files"
+};
 
-static void compare_fingerprints(const char *json_a, const char *json_b) {
-    diff_count = 0;
-    
-    char buf_a[256], buf_b[256];
-    double num_a, num_b;
-    
-    /* Compare system info */
-    if (json_get_string(json_a, "hostname", buf_a, sizeof(buf_a)) == 0 &&
-        json_get_string(json_b, "hostname", buf_b, sizeof(buf_b)) == 0) {
-        add_string_diff("hostname", buf_a, buf_b);
-    }
-    
-    if (json_get_string(json_a, "kernel", buf_a, sizeof(buf_a)) == 0 &&
-        json_get_string(json_b, "kernel", buf_b, sizeof(buf_b)) == 0) {
-        add_string_diff("kernel", buf_a, buf_b);
-    }
-    
-    /* Numeric comparisons */
-    if (json_get_number(json_a, "uptime_days", &num_a) == 0 &&
-        json_get_number(json_b, "uptime_days", &num_b) == 0) {
-        add_numeric_diff("uptime_days", num_a, num_b, 1.0);
-    }
-    
-    if (json_get_number(json_a, "memory_total_gb", &num_a) == 0 &&
-        json_get_number(json_b, "memory_total_gb", &num_b) == 0) {
-        add_numeric_diff("memory_total_gb", num_a, num_b, 1.0);
+static void print_set_item(const fpdiff_item_t *d) {
+    const char *prefix = d->is_significant ? "* " : "  ";
+    
+    switch (d->kind) {
+        case FPDIFF_REMOVED:
+            printf("%s- %s", prefix, d->key);
+            break;
+        case FPDIFF_ADDED:
+            printf("%s+ %s", prefix, d->key);
+            break;
+        case FPDIFF_CHANGED:
+            printf("%s~ %s  %s: %s -> %s", prefix, d->key, d->field, d->value_a, d->value_b);
+            break;
     }
     
-    if (json_get_number(json_a, "memory_used_percent", &num_a) == 0 &&
-        json_get_number(json_b, "memory_used_percent", &num_b) == 0) {
-        add_numeric_diff("memory_used_percent", num_a, num_b, 5.0);
+    /* Extra context for entries present on one side only */
+    const char *value = d->kind == FPDIFF_ADDED ? d->value_b : d->value_a;
+    if (d->kind != FPDIFF_CHANGED && value[0]) {
+        if (d->section == FPDIFF_PROCESS) printf("  (x%s)", value);
+        else if (d->section == FPDIFF_LISTENER) printf("  (%s)", value);
     }
-    
-    if (json_get_number(json_a, "total_count", &num_a) == 0 &&
-        json_get_number(json_b, "total_count", &num_b) == 0) {
-        add_numeric_diff("process_count", num_a, num_b, 5.0);
-    }
-    
-    if (json_get_number(json_a, "zombie_count", &num_a) == 0 &&
-        json_get_number(json_b, "zombie_count", &num_b) == 0) {
-        if (num_a != num_b) {
-            add_numeric_diff("zombie_count", num_a, num_b, 0.0);
-        }
-    }
-    
-    if (json_get_number(json_a, "high_fd_count", &num_a) == 0 &&
-        json_get_number(json_b, "high_fd_count", &num_b) == 0) {
-        if (num_a != num_b) {
-            add_numeric_diff("high_fd_count", num_a, num_b, 0.0);
-        }
-    }
-    
-    /* TODO: Compare config file checksums */
-    /* This would require more sophisticated JSON parsing */
+    printf("\n");
 }
 
-static void print_diff_report(const char *name_a, const char *name_b) {
+static void print_diff_report(const fpdiff_t *diff, const char *name_a, const char *name_b) {
     printf("C-Sentinel Drift Report\n");
     printf("========================\n");
     printf("Comparing: %s vs %s\n\n", name_a, name_b);
     
-    if (diff_count == 0) {
+    if (diff->count == 0) {
         printf("No significant differences detected.\n");
         return;
     }
     
-    printf("%-25s %-20s %-20s %s\n", "FIELD", name_a, name_b, "DELTA");
-    printf("%-25s %-20s %-20s %s\n", "-----", "------", "------", "-----");
-    
-    int significant_count = 0;
-    
-    for (int i = 0; i < diff_count; i++) {
-        diff_item_t *d = &diffs[i];
+    int section = -1;
+    for (int i = 0; i < diff->count; i++) {
+        const fpdiff_item_t *d = &diff->items[i];
+        
+        if ((int)d->section != section) {
+            section = d->section;
+            if (i > 0) printf("\n");
+            printf("--- %s ---\n", section_titles[section]);
+            if (section == FPDIFF_SYSTEM) {
+                printf("%-25s %-20s %-20s %s\n", "FIELD", name_a, name_b, "DELTA");
+                printf("%-25s %-20s %-20s %s\n", "-----", "------", "------", "-----");
+            } else {
+                printf("(- only on %s, + only on %s, ~ changed)\n", name_a, name_b);
+            }
+        }
+        
+        if (d->section != FPDIFF_SYSTEM) {
+            print_set_item(d);
+            continue;
+        }
         
         char delta[32] = "";
-        if (d->is_numeric && d->diff_percent > 0) {
-            snprintf(delta, sizeof(delta), "%.1f%%", d->diff_percent);
+        if (d->is_numeric && d->percent > 0) {
+            snprintf(delta, sizeof(delta), "%.1f%%", d->percent);
         }
         
         /* Highlight significant diffs */
         const char *prefix = d->is_significant ? "* " : "  ";
         
         printf("%s%-23s %-20s %-20s %s\n", 
-               prefix, d->field, d->value_a, d->value_b, delta);
-        
-        if (d->is_significant) significant_count++;
+               prefix, d->key, d->value_a, d->value_b, delta);
     }
     
     printf("\n");
-    printf("Total differences: %d\n", diff_count);
-    printf("Significant (*): %d\n", significant_count);
+    printf("Total differences: %d\n", diff->count);
+    printf("Significant (*): %d\n", diff->significant);
     
-    if (significant_count > 0) {
+    if (diff->significant > 0) {
+        int new_ports = 0, config_drift = 0;
+        
         printf("\n--- Analysis Hints ---\n");
-        for (int i = 0; i < diff_count; i++) {
-            diff_item_t *d = &diffs[i];
+        for (int i = 0; i < diff->count; i++) {
+            const fpdiff_item_t *d = &diff->items[i];
             if (!d->is_significant) continue;
             
-            if (strcmp(d->field, "kernel") == 0) {
+            if (d->section == FPDIFF_LISTENER) {
+                if (d->kind == FPDIFF_ADDED) new_ports++;
+                continue;
+            }
+            if (d->section == FPDIFF_CONFIG) {
+                config_drift++;
+                continue;
+            }
+            if (d->section != FPDIFF_SYSTEM) continue;
+            
+            if (strcmp(d->key, "kernel") == 0) {
                 printf("- Kernel version mismatch: May affect system call behavior\n");
-            } else if (strcmp(d->field, "uptime_days") == 0) {
+            } else if (strcmp(d->key, "uptime_days") == 0) {
                 printf("- Uptime difference: Recent restart may indicate instability\n");
-            } else if (strcmp(d->field, "memory_used_percent") == 0) {
+            } else if (strcmp(d->key, "memory_used_percent") == 0) {
                 printf("- Memory usage differs: Check for memory leaks or different workloads\n");
-            } else if (strcmp(d->field, "zombie_count") == 0) {
+            } else if (strcmp(d->key, "zombie_count") == 0) {
                 printf("- Zombie process count differs: Parent process handling issue\n");
-            } else if (strcmp(d->field, "high_fd_count") == 0) {
+            } else if (strcmp(d->key, "high_fd_count") == 0) {
                 printf("- FD-heavy processes differ: Possible descriptor leak\n");
             }
         }
+        if (new_ports > 0) {
+            printf("- %d port(s) listening only on %s: Review exposure\n", new_ports, name_b);
+        }
+        if (config_drift > 0) {
+            printf("- %d config file difference(s): Review for configuration drift\n", config_drift);
+        }
     }
 }
 
@@ -237,7 +142,7 @@ static void print_diff_report(const char *name_a, const char *name_b) {
  * File Reading
  * ============================================================ */
 
-static char* read_file(const char *path) {
+static char* read_file(const char *path, size_t *len) {
     FILE *f = fopen(path, "r");
     if (!f) {
         fprintf(stderr, "Error: Cannot open %s\n", path);
@@ -258,56 +163,394 @@ static char* read_file(const char *path) {
     content[bytes_read] = '\0';
     fclose(f);
     
+    *len = bytes_read;
     return content;
 }
 
+/*
+ * Load a JSON fingerprint, or the latest record of a binary archive.
+ * A binary load keeps the archive mapped in *file (its strings point
+ * into it); close it after fingerprint_free.
+ */
+static int load_fingerprint(const char *path, fingerprint_t *fp, fpbin_file_t *file) {
+    if (fpbin_open(file, path) != 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    
+    if (fpbin_detect(file->data, file->size)) {
+        fpbin_record_t rec, latest;
+        size_t offset = 0;
+        int found = 0, rc;
+        while ((rc = fpbin_next_record(file, &offset, &rec)) == 1) {
+            latest = rec;
+            found = 1;
+        }
+        if (rc < 0 || !found || fpbin_decode(&latest, fp) != 0) {
+            fprintf(stderr, "Error: %s: corrupt or empty fingerprint archive\n", path);
+            fpbin_close(file);
+            return -1;
+        }
+        return 0;
+    }
+    fpbin_close(file);
+    
+    size_t len;
+    char *json = read_file(path, &len);
+    if (!json) return -1;
+    int rc = fingerprint_from_json(fp, json, len);
+    free(json);
+    if (rc != 0) {
+        fprintf(stderr, "Error: %s is not a fingerprint\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Fleet Mode
+ * ============================================================ */
+
+typedef struct {
+    const char *path;
+    const char *name;
+    int loaded;
+    fingerprint_t fp;
+    fpbin_file_t file;
+    arena_t arena;              /* Signature */
+    fpdiff_signature_t sig;
+    /* Differences from the cluster reference, by section */
+    int differs[FPDIFF_CONFIG + 1];
+    int kernel_differs;
+    int drifted;                /* Any of the above */
+} fleet_host_t;
+
+typedef struct {
+    fleet_host_t *hosts;
+    const fleet_t *fleet;
+} fleet_job_t;
+
+static void fleet_load(int i, void *ctx) {
+    fleet_job_t *job = ctx;
+    fleet_host_t *h = &job->hosts[i];
+    
+    arena_init(&h->arena);
+    if (load_fingerprint(h->path, &h->fp, &h->file) != 0) return;
+    if (fpdiff_signature(&h->arena, &h->fp, &h->sig) != 0) {
+        fprintf(stderr, "Error: Out of memory reading %s\n", h->path);
+        arena_free(&h->fp.arena);
+        fpbin_close(&h->file);
+        return;
+    }
+    h->loaded = 1;
+}
+
+/* What sets a cluster member apart from its reference */
+static void fleet_compare(int i, void *ctx) {
+    fleet_job_t *job = ctx;
+    const fleet_t *f = job->fleet;
+    fleet_host_t *h = &job->hosts[i];
+    int ref = f->reference[f->cluster[i]];
+    
+    if (ref == i) return;
+    
+    fpdiff_t diff;
+    if (fpdiff_compare(&diff, &job->hosts[ref].fp, &h->fp) != 0) return;
+    for (int k = 0; k < diff.count; k++) {
+        const fpdiff_item_t *d = &diff.items[k];
+        if (d->section != FPDIFF_SYSTEM) {
+            h->differs[d->section]++;
+        } else if (strcmp(d->key, "kernel") == 0) {
+            h->kernel_differs = 1;
+        }
+    }
+    h->drifted = h->kernel_differs || h->differs[FPDIFF_PROCESS] ||
+                 h->differs[FPDIFF_LISTENER] || h->differs[FPDIFF_CONFIG];
+    fpdiff_free(&diff);
+}
+
+/* "kernel, 2 config, 1 listener" */
+static void describe_host(const fleet_host_t *h, char *buf, size_t size) {
+    static const char *labels[] = { "", "process", "listener", "config" };
+    size_t len = 0;
+    
+    buf[0] = '\0';
+    if (h->kernel_differs) {
+        len += snprintf(buf + len, size - len, "kernel");
+    }
+    for (int s = FPDIFF_PROCESS; s <= FPDIFF_CONFIG && len < size; s++) {
+        if (h->differs[s] == 0) continue;
+        len += snprintf(buf + len, size - len, "%s%d %s", len ? ", " : "",
+                        h->differs[s], labels[s]);
+    }
+}
+
+/* Closest host outside cluster c, or -1 */
+static int closest_outside(const fleet_t *f, int host) {
+    int best = -1;
+    for (int j = 0; j < f->host_count; j++) {
+        if (f->cluster[j] == f->cluster[host]) continue;
+        if (best < 0 || fleet_similarity(f, host, j) > fleet_similarity(f, host, best)) {
+            best = j;
+        }
+    }
+    return best;
+}
+
+static void print_fleet_report(const fleet_t *f, const fleet_host_t *hosts, double threshold) {
+    printf("C-Sentinel Fleet Report\n");
+    printf("========================\n");
+    printf("Hosts: %d   Clusters: %d   Threshold: %.2f\n", f->host_count, f->cluster_count, threshold);
+    
+    int singles = 0;
+    for (int c = 0; c < f->cluster_count; c++) {
+        int ref = f->reference[c];
+        if (f->cluster_size[c] == 1) {
+            singles++;
+            continue;
+        }
+        
+        int exact = 0;
+        for (int i = 0; i < f->host_count; i++) {
+            if (f->cluster[i] == c && i != ref && !hosts[i].drifted) exact++;
+        }
+        
+        printf("\nCluster %d: %d hosts, reference %s\n", c + 1, f->cluster_size[c], hosts[ref].name);
+        if (exact > 0) {
+            printf("  %d match %s exactly\n", exact, hosts[ref].name);
+        }
+        for (int i = 0; i < f->host_count; i++) {
+            if (f->cluster[i] != c || !hosts[i].drifted) continue;
+            char detail[128];
+            describe_host(&hosts[i], detail, sizeof(detail));
+            printf("  %-24s %.2f  %s\n", hosts[i].name, fleet_similarity(f, ref, i), detail);
+        }
+    }
+    
+    if (singles > 0) {
+        printf("\nUnclustered (no host above the threshold):\n");
+        for (int c = 0; c < f->cluster_count; c++) {
+            if (f->cluster_size[c] != 1) continue;
+            int host = f->reference[c];
+            int near = closest_outside(f, host);
+            if (near >= 0) {
+                printf("  %-24s closest: %s (%.2f)\n", hosts[host].name, hosts[near].name,
+                       fleet_similarity(f, host, near));
+            } else {
+                printf("  %s\n", hosts[host].name);
+            }
+        }
+    }
+}
+
+static int write_fleet_json(const fleet_t *f, const fleet_host_t *hosts, double threshold) {
+    static const char *labels[] = { "system", "process", "listener", "config" };
+    static json_writer_t w;     /* 8 KB buffer; keep it off the stack */
+    
+    json_writer_file(&w, stdout);
+    json_object_begin(&w, NULL);
+    json_int(&w, "hosts", f->host_count);
+    json_double(&w, "threshold", threshold, 2);
+    json_array_begin(&w, "clusters");
+    for (int c = 0; c < f->cluster_count; c++) {
+        int ref = f->reference[c];
+        json_object_begin(&w, NULL);
+        json_string(&w, "reference", hosts[ref].name);
+        json_int(&w, "size", f->cluster_size[c]);
+        json_array_begin(&w, "members");
+        for (int i = 0; i < f->host_count; i++) {
+            if (f->cluster[i] != c) continue;
+            json_object_begin_inline(&w, NULL);
+            json_string(&w, "host", hosts[i].name);
+            json_string(&w, "file", hosts[i].path);
+            json_double(&w, "similarity", fleet_similarity(f, ref, i), 3);
+            json_bool(&w, "drifted", hosts[i].drifted);
+            if (hosts[i].kernel_differs) json_bool(&w, "kernel_differs", 1);
+            for (int s = FPDIFF_PROCESS; s <= FPDIFF_CONFIG; s++) {
+                if (hosts[i].differs[s]) json_int(&w, labels[s], hosts[i].differs[s]);
+            }
+            json_object_end(&w);
+        }
+        json_array_end(&w);
+        json_object_end(&w);
+    }
+    json_array_end(&w);
+    json_object_end(&w);
+    return json_writer_finish(&w);
+}
+
+static int run_fleet(char **paths, int count, int json_mode, double threshold) {
+    fleet_host_t *hosts = calloc(count, sizeof(fleet_host_t));
+    if (!hosts) return 2;
+    
+    fleet_job_t job = { hosts, NULL };
+    for (int i = 0; i < count; i++) hosts[i].path = paths[i];
+    workpool_for(count, fleet_load, &job);
+    
+    /* Compact out the files that failed to load */
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (hosts[i].loaded) {
+            hosts[n++] = hosts[i];
+        } else {
+            arena_free(&hosts[i].arena);
+        }
+    }
+    
+    int rc = 2;
+    fleet_t fleet;
+    if (n < 2) {
+        fprintf(stderr, "Error: Fleet mode needs at least two readable fingerprints\n");
+    } else {
+        /* Hostname, or the file when two share a hostname (archives of one host) */
+        for (int i = 0; i < n; i++) {
+            const char *host = hosts[i].fp.system.hostname;
+            hosts[i].name = host[0] ? host : hosts[i].path;
+            for (int j = 0; j < n && host[0]; j++) {
+                if (j != i && strcmp(hosts[j].fp.system.hostname, host) == 0) {
+                    hosts[i].name = hosts[i].path;
+                    break;
+                }
+            }
+        }
+        
+        fpdiff_signature_t *sigs = malloc(n * sizeof(fpdiff_signature_t));
+        if (sigs) {
+            for (int i = 0; i < n; i++) sigs[i] = hosts[i].sig;
+        }
+        if (!sigs || fleet_cluster(&fleet, sigs, n, threshold) != 0) {
+            fprintf(stderr, "Error: Out of memory building the similarity matrix\n");
+        } else {
+            job.fleet = &fleet;
+            workpool_for(n, fleet_compare, &job);
+            
+            if (json_mode) {
+                rc = write_fleet_json(&fleet, hosts, threshold) == 0 ? 0 : 2;
+            } else {
+                print_fleet_report(&fleet, hosts, threshold);
+                rc = 0;
+            }
+            /* Drift: more than one cluster, or any member unlike its reference */
+            for (int i = 0; rc == 0 && i < n; i++) {
+                if (fleet.cluster_count > 1 || hosts[i].drifted) rc = 1;
+            }
+            fleet_free(&fleet);
+        }
+        free(sigs);
+    }
+    
+    /* The tool does not link the prober, so release the arenas directly */
+    for (int i = 0; i < n; i++) {
+        arena_free(&hosts[i].fp.arena);
+        arena_free(&hosts[i].arena);
+        fpbin_close(&hosts[i].file);
+    }
+    free(hosts);
+    return rc;
+}
+
 /* ============================================================
  * Main
  * ============================================================ */
 
 static void print_usage(const char *prog) {
     fprintf(stderr, "C-Sentinel Diff - Fingerprint Drift Detection\n\n");
-    fprintf(stderr, "Usage: %s <fingerprint_a.json> <fingerprint_b.json>\n\n", prog);
+    fprintf(stderr, "Usage: %s [--json] <fingerprint_a> <fingerprint_b>\n", prog);
+    fprintf(stderr, "       %s --fleet [--json] [-t SIM] [-J N] <fingerprint>...\n\n", prog);
     fprintf(stderr, "Compares two system fingerprints and highlights differences.\n");
+    fprintf(stderr, "Each may be JSON or a binary archive (its latest record).\n");
+    fprintf(stderr, "Processes are matched on name and parent names, listeners on\n");
+    fprintf(stderr, "protocol, address and port, config files on path.\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Fleet mode loads every fingerprint once, builds a similarity matrix\n");
+    fprintf(stderr, "and groups hosts into clusters, each reported against its most\n");
+    fprintf(stderr, "typical member.\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  --json    Machine-readable output\n");
+    fprintf(stderr, "  --fleet   Cluster many fingerprints\n");
+    fprintf(stderr, "  -t SIM    Fleet: similarity (0-1) that links two hosts (default: %.2f)\n",
+            FLEET_DEFAULT_THRESHOLD);
+    fprintf(stderr, "  -J N      Fleet: worker threads (0 = one per CPU, default: 1)\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Example:\n");
     fprintf(stderr, "  ./sentinel > node_a.json\n");
     fprintf(stderr, "  ssh node_b ./sentinel > node_b.json\n");
     fprintf(stderr, "  %s node_a.json node_b.json\n", prog);
+    fprintf(stderr, "  %s --fleet -J 0 fleet/*.json\n", prog);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        print_usage(argv[0]);
-        return 1;
-    }
-    
-    const char *file_a = argv[1];
-    const char *file_b = argv[2];
-    
-    char *json_a = read_file(file_a);
-    if (!json_a) return 1;
-    
-    char *json_b = read_file(file_b);
-    if (!json_b) {
-        free(json_a);
+static int run_pair(const char *file_a, const char *file_b, int json_mode) {
+    fingerprint_t fp_a, fp_b;
+    fpbin_file_t bin_a, bin_b;
+    if (load_fingerprint(file_a, &fp_a, &bin_a) != 0) return 1;
+    if (load_fingerprint(file_b, &fp_b, &bin_b) != 0) {
+        arena_free(&fp_a.arena);
+        fpbin_close(&bin_a);
         return 1;
     }
     
-    /* Extract hostnames for display (use filenames as fallback) */
+    /* Hostnames for display (use filenames as fallback) */
     char name_a[64], name_b[64];
-    if (json_get_string(json_a, "hostname", name_a, sizeof(name_a)) != 0) {
-        strncpy(name_a, file_a, sizeof(name_a) - 1);
+    snprintf(name_a, sizeof(name_a), "%.63s", fp_a.system.hostname[0] ? fp_a.system.hostname : file_a);
+    snprintf(name_b, sizeof(name_b), "%.63s", fp_b.system.hostname[0] ? fp_b.system.hostname : file_b);
+    
+    fpdiff_t diff;
+    int rc = fpdiff_compare(&diff, &fp_a, &fp_b);
+    int differences = 0;
+    if (rc != 0) {
+        fprintf(stderr, "Error: Out of memory comparing fingerprints\n");
+    } else if (json_mode) {
+        static json_writer_t w;     /* 8 KB buffer; keep it off the stack */
+        json_writer_file(&w, stdout);
+        fpdiff_write_json(&w, &diff, name_a, name_b);
+        if (json_writer_finish(&w) != 0) rc = -1;
+    } else {
+        print_diff_report(&diff, name_a, name_b);
     }
-    if (json_get_string(json_b, "hostname", name_b, sizeof(name_b)) != 0) {
-        strncpy(name_b, file_b, sizeof(name_b) - 1);
+    if (rc == 0) {
+        differences = diff.count;
+        fpdiff_free(&diff);
     }
     
-    compare_fingerprints(json_a, json_b);
-    print_diff_report(name_a, name_b);
+    /* The tool does not link the prober, so release the arenas directly */
+    arena_free(&fp_a.arena);
+    arena_free(&fp_b.arena);
+    fpbin_close(&bin_a);
+    fpbin_close(&bin_b);
     
-    free(json_a);
-    free(json_b);
+    if (rc != 0) return 2;
+    return (differences > 0) ? 1 : 0;  /* Exit code indicates drift */
+}
+
+int main(int argc, char *argv[]) {
+    int json_mode = 0;
+    int fleet_mode = 0;
+    double threshold = FLEET_DEFAULT_THRESHOLD;
+    int arg = 1;
+    
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "--json") == 0) {
+            json_mode = 1;
+        } else if (strcmp(argv[arg], "--fleet") == 0) {
+            fleet_mode = 1;
+        } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            threshold = atof(argv[++arg]);
+            if (threshold < 0.0) threshold = 0.0;
+            if (threshold > 1.0) threshold = 1.0;
+        } else if (strcmp(argv[arg], "-J") == 0 && arg + 1 < argc) {
+            workpool_set_jobs(atoi(argv[++arg]));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
     
-    return (diff_count > 0) ? 1 : 0;  /* Exit code indicates drift */
+    if (fleet_mode && argc - arg >= 2) {
+        return run_fleet(argv + arg, argc - arg, json_mode, threshold);
+    }
+    if (fleet_mode || argc - arg != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    return run_pair(argv[arg], argv[arg + 1], json_mode);
 }
@@ -0,0 +1,147 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fleet.c - Similarity matrix and drift clusters across many hosts
+ *
+ * Each matrix row is one workpool index computing its upper triangle;
+ * the lower half is mirrored afterwards, so the result does not depend
+ * on the job count. Clustering is union-find over the links above the
+ * threshold.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fleet.h"
+
+typedef struct {
+    const fpdiff_signature_t *sigs;
+    fleet_t *f;
+} matrix_job_t;
+
+static void matrix_row(int i, void *ctx) {
+    matrix_job_t *job = ctx;
+    int n = job->f->host_count;
+    float *row = job->f->similarity + (size_t)i * n;
+
+    row[i] = 1.0f;
+    for (int j = i + 1; j < n; j++) {
+        row[j] = (float)fpdiff_similarity(&job->sigs[i], &job->sigs[j]);
+    }
+}
+
+static int find_root(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];      /* Path halving */
+        x = parent[x];
+    }
+    return x;
+}
+
+int fleet_cluster(fleet_t *f, const fpdiff_signature_t *sigs, int host_count,
+                  double threshold) {
+    int n = host_count;
+
+    memset(f, 0, sizeof(*f));
+    f->host_count = n;
+    f->similarity = malloc((size_t)n * n * sizeof(float));
+    f->cluster = malloc(n * sizeof(int));
+    f->cluster_size = calloc(n, sizeof(int));
+    f->reference = malloc(n * sizeof(int));
+    int *parent = malloc(n * sizeof(int));
+    int *root_cluster = malloc(n * sizeof(int));
+    double *centrality = calloc(n, sizeof(double));
+    if (!f->similarity || !f->cluster || !f->cluster_size || !f->reference ||
+        !parent || !root_cluster || !centrality) {
+        free(parent);
+        free(root_cluster);
+        free(centrality);
+        fleet_free(f);
+        return -1;
+    }
+
+    matrix_job_t job = { sigs, f };
+    workpool_for(n, matrix_row, &job);
+
+    /* Mirror the lower half and link similar hosts */
+    for (int i = 0; i < n; i++) parent[i] = i;
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            float s = f->similarity[(size_t)i * n + j];
+            f->similarity[(size_t)j * n + i] = s;
+            if (s >= threshold) {
+                int ri = find_root(parent, i), rj = find_root(parent, j);
+                if (ri != rj) parent[rj] = ri;
+            }
+        }
+    }
+
+    /* Size each group, then number them largest first (ties in host order) */
+    for (int i = 0; i < n; i++) {
+        root_cluster[i] = -1;
+        f->cluster_size[find_root(parent, i)]++;
+    }
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < n; i++) {
+            if (parent[i] == i && root_cluster[i] < 0 &&
+                (best < 0 || f->cluster_size[i] > f->cluster_size[best])) {
+                best = i;
+            }
+        }
+        if (best < 0) break;
+        root_cluster[best] = f->cluster_count++;
+    }
+
+    int *sizes = calloc(n, sizeof(int));
+    if (!sizes) {
+        free(parent);
+        free(root_cluster);
+        free(centrality);
+        fleet_free(f);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        f->cluster[i] = root_cluster[find_root(parent, i)];
+        sizes[f->cluster[i]]++;
+    }
+    memcpy(f->cluster_size, sizes, n * sizeof(int));
+    free(sizes);
+
+    /* Reference: the member with the highest total similarity to its cluster */
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && f->cluster[i] == f->cluster[j]) {
+                centrality[i] += f->similarity[(size_t)i * n + j];
+            }
+        }
+    }
+    for (int c = 0; c < f->cluster_count; c++) f->reference[c] = -1;
+    for (int i = 0; i < n; i++) {
+        int c = f->cluster[i];
+        if (f->reference[c] < 0 || centrality[i] > centrality[f->reference[c]]) {
+            f->reference[c] = i;
+        }
+    }
+
+    free(parent);
+    free(root_cluster);
+    free(centrality);
+    return 0;
+}
+
+void fleet_free(fleet_t *f) {
+    if (!f) return;
+    free(f->similarity);
+    free(f->cluster);
+    free(f->cluster_size);
+    free(f->reference);
+    memset(f, 0, sizeof(*f));
+}
@@ -0,0 +1,896 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fpbin.c - Compact binary fingerprint format
+ *
+ * See fpbin.h for the layout. A typical record is a few KB against
+ * tens of KB of JSON, and reading one touches only the pages of the
+ * columns asked for.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fpbin.h"
+
+/* ============================================================
+ * Integer Coding
+ * ============================================================ */
+
+static uint64_t zigzag(int64_t v) {
+    return v < 0 ? ~((uint64_t)v << 1) : (uint64_t)v << 1;
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)((v >> 1) ^ (~(v & 1) + 1));
+}
+
+static void put_le16(unsigned char *p, unsigned v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_le32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned get_le16(const unsigned char *p) {
+    return (unsigned)p[0] | ((unsigned)p[1] << 8);
+}
+
+static uint32_t get_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* LEB128; -1 if truncated or longer than 64 bits */
+static int get_uvarint(const unsigned char **pp, const unsigned char *end, uint64_t *out) {
+    const unsigned char *p = *pp;
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return -1;
+        unsigned char c = *p++;
+        v |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *pp = p;
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ============================================================
+ * Encoder
+ * ============================================================ */
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+    int error;
+} buf_t;
+
+static int buf_reserve(buf_t *b, size_t n) {
+    if (b->error) return -1;
+    if (b->len + n <= b->cap) return 0;
+
+    size_t cap = b->cap ? b->cap : 256;
+    while (cap < b->len + n) cap *= 2;
+    unsigned char *grown = realloc(b->data, cap);
+    if (!grown) {
+        b->error = 1;
+        return -1;
+    }
+    b->data = grown;
+    b->cap = cap;
+    return 0;
+}
+
+static void buf_put(buf_t *b, const void *p, size_t n) {
+    if (n == 0 || buf_reserve(b, n) != 0) return;
+    memcpy(b->data + b->len, p, n);
+    b->len += n;
+}
+
+static void buf_byte(buf_t *b, unsigned char v) {
+    buf_put(b, &v, 1);
+}
+
+static void buf_uvarint(buf_t *b, uint64_t v) {
+    unsigned char tmp[10];
+    size_t n = 0;
+    do {
+        unsigned char c = (unsigned char)(v & 0x7F);
+        v >>= 7;
+        if (v) c |= 0x80;
+        tmp[n++] = c;
+    } while (v);
+    buf_put(b, tmp, n);
+}
+
+typedef struct {
+    buf_t strings;
+    uint32_t *slots;            /* String table hash: offset + 1, 0 = empty */
+    size_t slot_count;
+    size_t slot_used;
+    buf_t body;                 /* Finished sections, back to back */
+    buf_t section;
+    buf_t column;
+    int encoding;
+    int64_t prev;
+    uint32_t dir[FPBIN_SEC_MAX][3];     /* id, offset in body, length */
+    int dir_count;
+} encoder_t;
+
+static uint32_t string_hash(const char *s) {
+    uint32_t h = 2166136261u;       /* FNV-1a */
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int strings_grow(encoder_t *e) {
+    size_t count = e->slot_count ? e->slot_count * 2 : 256;
+    uint32_t *slots = calloc(count, sizeof(uint32_t));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < e->slot_count; i++) {
+        if (!e->slots[i]) continue;
+        const char *s = (const char *)e->strings.data + e->slots[i] - 1;
+        size_t j = string_hash(s) & (count - 1);
+        while (slots[j]) j = (j + 1) & (count - 1);
+        slots[j] = e->slots[i];
+    }
+    free(e->slots);
+    e->slots = slots;
+    e->slot_count = count;
+    return 0;
+}
+
+/* Offset of s in the string table, adding it on first use */
+static uint64_t string_ref(encoder_t *e, const char *s) {
+    if (!s || !*s) return 0;
+    if ((e->slot_used + 1) * 2 > e->slot_count && strings_grow(e) != 0) {
+        e->strings.error = 1;
+        return 0;
+    }
+
+    size_t j = string_hash(s) & (e->slot_count - 1);
+    while (e->slots[j]) {
+        const char *have = (const char *)e->strings.data + e->slots[j] - 1;
+        if (strcmp(have, s) == 0) return e->slots[j] - 1;
+        j = (j + 1) & (e->slot_count - 1);
+    }
+
+    uint32_t offset = (uint32_t)e->strings.len;
+    buf_put(&e->strings, s, strlen(s) + 1);
+    if (e->strings.error) return 0;
+    e->slots[j] = offset + 1;
+    e->slot_used++;
+    return offset;
+}
+
+static void section_begin(encoder_t *e, int rows, int columns) {
+    e->section.len = 0;
+    buf_uvarint(&e->section, (uint64_t)(rows > 0 ? rows : 0));
+    buf_uvarint(&e->section, (uint64_t)columns);
+}
+
+static void section_end(encoder_t *e, fpbin_section_t id, const buf_t *data) {
+    e->dir[e->dir_count][0] = (uint32_t)id;
+    e->dir[e->dir_count][1] = (uint32_t)e->body.len;
+    e->dir[e->dir_count][2] = (uint32_t)data->len;
+    e->dir_count++;
+    buf_put(&e->body, data->data, data->len);
+    if (data->error) e->body.error = 1;
+}
+
+static void column_begin(encoder_t *e, fpbin_encoding_t encoding) {
+    e->column.len = 0;
+    e->encoding = encoding;
+    e->prev = 0;
+}
+
+static void column_int(encoder_t *e, int64_t v) {
+    switch (e->encoding) {
+        case FPBIN_ENC_SVARINT:
+            buf_uvarint(&e->column, zigzag(v));
+            break;
+        case FPBIN_ENC_DELTA:
+            buf_uvarint(&e->column, zigzag(v - e->prev));
+            e->prev = v;
+            break;
+        case FPBIN_ENC_BYTE:
+            buf_byte(&e->column, (unsigned char)v);
+            break;
+        default:
+            buf_uvarint(&e->column, (uint64_t)v);
+    }
+}
+
+static void column_string(encoder_t *e, const char *s) {
+    buf_uvarint(&e->column, string_ref(e, s));
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Lower-case SHA256 hex packs to 32 bytes; anything else ("error") is a string */
+static void column_checksum(encoder_t *e, const char *hex) {
+    unsigned char raw[32];
+    int ok = strlen(hex) == 64;
+
+    for (int i = 0; ok && i < 32; i++) {
+        int hi = hex_value(hex[2 * i]), lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) ok = 0;
+        else raw[i] = (unsigned char)(hi << 4 | lo);
+    }
+
+    if (!*hex) {
+        buf_byte(&e->column, 0);
+    } else if (ok) {
+        buf_byte(&e->column, 32);
+        buf_put(&e->column, raw, sizeof(raw));
+    } else {
+        buf_byte(&e->column, 1);
+        column_string(e, hex);
+    }
+}
+
+static void column_end(encoder_t *e) {
+    buf_byte(&e->section, (unsigned char)e->encoding);
+    buf_uvarint(&e->section, e->column.len);
+    buf_put(&e->section, e->column.data, e->column.len);
+    if (e->column.error) e->section.error = 1;
+}
+
+/* One column over every row; expr may use the row index i */
+#define INT_COLUMN(e, enc, rows, expr) do {                     \
+        column_begin(e, enc);                                   \
+        for (int i = 0; i < (rows); i++) column_int(e, (int64_t)(expr)); \
+        column_end(e);                                          \
+    } while (0)
+
+#define STRING_COLUMN(e, rows, expr) do {                       \
+        column_begin(e, FPBIN_ENC_STRING);                      \
+        for (int i = 0; i < (rows); i++) column_string(e, (expr)); \
+        column_end(e);                                          \
+    } while (0)
+
+static int64_t scaled(double v, double scale) {
+    return (int64_t)(v * scale + (v < 0 ? -0.5 : 0.5));
+}
+
+static void encode_meta(encoder_t *e, const fingerprint_t *fp) {
+    const system_info_t *s = &fp->system;
+    const network_info_t *n = &fp->network;
+
+    section_begin(e, 1, FPBIN_META_COLUMNS);
+    STRING_COLUMN(e, 1, s->hostname);
+    STRING_COLUMN(e, 1, s->kernel_version);
+    INT_COLUMN(e, FPBIN_ENC_SVARINT, 1, s->boot_time);
+    INT_COLUMN(e, FPBIN_ENC_SVARINT, 1, s->probe_time);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(s->load_avg[0], 1000));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(s->load_avg[1], 1000));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(s->load_avg[2], 1000));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, s->total_ram);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, s->free_ram);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, s->uptime_seconds);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(fp->probe_duration_ms, 1000));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, fp->probe_errors);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, fp->config_cache_hits);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, fp->config_cache_misses);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, fp->processes_unlisted);
+    STRING_COLUMN(e, 1, n->backend);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, n->total_listening);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, n->total_established);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, n->unusual_port_count);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(n->owner_index_ms, 1000));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, 1, scaled(n->owner_lookup_ms, 1000));
+    section_end(e, FPBIN_SEC_META, &e->section);
+}
+
+static void encode_processes(encoder_t *e, const fingerprint_t *fp) {
+    const process_info_t *p = fp->processes;
+    int n = fp->process_count;
+
+    section_begin(e, n, FPBIN_PROC_COLUMNS);
+    INT_COLUMN(e, FPBIN_ENC_DELTA, n, p[i].pid);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].ppid);
+    STRING_COLUMN(e, n, p[i].name);
+    INT_COLUMN(e, FPBIN_ENC_BYTE, n, (unsigned char)p[i].state);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].rss_bytes);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].vsize_bytes);
+    INT_COLUMN(e, FPBIN_ENC_DELTA, n, p[i].start_time);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].open_fd_count);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].thread_count);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, scaled(p[i].cpu_percent, 100));
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, p[i].age_seconds);
+    INT_COLUMN(e, FPBIN_ENC_BYTE, n, p[i].is_potentially_stuck ? 1 : 0);
+    section_end(e, FPBIN_SEC_PROCESSES, &e->section);
+}
+
+static void encode_configs(encoder_t *e, const fingerprint_t *fp) {
+    const config_file_t *c = fp->configs;
+    int n = fp->config_count;
+
+    section_begin(e, n, FPBIN_CFG_COLUMNS);
+    STRING_COLUMN(e, n, c[i].path);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].size);
+    INT_COLUMN(e, FPBIN_ENC_DELTA, n, c[i].mtime);
+    INT_COLUMN(e, FPBIN_ENC_DELTA, n, c[i].ctime);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].permissions);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].owner);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].group);
+    column_begin(e, FPBIN_ENC_DIGEST);
+    for (int i = 0; i < n; i++) column_checksum(e, c[i].checksum);
+    column_end(e);
+    section_end(e, FPBIN_SEC_CONFIGS, &e->section);
+}
+
+static void encode_network(encoder_t *e, const fingerprint_t *fp) {
+    const net_listener_t *l = fp->network.listeners;
+    const net_connection_t *c = fp->network.connections;
+    int n = fp->network.listener_count;
+
+    section_begin(e, n, FPBIN_LSN_COLUMNS);
+    STRING_COLUMN(e, n, l[i].protocol);
+    STRING_COLUMN(e, n, l[i].local_addr);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, l[i].local_port);
+    STRING_COLUMN(e, n, l[i].state);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, l[i].inode);
+    INT_COLUMN(e, FPBIN_ENC_SVARINT, n, l[i].pid);
+    STRING_COLUMN(e, n, l[i].process_name);
+    section_end(e, FPBIN_SEC_LISTENERS, &e->section);
+
+    n = fp->network.connection_count;
+    section_begin(e, n, FPBIN_CONN_COLUMNS);
+    STRING_COLUMN(e, n, c[i].protocol);
+    STRING_COLUMN(e, n, c[i].local_addr);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].local_port);
+    STRING_COLUMN(e, n, c[i].remote_addr);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].remote_port);
+    STRING_COLUMN(e, n, c[i].state);
+    INT_COLUMN(e, FPBIN_ENC_UVARINT, n, c[i].inode);
+    INT_COLUMN(e, FPBIN_ENC_SVARINT, n, c[i].pid);
+    STRING_COLUMN(e, n, c[i].process_name);
+    section_end(e, FPBIN_SEC_CONNECTIONS, &e->section);
+}
+
+int fpbin_encode(const fingerprint_t *fp, unsigned char **out, size_t *len) {
+    encoder_t e;
+    int result = -1;
+
+    memset(&e, 0, sizeof(e));
+    *out = NULL;
+    *len = 0;
+
+    buf_byte(&e.strings, 0);        /* Offset 0 is "" */
+    encode_meta(&e, fp);
+    encode_processes(&e, fp);
+    encode_configs(&e, fp);
+    encode_network(&e, fp);
+    section_end(&e, FPBIN_SEC_STRINGS, &e.strings);
+
+    size_t head = FPBIN_HEADER_SIZE + (size_t)e.dir_count * FPBIN_DIR_ENTRY_SIZE;
+    size_t total = head + e.body.len;
+    unsigned char *rec = NULL;
+
+    if (!e.body.error && total <= UINT32_MAX && (rec = malloc(total)) != NULL) {
+        memcpy(rec, FPBIN_MAGIC, 4);
+        put_le16(rec + 4, FPBIN_VERSION);
+        put_le16(rec + 6, (unsigned)e.dir_count);
+        put_le32(rec + 8, (uint32_t)total);
+        put_le32(rec + 12, 0);
+        for (int i = 0; i < e.dir_count; i++) {
+            unsigned char *d = rec + FPBIN_HEADER_SIZE + i * FPBIN_DIR_ENTRY_SIZE;
+            put_le32(d, e.dir[i][0]);
+            put_le32(d + 4, (uint32_t)head + e.dir[i][1]);
+            put_le32(d + 8, e.dir[i][2]);
+        }
+        memcpy(rec + head, e.body.data, e.body.len);
+        *out = rec;
+        *len = total;
+        result = 0;
+    }
+
+    free(e.strings.data);
+    free(e.slots);
+    free(e.body.data);
+    free(e.section.data);
+    free(e.column.data);
+    return result;
+}
+
+/* Where the last append through this process left the archive whole */
+static struct {
+    dev_t dev;
+    ino_t ino;
+    off_t end;
+} g_append_end;
+
+/*
+ * End of the whole records in fd, walking headers from start (a record
+ * boundary). A record cut short by a crash mid-append is only ever the
+ * last one; anything else that does not parse is left for the reader.
+ */
+static off_t whole_end(int fd, off_t start, off_t size) {
+    unsigned char head[FPBIN_HEADER_SIZE];
+    off_t off = start;
+
+    while (off < size) {
+        off_t left = size - off;
+        if (left < FPBIN_HEADER_SIZE) return off;
+        if (pread(fd, head, sizeof(head), off) != (ssize_t)sizeof(head)) return size;
+        if (!fpbin_detect(head, sizeof(head))) return size;
+
+        off_t len = (off_t)get_le32(head + 8);
+        if (len < FPBIN_HEADER_SIZE) return size;
+        if (len > left) return off;
+        off += len;
+    }
+    return off;
+}
+
+int fpbin_append(const char *path, const fingerprint_t *fp) {
+    unsigned char *rec;
+    size_t len;
+    struct stat st;
+    struct flock lk;
+
+    if (fpbin_encode(fp, &rec, &len) != 0) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0640);
+    if (fd < 0) {
+        free(rec);
+        return -1;
+    }
+
+    /* Appenders take turns, so a record never interleaves with another */
+    memset(&lk, 0, sizeof(lk));
+    lk.l_type = F_WRLCK;
+    lk.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lk) != 0) {
+        if (errno != EINTR) goto fail;
+    }
+    if (fstat(fd, &st) != 0) goto fail;
+
+    /* Cut off a torn record, or everything appended after it is unreadable */
+    off_t start = 0;
+    if (st.st_dev == g_append_end.dev && st.st_ino == g_append_end.ino &&
+        g_append_end.end <= st.st_size) {
+        start = g_append_end.end;
+    }
+    off_t end = whole_end(fd, start, st.st_size);
+    if (end < st.st_size && ftruncate(fd, end) != 0) goto fail;
+
+    /* The record is already one buffer: one write; a short one is cut off next time */
+    ssize_t n;
+    do {
+        n = write(fd, rec, len);
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)len) goto fail;
+
+    g_append_end.dev = st.st_dev;
+    g_append_end.ino = st.st_ino;
+    g_append_end.end = end + (off_t)len;
+    free(rec);
+    return close(fd) == 0 ? 0 : -1;   /* Closing drops the lock */
+
+fail:
+    free(rec);
+    close(fd);
+    return -1;
+}
+
+/* ============================================================
+ * Reader
+ * ============================================================ */
+
+int fpbin_detect(const void *data, size_t size) {
+    return size >= 4 && memcmp(data, FPBIN_MAGIC, 4) == 0;
+}
+
+int fpbin_open(fpbin_file_t *f, const char *path) {
+    struct stat st;
+
+    memset(f, 0, sizeof(*f));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return -1;
+        }
+        f->data = map;
+        f->size = (size_t)st.st_size;
+        f->mapped = 1;
+    }
+    close(fd);      /* The mapping keeps the file */
+    return 0;
+}
+
+void fpbin_open_memory(fpbin_file_t *f, const void *data, size_t size) {
+    f->data = data;
+    f->size = size;
+    f->mapped = 0;
+}
+
+void fpbin_close(fpbin_file_t *f) {
+    if (f->mapped) munmap((void *)f->data, f->size);
+    memset(f, 0, sizeof(*f));
+}
+
+int fpbin_next_record(const fpbin_file_t *f, size_t *offset, fpbin_record_t *rec) {
+    size_t off = *offset;
+
+    if (off >= f->size) return 0;
+    if (f->size - off < FPBIN_HEADER_SIZE) return -1;
+
+    const unsigned char *p = f->data + off;
+    if (!fpbin_detect(p, FPBIN_HEADER_SIZE)) return -1;
+
+    unsigned version = get_le16(p + 4);
+    unsigned nsec = get_le16(p + 6);
+    size_t size = get_le32(p + 8);
+    size_t head = FPBIN_HEADER_SIZE + (size_t)nsec * FPBIN_DIR_ENTRY_SIZE;
+    if (version == 0 || version > FPBIN_VERSION) return -1;
+    if (size < head || size > f->size - off) return -1;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->version = version;
+    rec->offset = off;
+    rec->size = size;
+    for (unsigned i = 0; i < nsec; i++) {
+        const unsigned char *d = p + FPBIN_HEADER_SIZE + i * FPBIN_DIR_ENTRY_SIZE;
+        uint32_t id = get_le32(d);
+        size_t soff = get_le32(d + 4), slen = get_le32(d + 8);
+        if (soff < head || soff > size || slen > size - soff) return -1;
+        if (id > 0 && id < FPBIN_SEC_MAX) {
+            rec->sections[id].data = p + soff;
+            rec->sections[id].len = slen;
+        }
+    }
+
+    *offset = off + size;
+    return 1;
+}
+
+/* Row and column counts; rows can never exceed the section's bytes */
+static int table_header(const fpbin_record_t *r, fpbin_section_t section,
+                        uint64_t *rows, uint64_t *cols, const unsigned char **p) {
+    const fpbin_span_t *s = &r->sections[section];
+    const unsigned char *end = s->data + s->len;
+
+    *rows = *cols = 0;
+    *p = s->data;
+    if (!s->data) return 0;
+    if (get_uvarint(p, end, rows) != 0 || get_uvarint(p, end, cols) != 0) return -1;
+    if (*rows > s->len || *rows > INT32_MAX) return -1;
+    return 0;
+}
+
+int fpbin_rows(const fpbin_record_t *r, fpbin_section_t section) {
+    uint64_t rows, cols;
+    const unsigned char *p;
+    if (table_header(r, section, &rows, &cols, &p) != 0) return 0;
+    return (int)rows;
+}
+
+int fpbin_column(const fpbin_record_t *r, fpbin_section_t section, int column,
+                 fpbin_cursor_t *c) {
+    uint64_t rows, cols;
+    const unsigned char *p;
+    const unsigned char *end = r->sections[section].data + r->sections[section].len;
+
+    memset(c, 0, sizeof(*c));
+    c->record = r;
+    if (table_header(r, section, &rows, &cols, &p) != 0) {
+        c->error = 1;
+        return -1;
+    }
+
+    for (uint64_t k = 0; k < cols; k++) {
+        uint64_t len;
+        if (p >= end) break;
+        int encoding = *p++;
+        if (get_uvarint(&p, end, &len) != 0 || len > (uint64_t)(end - p)) break;
+        if (k == (uint64_t)column) {
+            c->p = p;
+            c->end = p + len;
+            c->encoding = encoding;
+            return 0;
+        }
+        p += len;
+    }
+
+    if (p < end && (uint64_t)column < cols) {
+        c->error = 1;       /* Stopped early on a bad column header */
+        return -1;
+    }
+    return 0;               /* Column newer than the writer: zeros */
+}
+
+int64_t fpbin_next_int(fpbin_cursor_t *c) {
+    uint64_t v;
+
+    switch (c->encoding) {
+        case 0:
+            return 0;
+        case FPBIN_ENC_BYTE:
+            if (c->p >= c->end) break;
+            return *c->p++;
+        case FPBIN_ENC_DIGEST: {
+            char skip[65];
+            fpbin_next_checksum(c, skip);
+            return 0;
+        }
+        default:
+            if (get_uvarint(&c->p, c->end, &v) != 0) break;
+            if (c->encoding == FPBIN_ENC_SVARINT) return unzigzag(v);
+            if (c->encoding == FPBIN_ENC_DELTA) return c->prev += unzigzag(v);
+            return (int64_t)v;
+    }
+    c->error = 1;
+    return 0;
+}
+
+const char* fpbin_next_string(fpbin_cursor_t *c) {
+    if (c->encoding != FPBIN_ENC_STRING) {
+        fpbin_next_int(c);
+        return "";
+    }
+    return fpbin_string(c->record, (uint64_t)fpbin_next_int(c));
+}
+
+void fpbin_next_checksum(fpbin_cursor_t *c, char hex[65]) {
+    static const char digits[] = "0123456789abcdef";
+    uint64_t ref;
+
+    hex[0] = '\0';
+    if (c->encoding != FPBIN_ENC_DIGEST) {
+        if (c->encoding == FPBIN_ENC_STRING) {
+            snprintf(hex, 65, "%s", fpbin_next_string(c));
+        } else {
+            fpbin_next_int(c);
+        }
+        return;
+    }
+    if (c->p >= c->end) {
+        c->error = 1;
+        return;
+    }
+
+    switch (*c->p++) {
+        case 0:
+            return;
+        case 32:
+            if (c->end - c->p < 32) break;
+            for (int i = 0; i < 32; i++) {
+                hex[2 * i] = digits[c->p[i] >> 4];
+                hex[2 * i + 1] = digits[c->p[i] & 0xF];
+            }
+            hex[64] = '\0';
+            c->p += 32;
+            return;
+        case 1:
+            if (get_uvarint(&c->p, c->end, &ref) != 0) break;
+            snprintf(hex, 65, "%s", fpbin_string(c->record, ref));
+            return;
+    }
+    c->error = 1;
+}
+
+const char* fpbin_string(const fpbin_record_t *r, uint64_t offset) {
+    const fpbin_span_t *s = &r->sections[FPBIN_SEC_STRINGS];
+    if (offset >= s->len) return "";
+    /* Must be terminated inside the section */
+    if (!memchr(s->data + offset, '\0', s->len - (size_t)offset)) return "";
+    return (const char *)s->data + offset;
+}
+
+/* ============================================================
+ * Decoding
+ * ============================================================ */
+
+/* Run assign for every row with cur on the column; it may use the row index i */
+#define DECODE_COLUMN(r, sec, col, rows, assign) do {           \
+        fpbin_cursor_t cur;                                     \
+        if (fpbin_column(r, sec, col, &cur) != 0) bad = 1;      \
+        for (int i = 0; i < (rows); i++) { assign; }            \
+        bad |= cur.error;                                       \
+    } while (0)
+
+/* One value of the single meta row; a bad column or value sets *bad */
+static int64_t meta_int(const fpbin_record_t *r, int col, int *bad) {
+    fpbin_cursor_t cur;
+    if (fpbin_column(r, FPBIN_SEC_META, col, &cur) != 0) *bad = 1;
+    int64_t v = fpbin_next_int(&cur);
+    *bad |= cur.error;
+    return v;
+}
+
+static const char* meta_string(const fpbin_record_t *r, int col, int *bad) {
+    fpbin_cursor_t cur;
+    if (fpbin_column(r, FPBIN_SEC_META, col, &cur) != 0) *bad = 1;
+    const char *v = fpbin_next_string(&cur);
+    *bad |= cur.error;
+    return v;
+}
+
+static int decode_meta(const fpbin_record_t *r, fingerprint_t *fp) {
+    system_info_t *s = &fp->system;
+    network_info_t *n = &fp->network;
+    int bad = 0;
+
+    if (fpbin_rows(r, FPBIN_SEC_META) != 1) return -1;
+
+#define META(col) meta_int(r, col, &bad)
+#define META_STR(col) meta_string(r, col, &bad)
+    snprintf(s->hostname, sizeof(s->hostname), "%s", META_STR(FPBIN_META_HOSTNAME));
+    snprintf(s->kernel_version, sizeof(s->kernel_version), "%s", META_STR(FPBIN_META_KERNEL));
+    s->boot_time = (time_t)META(FPBIN_META_BOOT_TIME);
+    s->probe_time = (time_t)META(FPBIN_META_PROBE_TIME);
+    s->load_avg[0] = META(FPBIN_META_LOAD1) / 1000.0;
+    s->load_avg[1] = META(FPBIN_META_LOAD5) / 1000.0;
+    s->load_avg[2] = META(FPBIN_META_LOAD15) / 1000.0;
+    s->total_ram = (uint64_t)META(FPBIN_META_TOTAL_RAM);
+    s->free_ram = (uint64_t)META(FPBIN_META_FREE_RAM);
+    s->uptime_seconds = (uint64_t)META(FPBIN_META_UPTIME);
+    fp->probe_duration_ms = META(FPBIN_META_PROBE_US) / 1000.0;
+    fp->probe_errors = (int)META(FPBIN_META_PROBE_ERRORS);
+    fp->config_cache_hits = (int)META(FPBIN_META_CACHE_HITS);
+    fp->config_cache_misses = (int)META(FPBIN_META_CACHE_MISSES);
+    fp->processes_unlisted = (int)META(FPBIN_META_PROCS_UNLISTED);
+    snprintf(n->backend, sizeof(n->backend), "%s", META_STR(FPBIN_META_NET_BACKEND));
+    n->total_listening = (int)META(FPBIN_META_NET_LISTENING);
+    n->total_established = (int)META(FPBIN_META_NET_ESTABLISHED);
+    n->unusual_port_count = (int)META(FPBIN_META_NET_UNUSUAL);
+    n->owner_index_ms = META(FPBIN_META_NET_INDEX_US) / 1000.0;
+    n->owner_lookup_ms = META(FPBIN_META_NET_LOOKUP_US) / 1000.0;
+#undef META
+#undef META_STR
+
+    return bad ? -1 : 0;
+}
+
+static int decode_processes(const fpbin_record_t *r, fingerprint_t *fp) {
+    int n = fpbin_rows(r, FPBIN_SEC_PROCESSES);
+    int bad = 0;
+    if (n == 0) return 0;
+
+    process_info_t *p = arena_alloc(&fp->arena, n * sizeof(process_info_t));
+    if (!p) return -1;
+    memset(p, 0, n * sizeof(process_info_t));
+
+    fpbin_section_t sec = FPBIN_SEC_PROCESSES;
+    DECODE_COLUMN(r, sec, FPBIN_PROC_PID, n, p[i].pid = (pid_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_PPID, n, p[i].ppid = (pid_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_NAME, n, p[i].name = fpbin_next_string(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_STATE, n, p[i].state = (char)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_RSS, n, p[i].rss_bytes = (uint64_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_VSIZE, n, p[i].vsize_bytes = (uint64_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_START_TIME, n, p[i].start_time = (time_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_FDS, n, p[i].open_fd_count = (uint32_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_THREADS, n, p[i].thread_count = (uint32_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_CPU, n, p[i].cpu_percent = fpbin_next_int(&cur) / 100.0);
+    DECODE_COLUMN(r, sec, FPBIN_PROC_AGE, n, p[i].age_seconds = (uint64_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_PROC_STUCK, n, p[i].is_potentially_stuck = (int)fpbin_next_int(&cur));
+
+    fp->processes = p;
+    fp->process_count = n;
+    return bad ? -1 : 0;
+}
+
+static int decode_configs(const fpbin_record_t *r, fingerprint_t *fp) {
+    int n = fpbin_rows(r, FPBIN_SEC_CONFIGS);
+    int bad = 0;
+    if (n == 0) return 0;
+
+    config_file_t *c = arena_alloc(&fp->arena, n * sizeof(config_file_t));
+    if (!c) return -1;
+    memset(c, 0, n * sizeof(config_file_t));
+
+    fpbin_section_t sec = FPBIN_SEC_CONFIGS;
+    DECODE_COLUMN(r, sec, FPBIN_CFG_PATH, n, c[i].path = fpbin_next_string(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_SIZE, n, c[i].size = (uint64_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_MTIME, n, c[i].mtime = (time_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_CTIME, n, c[i].ctime = (time_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_MODE, n, c[i].permissions = (mode_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_OWNER, n, c[i].owner = (uid_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_GROUP, n, c[i].group = (gid_t)fpbin_next_int(&cur));
+    DECODE_COLUMN(r, sec, FPBIN_CFG_CHECKSUM, n, fpbin_next_checksum(&cur, c[i].checksum));
+
+    fp->configs = c;
+    fp->config_count = n;
+    return bad ? -1 : 0;
+}
+
+static int decode_network(const fpbin_record_t *r, fingerprint_t *fp) {
+    network_info_t *net = &fp->network;
+    int n = fpbin_rows(r, FPBIN_SEC_LISTENERS);
+    int bad = 0;
+
+    if (n > 0) {
+        net_listener_t *l = arena_alloc(&fp->arena, n * sizeof(net_listener_t));
+        if (!l) return -1;
+        memset(l, 0, n * sizeof(net_listener_t));
+
+        fpbin_section_t sec = FPBIN_SEC_LISTENERS;
+        DECODE_COLUMN(r, sec, FPBIN_LSN_PROTOCOL, n, l[i].protocol = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_ADDR, n, l[i].local_addr = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_PORT, n, l[i].local_port = (uint16_t)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_STATE, n, l[i].state = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_INODE, n, l[i].inode = (unsigned long)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_PID, n, l[i].pid = (pid_t)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_LSN_PROCESS, n, l[i].process_name = fpbin_next_string(&cur));
+        net->listeners = l;
+        net->listener_count = net->listener_capacity = n;
+    }
+
+    n = fpbin_rows(r, FPBIN_SEC_CONNECTIONS);
+    if (n > 0) {
+        net_connection_t *c = arena_alloc(&fp->arena, n * sizeof(net_connection_t));
+        if (!c) return -1;
+        memset(c, 0, n * sizeof(net_connection_t));
+
+        fpbin_section_t sec = FPBIN_SEC_CONNECTIONS;
+        DECODE_COLUMN(r, sec, FPBIN_CONN_PROTOCOL, n, c[i].protocol = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_LOCAL_ADDR, n, c[i].local_addr = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_LOCAL_PORT, n, c[i].local_port = (uint16_t)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_REMOTE_ADDR, n, c[i].remote_addr = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_REMOTE_PORT, n, c[i].remote_port = (uint16_t)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_STATE, n, c[i].state = fpbin_next_string(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_INODE, n, c[i].inode = (unsigned long)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_PID, n, c[i].pid = (pid_t)fpbin_next_int(&cur));
+        DECODE_COLUMN(r, sec, FPBIN_CONN_PROCESS, n, c[i].process_name = fpbin_next_string(&cur));
+        net->connections = c;
+        net->connection_count = net->connection_capacity = n;
+    }
+    return bad ? -1 : 0;
+}
+
+int fpbin_decode(const fpbin_record_t *r, fingerprint_t *fp) {
+    memset(fp, 0, sizeof(*fp));
+    arena_init(&fp->arena);
+
+    if (decode_meta(r, fp) != 0 ||
+        decode_processes(r, fp) != 0 ||
+        decode_configs(r, fp) != 0 ||
+        decode_network(r, fp) != 0) {
+        arena_free(&fp->arena);
+        memset(fp, 0, sizeof(*fp));
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fpconv.c - Convert fingerprints between JSON and binary archives
+ *
+ * JSON in appends a record to a binary archive; a binary archive in
+ * writes JSON. Listing an archive reads only the columns it reports,
+ * straight from the mapped file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "sentinel.h"
+#include "fpbin.h"
+
+/* ============================================================
+ * File Reading
+ * ============================================================ */
+
+static char* read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    size_t cap = 65536, n = 0;
+    char *buf = malloc(cap);
+    while (buf) {
+        n += fread(buf + n, 1, cap - n, f);
+        if (n < cap) break;
+        char *grown = realloc(buf, cap * 2);
+        if (!grown) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = grown;
+        cap *= 2;
+    }
+    fclose(f);
+    if (buf) *len = n;
+    return buf;
+}
+
+/* ============================================================
+ * Modes
+ * ============================================================ */
+
+static int json_to_binary(const char *in, const char *out) {
+    size_t len;
+    char *json = read_file(in, &len);
+    if (!json) return 1;
+
+    fingerprint_t fp;
+    int rc = fingerprint_from_json(&fp, json, len);
+    free(json);
+    if (rc != 0) {
+        fprintf(stderr, "Error: %s is not a fingerprint JSON document\n", in);
+        return 1;
+    }
+
+    rc = fpbin_append(out, &fp);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", out, strerror(errno));
+    }
+    arena_free(&fp.arena);      /* Tools do not link the prober */
+    return rc != 0;
+}
+
+static int write_record_json(const fpbin_record_t *rec, FILE *out) {
+    fingerprint_t fp;
+    if (fpbin_decode(rec, &fp) != 0) {
+        fprintf(stderr, "Error: Corrupt record at offset %zu\n", rec->offset);
+        return -1;
+    }
+
+    char *json = fingerprint_to_json(&fp);
+    arena_free(&fp.arena);      /* Tools do not link the prober */
+    if (!json) return -1;
+    fputs(json, out);
+    free(json);
+    return 0;
+}
+
+/* index < 0 counts from the end; all writes every record */
+static int binary_to_json(const fpbin_file_t *f, int index, int all, FILE *out) {
+    fpbin_record_t rec;
+    size_t offset = 0;
+    int count = 0, rc;
+
+    /* Counting first lets negative indexes work without a record table */
+    while ((rc = fpbin_next_record(f, &offset, &rec)) == 1) count++;
+    if (index < 0) index += count;
+    if (!all && (index < 0 || index >= count)) {
+        fprintf(stderr, "Error: No record %d (archive has %d)\n", index, count);
+        return 1;
+    }
+
+    offset = 0;
+    for (int i = 0; fpbin_next_record(f, &offset, &rec) == 1; i++) {
+        if (!all && i != index) continue;
+        if (write_record_json(&rec, out) != 0) return 1;
+    }
+    if (rc < 0) {
+        fprintf(stderr, "Error: Corrupt record at offset %zu\n", offset);
+        return 1;
+    }
+    return 0;
+}
+
+/* One line per record, from the columns alone */
+static int list_records(const fpbin_file_t *f) {
+    fpbin_record_t rec;
+    fpbin_cursor_t c;
+    size_t offset = 0;
+    int rc, count = 0;
+
+    printf("%-6s %-20s %-20s %8s %6s %6s %6s %8s\n",
+           "RECORD", "PROBE TIME", "HOSTNAME", "PROCS", "ZOMBIE", "CONFIG", "LISTEN", "BYTES");
+
+    while ((rc = fpbin_next_record(f, &offset, &rec)) == 1) {
+        char when[32] = "-";
+        fpbin_column(&rec, FPBIN_SEC_META, FPBIN_META_PROBE_TIME, &c);
+        time_t t = (time_t)fpbin_next_int(&c);
+        struct tm *tm = gmtime(&t);
+        if (tm) strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", tm);
+
+        fpbin_column(&rec, FPBIN_SEC_META, FPBIN_META_HOSTNAME, &c);
+        const char *host = fpbin_next_string(&c);
+
+        int procs = fpbin_rows(&rec, FPBIN_SEC_PROCESSES);
+        int zombies = 0;
+        fpbin_column(&rec, FPBIN_SEC_PROCESSES, FPBIN_PROC_STATE, &c);
+        for (int i = 0; i < procs; i++) {
+            if (fpbin_next_int(&c) == 'Z') zombies++;
+        }
+
+        printf("%-6d %-20s %-20.20s %8d %6d %6d %6d %8zu\n",
+               count++, when, host, procs, zombies,
+               fpbin_rows(&rec, FPBIN_SEC_CONFIGS),
+               fpbin_rows(&rec, FPBIN_SEC_LISTENERS), rec.size);
+    }
+
+    if (count > 0) {
+        double avg = (double)offset / count;
+        printf("\n%d records, %zu bytes (%.0f per record; a year at one per minute is ~%.1f GB)\n",
+               count, offset, avg, avg * 525600.0 / (1024.0 * 1024.0 * 1024.0));
+    }
+    if (rc < 0) {
+        fprintf(stderr, "Error: Corrupt record at offset %zu\n", offset);
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Main
+ * ============================================================ */
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "C-Sentinel Fingerprint Converter\n\n");
+    fprintf(stderr, "Usage: %s <fingerprint.json> <archive.fpb>\n", prog);
+    fprintf(stderr, "       %s [-r N | -a] <archive.fpb> [output.json]\n", prog);
+    fprintf(stderr, "       %s -l <archive.fpb>\n\n", prog);
+    fprintf(stderr, "JSON input is appended to the archive as one record. Archive\n");
+    fprintf(stderr, "input is written as JSON: the last record, record N (negative\n");
+    fprintf(stderr, "counts from the end), or all of them.\n\n");
+    fprintf(stderr, "  -r N    Record to convert (default: -1, the latest)\n");
+    fprintf(stderr, "  -a      Convert every record\n");
+    fprintf(stderr, "  -l      List records\n");
+    fprintf(stderr, "\nExample:\n");
+    fprintf(stderr, "  ./sentinel -w -B host.fpb          Archive every watch-mode capture\n");
+    fprintf(stderr, "  %s -r 0 host.fpb first.json\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    int index = -1, all = 0, list = 0;
+    int i = 1;
+
+    for (; i < argc && argv[i][0] == '-' && argv[i][1]; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            index = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-a") == 0) {
+            all = 1;
+        } else if (strcmp(argv[i], "-l") == 0) {
+            list = 1;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - i < 1 || argc - i > 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *in = argv[i];
+    const char *out = (argc - i == 2) ? argv[i + 1] : NULL;
+
+    fpbin_file_t f;
+    if (fpbin_open(&f, in) != 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", in, strerror(errno));
+        return 1;
+    }
+
+    int rc;
+    if (!fpbin_detect(f.data, f.size)) {
+        fpbin_close(&f);
+        if (list || !out) {
+            fprintf(stderr, "Error: %s is not a binary fingerprint archive\n", in);
+            return 1;
+        }
+        return json_to_binary(in, out);
+    }
+
+    if (list) {
+        rc = list_records(&f);
+    } else {
+        FILE *fout = out ? fopen(out, "w") : stdout;
+        if (!fout) {
+            fprintf(stderr, "Error: Cannot write %s: %s\n", out, strerror(errno));
+            fpbin_close(&f);
+            return 1;
+        }
+        rc = binary_to_json(&f, index, all, fout);
+        if (out && fclose(fout) != 0) rc = 1;
+    }
+
+    fpbin_close(&f);
+    return rc;
+}
@@ -0,0 +1,573 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * fpdiff.c - Structural diff between two fingerprints
+ *
+ * Every entry's key is interned in the diff's arena, so equal keys are
+ * the same pointer and the join table never compares strings.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "fpdiff.h"
+
+#define GB (1024.0 * 1024.0 * 1024.0)
+
+typedef struct {
+    fpdiff_t *d;
+    int error;                  /* Sticky out-of-memory flag */
+} diff_ctx_t;
+
+/* ============================================================
+ * Items
+ * ============================================================ */
+
+static const char* fmt(diff_ctx_t *ctx, const char *format, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, format);
+    vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    return arena_intern(&ctx->d->arena, buf);
+}
+
+static fpdiff_item_t* add_item(diff_ctx_t *ctx, fpdiff_section_t section, fpdiff_kind_t kind,
+                               const char *key, const char *field,
+                               const char *a, const char *b) {
+    fpdiff_t *d = ctx->d;
+    fpdiff_item_t *items = arena_grow(&d->arena, d->items, sizeof(fpdiff_item_t),
+                                      d->count, &d->capacity);
+    if (!items) {
+        ctx->error = 1;
+        return NULL;
+    }
+    d->items = items;
+
+    fpdiff_item_t *it = &d->items[d->count++];
+    memset(it, 0, sizeof(*it));
+    it->section = section;
+    it->kind = kind;
+    it->key = key;
+    it->field = field;
+    it->value_a = a ? a : "";
+    it->value_b = b ? b : "";
+    it->is_significant = 1;
+    d->significant++;
+    return it;
+}
+
+static void string_diff(diff_ctx_t *ctx, const char *field, const char *a, const char *b) {
+    if (strcmp(a, b) == 0) return;  /* No difference */
+    add_item(ctx, FPDIFF_SYSTEM, FPDIFF_CHANGED, field, NULL,
+             arena_intern(&ctx->d->arena, a), arena_intern(&ctx->d->arena, b));
+}
+
+static void numeric_diff(diff_ctx_t *ctx, fpdiff_section_t section, const char *key,
+                         const char *field, double a, double b, double threshold) {
+    double diff = fabs(a - b);
+    double avg = (fabs(a) + fabs(b)) / 2.0;
+    double percent = (avg > 0) ? (diff / avg * 100.0) : 0.0;
+
+    if (diff == 0 || percent < threshold) return;  /* Below significance threshold */
+
+    fpdiff_item_t *it = add_item(ctx, section, FPDIFF_CHANGED, key, field,
+                                 fmt(ctx, "%.2f", a), fmt(ctx, "%.2f", b));
+    if (!it) return;
+    it->percent = percent;
+    it->is_numeric = 1;
+    if (percent <= 10.0) {          /* >10% is significant */
+        it->is_significant = 0;
+        ctx->d->significant--;
+    }
+}
+
+/* ============================================================
+ * System Fields
+ * ============================================================ */
+
+/* Same tests, in the same order, as json_serialize.c's notable list */
+static void count_flags(const fingerprint_t *fp, int *zombies, int *high_fd) {
+    *zombies = *high_fd = 0;
+    for (int i = 0; i < fp->process_count; i++) {
+        const process_info_t *p = &fp->processes[i];
+        if (p->state == 'Z') {
+            (*zombies)++;
+        } else if (p->open_fd_count > 100 && p->open_fd_count < 100000) {
+            (*high_fd)++;
+        }
+    }
+}
+
+static double used_percent(const fingerprint_t *fp) {
+    if (fp->system.total_ram == 0) return 0.0;
+    return 100.0 * (1.0 - (double)fp->system.free_ram / fp->system.total_ram);
+}
+
+static void diff_system(diff_ctx_t *ctx, const fingerprint_t *a, const fingerprint_t *b) {
+    string_diff(ctx, "hostname", a->system.hostname, b->system.hostname);
+    string_diff(ctx, "kernel", a->system.kernel_version, b->system.kernel_version);
+
+    numeric_diff(ctx, FPDIFF_SYSTEM, "uptime_days", NULL, a->system.uptime_seconds / 86400.0,
+                 b->system.uptime_seconds / 86400.0, 1.0);
+    numeric_diff(ctx, FPDIFF_SYSTEM, "memory_total_gb", NULL, a->system.total_ram / GB,
+                 b->system.total_ram / GB, 1.0);
+    numeric_diff(ctx, FPDIFF_SYSTEM, "memory_used_percent", NULL, used_percent(a),
+                 used_percent(b), 5.0);
+    numeric_diff(ctx, FPDIFF_SYSTEM, "process_count", NULL,
+                 a->process_count + a->processes_unlisted,
+                 b->process_count + b->processes_unlisted, 5.0);
+
+    int zombies_a, zombies_b, high_fd_a, high_fd_b;
+    count_flags(a, &zombies_a, &high_fd_a);
+    count_flags(b, &zombies_b, &high_fd_b);
+    numeric_diff(ctx, FPDIFF_SYSTEM, "zombie_count", NULL, zombies_a, zombies_b, 0.0);
+    numeric_diff(ctx, FPDIFF_SYSTEM, "high_fd_count", NULL, high_fd_a, high_fd_b, 0.0);
+}
+
+/* ============================================================
+ * Join Table
+ * ============================================================ */
+
+typedef struct {
+    const char *key;            /* Interned: compared by pointer */
+    int first_a, first_b;       /* First entry with this key on each side */
+    int count_a, count_b;
+} join_slot_t;
+
+typedef struct {
+    join_slot_t *slots;
+    size_t mask;
+} join_t;
+
+/* Keys are interned pointers or pids; mix them so nearby values spread */
+static uint32_t mix_hash(uint64_t v) {
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    return (uint32_t)v;
+}
+
+static int join_init(diff_ctx_t *ctx, join_t *j, int entries) {
+    size_t size = 16;
+    while (size < (size_t)entries * 2) size <<= 1;     /* Load factor under 1/2 */
+    j->slots = arena_alloc(&ctx->d->arena, size * sizeof(join_slot_t));
+    if (!j->slots) {
+        ctx->error = 1;
+        return -1;
+    }
+    memset(j->slots, 0, size * sizeof(join_slot_t));
+    j->mask = size - 1;
+    return 0;
+}
+
+static void join_add(join_t *j, const char *key, int side, int index) {
+    size_t slot = mix_hash((uintptr_t)key) & j->mask;
+    while (j->slots[slot].key && j->slots[slot].key != key) {
+        slot = (slot + 1) & j->mask;
+    }
+    join_slot_t *s = &j->slots[slot];
+    if (!s->key) {
+        s->key = key;
+        s->first_a = s->first_b = -1;
+    }
+    if (side == 0) {
+        if (s->count_a++ == 0) s->first_a = index;
+    } else {
+        if (s->count_b++ == 0) s->first_b = index;
+    }
+}
+
+static const join_slot_t* join_find(const join_t *j, const char *key) {
+    size_t slot = mix_hash((uintptr_t)key) & j->mask;
+    while (j->slots[slot].key != key) {
+        slot = (slot + 1) & j->mask;
+    }
+    return &j->slots[slot];
+}
+
+/* ============================================================
+ * Keyed Sections
+ * ============================================================ */
+
+/* pid -> process index, for walking ppid chains */
+typedef struct {
+    const fingerprint_t *fp;
+    int *slots;                 /* Index + 1; 0 is empty */
+    size_t mask;
+} pid_index_t;
+
+static int pid_index_build(arena_t *a, pid_index_t *ix, const fingerprint_t *fp) {
+    size_t size = 16;
+    while (size < (size_t)fp->process_count * 2) size <<= 1;
+    ix->fp = fp;
+    ix->mask = size - 1;
+    ix->slots = arena_alloc(a, size * sizeof(int));
+    if (!ix->slots) return -1;
+    memset(ix->slots, 0, size * sizeof(int));
+
+    for (int i = 0; i < fp->process_count; i++) {
+        size_t slot = mix_hash((uint64_t)fp->processes[i].pid) & ix->mask;
+        while (ix->slots[slot]) slot = (slot + 1) & ix->mask;
+        ix->slots[slot] = i + 1;
+    }
+    return 0;
+}
+
+static const process_info_t* pid_lookup(const pid_index_t *ix, pid_t pid) {
+    size_t slot = mix_hash((uint64_t)pid) & ix->mask;
+    while (ix->slots[slot]) {
+        const process_info_t *p = &ix->fp->processes[ix->slots[slot] - 1];
+        if (p->pid == pid) return p;
+        slot = (slot + 1) & ix->mask;
+    }
+    return NULL;
+}
+
+/*
+ * "init>sshd>bash": the process and as many parents as the fingerprint
+ * holds. JSON carries no ppid, so there the key is just the name.
+ */
+static const char* process_key(arena_t *a, const pid_index_t *ix, const process_info_t *p) {
+    const char *chain[FPDIFF_CHAIN_DEPTH + 1];
+    int depth = 0;
+
+    chain[depth++] = p->name ? p->name : "";
+    const process_info_t *cur = p;
+    while (depth <= FPDIFF_CHAIN_DEPTH && cur->ppid > 0 && cur->ppid != cur->pid) {
+        const process_info_t *parent = pid_lookup(ix, cur->ppid);
+        if (!parent) break;
+        chain[depth++] = parent->name ? parent->name : "";
+        cur = parent;
+    }
+
+    char buf[512];
+    size_t len = 0;
+    for (int i = depth - 1; i >= 0 && len < sizeof(buf); i--) {
+        int n = snprintf(buf + len, sizeof(buf) - len, "%s%s", chain[i], i ? ">" : "");
+        if (n < 0) break;
+        len += (size_t)n;
+    }
+    if (len >= sizeof(buf)) len = sizeof(buf) - 1;
+    return arena_intern_n(a, buf, len);
+}
+
+static void diff_processes(diff_ctx_t *ctx, const fingerprint_t *a, const fingerprint_t *b) {
+    pid_index_t ix_a, ix_b;
+    join_t j;
+    if (pid_index_build(&ctx->d->arena, &ix_a, a) != 0 ||
+        pid_index_build(&ctx->d->arena, &ix_b, b) != 0) {
+        ctx->error = 1;
+        return;
+    }
+    if (join_init(ctx, &j, a->process_count + b->process_count) != 0) return;
+
+    const char **keys_a = arena_alloc(&ctx->d->arena, (a->process_count + 1) * sizeof(char *));
+    const char **keys_b = arena_alloc(&ctx->d->arena, (b->process_count + 1) * sizeof(char *));
+    if (!keys_a || !keys_b) {
+        ctx->error = 1;
+        return;
+    }
+    for (int i = 0; i < a->process_count; i++) {
+        keys_a[i] = process_key(&ctx->d->arena, &ix_a, &a->processes[i]);
+        join_add(&j, keys_a[i], 0, i);
+    }
+    for (int i = 0; i < b->process_count; i++) {
+        keys_b[i] = process_key(&ctx->d->arena, &ix_b, &b->processes[i]);
+        join_add(&j, keys_b[i], 1, i);
+    }
+
+    /*
+     * JSON lists notable processes only. Something missing from a
+     * partial list may just be unlisted, so only a complete side can
+     * show that a process is absent or fewer.
+     */
+    int complete_a = a->processes_unlisted == 0;
+    int complete_b = b->processes_unlisted == 0;
+
+    for (int i = 0; i < a->process_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_a[i]);
+        if (s->first_a != i) continue;
+        if ((s->count_b < s->count_a && !complete_b) ||
+            (s->count_a < s->count_b && !complete_a)) {
+            continue;
+        }
+        if (s->count_b == 0) {
+            add_item(ctx, FPDIFF_PROCESS, FPDIFF_REMOVED, s->key, NULL,
+                     fmt(ctx, "%d", s->count_a), "");
+        } else if (s->count_a != s->count_b) {
+            numeric_diff(ctx, FPDIFF_PROCESS, s->key, "count", s->count_a, s->count_b, 0.0);
+        }
+    }
+    for (int i = 0; i < b->process_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_b[i]);
+        if (s->first_b == i && s->count_a == 0 && complete_a) {
+            add_item(ctx, FPDIFF_PROCESS, FPDIFF_ADDED, s->key, NULL,
+                     "", fmt(ctx, "%d", s->count_b));
+        }
+    }
+}
+
+static const char* listener_key(arena_t *a, const net_listener_t *l) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s %s:%u", l->protocol ? l->protocol : "",
+             l->local_addr ? l->local_addr : "", (unsigned)l->local_port);
+    return arena_intern(a, buf);
+}
+
+static void diff_listeners(diff_ctx_t *ctx, const network_info_t *a, const network_info_t *b) {
+    join_t j;
+    if (join_init(ctx, &j, a->listener_count + b->listener_count) != 0) return;
+
+    const char **keys_a = arena_alloc(&ctx->d->arena, (a->listener_count + 1) * sizeof(char *));
+    const char **keys_b = arena_alloc(&ctx->d->arena, (b->listener_count + 1) * sizeof(char *));
+    if (!keys_a || !keys_b) {
+        ctx->error = 1;
+        return;
+    }
+    for (int i = 0; i < a->listener_count; i++) {
+        keys_a[i] = listener_key(&ctx->d->arena, &a->listeners[i]);
+        join_add(&j, keys_a[i], 0, i);
+    }
+    for (int i = 0; i < b->listener_count; i++) {
+        keys_b[i] = listener_key(&ctx->d->arena, &b->listeners[i]);
+        join_add(&j, keys_b[i], 1, i);
+    }
+
+    for (int i = 0; i < a->listener_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_a[i]);
+        if (s->first_a != i) continue;
+        const char *owner_a = a->listeners[i].process_name ? a->listeners[i].process_name : "";
+        if (s->count_b == 0) {
+            add_item(ctx, FPDIFF_LISTENER, FPDIFF_REMOVED, s->key, NULL, owner_a, "");
+            continue;
+        }
+        const net_listener_t *lb = &b->listeners[s->first_b];
+        const char *owner_b = lb->process_name ? lb->process_name : "";
+        if (strcmp(owner_a, owner_b) != 0) {
+            add_item(ctx, FPDIFF_LISTENER, FPDIFF_CHANGED, s->key, "process", owner_a, owner_b);
+        }
+    }
+    for (int i = 0; i < b->listener_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_b[i]);
+        if (s->first_b == i && s->count_a == 0) {
+            const char *owner = b->listeners[i].process_name;
+            add_item(ctx, FPDIFF_LISTENER, FPDIFF_ADDED, s->key, NULL, "", owner ? owner : "");
+        }
+    }
+}
+
+static void diff_config_pair(diff_ctx_t *ctx, const char *key,
+                             const config_file_t *a, const config_file_t *b) {
+    if (strcmp(a->checksum, b->checksum) != 0) {
+        add_item(ctx, FPDIFF_CONFIG, FPDIFF_CHANGED, key, "checksum",
+                 fmt(ctx, "%.16s", a->checksum), fmt(ctx, "%.16s", b->checksum));
+    }
+    /* A capture keeps the file type bits; JSON does not */
+    if ((a->permissions & 07777) != (b->permissions & 07777)) {
+        add_item(ctx, FPDIFF_CONFIG, FPDIFF_CHANGED, key, "permissions",
+                 fmt(ctx, "%04o", (unsigned)(a->permissions & 07777)),
+                 fmt(ctx, "%04o", (unsigned)(b->permissions & 07777)));
+    }
+    if (a->owner != b->owner) {
+        add_item(ctx, FPDIFF_CONFIG, FPDIFF_CHANGED, key, "owner",
+                 fmt(ctx, "%u", (unsigned)a->owner), fmt(ctx, "%u", (unsigned)b->owner));
+    }
+    if (a->group != b->group) {
+        add_item(ctx, FPDIFF_CONFIG, FPDIFF_CHANGED, key, "group",
+                 fmt(ctx, "%u", (unsigned)a->group), fmt(ctx, "%u", (unsigned)b->group));
+    }
+}
+
+static void diff_configs(diff_ctx_t *ctx, const fingerprint_t *a, const fingerprint_t *b) {
+    join_t j;
+    if (join_init(ctx, &j, a->config_count + b->config_count) != 0) return;
+
+    const char **keys_a = arena_alloc(&ctx->d->arena, (a->config_count + 1) * sizeof(char *));
+    const char **keys_b = arena_alloc(&ctx->d->arena, (b->config_count + 1) * sizeof(char *));
+    if (!keys_a || !keys_b) {
+        ctx->error = 1;
+        return;
+    }
+    for (int i = 0; i < a->config_count; i++) {
+        keys_a[i] = arena_intern(&ctx->d->arena, a->configs[i].path);
+        join_add(&j, keys_a[i], 0, i);
+    }
+    for (int i = 0; i < b->config_count; i++) {
+        keys_b[i] = arena_intern(&ctx->d->arena, b->configs[i].path);
+        join_add(&j, keys_b[i], 1, i);
+    }
+
+    for (int i = 0; i < a->config_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_a[i]);
+        if (s->first_a != i) continue;
+        if (s->count_b == 0) {
+            add_item(ctx, FPDIFF_CONFIG, FPDIFF_REMOVED, s->key, NULL,
+                     fmt(ctx, "%.16s", a->configs[i].checksum), "");
+        } else {
+            diff_config_pair(ctx, s->key, &a->configs[i], &b->configs[s->first_b]);
+        }
+    }
+    for (int i = 0; i < b->config_count; i++) {
+        const join_slot_t *s = join_find(&j, keys_b[i]);
+        if (s->first_b == i && s->count_a == 0) {
+            add_item(ctx, FPDIFF_CONFIG, FPDIFF_ADDED, s->key, NULL,
+                     "", fmt(ctx, "%.16s", b->configs[i].checksum));
+        }
+    }
+}
+
+/* ============================================================
+ * Signatures
+ * ============================================================ */
+
+static uint64_t key_hash(char tag, const char *s) {
+    /* FNV-1a, 64-bit; the tag keeps sections apart */
+    uint64_t h = 14695981039346656037ULL;
+    h = (h ^ (unsigned char)tag) * 1099511628211ULL;
+    for (; *s; s++) {
+        h = (h ^ (unsigned char)*s) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static int cmp_u64(const void *x, const void *y) {
+    uint64_t a = *(const uint64_t *)x, b = *(const uint64_t *)y;
+    return (a > b) - (a < b);
+}
+
+int fpdiff_signature(arena_t *a, const fingerprint_t *fp, fpdiff_signature_t *sig) {
+    const network_info_t *net = &fp->network;
+    int max = 1 + fp->process_count + net->listener_count + fp->config_count;
+    pid_index_t ix;
+
+    memset(sig, 0, sizeof(*sig));
+    sig->hashes = arena_alloc(a, (size_t)max * sizeof(uint64_t));
+    if (!sig->hashes || pid_index_build(a, &ix, fp) != 0) return -1;
+
+    int n = 0;
+    for (int i = 0; i < fp->process_count; i++) {
+        const char *key = process_key(a, &ix, &fp->processes[i]);
+        /* Kernel workers carry per-boot queue names; they are noise here */
+        if (strncmp(key, "kthreadd", 8) == 0) continue;
+        sig->hashes[n++] = key_hash('p', key);
+    }
+    for (int i = 0; i < net->listener_count; i++) {
+        sig->hashes[n++] = key_hash('l', listener_key(a, &net->listeners[i]));
+    }
+    for (int i = 0; i < fp->config_count; i++) {
+        sig->hashes[n++] = key_hash('c', fp->configs[i].path ? fp->configs[i].path : "");
+    }
+
+    /* Sorted and de-duplicated: a set, compared by merging */
+    qsort(sig->hashes, n, sizeof(uint64_t), cmp_u64);
+    int unique = 0;
+    for (int i = 0; i < n; i++) {
+        if (unique == 0 || sig->hashes[unique - 1] != sig->hashes[i]) {
+            sig->hashes[unique++] = sig->hashes[i];
+        }
+    }
+    sig->count = unique;
+    return 0;
+}
+
+double fpdiff_similarity(const fpdiff_signature_t *a, const fpdiff_signature_t *b) {
+    int i = 0, j = 0, common = 0;
+    while (i < a->count && j < b->count) {
+        if (a->hashes[i] < b->hashes[j]) {
+            i++;
+        } else if (a->hashes[i] > b->hashes[j]) {
+            j++;
+        } else {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    int total = a->count + b->count - common;
+    return total > 0 ? (double)common / total : 1.0;
+}
+
+/* ============================================================
+ * Public Interface
+ * ============================================================ */
+
+int fpdiff_compare(fpdiff_t *d, const fingerprint_t *a, const fingerprint_t *b) {
+    diff_ctx_t ctx = { d, 0 };
+
+    memset(d, 0, sizeof(*d));
+    arena_init(&d->arena);
+
+    diff_system(&ctx, a, b);
+    diff_processes(&ctx, a, b);
+    diff_listeners(&ctx, &a->network, &b->network);
+    diff_configs(&ctx, a, b);
+
+    if (ctx.error) {
+        fpdiff_free(d);
+        return -1;
+    }
+    return 0;
+}
+
+void fpdiff_free(fpdiff_t *d) {
+    if (!d) return;
+    arena_free(&d->arena);
+    memset(d, 0, sizeof(*d));
+}
+
+const char* fpdiff_section_name(fpdiff_section_t section) {
+    switch (section) {
+        case FPDIFF_SYSTEM:   return "system";
+        case FPDIFF_PROCESS:  return "process";
+        case FPDIFF_LISTENER: return "listener";
+        case FPDIFF_CONFIG:   return "config";
+    }
+    return "unknown";
+}
+
+const char* fpdiff_kind_name(fpdiff_kind_t kind) {
+    switch (kind) {
+        case FPDIFF_CHANGED: return "changed";
+        case FPDIFF_ADDED:   return "added";
+        case FPDIFF_REMOVED: return "removed";
+    }
+    return "unknown";
+}
+
+void fpdiff_write_json(json_writer_t *w, const fpdiff_t *d,
+                       const char *name_a, const char *name_b) {
+    json_object_begin(w, NULL);
+    json_string(w, "a", name_a);
+    json_string(w, "b", name_b);
+    json_int(w, "differences", d->count);
+    json_int(w, "significant", d->significant);
+
+    json_array_begin(w, "items");
+    for (int i = 0; i < d->count; i++) {
+        const fpdiff_item_t *it = &d->items[i];
+        json_object_begin_inline(w, NULL);
+        json_string(w, "section", fpdiff_section_name(it->section));
+        json_string(w, "kind", fpdiff_kind_name(it->kind));
+        json_string(w, "key", it->key);
+        if (it->field) json_string(w, "field", it->field);
+        if (it->kind != FPDIFF_ADDED) json_string(w, "a", it->value_a);
+        if (it->kind != FPDIFF_REMOVED) json_string(w, "b", it->value_b);
+        if (it->is_numeric) json_double(w, "percent", it->percent, 1);
+        json_bool(w, "significant", it->is_significant);
+        json_object_end(w);
+    }
+    json_array_end(w);
+
+    json_object_end(w);
+}
@@ -0,0 +1,262 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * hash_cache.c - Persistent config checksum cache
+ *
+ * Remembers the SHA256 of each config file keyed by (dev, inode, size,
+ * mtime, ctime) so unchanged files are not re-read on every probe.
+ * ctime is part of the key because it cannot be set from userspace:
+ * rewriting a file and restoring its mtime with touch(1) still misses.
+ *
+ * The cache lives next to the baseline as hashcache.dat. Lookups are
+ * read-only and safe from worker threads; stores and saves happen on
+ * the probing thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "sentinel.h"
+
+#define HASH_CACHE_FILENAME "hashcache.dat"
+#define HASH_CACHE_MAGIC    "SNTLHASH"
+#define HASH_CACHE_VERSION  1
+#define HASH_CACHE_INITIAL  256
+#define HASH_CACHE_MAX_AGE  (30 * 86400)   /* Drop entries unseen for 30 days */
+
+/* On-disk and in-memory entry */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime;
+    int64_t ctime;
+    int64_t last_seen;
+    char checksum[65];
+} hash_cache_entry_t;
+
+typedef struct {
+    char magic[8];              /* "SNTLHASH" */
+    uint32_t version;
+    uint32_t count;
+} hash_cache_header_t;
+
+static hash_cache_entry_t *g_entries = NULL;
+static int g_count = 0;
+static int g_capacity = 0;
+static int *g_index = NULL;     /* Open-addressed on (dev, ino) */
+static int g_index_size = 0;
+static int g_loaded = 0;
+static int g_dirty = 0;
+
+/* ============================================================
+ * Index
+ * ============================================================ */
+
+static unsigned key_hash(uint64_t dev, uint64_t ino) {
+    uint64_t h = ino * 0x9E3779B97F4A7C15ULL ^ dev;
+    h ^= h >> 29;
+    return (unsigned)h;
+}
+
+static int rebuild_index(int size) {
+    int *index = malloc(size * sizeof(int));
+    if (!index) return -1;
+    for (int i = 0; i < size; i++) index[i] = -1;
+
+    for (int i = 0; i < g_count; i++) {
+        unsigned slot = key_hash(g_entries[i].dev, g_entries[i].ino) & (size - 1);
+        while (index[slot] >= 0) slot = (slot + 1) & (size - 1);
+        index[slot] = i;
+    }
+
+    free(g_index);
+    g_index = index;
+    g_index_size = size;
+    return 0;
+}
+
+static int find_entry(uint64_t dev, uint64_t ino) {
+    if (!g_index) return -1;
+    unsigned mask = g_index_size - 1;
+    unsigned slot = key_hash(dev, ino) & mask;
+    while (g_index[slot] >= 0) {
+        const hash_cache_entry_t *e = &g_entries[g_index[slot]];
+        if (e->dev == dev && e->ino == ino) return g_index[slot];
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+/* ============================================================
+ * Persistence
+ * ============================================================ */
+
+static void get_cache_path(char *path, size_t path_size) {
+    char dir[256];
+    sentinel_state_dir(dir, sizeof(dir));
+    snprintf(path, path_size, "%s/%s", dir, HASH_CACHE_FILENAME);
+}
+
+int hash_cache_load(void) {
+    if (g_loaded) return 0;
+    g_loaded = 1;
+
+    char path[512];
+    get_cache_path(path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return rebuild_index(HASH_CACHE_INITIAL);
+
+    hash_cache_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, HASH_CACHE_MAGIC, 8) != 0 ||
+        hdr.version != HASH_CACHE_VERSION || hdr.count > 1000000) {
+        fclose(f);
+        return rebuild_index(HASH_CACHE_INITIAL);  /* Stale or corrupt - start over */
+    }
+
+    if (hdr.count > 0) {
+        g_entries = malloc(hdr.count * sizeof(hash_cache_entry_t));
+        if (!g_entries || fread(g_entries, sizeof(hash_cache_entry_t), hdr.count, f) != hdr.count) {
+            free(g_entries);
+            g_entries = NULL;
+            hdr.count = 0;
+        }
+    }
+    fclose(f);
+
+    g_count = g_capacity = (int)hdr.count;
+    for (int i = 0; i < g_count; i++) {
+        g_entries[i].checksum[64] = '\0';
+    }
+
+    int size = HASH_CACHE_INITIAL;
+    while (size < g_count * 2) size *= 2;
+    return rebuild_index(size);
+}
+
+int hash_cache_save(void) {
+    if (!g_dirty) return 0;
+    if (sentinel_ensure_state_dir() != 0) return -1;
+
+    char path[512], tmp_path[520];
+    get_cache_path(path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    /* Age out files that are no longer probed */
+    time_t now = time(NULL);
+    hash_cache_header_t hdr;
+    memcpy(hdr.magic, HASH_CACHE_MAGIC, 8);
+    hdr.version = HASH_CACHE_VERSION;
+    hdr.count = 0;
+    for (int i = 0; i < g_count; i++) {
+        if (now - g_entries[i].last_seen <= HASH_CACHE_MAX_AGE) hdr.count++;
+    }
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) return -1;
+
+    int ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    for (int i = 0; ok && i < g_count; i++) {
+        if (now - g_entries[i].last_seen > HASH_CACHE_MAX_AGE) continue;
+        ok = fwrite(&g_entries[i], sizeof(g_entries[i]), 1, f) == 1;
+    }
+    if (fclose(f) != 0) ok = 0;
+
+    /* Rename so a crash mid-write never leaves a torn cache */
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return -1;
+    }
+    g_dirty = 0;
+    return 0;
+}
+
+void hash_cache_free(void) {
+    free(g_entries);
+    free(g_index);
+    g_entries = NULL;
+    g_index = NULL;
+    g_count = g_capacity = g_index_size = 0;
+    g_loaded = g_dirty = 0;
+}
+
+/* ============================================================
+ * Lookup and Store
+ * ============================================================ */
+
+static int entry_matches(const hash_cache_entry_t *e, const struct stat *st) {
+    return e->size == (uint64_t)st->st_size &&
+           e->mtime == (int64_t)st->st_mtime &&
+           e->ctime == (int64_t)st->st_ctime;
+}
+
+/* Copy the cached checksum for st into out. Returns 1 on hit, 0 on miss */
+int hash_cache_lookup(const struct stat *st, char *out, size_t out_size) {
+    int i = find_entry((uint64_t)st->st_dev, (uint64_t)st->st_ino);
+    if (i < 0 || !entry_matches(&g_entries[i], st)) return 0;
+    snprintf(out, out_size, "%s", g_entries[i].checksum);
+    return 1;
+}
+
+/* Note that st was seen this cycle, recording checksum if it was rehashed */
+void hash_cache_store(const struct stat *st, const char *checksum, time_t now) {
+    /*
+     * A file modified in the same second we hashed it may change again
+     * without moving mtime. Leave it uncached until its timestamps settle.
+     */
+    if (st->st_mtime >= now || st->st_ctime >= now) return;
+    if (strlen(checksum) != 64) return;     /* "error" from sha256_file */
+
+    int i = find_entry((uint64_t)st->st_dev, (uint64_t)st->st_ino);
+    if (i >= 0) {
+        hash_cache_entry_t *e = &g_entries[i];
+        if (entry_matches(e, st) && strcmp(e->checksum, checksum) == 0) {
+            /* Only refresh last_seen once a day to avoid rewriting the file every probe */
+            if (now - e->last_seen > 86400) {
+                e->last_seen = now;
+                g_dirty = 1;
+            }
+            return;
+        }
+    } else {
+        if (g_count >= g_capacity) {
+            int new_cap = g_capacity ? g_capacity * 2 : HASH_CACHE_INITIAL;
+            hash_cache_entry_t *grown = realloc(g_entries, new_cap * sizeof(*grown));
+            if (!grown) return;
+            g_entries = grown;
+            g_capacity = new_cap;
+        }
+        if ((g_count + 1) * 2 > g_index_size &&
+            rebuild_index(g_index_size ? g_index_size * 2 : HASH_CACHE_INITIAL) != 0) {
+            return;
+        }
+        i = g_count++;
+        memset(&g_entries[i], 0, sizeof(g_entries[i]));
+        g_entries[i].dev = (uint64_t)st->st_dev;
+        g_entries[i].ino = (uint64_t)st->st_ino;
+
+        unsigned mask = g_index_size - 1;
+        unsigned slot = key_hash(g_entries[i].dev, g_entries[i].ino) & mask;
+        while (g_index[slot] >= 0) slot = (slot + 1) & mask;
+        g_index[slot] = i;
+    }
+
+    hash_cache_entry_t *e = &g_entries[i];
+    e->size = (uint64_t)st->st_size;
+    e->mtime = (int64_t)st->st_mtime;
+    e->ctime = (int64_t)st->st_ctime;
+    e->last_seen = now;
+    snprintf(e->checksum, sizeof(e->checksum), "%s", checksum);
+    g_dirty = 1;
+}
@@ -0,0 +1,447 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * http_client.c - Keep-alive HTTP/1.1 POST, plain or over TLS
+ *
+ * Enough of HTTP/1.1 for webhooks: one request at a time, the response
+ * status and headers parsed, the body skipped. The socket has send and
+ * receive timeouts, so an unresponsive server costs at most
+ * HTTP_TIMEOUT_MS per step rather than hanging the caller.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifdef HAVE_OPENSSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#include "http_client.h"
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+int http_client_init(http_client_t *c, const char *url) {
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+    if (!url) return -1;
+
+    if (strncmp(url, "http://", 7) == 0) {
+        url += 7;
+        c->port = 80;
+    } else if (strncmp(url, "https://", 8) == 0) {
+#ifndef HAVE_OPENSSL
+        return -1;
+#endif
+        url += 8;
+        c->port = 443;
+        c->tls = 1;
+    } else {
+        return -1;
+    }
+
+    size_t host_len = strcspn(url, ":/?#");
+    if (host_len == 0 || host_len >= sizeof(c->host)) return -1;
+    memcpy(c->host, url, host_len);
+    url += host_len;
+
+    if (*url == ':') {
+        char *end;
+        long port = strtol(url + 1, &end, 10);
+        if (end == url + 1 || port <= 0 || port > 65535) return -1;
+        c->port = (int)port;
+        url = end;
+    }
+
+    if (*url == '\0' || *url == '#') {
+        snprintf(c->path, sizeof(c->path), "/");
+    } else if (*url == '/' || *url == '?') {
+        size_t path_len = strcspn(url, "#");
+        if (path_len + 2 > sizeof(c->path)) return -1;
+        snprintf(c->path, sizeof(c->path), "%s%.*s", *url == '?' ? "/" : "", (int)path_len, url);
+    } else {
+        return -1;
+    }
+
+#if !defined(MSG_NOSIGNAL) && !defined(SO_NOSIGPIPE)
+    /* A server closing the connection must not kill the process */
+    signal(SIGPIPE, SIG_IGN);
+#elif defined(HAVE_OPENSSL) && !defined(SO_NOSIGPIPE)
+    /* OpenSSL writes with write(), which has no per-call flag */
+    if (c->tls) signal(SIGPIPE, SIG_IGN);
+#endif
+    return 0;
+}
+
+/* ============================================================
+ * Connection
+ * ============================================================ */
+
+/* Connect with a timeout to the first address that answers */
+static int open_socket(const http_client_t *c) {
+    struct addrinfo hints, *res, *ai;
+    char port[16];
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(port, sizeof(port), "%d", c->port);
+    if (getaddrinfo(c->host, port, &hints, &res) != 0) return -1;
+
+    for (ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM, 0);
+        if (fd < 0) continue;
+
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            int err = 0;
+            socklen_t err_len = sizeof(err);
+            if (poll(&pfd, 1, HTTP_TIMEOUT_MS) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0 && err == 0) {
+                rc = 0;
+            }
+        }
+        if (rc < 0) {
+            close(fd);
+            fd = -1;
+            continue;
+        }
+        fcntl(fd, F_SETFL, flags);
+    }
+    freeaddrinfo(res);
+    if (fd < 0) return -1;
+
+    struct timeval tv = { HTTP_TIMEOUT_MS / 1000, (HTTP_TIMEOUT_MS % 1000) * 1000 };
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    /* Headers and body go out as separate writes */
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    return fd;
+}
+
+#ifdef HAVE_OPENSSL
+static int tls_start(http_client_t *c) {
+    if (!c->ssl_ctx) {
+        SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+        if (!ctx) return -1;
+        SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+        SSL_CTX_set_default_verify_paths(ctx);
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+        /* A close without close_notify reads as end of data, as on plain TCP */
+        SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+        c->ssl_ctx = ctx;
+    }
+
+    SSL *ssl = SSL_new(c->ssl_ctx);
+    if (!ssl) return -1;
+    SSL_set_fd(ssl, c->fd);
+    SSL_set_tlsext_host_name(ssl, c->host);
+    SSL_set1_host(ssl, c->host);
+    if (SSL_connect(ssl) != 1) {
+        ERR_clear_error();
+        SSL_free(ssl);
+        return -1;
+    }
+    c->ssl = ssl;
+    return 0;
+}
+#endif
+
+static int open_connection(http_client_t *c) {
+    c->fd = open_socket(c);
+    if (c->fd < 0) return -1;
+
+#ifdef HAVE_OPENSSL
+    if (c->tls && tls_start(c) != 0) {
+        close(c->fd);
+        c->fd = -1;
+        return -1;
+    }
+#endif
+    c->connects++;
+    return 0;
+}
+
+static void disconnect(http_client_t *c) {
+#ifdef HAVE_OPENSSL
+    if (c->ssl) {
+        SSL_shutdown(c->ssl);
+        SSL_free(c->ssl);
+        ERR_clear_error();
+        c->ssl = NULL;
+    }
+#endif
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+}
+
+/* A server sends nothing between responses: readable means it closed */
+static int server_gone(const http_client_t *c) {
+    struct pollfd pfd = { c->fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) != 0;
+}
+
+/* ============================================================
+ * I/O
+ * ============================================================ */
+
+/* Bytes read, 0 if the server closed (EOF or reset), -1 on timeout or error */
+static ssize_t io_read(http_client_t *c, char *dst, size_t cap) {
+#ifdef HAVE_OPENSSL
+    if (c->ssl) {
+        errno = 0;
+        int n = SSL_read(c->ssl, dst, cap > 65536 ? 65536 : (int)cap);
+        if (n > 0) return n;
+        int saved = errno;
+        int err = SSL_get_error(c->ssl, n);
+        if (err == SSL_ERROR_ZERO_RETURN ||
+            (err == SSL_ERROR_SYSCALL && (saved == 0 || saved == ECONNRESET))) {
+            return 0;
+        }
+        return -1;
+    }
+#endif
+    for (;;) {
+        ssize_t n = recv(c->fd, dst, cap, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == ECONNRESET) return 0;
+        return n;
+    }
+}
+
+static int io_write(http_client_t *c, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n;
+#ifdef HAVE_OPENSSL
+        if (c->ssl) {
+            n = SSL_write(c->ssl, data, len > 65536 ? 65536 : (int)len);
+        } else
+#endif
+        n = send(c->fd, data, len, SEND_FLAGS);
+        if (n < 0 && errno == EINTR && !c->ssl) continue;
+        if (n <= 0) return -1;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* Read more into the buffer, keeping what is still unread */
+static int fill(http_client_t *c) {
+    if (c->buf_pos > 0) {
+        memmove(c->buf, c->buf + c->buf_pos, c->buf_len - c->buf_pos);
+        c->buf_len -= c->buf_pos;
+        c->buf_pos = 0;
+    }
+    if (c->buf_len == sizeof(c->buf)) return -1;
+
+    ssize_t n = io_read(c, c->buf + c->buf_len, sizeof(c->buf) - c->buf_len);
+    if (n == 0) c->peer_closed = 1;
+    if (n <= 0) return -1;
+    c->response_started = 1;
+    c->buf_len += (size_t)n;
+    return 0;
+}
+
+/* Next line, without its line ending; NULL at end of data or if too long */
+static char* read_line(http_client_t *c) {
+    for (;;) {
+        char *start = c->buf + c->buf_pos;
+        char *nl = memchr(start, '\n', c->buf_len - c->buf_pos);
+        if (nl) {
+            size_t len = (size_t)(nl - start);
+            c->buf_pos += len + 1;
+            if (len > 0 && start[len - 1] == '\r') len--;
+            start[len] = '\0';
+            return start;
+        }
+        if (fill(c) != 0) return NULL;
+    }
+}
+
+static int skip_bytes(http_client_t *c, unsigned long long n) {
+    while (n > 0) {
+        if (c->buf_pos == c->buf_len) {
+            c->buf_pos = c->buf_len = 0;
+            if (fill(c) != 0) return -1;
+        }
+        size_t avail = c->buf_len - c->buf_pos;
+        size_t take = n < avail ? (size_t)n : avail;
+        c->buf_pos += take;
+        n -= take;
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Response
+ * ============================================================ */
+
+/* Case-insensitive search for a token in a header value */
+static int has_token(const char *value, const char *token) {
+    size_t len = strlen(token);
+    for (; *value; value++) {
+        if (strncasecmp(value, token, len) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Status line and headers, then the body skipped; returns the status or -1 */
+static int read_response(http_client_t *c, int *keep_alive) {
+    int status, minor;
+    long long length;
+    int chunked;
+    char *line;
+
+    c->buf_pos = c->buf_len = 0;
+    do {
+        line = read_line(c);
+        if (!line || sscanf(line, "HTTP/1.%d %d", &minor, &status) != 2) return -1;
+        *keep_alive = minor >= 1;
+        length = -1;
+        chunked = 0;
+
+        while ((line = read_line(c)) != NULL && line[0]) {
+            char *value = strchr(line, ':');
+            if (!value) continue;
+            *value++ = '\0';
+            while (*value == ' ' || *value == '\t') value++;
+
+            if (strcasecmp(line, "Content-Length") == 0) {
+                length = strtoll(value, NULL, 10);
+            } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+                chunked = has_token(value, "chunked");
+            } else if (strcasecmp(line, "Connection") == 0) {
+                if (has_token(value, "close")) *keep_alive = 0;
+                else if (has_token(value, "keep-alive")) *keep_alive = 1;
+            }
+        }
+        if (!line) return -1;
+    } while (status >= 100 && status < 200);    /* 100 Continue and the like */
+
+    if (status == 204 || status == 304) return status;
+
+    if (chunked) {
+        for (;;) {
+            line = read_line(c);
+            if (!line) return -1;
+            unsigned long long size = strtoull(line, NULL, 16);
+            if (size == 0) break;
+            if (skip_bytes(c, size) != 0 || !read_line(c)) return -1;
+        }
+        /* Trailers, up to the blank line */
+        while ((line = read_line(c)) != NULL && line[0]) {}
+        if (!line) return -1;
+    } else if (length >= 0) {
+        if (skip_bytes(c, (unsigned long long)length) != 0) return -1;
+    } else {
+        /* Body delimited by the server closing */
+        do {
+            c->buf_pos = c->buf_len = 0;
+        } while (fill(c) == 0);
+        *keep_alive = 0;
+    }
+    return status;
+}
+
+/* ============================================================
+ * Public API
+ * ============================================================ */
+
+int http_client_post(http_client_t *c, const char *content_type,
+                     const char *body, size_t len) {
+    char head[2048];
+    char port[16] = "";
+
+    if ((c->tls && c->port != 443) || (!c->tls && c->port != 80)) {
+        snprintf(port, sizeof(port), ":%d", c->port);
+    }
+    int head_len = snprintf(head, sizeof(head),
+                            "POST %s HTTP/1.1\r\n"
+                            "Host: %s%s\r\n"
+                            "User-Agent: C-Sentinel\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %lu\r\n"
+                            "Connection: keep-alive\r\n"
+                            "\r\n",
+                            c->path, c->host, port, content_type, (unsigned long)len);
+    if (head_len < 0 || head_len >= (int)sizeof(head)) return -1;
+    c->requests++;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int reused = c->fd >= 0;
+        if (reused && server_gone(c)) {
+            disconnect(c);
+            reused = 0;
+        }
+        if (c->fd < 0 && open_connection(c) != 0) break;
+
+        int keep_alive = 0;
+        int status = -1;
+        c->response_started = c->peer_closed = 0;
+        int head_sent = io_write(c, head, (size_t)head_len) == 0;
+        if (head_sent && io_write(c, body, len) == 0) {
+            status = read_response(c, &keep_alive);
+        }
+        if (status > 0) {
+            if (!keep_alive) disconnect(c);
+            return status;
+        }
+        disconnect(c);
+
+        /*
+         * Only a reused connection gets a second try: it may have gone
+         * stale. Even then, resend only if the server cannot have taken
+         * the request - the head never went out, or it closed without a
+         * byte of reply. After a timeout it may have handled it already.
+         */
+        if (!reused) break;
+        if (head_sent && (c->response_started || !c->peer_closed)) break;
+    }
+    c->failures++;
+    return -1;
+}
+
+void http_client_close(http_client_t *c) {
+    disconnect(c);
+#ifdef HAVE_OPENSSL
+    if (c->ssl_ctx) SSL_CTX_free(c->ssl_ctx);
+#endif
+    c->ssl_ctx = NULL;
+}
@@ -0,0 +1,220 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * json_load.c - Read fingerprint JSON back into a fingerprint_t
+ *
+ * The inverse of json_serialize.c, so tools can work on structures
+ * instead of searching the text for keys. Units are converted back
+ * (days to seconds, GB to bytes); the precision JSON rounded away
+ * stays lost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sentinel.h"
+#include "json_reader.h"
+
+#define GB (1024.0 * 1024.0 * 1024.0)
+#define MB (1024.0 * 1024.0)
+
+static const char* str_member(const json_value_t *obj, const char *key) {
+    return json_as_string(json_member(obj, key), "");
+}
+
+static double num_member(const json_value_t *obj, const char *key) {
+    return json_as_number(json_member(obj, key), 0);
+}
+
+static void copy_field(char *dst, size_t size, const char *src) {
+    snprintf(dst, size, "%s", src);
+}
+
+/* "2025-01-31T12:00:00Z" as written by format_iso_time(); 0 if malformed */
+static time_t parse_iso_time(const char *s) {
+    int y, mo, d, h, mi, sec;
+    if (sscanf(s, "%4d-%2d-%2dT%2d:%2d:%2dZ", &y, &mo, &d, &h, &mi, &sec) != 6) return 0;
+
+    /* Days since the epoch for a proleptic Gregorian date (timegm is not C99) */
+    y -= mo <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153L * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long days = era * 146097 + doe - 719468;
+
+    return (time_t)(days * 86400L + h * 3600L + mi * 60L + sec);
+}
+
+/* ============================================================
+ * Sections
+ * ============================================================ */
+
+static void load_system(fingerprint_t *fp, const json_value_t *root) {
+    const json_value_t *sys = json_member(root, "system");
+    system_info_t *info = &fp->system;
+
+    copy_field(info->hostname, sizeof(info->hostname), str_member(sys, "hostname"));
+    copy_field(info->kernel_version, sizeof(info->kernel_version), str_member(sys, "kernel"));
+    info->probe_time = parse_iso_time(str_member(root, "probe_time"));
+    info->uptime_seconds = (uint64_t)(num_member(sys, "uptime_days") * 86400.0);
+    info->boot_time = info->probe_time - (time_t)info->uptime_seconds;
+    info->total_ram = (uint64_t)(num_member(sys, "memory_total_gb") * GB);
+    info->free_ram = (uint64_t)(num_member(sys, "memory_free_gb") * GB);
+
+    const json_value_t *load = json_member(sys, "load_average");
+    if (load && load->type == JSON_ARRAY) {
+        const json_value_t *v = load->child;
+        for (int i = 0; i < 3 && v; i++, v = v->next) {
+            info->load_avg[i] = json_as_number(v, 0);
+        }
+    }
+
+    fp->probe_duration_ms = num_member(root, "probe_duration_ms");
+    fp->probe_errors = (int)num_member(root, "probe_errors");
+}
+
+static int load_processes(fingerprint_t *fp, const json_value_t *root) {
+    const json_value_t *summary = json_member(root, "process_summary");
+    const json_value_t *list = json_member(summary, "notable_processes");
+    int total = (int)num_member(summary, "total_count");
+    int count = (list && list->type == JSON_ARRAY) ? list->count : 0;
+
+    if (count > 0) {
+        fp->processes = arena_alloc(&fp->arena, count * sizeof(process_info_t));
+        if (!fp->processes) return -1;
+    }
+
+    int n = 0;
+    for (const json_value_t *v = count ? list->child : NULL; v; v = v->next) {
+        process_info_t *p = &fp->processes[n++];
+        memset(p, 0, sizeof(*p));
+        p->pid = (pid_t)num_member(v, "pid");
+        p->name = arena_intern(&fp->arena, str_member(v, "name"));
+        p->state = str_member(v, "state")[0];
+        p->age_seconds = (uint64_t)(num_member(v, "age_days") * 86400.0);
+        p->start_time = fp->system.probe_time - (time_t)p->age_seconds;
+        p->rss_bytes = (uint64_t)(num_member(v, "memory_mb") * MB);
+        /* -1 (unreadable) goes back to the wrapped uint32 the prober stores */
+        p->open_fd_count = (uint32_t)(int)num_member(v, "open_fds");
+        p->thread_count = (uint32_t)(int)num_member(v, "threads");
+        p->is_potentially_stuck = strcmp(str_member(v, "flag"), "potentially_stuck") == 0;
+    }
+    fp->process_count = n;
+    fp->processes_unlisted = total > n ? total - n : 0;
+    return 0;
+}
+
+static int load_configs(fingerprint_t *fp, const json_value_t *root) {
+    const json_value_t *list = json_member(root, "config_files");
+    if (!list || list->type != JSON_ARRAY || list->count == 0) return 0;
+
+    fp->configs = arena_alloc(&fp->arena, list->count * sizeof(config_file_t));
+    if (!fp->configs) return -1;
+
+    for (const json_value_t *v = list->child; v; v = v->next) {
+        config_file_t *c = &fp->configs[fp->config_count++];
+        memset(c, 0, sizeof(*c));
+        c->path = arena_intern(&fp->arena, str_member(v, "path"));
+        c->size = (uint64_t)num_member(v, "size_bytes");
+        c->mtime = parse_iso_time(str_member(v, "modified"));
+        c->permissions = (mode_t)strtoul(str_member(v, "permissions"), NULL, 8);
+        c->owner = (uid_t)num_member(v, "owner_uid");
+        copy_field(c->checksum, sizeof(c->checksum), str_member(v, "checksum"));
+    }
+
+    const json_value_t *cache = json_member(root, "config_hash_cache");
+    fp->config_cache_hits = (int)num_member(cache, "hits");
+    fp->config_cache_misses = (int)num_member(cache, "misses");
+    return 0;
+}
+
+static int load_network(fingerprint_t *fp, const json_value_t *root) {
+    const json_value_t *net = json_member(root, "network");
+    network_info_t *n = &fp->network;
+    if (!net) return 0;
+
+    copy_field(n->backend, sizeof(n->backend), str_member(net, "backend"));
+    n->total_listening = (int)num_member(net, "total_listeners");
+    n->total_established = (int)num_member(net, "total_established");
+    n->unusual_port_count = (int)num_member(net, "unusual_ports");
+    n->owner_index_ms = num_member(net, "owner_index_ms");
+    n->owner_lookup_ms = num_member(net, "owner_lookup_ms");
+
+    const json_value_t *list = json_member(net, "listeners");
+    if (list && list->type == JSON_ARRAY && list->count > 0) {
+        n->listeners = arena_alloc(&fp->arena, list->count * sizeof(net_listener_t));
+        if (!n->listeners) return -1;
+        n->listener_capacity = list->count;
+        for (const json_value_t *v = list->child; v; v = v->next) {
+            net_listener_t *l = &n->listeners[n->listener_count++];
+            memset(l, 0, sizeof(*l));
+            l->protocol = arena_intern(&fp->arena, str_member(v, "protocol"));
+            l->local_addr = arena_intern(&fp->arena, str_member(v, "address"));
+            l->local_port = (uint16_t)num_member(v, "port");
+            l->state = arena_intern(&fp->arena, "LISTEN");
+            l->pid = (pid_t)num_member(v, "pid");
+            l->process_name = arena_intern(&fp->arena, str_member(v, "process"));
+        }
+    }
+
+    list = json_member(net, "connections");
+    if (list && list->type == JSON_ARRAY && list->count > 0) {
+        n->connections = arena_alloc(&fp->arena, list->count * sizeof(net_connection_t));
+        if (!n->connections) return -1;
+        n->connection_capacity = list->count;
+        for (const json_value_t *v = list->child; v; v = v->next) {
+            net_connection_t *c = &n->connections[n->connection_count++];
+            memset(c, 0, sizeof(*c));
+            c->protocol = arena_intern(&fp->arena, str_member(v, "protocol"));
+            c->local_addr = arena_intern(&fp->arena, str_member(v, "local_addr"));
+            c->local_port = (uint16_t)num_member(v, "local_port");
+            c->remote_addr = arena_intern(&fp->arena, str_member(v, "remote_addr"));
+            c->remote_port = (uint16_t)num_member(v, "remote_port");
+            c->state = arena_intern(&fp->arena, str_member(v, "state"));
+            c->pid = (pid_t)num_member(v, "pid");
+            c->process_name = arena_intern(&fp->arena, str_member(v, "process"));
+        }
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Public Interface
+ * ============================================================ */
+
+int fingerprint_from_json(fingerprint_t *fp, const char *json, size_t len) {
+    arena_t tree;
+    int result = -1;
+
+    memset(fp, 0, sizeof(*fp));
+    arena_init(&fp->arena);
+    arena_init(&tree);
+
+    const json_value_t *root = json_parse(&tree, json, len, NULL);
+
+    /* A delta only makes sense on top of its keyframe */
+    if (root && root->type == JSON_OBJECT && json_member(root, "system") &&
+        strcmp(json_as_string(json_member(root, "type"), "keyframe"), "keyframe") == 0) {
+        load_system(fp, root);
+        if (load_processes(fp, root) == 0 &&
+            load_configs(fp, root) == 0 &&
+            load_network(fp, root) == 0) {
+            result = 0;
+        }
+    }
+
+    arena_free(&tree);
+    if (result != 0) {
+        arena_free(&fp->arena);
+        memset(fp, 0, sizeof(*fp));
+    }
+    return result;
+}
@@ -0,0 +1,292 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * json_reader.c - Recursive-descent JSON parser
+ *
+ * Strict RFC 8259 apart from accepting any top-level value. Nesting
+ * is capped so a hostile document cannot exhaust the stack.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_reader.h"
+
+typedef struct {
+    arena_t *arena;
+    const char *p;
+    const char *end;
+    int depth;
+} parser_t;
+
+static json_value_t* parse_value(parser_t *ps);
+
+static void skip_space(parser_t *ps) {
+    while (ps->p < ps->end &&
+           (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r')) {
+        ps->p++;
+    }
+}
+
+static json_value_t* new_value(parser_t *ps, json_type_t type) {
+    json_value_t *v = arena_alloc(ps->arena, sizeof(*v));
+    if (v) {
+        memset(v, 0, sizeof(*v));
+        v->type = type;
+    }
+    return v;
+}
+
+static int literal(parser_t *ps, const char *word) {
+    size_t n = strlen(word);
+    if ((size_t)(ps->end - ps->p) < n || memcmp(ps->p, word, n) != 0) return 0;
+    ps->p += n;
+    return 1;
+}
+
+/* ============================================================
+ * Scalars
+ * ============================================================ */
+
+static int hex4(const char *p, unsigned *out) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= (unsigned)(c - 'A' + 10);
+        else return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+static size_t put_utf8(char *out, unsigned cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    } else if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* ps->p is on the opening quote; result is NUL-terminated in the arena */
+static const char* parse_string(parser_t *ps) {
+    const char *start = ++ps->p;
+    size_t raw = 0;
+
+    /* Find the closing quote first: the decoded form is never longer */
+    while (start + raw < ps->end && start[raw] != '"') {
+        if ((unsigned char)start[raw] < 0x20) return NULL;
+        raw += (start[raw] == '\\') ? 2 : 1;
+    }
+    if (start + raw >= ps->end) return NULL;
+
+    char *out = arena_alloc(ps->arena, raw + 1);
+    if (!out) return NULL;
+
+    size_t n = 0;
+    const char *p = start, *stop = start + raw;
+    while (p < stop) {
+        if (*p != '\\') {
+            out[n++] = *p++;
+            continue;
+        }
+        p++;
+        switch (*p++) {
+            case '"':  out[n++] = '"';  break;
+            case '\\': out[n++] = '\\'; break;
+            case '/':  out[n++] = '/';  break;
+            case 'b':  out[n++] = '\b'; break;
+            case 'f':  out[n++] = '\f'; break;
+            case 'n':  out[n++] = '\n'; break;
+            case 'r':  out[n++] = '\r'; break;
+            case 't':  out[n++] = '\t'; break;
+            case 'u': {
+                unsigned cp, lo;
+                if (stop - p < 4 || hex4(p, &cp) != 0) return NULL;
+                p += 4;
+                /* Surrogate pair; a lone half becomes U+FFFD */
+                if (cp >= 0xD800 && cp <= 0xDBFF && stop - p >= 6 &&
+                    p[0] == '\\' && p[1] == 'u' && hex4(p + 2, &lo) == 0 &&
+                    lo >= 0xDC00 && lo <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+                    cp = 0xFFFD;
+                }
+                /* \uXXXX is 6 bytes in; UTF-8 out is at most 4 */
+                n += put_utf8(out + n, cp);
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+    out[n] = '\0';
+    ps->p = stop + 1;
+    return out;
+}
+
+static json_value_t* parse_number(parser_t *ps) {
+    const char *start = ps->p;
+    const char *p = ps->p;
+
+    if (p < ps->end && *p == '-') p++;
+    if (p >= ps->end || *p < '0' || *p > '9') return NULL;
+    while (p < ps->end && ((*p >= '0' && *p <= '9') || *p == '.' ||
+                           *p == 'e' || *p == 'E' || *p == '+' || *p == '-')) {
+        p++;
+    }
+
+    /* Text need not be NUL-terminated, so strtod works on a copy */
+    char buf[64];
+    size_t n = (size_t)(p - start);
+    if (n >= sizeof(buf)) return NULL;
+    memcpy(buf, start, n);
+    buf[n] = '\0';
+
+    char *end;
+    double d = strtod(buf, &end);
+    if (end != buf + n) return NULL;
+
+    json_value_t *v = new_value(ps, JSON_NUMBER);
+    if (v) v->number = d;
+    ps->p = p;
+    return v;
+}
+
+/* ============================================================
+ * Containers
+ * ============================================================ */
+
+static json_value_t* parse_container(parser_t *ps, json_type_t type) {
+    char close = (type == JSON_OBJECT) ? '}' : ']';
+    json_value_t *v = new_value(ps, type);
+    if (!v || ++ps->depth > JSON_READER_MAX_DEPTH) return NULL;
+
+    ps->p++;
+    skip_space(ps);
+    if (ps->p < ps->end && *ps->p == close) {
+        ps->p++;
+        ps->depth--;
+        return v;
+    }
+
+    json_value_t **tail = &v->child;
+    for (;;) {
+        const char *key = NULL;
+        skip_space(ps);
+        if (type == JSON_OBJECT) {
+            if (ps->p >= ps->end || *ps->p != '"') return NULL;
+            if (!(key = parse_string(ps))) return NULL;
+            skip_space(ps);
+            if (ps->p >= ps->end || *ps->p != ':') return NULL;
+            ps->p++;
+        }
+
+        json_value_t *item = parse_value(ps);
+        if (!item) return NULL;
+        item->key = key;
+        *tail = item;
+        tail = &item->next;
+        v->count++;
+
+        skip_space(ps);
+        if (ps->p >= ps->end) return NULL;
+        if (*ps->p == ',') {
+            ps->p++;
+            continue;
+        }
+        if (*ps->p != close) return NULL;
+        ps->p++;
+        ps->depth--;
+        return v;
+    }
+}
+
+static json_value_t* parse_value(parser_t *ps) {
+    json_value_t *v;
+
+    skip_space(ps);
+    if (ps->p >= ps->end) return NULL;
+
+    switch (*ps->p) {
+        case '{':
+            return parse_container(ps, JSON_OBJECT);
+        case '[':
+            return parse_container(ps, JSON_ARRAY);
+        case '"': {
+            const char *s = parse_string(ps);
+            if (!s || !(v = new_value(ps, JSON_STRING))) return NULL;
+            v->string = s;
+            return v;
+        }
+        case 't':
+        case 'f': {
+            int truth = (*ps->p == 't');
+            if (!literal(ps, truth ? "true" : "false")) return NULL;
+            if ((v = new_value(ps, JSON_BOOL))) v->number = truth;
+            return v;
+        }
+        case 'n':
+            if (!literal(ps, "null")) return NULL;
+            return new_value(ps, JSON_NULL);
+        default:
+            return parse_number(ps);
+    }
+}
+
+/* ============================================================
+ * Public Interface
+ * ============================================================ */
+
+json_value_t* json_parse(arena_t *a, const char *text, size_t len, size_t *error_offset) {
+    parser_t ps = { a, text, text + len, 0 };
+
+    json_value_t *root = parse_value(&ps);
+    if (root) {
+        skip_space(&ps);
+        if (ps.p != ps.end) root = NULL;     /* Trailing garbage */
+    }
+    if (!root && error_offset) *error_offset = (size_t)(ps.p - text);
+    return root;
+}
+
+const json_value_t* json_member(const json_value_t *obj, const char *key) {
+    if (!obj || obj->type != JSON_OBJECT) return NULL;
+    for (const json_value_t *m = obj->child; m; m = m->next) {
+        if (strcmp(m->key, key) == 0) return m;
+    }
+    return NULL;
+}
+
+double json_as_number(const json_value_t *v, double fallback) {
+    if (!v || (v->type != JSON_NUMBER && v->type != JSON_BOOL)) return fallback;
+    return v->number;
+}
+
+const char* json_as_string(const json_value_t *v, const char *fallback) {
+    if (!v || v->type != JSON_STRING) return fallback;
+    return v->string;
+}
@@ -8,111 +8,19 @@
  * https://github.com/williamofai/c-sentinel
  *
  * json_serialize.c - Convert fingerprints to JSON for LLM analysis
+ *
+ * Sections are written straight into a json_writer_t, so a document
+ * streams to its destination through one fixed buffer however many
+ * processes and sockets the host has.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 #include <time.h>
 
 #include "sentinel.h"
-
-/* Buffer growth settings */
-#define INITIAL_BUF_SIZE 8192
-#define BUF_GROW_FACTOR 2
-
-/* Dynamic buffer for JSON construction */
-typedef struct {
-    char *data;
-    size_t size;
-    size_t capacity;
-} json_buffer_t;
-
-static int buf_init(json_buffer_t *buf) {
-    buf->data = malloc(INITIAL_BUF_SIZE);
-    if (!buf->data) return -1;
-    buf->data[0] = '\0';
-    buf->size = 0;
-    buf->capacity = INITIAL_BUF_SIZE;
-    return 0;
-}
-
-static int buf_ensure(json_buffer_t *buf, size_t additional) {
-    if (buf->size + additional < buf->capacity) return 0;
-    
-    size_t new_cap = buf->capacity;
-    while (new_cap < buf->size + additional) {
-        new_cap *= BUF_GROW_FACTOR;
-    }
-    
-    char *new_data = realloc(buf->data, new_cap);
-    if (!new_data) return -1;
-    
-    buf->data = new_data;
-    buf->capacity = new_cap;
-    return 0;
-}
-
-static int buf_append(json_buffer_t *buf, const char *str) {
-    size_t len = strlen(str);
-    if (buf_ensure(buf, len + 1) != 0) return -1;
-    
-    memcpy(buf->data + buf->size, str, len + 1);
-    buf->size += len;
-    return 0;
-}
-
-static int buf_appendf(json_buffer_t *buf, const char *fmt, ...) {
-    char tmp[1024];
-    va_list args;
-    va_start(args, fmt);
-    int len = vsnprintf(tmp, sizeof(tmp), fmt, args);
-    va_end(args);
-    
-    if (len < 0) return -1;
-    if ((size_t)len >= sizeof(tmp)) {
-        /* Need larger buffer */
-        char *large = malloc(len + 1);
-        if (!large) return -1;
-        va_start(args, fmt);
-        vsnprintf(large, len + 1, fmt, args);
-        va_end(args);
-        int result = buf_append(buf, large);
-        free(large);
-        return result;
-    }
-    
-    return buf_append(buf, tmp);
-}
-
-/* Escape a string for JSON */
-static int buf_append_json_string(json_buffer_t *buf, const char *str) {
-    if (buf_append(buf, "\"") != 0) return -1;
-    
-    for (const char *p = str; *p; p++) {
-        char escaped[8];
-        switch (*p) {
-            case '"':  strcpy(escaped, "\\\""); break;
-            case '\\': strcpy(escaped, "\\\\"); break;
-            case '\b': strcpy(escaped, "\\b"); break;
-            case '\f': strcpy(escaped, "\\f"); break;
-            case '\n': strcpy(escaped, "\\n"); break;
-            case '\r': strcpy(escaped, "\\r"); break;
-            case '\t': strcpy(escaped, "\\t"); break;
-            default:
-                if ((unsigned char)*p < 0x20) {
-                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*p);
-                } else {
-                    escaped[0] = *p;
-                    escaped[1] = '\0';
-                }
-        }
-        if (buf_append(buf, escaped) != 0) return -1;
-    }
-    
-    return buf_append(buf, "\"");
-}
+#include "json_writer.h"
 
 /* Format time as ISO 8601 */
 static void format_iso_time(time_t t, char *buf, size_t buf_size) {
@@ -120,211 +28,303 @@ static void format_iso_time(time_t t, char *buf, size_t buf_size) {
     strftime(buf, buf_size, "%Y-%m-%dT%H:%M:%SZ", tm);
 }
 
+/* Permission bits as the 4-digit octal string the schema has always used */
+static void format_mode(mode_t mode, char out[5]) {
+    mode &= 07777;
+    for (int i = 3; i >= 0; i--) {
+        out[i] = (char)('0' + (mode & 7));
+        mode >>= 3;
+    }
+    out[4] = '\0';
+}
+
 /* ============================================================
- * Main Serialization Function
+ * Sections - Shared by Full, Keyframe and Delta Documents
  * ============================================================ */
 
-char* fingerprint_to_json(const fingerprint_t *fp) {
-    if (!fp) return NULL;
-    
-    json_buffer_t buf;
-    if (buf_init(&buf) != 0) return NULL;
-    
+static void write_metadata(json_writer_t *w, const fingerprint_t *fp) {
     char time_buf[32];
-    
-    /* Root object */
-    buf_append(&buf, "{\n");
-    
-    /* Metadata */
-    buf_append(&buf, "  \"sentinel_version\": \"" SENTINEL_VERSION "\",\n");
+
     format_iso_time(fp->system.probe_time, time_buf, sizeof(time_buf));
-    buf_appendf(&buf, "  \"probe_time\": \"%s\",\n", time_buf);
-    buf_appendf(&buf, "  \"probe_duration_ms\": %.2f,\n", fp->probe_duration_ms);
-    buf_appendf(&buf, "  \"probe_errors\": %d,\n", fp->probe_errors);
-    
-    /* System info */
-    buf_append(&buf, "  \"system\": {\n");
-    buf_append(&buf, "    \"hostname\": ");
-    buf_append_json_string(&buf, fp->system.hostname);
-    buf_append(&buf, ",\n");
-    buf_append(&buf, "    \"kernel\": ");
-    buf_append_json_string(&buf, fp->system.kernel_version);
-    buf_append(&buf, ",\n");
-    buf_appendf(&buf, "    \"uptime_days\": %.2f,\n", 
-                fp->system.uptime_seconds / 86400.0);
-    buf_appendf(&buf, "    \"load_average\": [%.2f, %.2f, %.2f],\n",
-                fp->system.load_avg[0], fp->system.load_avg[1], fp->system.load_avg[2]);
-    buf_appendf(&buf, "    \"memory_total_gb\": %.2f,\n",
-                fp->system.total_ram / (1024.0 * 1024.0 * 1024.0));
-    buf_appendf(&buf, "    \"memory_free_gb\": %.2f,\n",
-                fp->system.free_ram / (1024.0 * 1024.0 * 1024.0));
-    buf_appendf(&buf, "    \"memory_used_percent\": %.1f\n",
-                100.0 * (1.0 - (double)fp->system.free_ram / fp->system.total_ram));
-    buf_append(&buf, "  },\n");
-    
+    json_string(w, "probe_time", time_buf);
+    json_double(w, "probe_duration_ms", fp->probe_duration_ms, 2);
+    json_int(w, "probe_errors", fp->probe_errors);
+}
+
+static void write_system(json_writer_t *w, const fingerprint_t *fp) {
+    json_object_begin(w, "system");
+    json_string(w, "hostname", fp->system.hostname);
+    json_string(w, "kernel", fp->system.kernel_version);
+    json_double(w, "uptime_days", fp->system.uptime_seconds / 86400.0, 2);
+    json_array_begin_inline(w, "load_average");
+    for (int i = 0; i < 3; i++) {
+        json_double(w, NULL, fp->system.load_avg[i], 2);
+    }
+    json_array_end(w);
+    json_double(w, "memory_total_gb", fp->system.total_ram / (1024.0 * 1024.0 * 1024.0), 2);
+    json_double(w, "memory_free_gb", fp->system.free_ram / (1024.0 * 1024.0 * 1024.0), 2);
+    json_double(w, "memory_used_percent",
+                100.0 * (1.0 - (double)fp->system.free_ram / fp->system.total_ram), 1);
+    json_object_end(w);
+}
+
+static void write_process_summary(json_writer_t *w, const fingerprint_t *fp) {
     /* Process summary - we don't dump all processes, just interesting ones */
-    buf_append(&buf, "  \"process_summary\": {\n");
-    buf_appendf(&buf, "    \"total_count\": %d,\n", fp->process_count);
-    
+    json_object_begin(w, "process_summary");
+    json_int(w, "total_count", fp->process_count + fp->processes_unlisted);
+
     /* Find interesting processes */
     int zombie_count = 0;
     int high_fd_count = 0;
     int stuck_count = 0;
-    
-    buf_append(&buf, "    \"notable_processes\": [\n");
-    int first = 1;
-    
+
+    json_array_begin(w, "notable_processes");
+
     for (int i = 0; i < fp->process_count; i++) {
         const process_info_t *p = &fp->processes[i];
-        
+
         /* Only include "interesting" processes */
-        int interesting = 0;
-        const char *reason = "";
-        
+        const char *reason = NULL;
+
         if (p->state == 'Z') {
-            interesting = 1;
             reason = "zombie";
             zombie_count++;
         } else if (p->open_fd_count > 100 && p->open_fd_count < 100000) {
             /* Only flag if we could actually read FDs (uint32 -1 wraps to ~4 billion) */
-            interesting = 1;
             reason = "high_fd_count";
             high_fd_count++;
         } else if (p->is_potentially_stuck) {
-            interesting = 1;
             reason = "potentially_stuck";
             stuck_count++;
         } else if (p->age_seconds > 30 * 24 * 3600) {
-            interesting = 1;
             reason = "very_long_running";
         } else if (p->rss_bytes > 1024 * 1024 * 1024) {
-            interesting = 1;
             reason = "high_memory";
         }
-        
-        if (interesting) {
-            if (!first) buf_append(&buf, ",\n");
-            first = 0;
-            
-            buf_append(&buf, "      {\n");
-            buf_appendf(&buf, "        \"pid\": %d,\n", p->pid);
-            buf_append(&buf, "        \"name\": ");
-            buf_append_json_string(&buf, p->name);
-            buf_append(&buf, ",\n");
+
+        if (reason) {
             /* Handle unprintable state characters - only allow A-Z for process states */
-            char state_char;
+            char state[2] = { '?', '\0' };
             if (p->state >= 'A' && p->state <= 'Z') {
-                state_char = p->state;
-            } else if (p->state == '?') {
-                state_char = '?';
-            } else {
-                state_char = '?';  /* Force unknown for any other value */
+                state[0] = p->state;
             }
-            buf_appendf(&buf, "        \"state\": \"%c\",\n", state_char);
-            buf_appendf(&buf, "        \"age_days\": %.2f,\n", p->age_seconds / 86400.0);
-            buf_appendf(&buf, "        \"memory_mb\": %.1f,\n", p->rss_bytes / (1024.0 * 1024.0));
-            buf_appendf(&buf, "        \"open_fds\": %d,\n", p->open_fd_count);
-            buf_appendf(&buf, "        \"threads\": %d,\n", p->thread_count);
-            buf_append(&buf, "        \"flag\": ");
-            buf_append_json_string(&buf, reason);
-            buf_append(&buf, "\n");
-            buf_append(&buf, "      }");
+
+            json_object_begin(w, NULL);
+            json_int(w, "pid", p->pid);
+            json_string(w, "name", p->name);
+            json_string(w, "state", state);
+            json_double(w, "age_days", p->age_seconds / 86400.0, 2);
+            json_double(w, "memory_mb", p->rss_bytes / (1024.0 * 1024.0), 1);
+            json_int(w, "open_fds", (int)p->open_fd_count);
+            json_int(w, "threads", (int)p->thread_count);
+            json_string(w, "flag", reason);
+            json_object_end(w);
         }
     }
-    
-    buf_append(&buf, "\n    ],\n");
-    buf_appendf(&buf, "    \"zombie_count\": %d,\n", zombie_count);
-    buf_appendf(&buf, "    \"high_fd_count\": %d,\n", high_fd_count);
-    buf_appendf(&buf, "    \"stuck_count\": %d\n", stuck_count);
-    buf_append(&buf, "  },\n");
-    
+
+    json_array_end(w);
+    json_int(w, "zombie_count", zombie_count);
+    json_int(w, "high_fd_count", high_fd_count);
+    json_int(w, "stuck_count", stuck_count);
+    json_object_end(w);
+}
+
+static void write_config(json_writer_t *w, const config_file_t *c) {
+    char time_buf[32];
+    char mode[5];
+
+    json_object_begin(w, NULL);
+    json_string(w, "path", c->path);
+    json_uint(w, "size_bytes", c->size);
+    format_iso_time(c->mtime, time_buf, sizeof(time_buf));
+    json_string(w, "modified", time_buf);
+    format_mode(c->permissions, mode);
+    json_string(w, "permissions", mode);
+    json_int(w, "owner_uid", c->owner);
+    json_string(w, "checksum", c->checksum);
+
+    /* Flag permission issues */
+    if (c->permissions & S_IWOTH) {
+        json_string(w, "warning", "world_writable");
+    }
+    json_object_end(w);
+}
+
+static void write_config_cache(json_writer_t *w, const fingerprint_t *fp) {
+    json_object_begin(w, "config_hash_cache");
+    json_int(w, "hits", fp->config_cache_hits);
+    json_int(w, "misses", fp->config_cache_misses);
+    json_object_end(w);
+}
+
+/* Scalar network fields, into the open "network" object */
+static void write_network_summary(json_writer_t *w, const fingerprint_t *fp) {
+    json_string(w, "backend", fp->network.backend);
+    json_int(w, "total_listeners", fp->network.total_listening);
+    json_int(w, "total_established", fp->network.total_established);
+    json_int(w, "unusual_ports", fp->network.unusual_port_count);
+    json_double(w, "owner_index_ms", fp->network.owner_index_ms, 3);
+    json_double(w, "owner_lookup_ms", fp->network.owner_lookup_ms, 3);
+}
+
+static void write_listener(json_writer_t *w, const net_listener_t *l) {
+    json_object_begin(w, NULL);
+    json_string(w, "protocol", l->protocol);
+    json_string(w, "address", l->local_addr);
+    json_int(w, "port", l->local_port);
+    json_int(w, "pid", l->pid);
+    json_string(w, "process", l->process_name);
+    json_object_end(w);
+}
+
+static void write_connection(json_writer_t *w, const net_connection_t *c) {
+    json_object_begin(w, NULL);
+    json_string(w, "protocol", c->protocol);
+    json_string(w, "local_addr", c->local_addr);
+    json_int(w, "local_port", c->local_port);
+    json_string(w, "remote_addr", c->remote_addr);
+    json_int(w, "remote_port", c->remote_port);
+    json_string(w, "state", c->state);
+    json_int(w, "pid", c->pid);
+    json_string(w, "process", c->process_name);
+    json_object_end(w);
+}
+
+/* ============================================================
+ * Main Serialization Functions
+ * ============================================================ */
+
+/* Full document members; keyframes (sequence > 0) are tagged for watch mode */
+void fingerprint_json_members(json_writer_t *w, const fingerprint_t *fp,
+                              unsigned long sequence) {
+    /* Metadata */
+    json_string(w, "sentinel_version", SENTINEL_VERSION);
+    if (sequence > 0) {
+        json_string(w, "type", "keyframe");
+        json_uint(w, "sequence", sequence);
+    }
+    write_metadata(w, fp);
+
+    write_system(w, fp);
+    write_process_summary(w, fp);
+
     /* Config files */
-    buf_append(&buf, "  \"config_files\": [\n");
+    json_array_begin(w, "config_files");
     for (int i = 0; i < fp->config_count; i++) {
-        const config_file_t *c = &fp->configs[i];
-        
-        if (i > 0) buf_append(&buf, ",\n");
-        
-        buf_append(&buf, "    {\n");
-        buf_append(&buf, "      \"path\": ");
-        buf_append_json_string(&buf, c->path);
-        buf_append(&buf, ",\n");
-        buf_appendf(&buf, "      \"size_bytes\": %lu,\n", (unsigned long)c->size);
-        format_iso_time(c->mtime, time_buf, sizeof(time_buf));
-        buf_appendf(&buf, "      \"modified\": \"%s\",\n", time_buf);
-        buf_appendf(&buf, "      \"permissions\": \"%04o\",\n", c->permissions & 07777);
-        buf_appendf(&buf, "      \"owner_uid\": %d,\n", c->owner);
-        buf_append(&buf, "      \"checksum\": ");
-        buf_append_json_string(&buf, c->checksum);
-        
-        /* Flag permission issues */
-        if (c->permissions & S_IWOTH) {
-            buf_append(&buf, ",\n      \"warning\": \"world_writable\"");
-        }
-        
-        buf_append(&buf, "\n    }");
+        write_config(w, &fp->configs[i]);
     }
-    buf_append(&buf, "\n  ],\n");
-    
+    json_array_end(w);
+    write_config_cache(w, fp);
+
     /* Network info */
-    buf_append(&buf, "  \"network\": {\n");
-    buf_appendf(&buf, "    \"total_listeners\": %d,\n", fp->network.total_listening);
-    buf_appendf(&buf, "    \"total_established\": %d,\n", fp->network.total_established);
-    buf_appendf(&buf, "    \"unusual_ports\": %d,\n", fp->network.unusual_port_count);
-    
-    /* Listeners */
-    buf_append(&buf, "    \"listeners\": [\n");
+    json_object_begin(w, "network");
+    write_network_summary(w, fp);
+
+    json_array_begin(w, "listeners");
     for (int i = 0; i < fp->network.listener_count; i++) {
-        const net_listener_t *l = &fp->network.listeners[i];
-        
-        if (i > 0) buf_append(&buf, ",\n");
-        
-        buf_append(&buf, "      {\n");
-        buf_append(&buf, "        \"protocol\": ");
-        buf_append_json_string(&buf, l->protocol);
-        buf_append(&buf, ",\n");
-        buf_append(&buf, "        \"address\": ");
-        buf_append_json_string(&buf, l->local_addr);
-        buf_append(&buf, ",\n");
-        buf_appendf(&buf, "        \"port\": %d,\n", l->local_port);
-        buf_appendf(&buf, "        \"pid\": %d,\n", l->pid);
-        buf_append(&buf, "        \"process\": ");
-        buf_append_json_string(&buf, l->process_name);
-        buf_append(&buf, "\n      }");
+        write_listener(w, &fp->network.listeners[i]);
     }
-    buf_append(&buf, "\n    ],\n");
-    
-    /* Connections */
-    buf_append(&buf, "    \"connections\": [\n");
+    json_array_end(w);
+
+    json_array_begin(w, "connections");
     for (int i = 0; i < fp->network.connection_count; i++) {
-        const net_connection_t *c = &fp->network.connections[i];
-        
-        if (i > 0) buf_append(&buf, ",\n");
-        
-        buf_append(&buf, "      {\n");
-        buf_append(&buf, "        \"protocol\": ");
-        buf_append_json_string(&buf, c->protocol);
-        buf_append(&buf, ",\n");
-        buf_append(&buf, "        \"local_addr\": ");
-        buf_append_json_string(&buf, c->local_addr);
-        buf_append(&buf, ",\n");
-        buf_appendf(&buf, "        \"local_port\": %d,\n", c->local_port);
-        buf_append(&buf, "        \"remote_addr\": ");
-        buf_append_json_string(&buf, c->remote_addr);
-        buf_append(&buf, ",\n");
-        buf_appendf(&buf, "        \"remote_port\": %d,\n", c->remote_port);
-        buf_append(&buf, "        \"state\": ");
-        buf_append_json_string(&buf, c->state);
-        buf_append(&buf, ",\n");
-        buf_appendf(&buf, "        \"pid\": %d,\n", c->pid);
-        buf_append(&buf, "        \"process\": ");
-        buf_append_json_string(&buf, c->process_name);
-        buf_append(&buf, "\n      }");
+        write_connection(w, &fp->network.connections[i]);
+    }
+    json_array_end(w);
+    json_object_end(w);
+}
+
+char* fingerprint_to_json(const fingerprint_t *fp) {
+    if (!fp) return NULL;
+
+    json_writer_t *w = malloc(sizeof(*w));
+    if (!w) return NULL;
+
+    json_writer_memory(w);
+    json_object_begin(w, NULL);
+    fingerprint_json_members(w, fp, 0);
+    json_object_end(w);
+
+    char *json = json_writer_take(w);
+    free(w);
+    return json;
+}
+
+/* ============================================================
+ * Delta Serialization
+ * ============================================================ */
+
+void fingerprint_delta_json_members(json_writer_t *w, const fingerprint_delta_t *d,
+                                    unsigned long sequence, unsigned long base_sequence) {
+    const fingerprint_t *fp = d->cur;
+
+    json_string(w, "sentinel_version", SENTINEL_VERSION);
+    json_string(w, "type", "delta");
+    json_uint(w, "sequence", sequence);
+    json_uint(w, "base_sequence", base_sequence);
+    json_int(w, "changes", d->changes);
+    write_metadata(w, fp);
+
+    /* Summaries are small; always sent whole */
+    write_system(w, fp);
+    write_process_summary(w, fp);
+
+    /* Processes: started in full, exited by pid */
+    json_array_begin(w, "processes_started");
+    for (int i = 0; i < d->started_count; i++) {
+        const process_info_t *p = &fp->processes[d->started[i]];
+        json_object_begin_inline(w, NULL);
+        json_int(w, "pid", p->pid);
+        json_int(w, "ppid", p->ppid);
+        json_string(w, "name", p->name);
+        json_object_end(w);
+    }
+    json_array_end(w);
+
+    json_array_begin_inline(w, "processes_exited");
+    for (int i = 0; i < d->exited_count; i++) {
+        json_int(w, NULL, d->prev->processes[d->exited[i]].pid);
+    }
+    json_array_end(w);
+
+    /* Config files: new or modified in full, removed by path */
+    json_array_begin(w, "config_files_changed");
+    for (int i = 0; i < d->configs_changed_count; i++) {
+        write_config(w, &fp->configs[d->configs_changed[i]]);
+    }
+    json_array_end(w);
+
+    json_array_begin_inline(w, "config_files_removed");
+    for (int i = 0; i < d->configs_removed_count; i++) {
+        json_string(w, NULL, d->prev->configs[d->configs_removed[i]].path);
+    }
+    json_array_end(w);
+    write_config_cache(w, fp);
+
+    /* Network: entries are keyed on every field, so removals are sent whole */
+    json_object_begin(w, "network");
+    write_network_summary(w, fp);
+
+    json_array_begin(w, "listeners_added");
+    for (int i = 0; i < d->listeners_added_count; i++) {
+        write_listener(w, &fp->network.listeners[d->listeners_added[i]]);
+    }
+    json_array_end(w);
+    json_array_begin(w, "listeners_removed");
+    for (int i = 0; i < d->listeners_removed_count; i++) {
+        write_listener(w, &d->prev->network.listeners[d->listeners_removed[i]]);
+    }
+    json_array_end(w);
+
+    json_array_begin(w, "connections_added");
+    for (int i = 0; i < d->connections_added_count; i++) {
+        write_connection(w, &fp->network.connections[d->connections_added[i]]);
+    }
+    json_array_end(w);
+    json_array_begin(w, "connections_removed");
+    for (int i = 0; i < d->connections_removed_count; i++) {
+        write_connection(w, &d->prev->network.connections[d->connections_removed[i]]);
     }
-    buf_append(&buf, "\n    ]\n");
-    buf_append(&buf, "  }\n");
-    
-    buf_append(&buf, "}\n");
-    
-    return buf.data;
+    json_array_end(w);
+    json_object_end(w);
 }
@@ -0,0 +1,334 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * json_writer.c - Streaming JSON output
+ *
+ * Numbers are formatted by hand rather than through printf: the
+ * fingerprint is mostly integers and fixed-precision doubles, and
+ * vsnprintf's format parsing was most of the serialization cost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "json_writer.h"
+
+/* ============================================================
+ * Buffer and Sinks
+ * ============================================================ */
+
+static void init(json_writer_t *w, json_sink_t sink) {
+    w->len = 0;
+    w->sink = sink;
+    w->fd = -1;
+    w->file = NULL;
+    w->mem = NULL;
+    w->mem_len = w->mem_cap = 0;
+    w->callback = NULL;
+    w->callback_ctx = NULL;
+    w->error = 0;
+    w->depth = 0;
+    w->members[0] = 0;
+    w->inline_depth = 0;
+}
+
+void json_writer_fd(json_writer_t *w, int fd) {
+    init(w, JSON_SINK_FD);
+    w->fd = fd;
+}
+
+void json_writer_file(json_writer_t *w, FILE *f) {
+    init(w, JSON_SINK_FILE);
+    w->file = f;
+}
+
+void json_writer_memory(json_writer_t *w) {
+    init(w, JSON_SINK_MEMORY);
+}
+
+void json_writer_callback(json_writer_t *w, json_sink_fn fn, void *ctx) {
+    init(w, JSON_SINK_CALLBACK);
+    w->callback = fn;
+    w->callback_ctx = ctx;
+}
+
+static void flush(json_writer_t *w) {
+    if (w->len == 0) return;
+
+    switch (w->sink) {
+        case JSON_SINK_FD: {
+            size_t off = 0;
+            while (off < w->len) {
+                ssize_t n = write(w->fd, w->buf + off, w->len - off);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    w->error = 1;
+                    break;
+                }
+                off += (size_t)n;
+            }
+            break;
+        }
+        case JSON_SINK_FILE:
+            if (fwrite(w->buf, 1, w->len, w->file) != w->len) w->error = 1;
+            break;
+        case JSON_SINK_MEMORY:
+            if (w->mem_len + w->len + 1 > w->mem_cap) {
+                size_t cap = w->mem_cap ? w->mem_cap : JSON_WRITER_BUF_SIZE;
+                while (cap < w->mem_len + w->len + 1) cap *= 2;
+                char *grown = realloc(w->mem, cap);
+                if (!grown) {
+                    w->error = 1;
+                    break;
+                }
+                w->mem = grown;
+                w->mem_cap = cap;
+            }
+            memcpy(w->mem + w->mem_len, w->buf, w->len);
+            w->mem_len += w->len;
+            w->mem[w->mem_len] = '\0';
+            break;
+        case JSON_SINK_CALLBACK:
+            if (w->callback(w->callback_ctx, w->buf, w->len) != 0) w->error = 1;
+            break;
+    }
+    w->len = 0;
+}
+
+static void put(json_writer_t *w, const char *s, size_t n) {
+    while (n > 0) {
+        if (w->len == sizeof(w->buf)) flush(w);
+        size_t room = sizeof(w->buf) - w->len;
+        size_t chunk = n < room ? n : room;
+        memcpy(w->buf + w->len, s, chunk);
+        w->len += chunk;
+        s += chunk;
+        n -= chunk;
+    }
+}
+
+static void put_char(json_writer_t *w, char c) {
+    if (w->len == sizeof(w->buf)) flush(w);
+    w->buf[w->len++] = c;
+}
+
+static void put_str(json_writer_t *w, const char *s) {
+    put(w, s, strlen(s));
+}
+
+int json_writer_finish(json_writer_t *w) {
+    flush(w);
+    if (w->sink == JSON_SINK_FILE && fflush(w->file) != 0) w->error = 1;
+    return w->error ? -1 : 0;
+}
+
+char* json_writer_take(json_writer_t *w) {
+    if (json_writer_finish(w) != 0 || !w->mem) {
+        free(w->mem);
+        w->mem = NULL;
+        return NULL;
+    }
+    char *doc = w->mem;
+    w->mem = NULL;
+    w->mem_len = w->mem_cap = 0;
+    return doc;
+}
+
+/* ============================================================
+ * Scalars
+ * ============================================================ */
+
+static void put_uint(json_writer_t *w, unsigned long long v) {
+    char tmp[24];
+    int i = sizeof(tmp);
+    do {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    put(w, tmp + i, sizeof(tmp) - i);
+}
+
+static void put_int(json_writer_t *w, long long v) {
+    if (v < 0) {
+        put_char(w, '-');
+        put_uint(w, 0ULL - (unsigned long long)v);
+    } else {
+        put_uint(w, (unsigned long long)v);
+    }
+}
+
+/* Fixed-point, like %.Nf for the ranges a fingerprint holds */
+static void put_double(json_writer_t *w, double v, int decimals) {
+    static const double scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+    if (!isfinite(v)) {
+        put_str(w, "null");     /* NaN/inf are not JSON */
+        return;
+    }
+    if (decimals < 0) decimals = 0;
+    if (decimals > 6) decimals = 6;
+
+    double scaled = fabs(v) * scales[decimals] + 0.5;
+    if (scaled >= 1e18) {
+        char tmp[64];
+        snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+        put_str(w, tmp);
+        return;
+    }
+
+    unsigned long long units = (unsigned long long)scaled;
+    unsigned long long scale = (unsigned long long)scales[decimals];
+    if (v < 0 && units > 0) put_char(w, '-');
+    put_uint(w, units / scale);
+    if (decimals > 0) {
+        char frac[8];
+        unsigned long long f = units % scale;
+        for (int i = decimals - 1; i >= 0; i--) {
+            frac[i] = (char)('0' + f % 10);
+            f /= 10;
+        }
+        put_char(w, '.');
+        put(w, frac, decimals);
+    }
+}
+
+static void put_escaped(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(w, '"');
+    if (!s) s = "";
+    while (*s) {
+        /* Copy runs that need no escaping in one go */
+        const char *run = s;
+        while ((unsigned char)*s >= 0x20 && *s != '"' && *s != '\\') s++;
+        if (s > run) put(w, run, s - run);
+        if (!*s) break;
+
+        char esc[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t n = 2;
+        switch (*s) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = hex[((unsigned char)*s >> 4) & 0xf];
+                esc[5] = hex[(unsigned char)*s & 0xf];
+                n = 6;
+        }
+        put(w, esc, n);
+        s++;
+    }
+    put_char(w, '"');
+}
+
+/* ============================================================
+ * Structure
+ * ============================================================ */
+
+static void indent(json_writer_t *w, int level) {
+    static const char spaces[] = "                                ";
+    int n = level * 2;
+    while (n > 0) {
+        int chunk = n < (int)sizeof(spaces) - 1 ? n : (int)sizeof(spaces) - 1;
+        put(w, spaces, chunk);
+        n -= chunk;
+    }
+}
+
+/* Separator, indentation and key before any member or element */
+static void member(json_writer_t *w, const char *key) {
+    if (w->depth > 0) {
+        int first = w->members[w->depth]++ == 0;
+        if (w->inline_depth) {
+            if (!first) put(w, ", ", 2);
+        } else {
+            put_str(w, first ? "\n" : ",\n");
+            indent(w, w->depth);
+        }
+    }
+    if (key) {
+        put_escaped(w, key);
+        put(w, ": ", 2);
+    }
+}
+
+static void container_open(json_writer_t *w, const char *key, char bracket, int one_line) {
+    member(w, key);
+    put_char(w, bracket);
+    if (w->depth + 1 >= JSON_WRITER_MAX_DEPTH) {
+        w->error = 1;
+        return;
+    }
+    w->depth++;
+    w->members[w->depth] = 0;
+    if (one_line && !w->inline_depth) w->inline_depth = w->depth;
+}
+
+static void container_close(json_writer_t *w, char bracket) {
+    if (w->depth == 0) {
+        w->error = 1;
+        return;
+    }
+    if (!w->inline_depth && w->members[w->depth] > 0) {
+        put_char(w, '\n');
+        indent(w, w->depth - 1);
+    }
+    put_char(w, bracket);
+    if (w->inline_depth == w->depth) w->inline_depth = 0;
+    w->depth--;
+    if (w->depth == 0) put_char(w, '\n');   /* End of document */
+}
+
+void json_object_begin(json_writer_t *w, const char *key) { container_open(w, key, '{', 0); }
+void json_object_begin_inline(json_writer_t *w, const char *key) { container_open(w, key, '{', 1); }
+void json_object_end(json_writer_t *w) { container_close(w, '}'); }
+void json_array_begin(json_writer_t *w, const char *key) { container_open(w, key, '[', 0); }
+void json_array_begin_inline(json_writer_t *w, const char *key) { container_open(w, key, '[', 1); }
+void json_array_end(json_writer_t *w) { container_close(w, ']'); }
+
+void json_string(json_writer_t *w, const char *key, const char *value) {
+    member(w, key);
+    put_escaped(w, value);
+}
+
+void json_int(json_writer_t *w, const char *key, long long value) {
+    member(w, key);
+    put_int(w, value);
+}
+
+void json_uint(json_writer_t *w, const char *key, unsigned long long value) {
+    member(w, key);
+    put_uint(w, value);
+}
+
+void json_double(json_writer_t *w, const char *key, double value, int decimals) {
+    member(w, key);
+    put_double(w, value, decimals);
+}
+
+void json_bool(json_writer_t *w, const char *key, int value) {
+    member(w, key);
+    put_str(w, value ? "true" : "false");
+}
+
+void json_null(json_writer_t *w, const char *key) {
+    member(w, key);
+    put_str(w, "null");
+}
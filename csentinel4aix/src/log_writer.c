@@ -0,0 +1,407 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * log_writer.c - Buffered, self-rotating line log
+ *
+ * Rotation only ever renames whole files, so a reader tailing PATH sees
+ * it replaced at once and finds every line either in PATH.1 or in the
+ * new PATH. Segments are compressed by a background thread at zlib's
+ * fastest level, into PATH.N.gz.tmp which is renamed when complete. The
+ * segment is shifted by name, so a rotation first waits for the previous
+ * compression: with segments of any size that is long done.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "log_writer.h"
+
+#define LOG_FILE_MODE 0640
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* PATH.n, PATH.n.gz */
+static void segment_name(const log_writer_t *w, int n, int gz, char *out, size_t size) {
+    snprintf(out, size, "%s.%d%s", w->path, n, gz ? ".gz" : "");
+}
+
+/* ============================================================
+ * Options
+ * ============================================================ */
+
+void log_writer_defaults(log_writer_opts_t *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->buffer_size = LOG_WRITER_BUFFER;
+    opts->flush_ms = LOG_WRITER_FLUSH_MS;
+    opts->fsync = LOG_FSYNC_ROTATE;
+    opts->max_bytes = LOG_WRITER_MAX_BYTES;
+    opts->max_age_s = 0;
+    opts->keep = LOG_WRITER_KEEP;
+    opts->compress = 0;
+}
+
+static int parse_number(const char *s, long max, long *out) {
+    char *end;
+    long v;
+
+    if (!s || !*s) return -1;
+    errno = 0;
+    v = strtol(s, &end, 10);
+    if (errno || *end || v < 0 || v > max) return -1;
+    *out = v;
+    return 0;
+}
+
+int log_writer_parse_opts(log_writer_opts_t *opts, const char *spec) {
+    char copy[256];
+    char *save = NULL;
+    char *item;
+    long v;
+
+    if (!spec) return 0;
+    if (strlen(spec) >= sizeof(copy)) return -1;
+    strcpy(copy, spec);
+
+    for (item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        char *value = strchr(item, '=');
+        if (value) *value++ = '\0';
+
+        if (strcmp(item, "size") == 0) {
+            if (parse_number(value, 1024L * 1024, &v) != 0) return -1;
+            opts->max_bytes = (uint64_t)v * 1024 * 1024;
+        } else if (strcmp(item, "age") == 0) {
+            if (parse_number(value, 24L * 365, &v) != 0) return -1;
+            opts->max_age_s = (int)(v * 3600);
+        } else if (strcmp(item, "keep") == 0) {
+            if (parse_number(value, LOG_WRITER_MAX_KEEP, &v) != 0) return -1;
+            opts->keep = (int)v;
+        } else if (strcmp(item, "flush") == 0) {
+            if (parse_number(value, 3600L * 1000, &v) != 0) return -1;
+            opts->flush_ms = (int)v;
+        } else if (strcmp(item, "gzip") == 0 && !value) {
+            opts->compress = 1;
+        } else if (strcmp(item, "fsync") == 0 && value) {
+            if (strcmp(value, "never") == 0) opts->fsync = LOG_FSYNC_NEVER;
+            else if (strcmp(value, "rotate") == 0) opts->fsync = LOG_FSYNC_ROTATE;
+            else if (strcmp(value, "commit") == 0) opts->fsync = LOG_FSYNC_COMMIT;
+            else return -1;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Compression
+ * ============================================================ */
+
+#ifdef HAVE_ZLIB
+/* src -> src.gz; src is removed only once the .gz is complete */
+static int compress_segment(const log_writer_t *w, const char *src) {
+    char dst[600], tmp[610];
+    char buf[65536];
+    ssize_t n;
+    int in, out, gzfd;
+    gzFile gz;
+    int rc = 0;
+
+    snprintf(dst, sizeof(dst), "%s.gz", src);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", dst);
+
+    in = open(src, O_RDONLY);
+    if (in < 0) return -1;
+    out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, LOG_FILE_MODE);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    /* gzclose() closes the fd it was given; keep ours for fsync() */
+    gzfd = dup(out);
+    gz = gzfd >= 0 ? gzdopen(gzfd, "wb1") : NULL;
+    if (!gz) {
+        if (gzfd >= 0) close(gzfd);
+        close(in);
+        close(out);
+        unlink(tmp);
+        return -1;
+    }
+
+    while ((n = read(in, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            rc = -1;
+            break;
+        }
+        if (gzwrite(gz, buf, (unsigned)n) != (int)n) {
+            rc = -1;
+            break;
+        }
+    }
+    if (gzclose(gz) != Z_OK) rc = -1;
+    if (rc == 0 && w->opts.fsync != LOG_FSYNC_NEVER && fsync(out) != 0) rc = -1;
+    close(in);
+    close(out);
+
+    if (rc == 0 && rename(tmp, dst) == 0) {
+        unlink(src);
+        return 0;
+    }
+    unlink(tmp);
+    return -1;
+}
+
+static void *compress_run(void *arg) {
+    log_writer_t *w = arg;
+
+    w->compress_rc = compress_segment(w, w->compress_src);
+    return NULL;
+}
+
+/* Hand the segment just rotated to the compressor thread */
+static void compress_start(log_writer_t *w, const char *src) {
+    sigset_t all, old;
+    int rc;
+
+    snprintf(w->compress_src, sizeof(w->compress_src), "%s", src);
+
+    /* Signals stay with the caller's thread */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    rc = pthread_create(&w->compressor, NULL, compress_run, w);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc == 0) w->compressing = 1;
+    else w->errors++;           /* The segment stays uncompressed */
+}
+#endif
+
+/* Wait for the compressor, if one is running */
+static void compress_wait(log_writer_t *w) {
+    if (!w->compressing) return;
+    pthread_join(w->compressor, NULL);
+    w->compressing = 0;
+    if (w->compress_rc != 0) w->errors++;
+}
+
+/* ============================================================
+ * Rotation
+ * ============================================================ */
+
+static int open_segment(log_writer_t *w) {
+    struct stat st;
+
+    w->fd = open(w->path, O_WRONLY | O_CREAT | O_APPEND, LOG_FILE_MODE);
+    if (w->fd < 0) return -1;
+    w->size = fstat(w->fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+    return 0;
+}
+
+/*
+ * Shift PATH.n to PATH.n+1 (plain or compressed), dropping what would
+ * pass keep, then move PATH to PATH.1 and start a new PATH.
+ */
+static int rotate(log_writer_t *w) {
+    char from[600], to[600];
+    int n, gz;
+
+    if (w->opts.fsync != LOG_FSYNC_NEVER && fsync(w->fd) == 0) w->fsyncs++;
+    close(w->fd);
+    w->fd = -1;
+
+    compress_wait(w);
+    if (w->opts.keep > 0) {
+        for (gz = 0; gz <= 1; gz++) {
+            segment_name(w, w->opts.keep, gz, from, sizeof(from));
+            unlink(from);
+        }
+        for (n = w->opts.keep - 1; n >= 1; n--) {
+            for (gz = 0; gz <= 1; gz++) {
+                segment_name(w, n, gz, from, sizeof(from));
+                segment_name(w, n + 1, gz, to, sizeof(to));
+                if (rename(from, to) != 0 && errno != ENOENT) w->errors++;
+            }
+        }
+        segment_name(w, 1, 0, to, sizeof(to));
+        if (rename(w->path, to) != 0) w->errors++;
+    } else {
+        unlink(w->path);
+    }
+
+    w->rotations++;
+    w->segment_start = time(NULL);
+    if (open_segment(w) != 0) {
+        w->errors++;
+        return -1;
+    }
+
+#ifdef HAVE_ZLIB
+    if (w->opts.compress && w->opts.keep > 0) compress_start(w, to);
+#endif
+    return 0;
+}
+
+static int rotation_due(const log_writer_t *w) {
+    if (w->size == 0) return 0;
+    if (w->opts.max_bytes && w->size >= w->opts.max_bytes) return 1;
+    if (w->opts.max_age_s && time(NULL) - w->segment_start >= w->opts.max_age_s) return 1;
+    return 0;
+}
+
+/* ============================================================
+ * Writing
+ * ============================================================ */
+
+static int write_all(log_writer_t *w, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(w->fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            w->errors++;
+            return -1;
+        }
+        w->size += (uint64_t)n;
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/* Write the buffer (one group commit), then rotate if due */
+static int commit(log_writer_t *w) {
+    int rc = 0;
+
+    if (w->fd < 0) return -1;
+
+    if (w->len > 0) {
+        struct iovec iov;
+        iov.iov_base = w->buf;
+        iov.iov_len = w->len;
+        rc = write_all(w, &iov, 1);
+        w->len = 0;             /* Not retried: a failing disk must not grow us */
+        w->commits++;
+        if (rc == 0 && w->opts.fsync == LOG_FSYNC_COMMIT && fsync(w->fd) == 0)
+            w->fsyncs++;
+    }
+
+    if (rotation_due(w) && rotate(w) != 0) rc = -1;
+    return rc;
+}
+
+int log_writer_open(log_writer_t *w, const char *path, const log_writer_opts_t *opts) {
+    char name[600];
+    struct stat st;
+
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+    if (opts) w->opts = *opts;
+    else log_writer_defaults(&w->opts);
+    if (w->opts.buffer_size < 1024) w->opts.buffer_size = 1024;
+
+    if (strlen(path) >= sizeof(w->path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(w->path, path);
+
+#ifndef HAVE_ZLIB
+    if (w->opts.compress) {
+        fprintf(stderr, "Warning: Built without zlib, rotated logs are not compressed\n");
+        w->opts.compress = 0;
+    }
+#endif
+
+    w->buf = malloc(w->opts.buffer_size);
+    if (!w->buf) return -1;
+
+    if (open_segment(w) != 0) {
+        free(w->buf);
+        w->buf = NULL;
+        return -1;
+    }
+
+    /* The last rotation's segment was last written when it rotated */
+    segment_name(w, 1, 0, name, sizeof(name));
+    if (stat(name, &st) != 0) segment_name(w, 1, 1, name, sizeof(name));
+    w->segment_start = stat(name, &st) == 0 ? st.st_mtime : time(NULL);
+    return 0;
+}
+
+int log_writer_append(log_writer_t *w, const char *line, size_t len) {
+    size_t need = len + 1;
+    int rc = 0;
+
+    if (w->fd < 0) return -1;
+
+    if (w->len > 0 && w->len + need > w->opts.buffer_size) rc = commit(w);
+
+    if (need > w->opts.buffer_size) {
+        /* Longer than the whole buffer: straight through */
+        struct iovec iov[2];
+        iov[0].iov_base = (void *)line;
+        iov[0].iov_len = len;
+        iov[1].iov_base = "\n";
+        iov[1].iov_len = 1;
+        if (write_all(w, iov, 2) != 0) rc = -1;
+        w->commits++;
+        w->lines++;
+        if (rotation_due(w) && rotate(w) != 0) rc = -1;
+        return rc;
+    }
+
+    if (w->len == 0) w->first_ms = now_ms();
+    memcpy(w->buf + w->len, line, len);
+    w->buf[w->len + len] = '\n';
+    w->len += need;
+    w->lines++;
+
+    if (now_ms() - w->first_ms >= w->opts.flush_ms && commit(w) != 0) rc = -1;
+    return rc;
+}
+
+int log_writer_flush(log_writer_t *w) {
+    return commit(w);
+}
+
+void log_writer_close(log_writer_t *w) {
+    if (w->fd >= 0) {
+        commit(w);
+        if (w->opts.fsync != LOG_FSYNC_NEVER && fsync(w->fd) == 0) w->fsyncs++;
+        close(w->fd);
+        w->fd = -1;
+    }
+    compress_wait(w);
+    free(w->buf);
+    w->buf = NULL;
+}
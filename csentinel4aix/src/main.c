@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #ifndef _AIX
 #include <getopt.h>
@@ -25,11 +26,14 @@
 #include "audit.h"
 #endif
 #include "color.h"
+#include "json_writer.h"
+#include "fpbin.h"
+#include "sanitize.h"
+#include "metrics.h"
 
 #ifdef _AIX
 /* AIX audit summary - from aix_audit.c */
 extern int probe_aix_audit(aix_audit_summary_t *summary, time_t since);
-extern int aix_audit_to_json(const aix_audit_summary_t *summary, char *buf, size_t buf_size);
 #endif
 
 /* Default config files to probe if none specified */
@@ -72,6 +76,12 @@ static aix_audit_summary_t g_aix_audit;
 static audit_summary_t *g_audit_summary = NULL;
 #endif
 
+/* Binary archive every capture is appended to (-B), or NULL */
+static const char *g_archive_path = NULL;
+
+/* Redact addresses, home directories and secrets from JSON output (-Z) */
+static int g_sanitize = 0;
+
 static void signal_handler(int signum) {
     (void)signum;
     keep_running = 0;
@@ -90,6 +100,10 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  -j          Output JSON to stdout (even in quick mode)\n");
     fprintf(stderr, "  -w          Continuous monitoring mode\n");
     fprintf(stderr, "  -i SEC      Interval between probes in watch mode (default: 60)\n");
+    fprintf(stderr, "  -J N        Capture with N worker threads (0 = one per CPU, default: 1)\n");
+    fprintf(stderr, "  -k N        Watch JSON: full document every N, deltas between (default: 10)\n");
+    fprintf(stderr, "  -B FILE     Append each capture to a binary fingerprint archive\n");
+    fprintf(stderr, "  -Z          Redact IPs, home directories and secrets from JSON output\n");
     fprintf(stderr, "  -n          Include network probe (listeners, connections)\n");
     fprintf(stderr, "  -a          Include security events (AIX audit - requires: audit start)\n");
     fprintf(stderr, "  -F          Full AIX file integrity check (~150 critical files)\n");
@@ -100,10 +114,14 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  -A          Learn audit baseline (Linux only)\n");
     fprintf(stderr, "  -K          Force coloured output\n");
     fprintf(stderr, "  -N          Disable coloured output\n");
+    fprintf(stderr, "  -E [HOST]:PORT  Serve Prometheus metrics on /metrics, refreshed every -i SEC\n");
     fprintf(stderr, "\nSIEM Integration:\n");
-    fprintf(stderr, "  -S HOST:PORT  Send events via syslog (UDP) to SIEM\n");
+    fprintf(stderr, "  -S HOST:PORT  Send events via syslog (UDP) to SIEM;\n");
+    fprintf(stderr, "                tcp://HOST:PORT for TCP (RFC 6587 framing)\n");
     fprintf(stderr, "  -R FORMAT     Syslog format: cef (default) or json\n");
     fprintf(stderr, "  -L FILE       Write events to log file (JSON lines)\n");
+    fprintf(stderr, "  -O LIST       Log file rotation: size=MB,age=HOURS,keep=N,gzip,\n");
+    fprintf(stderr, "                fsync=never|rotate|commit (default: size=100,keep=4)\n");
     fprintf(stderr, "  -M EMAIL      Send email alerts for critical events\n");
     fprintf(stderr, "  -T SCORE      Alert threshold (1-100, default: 50)\n");
 #else
@@ -111,8 +129,13 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  -q, --quick          Only show quick analysis summary\n");
     fprintf(stderr, "  -v, --verbose        Include all processes (not just notable ones)\n");
     fprintf(stderr, "  -j, --json           Output JSON to stdout (even in quick mode)\n");
-    fprintf(stderr, "  -w, --watch          Continuous monitoring mode\n");
-    fprintf(stderr, "  -i, --interval SEC   Interval between probes in watch mode (default: 60)\n");
+    fprintf(stderr, "  -w, --watch          Continuous monitoring mode (re-probes on change)\n");
+    fprintf(stderr, "  -i, --interval SEC   Full resync interval in watch mode (default: 60)\n");
+    fprintf(stderr, "  -P, --poll           Watch by polling every interval instead of on events\n");
+    fprintf(stderr, "  -k, --keyframe N     Watch JSON: full document every N, deltas between (default: 10)\n");
+    fprintf(stderr, "  -B, --archive FILE   Append each capture to a binary fingerprint archive\n");
+    fprintf(stderr, "  -Z, --sanitize       Redact IPs, home directories and secrets from JSON output\n");
+    fprintf(stderr, "  -J, --jobs N         Capture with N worker threads (0 = one per CPU, default: 1)\n");
     fprintf(stderr, "  -n, --network        Include network probe (listeners, connections)\n");
     fprintf(stderr, "  -a, --audit          Include auditd security events\n");
     fprintf(stderr, "  -b, --baseline       Compare against learned baseline\n");
@@ -122,6 +145,8 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "      --audit-learn    Learn audit baseline\n");
     fprintf(stderr, "      --color          Force coloured output\n");
     fprintf(stderr, "      --no-color       Disable coloured output\n");
+    fprintf(stderr, "  -E, --serve-metrics [HOST]:PORT\n");
+    fprintf(stderr, "                       Serve Prometheus metrics on /metrics, refreshed every -i SEC\n");
 #endif
     fprintf(stderr, "\n");
     fprintf(stderr, "Exit codes:\n");
@@ -170,15 +195,18 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  %s -w -i 60 -n -a -S 10.0.0.50:514      Syslog to QRadar (CEF)\n", prog);
     fprintf(stderr, "  %s -w -i 60 -n -a -S 10.0.0.50:514 -R json    Syslog JSON format\n", prog);
     fprintf(stderr, "  %s -w -i 60 -n -a -L /var/log/sentinel.log   Log file for Wazuh\n", prog);
+    fprintf(stderr, "  %s -w -i 60 -a -L /var/log/sentinel.log -O size=50,keep=7,gzip\n", prog);
     fprintf(stderr, "  %s -w -i 60 -n -a -M admin@x.com -T 70       Email on high risk\n", prog);
+    fprintf(stderr, "  %s -E :9464 -i 30 -n -a                       Prometheus exporter\n", prog);
 #else
     fprintf(stderr, "  %s --quick                    One-shot quick analysis\n", prog);
     fprintf(stderr, "  %s --quick --network          Include network probe\n", prog);
     fprintf(stderr, "  %s --quick --network --audit  Include network + security events\n", prog);
-    fprintf(stderr, "  %s --watch --interval 300     Monitor every 5 minutes\n", prog);
+    fprintf(stderr, "  %s --watch --interval 300     Monitor changes, full resync every 5 minutes\n", prog);
     fprintf(stderr, "  %s --json > fingerprint.json  Save full JSON output\n", prog);
     fprintf(stderr, "  %s --learn --network          Learn current state as baseline\n", prog);
     fprintf(stderr, "  %s --baseline --network       Compare against baseline\n", prog);
+    fprintf(stderr, "  %s --serve-metrics :9464 -n   Prometheus exporter, refresh every 60s\n", prog);
 #endif
 }
 
@@ -258,123 +286,176 @@ static void print_audit_summary_quick(const audit_summary_t *audit) {
 }
 #endif /* !_AIX */
 
-static int run_analysis(const char **configs, int config_count, 
-                        int quick_mode, int json_mode, int network_mode, int audit_mode) {
-    fingerprint_t fp;
-    int result = capture_fingerprint(&fp, configs, config_count);
+/* Watch mode JSON document: a keyframe, or a delta when delta is set */
+typedef struct {
+    unsigned long sequence;
+    const fingerprint_delta_t *delta;
+} json_doc_t;
+
+#ifdef _AIX
+typedef aix_audit_summary_t report_audit_t;
+#else
+typedef audit_summary_t report_audit_t;
+#endif
+
+static int write_stdout(void *ctx, const char *data, size_t len) {
+    (void)ctx;
+    return fwrite(data, 1, len, stdout) == len ? 0 : -1;
+}
+
+static int write_sanitized(void *stream, const char *data, size_t len) {
+    return sanitize_stream_write(stream, data, len);
+}
+
+/* Stream the JSON document to stdout, with audit as a nested member */
+static int print_json(const fingerprint_t *fp, const json_doc_t *doc,
+                      const report_audit_t *audit) {
+    static json_writer_t w;     /* 8 KB buffer; keep it off the stack */
+    sanitize_stream_t *stream = NULL;
     
-    if (result != 0) {
-        fprintf(stderr, "Warning: Some probes failed (errors: %d)\n", fp.probe_errors);
+    if (g_sanitize) {
+        stream = sanitize_stream_new(SANITIZE_DEFAULT, write_stdout, NULL);
+        if (!stream) return -1;
+        json_writer_callback(&w, write_sanitized, stream);
+    } else {
+        json_writer_file(&w, stdout);
     }
-    
-    /* Probe network if requested */
-    if (network_mode) {
-        probe_network(&fp.network);
+    json_object_begin(&w, NULL);
+    if (doc && doc->delta) {
+        fingerprint_delta_json_members(&w, doc->delta, doc->sequence, doc->sequence - 1);
+    } else {
+        fingerprint_json_members(&w, fp, doc ? doc->sequence : 0);
     }
-    
-    /* Probe audit if requested */
+    if (audit) {
 #ifdef _AIX
-    aix_audit_summary_t *aix_audit = NULL;
-    if (audit_mode) {
-        memset(&g_aix_audit, 0, sizeof(g_aix_audit));
-        time_t since = time(NULL) - 300;  /* Last 5 minutes */
-        probe_aix_audit(&g_aix_audit, since);
-        aix_audit = &g_aix_audit;
+        aix_audit_json_member(&w, audit);
+#else
+        audit_json_member(&w, audit);
+#endif
+    }
+    json_object_end(&w);
+    int rc = json_writer_finish(&w);
+    if (stream) {
+        if (sanitize_stream_finish(stream) < 0) rc = -1;
+        sanitize_stream_free(stream);
+        if (fflush(stdout) != 0) rc = -1;
     }
+    return rc;
+}
+
+/* Probe the last 5 minutes of audit events; release_audit() when done */
+static report_audit_t *probe_report_audit(void) {
+#ifdef _AIX
+    memset(&g_aix_audit, 0, sizeof(g_aix_audit));
+    time_t since = time(NULL) - 300;  /* Last 5 minutes */
+    probe_aix_audit(&g_aix_audit, since);
+    return &g_aix_audit;
 #else
-    audit_summary_t *audit = NULL;
-    if (audit_mode) {
-        audit = probe_audit(300);  /* Last 5 minutes */
-        g_audit_summary = audit;
+    audit_summary_t *audit = probe_audit(300);  /* Last 5 minutes */
+    g_audit_summary = audit;
+
+    /* Auto-update baseline on each probe */
+    if (audit && audit->enabled) {
+        audit_baseline_t baseline = {0};
+        load_audit_baseline(&baseline);
+        update_audit_baseline(&baseline, audit);
+        save_audit_baseline(&baseline);
+        /* Update sample count in summary for JSON output */
+        audit->baseline_sample_count = baseline.sample_count;
+    }
+    return audit;
+#endif
+}
+
+static void release_audit(report_audit_t *audit) {
+#ifdef _AIX
+    (void)audit;
+#else
+    if (audit) {
+        free_audit_summary(audit);
+        g_audit_summary = NULL;
+    }
+#endif
+}
 
-        /* Auto-update baseline on each probe */
-        if (audit && audit->enabled) {
-            audit_baseline_t baseline = {0};
-            load_audit_baseline(&baseline);
-            update_audit_baseline(&baseline, audit);
-            save_audit_baseline(&baseline);
-            /* Update sample count in summary for JSON output */
-            audit->baseline_sample_count = baseline.sample_count;
+/* Exit code for the analysis and audit risk: EXIT_OK, _WARNINGS or _CRITICAL */
+static int fingerprint_status(const quick_analysis_t *analysis, const report_audit_t *audit) {
+    int exit_code = EXIT_OK;
+    
+    if (analysis->zombie_process_count > 0 || 
+        analysis->config_permission_issues > 0 ||
+        analysis->unusual_listeners > 3) {
+        exit_code = EXIT_CRITICAL;
+    } else if (analysis->high_fd_process_count > 5 ||
+               analysis->unusual_listeners > 0) {
+        exit_code = EXIT_WARNINGS;
+    }
+    
+    /* Audit can also trigger critical */
+    if (audit && audit->enabled) {
+#ifdef _AIX
+        if (audit->risk_score >= 70) {  /* critical */
+            exit_code = EXIT_CRITICAL;
+        } else if (audit->risk_score >= 20 && exit_code < EXIT_WARNINGS) {
+            exit_code = EXIT_WARNINGS;
         }
+#else
+        if (audit->risk_score >= 16) {  /* high or critical */
+            exit_code = EXIT_CRITICAL;
+        } else if (audit->risk_score >= 6 && exit_code < EXIT_WARNINGS) {
+            exit_code = EXIT_WARNINGS;
+        }
+#endif
     }
+    return exit_code;
+}
+
+/*
+ * Probe audit, analyse and print a captured fingerprint; returns the exit
+ * code. doc selects watch mode keyframe/delta output instead of plain JSON.
+ */
+static int report_fingerprint(fingerprint_t *fp, const json_doc_t *doc, int quick_mode,
+                              int json_mode, int network_mode, int audit_mode) {
+    /* Probe audit if requested */
+#ifdef _AIX
+    aix_audit_summary_t *aix_audit = audit_mode ? probe_report_audit() : NULL;
+#else
+    audit_summary_t *audit = audit_mode ? probe_report_audit() : NULL;
 #endif
     
     /* Always do quick analysis for exit code calculation */
     quick_analysis_t analysis;
-    analyze_fingerprint_quick(&fp, &analysis);
+    analyze_fingerprint_quick(fp, &analysis);
+    
+#ifdef _AIX
+    const report_audit_t *json_audit = aix_audit;
+#else
+    const report_audit_t *json_audit = (audit && audit->enabled) ? audit : NULL;
+#endif
     
     if (json_mode) {
         /* Full JSON output */
-        char *json = fingerprint_to_json(&fp);
-        if (!json) {
-            fprintf(stderr, "Error: Failed to serialize fingerprint to JSON\n");
+        if (print_json(fp, doc, json_audit) != 0) {
+            fprintf(stderr, "Error: Failed to write fingerprint JSON\n");
 #ifndef _AIX
-            if (audit) free_audit_summary(audit);
+            release_audit(audit);
 #endif
             return EXIT_ERROR;
         }
-
-#ifdef _AIX
-        /* AIX: Inject AIX audit JSON if audit mode is on */
-        if (audit_mode && aix_audit) {
-            char *last_brace = strrchr(json, '}');
-            if (last_brace && last_brace > json) {
-                char audit_json[8192];
-                if (aix_audit->enabled) {
-                    aix_audit_to_json(aix_audit, audit_json, sizeof(audit_json));
-                } else {
-                    /* Audit not enabled - show instructions */
-                    snprintf(audit_json, sizeof(audit_json),
-                        "  \"audit_summary\": {\n"
-                        "    \"enabled\": false,\n"
-                        "    \"platform\": \"AIX\",\n"
-                        "    \"message\": \"AIX audit subsystem not enabled\",\n"
-                        "    \"enable_instructions\": \"/usr/sbin/audit start\"\n"
-                        "  }");
-                }
-                *last_brace = '\0';
-                printf("%s,\n%s\n}\n", json, audit_json);
-            } else {
-                printf("%s", json);
-            }
-        } else {
-            printf("%s", json);
-        }
-#else
-        /* Linux: If audit mode, we need to inject audit JSON before the closing brace */
-        if (audit && audit->enabled) {
-            /* Find the last closing brace */
-            char *last_brace = strrchr(json, '}');
-            if (last_brace && last_brace > json) {
-                /* Build combined output */
-                char audit_json[16384];
-                audit_to_json(audit, audit_json, sizeof(audit_json));
-
-                /* Print everything before the last }, then audit, then } */
-                *last_brace = '\0';
-                printf("%s,\n%s\n}\n", json, audit_json);
-            } else {
-                printf("%s", json);
-            }
-        } else {
-            printf("%s", json);
-        }
-#endif
-        free(json);
     } else if (quick_mode) {
         /* Quick analysis only */
         printf("%sC-Sentinel Quick Analysis%s\n", col_header(), col_reset());
         printf("========================\n");
-        printf("Hostname: %s%s%s\n", col_info(), fp.system.hostname, col_reset());
-        printf("Uptime: %.1f days\n", fp.system.uptime_seconds / 86400.0);
+        printf("Hostname: %s%s%s\n", col_info(), fp->system.hostname, col_reset());
+        printf("Uptime: %.1f days\n", fp->system.uptime_seconds / 86400.0);
         printf("Load: %.2f %.2f %.2f\n", 
-               fp.system.load_avg[0], fp.system.load_avg[1], fp.system.load_avg[2]);
+               fp->system.load_avg[0], fp->system.load_avg[1], fp->system.load_avg[2]);
         
-        double mem_pct = 100.0 * (1.0 - (double)fp.system.free_ram / fp.system.total_ram);
+        double mem_pct = 100.0 * (1.0 - (double)fp->system.free_ram / fp->system.total_ram);
         printf("Memory: %s%.1f%%%s used\n", 
                mem_pct > 90 ? col_error() : mem_pct > 75 ? col_warn() : col_ok(),
                mem_pct, col_reset());
-        printf("Processes: %d total\n", fp.process_count);
+        printf("Processes: %d total\n", fp->process_count);
         
         printf("\n%sPotential Issues:%s\n", col_header(), col_reset());
         printf("  Zombie processes: %s%d%s%s\n", 
@@ -393,24 +474,24 @@ static int run_analysis(const char **configs, int config_count,
         
         if (network_mode) {
             printf("\n%sNetwork:%s\n", col_header(), col_reset());
-            printf("  Listening ports: %d\n", fp.network.total_listening);
-            printf("  Established connections: %d\n", fp.network.total_established);
+            printf("  Listening ports: %d\n", fp->network.total_listening);
+            printf("  Established connections: %d\n", fp->network.total_established);
             printf("  Unusual ports: %s%d%s%s\n", 
                    analysis.unusual_listeners > 0 ? col_warn() : col_ok(),
                    analysis.unusual_listeners, col_reset(),
                    analysis.unusual_listeners > 0 ? " ⚠" : "");
             
             /* Show listeners if any */
-            if (fp.network.listener_count > 0) {
+            if (fp->network.listener_count > 0) {
                 printf("\n  Listeners:\n");
-                for (int i = 0; i < fp.network.listener_count && i < 10; i++) {
-                    net_listener_t *l = &fp.network.listeners[i];
+                for (int i = 0; i < fp->network.listener_count && i < 10; i++) {
+                    net_listener_t *l = &fp->network.listeners[i];
                     printf("    %s%s:%d%s (%s) - %s\n", 
                            col_dim(), l->local_addr, l->local_port, col_reset(),
                            l->protocol, l->process_name);
                 }
-                if (fp.network.listener_count > 10) {
-                    printf("    %s... and %d more%s\n", col_dim(), fp.network.listener_count - 10, col_reset());
+                if (fp->network.listener_count > 10) {
+                    printf("    %s... and %d more%s\n", col_dim(), fp->network.listener_count - 10, col_reset());
                 }
             }
         }
@@ -442,107 +523,163 @@ static int run_analysis(const char **configs, int config_count,
         }
     } else {
         /* Full JSON output (default) */
-        char *json = fingerprint_to_json(&fp);
-        if (!json) {
-            fprintf(stderr, "Error: Failed to serialize fingerprint to JSON\n");
+        if (print_json(fp, doc, json_audit) != 0) {
+            fprintf(stderr, "Error: Failed to write fingerprint JSON\n");
 #ifndef _AIX
-            if (audit) free_audit_summary(audit);
+            release_audit(audit);
 #endif
             return EXIT_ERROR;
         }
-
+    }
+    
+    /* Calculate exit code based on issues */
 #ifdef _AIX
-        /* AIX: Inject AIX audit JSON if audit mode is on */
-        if (audit_mode && aix_audit) {
-            char *last_brace = strrchr(json, '}');
-            if (last_brace && last_brace > json) {
-                char audit_json[8192];
-                if (aix_audit->enabled) {
-                    aix_audit_to_json(aix_audit, audit_json, sizeof(audit_json));
-                } else {
-                    snprintf(audit_json, sizeof(audit_json),
-                        "  \"audit_summary\": {\n"
-                        "    \"enabled\": false,\n"
-                        "    \"platform\": \"AIX\",\n"
-                        "    \"message\": \"AIX audit subsystem not enabled\",\n"
-                        "    \"enable_instructions\": \"/usr/sbin/audit start\"\n"
-                        "  }");
-                }
-                *last_brace = '\0';
-                printf("%s,\n%s\n}\n", json, audit_json);
-            } else {
-                printf("%s", json);
-            }
-        } else {
-            printf("%s", json);
-        }
+    int exit_code = fingerprint_status(&analysis, aix_audit);
+
+    /* Process SIEM events if enabled */
+    if (siem_is_enabled()) {
+        siem_process_fingerprint(fp);
+    }
 #else
-        /* Same audit injection logic */
-        if (audit && audit->enabled) {
-            char *last_brace = strrchr(json, '}');
-            if (last_brace && last_brace > json) {
-                char audit_json[16384];
-                audit_to_json(audit, audit_json, sizeof(audit_json));
-                *last_brace = '\0';
-                printf("%s,\n%s\n}\n", json, audit_json);
-            } else {
-                printf("%s", json);
-            }
-        } else {
-            printf("%s", json);
-        }
+    int exit_code = fingerprint_status(&analysis, audit);
+
+    release_audit(audit);
 #endif
-        free(json);
+
+    return exit_code;
+}
+
+static void archive_fingerprint(const fingerprint_t *fp) {
+    if (g_archive_path && fpbin_append(g_archive_path, fp) != 0) {
+        fprintf(stderr, "Warning: Cannot append to archive %s: %s\n",
+                g_archive_path, strerror(errno));
     }
+}
+
+static int run_analysis(const char **configs, int config_count, 
+                        int quick_mode, int json_mode, int network_mode, int audit_mode) {
+    fingerprint_t fp;
+    int result = capture_fingerprint(&fp, configs, config_count);
     
-    /* Calculate exit code based on issues */
-    int exit_code = EXIT_OK;
+    if (result != 0) {
+        fprintf(stderr, "Warning: Some probes failed (errors: %d)\n", fp.probe_errors);
+    }
     
-    if (analysis.zombie_process_count > 0 || 
-        analysis.config_permission_issues > 0 ||
-        analysis.unusual_listeners > 3) {
-        exit_code = EXIT_CRITICAL;
-    } else if (analysis.high_fd_process_count > 5 ||
-               analysis.unusual_listeners > 0) {
-        exit_code = EXIT_WARNINGS;
+    /* Probe network if requested */
+    if (network_mode) {
+        probe_fingerprint_network(&fp);
     }
+    archive_fingerprint(&fp);
     
-    /* Audit can also trigger critical */
-#ifdef _AIX
-    if (aix_audit && aix_audit->enabled) {
-        if (aix_audit->risk_score >= 70) {  /* critical */
-            exit_code = EXIT_CRITICAL;
-        } else if (aix_audit->risk_score >= 20 && exit_code < EXIT_WARNINGS) {
-            exit_code = EXIT_WARNINGS;
-        }
+    int exit_code = report_fingerprint(&fp, NULL, quick_mode, json_mode, network_mode, audit_mode);
+    fingerprint_free(&fp);
+    return exit_code;
+}
+
+/*
+ * Exporter mode: capture every interval and publish the rendered page.
+ * Scrapes are answered from it by the server thread and never probe.
+ */
+static int run_metrics_exporter(const char *listen_addr, const char **configs, int config_count,
+                                int interval, int network_mode, int audit_mode) {
+    metrics_server_t server;
+    static baseline_t baseline;
+    unsigned long refreshes = 0;
+    int capture_failing = 0;
+
+    if (metrics_server_start(&server, listen_addr) != 0) {
+        return EXIT_ERROR;
     }
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
 
-    /* Process SIEM events if enabled */
-    if (siem_is_enabled()) {
-        siem_process_fingerprint(&fp);
+    fprintf(stderr, "C-Sentinel v%s - Metrics on %s/metrics (Ctrl+C to stop)\n",
+            SENTINEL_VERSION, listen_addr);
+    fprintf(stderr, "Refresh: every %d seconds\n", interval);
+    if (audit_mode) {
+        fprintf(stderr, "Audit: enabled\n");
     }
-#else
-    if (audit && audit->enabled) {
-        if (audit->risk_score >= 16) {  /* high or critical */
-            exit_code = EXIT_CRITICAL;
-        } else if (audit->risk_score >= 6 && exit_code < EXIT_WARNINGS) {
-            exit_code = EXIT_WARNINGS;
+
+    while (keep_running) {
+        fingerprint_t fp;
+        if (capture_fingerprint(&fp, configs, config_count) != 0) {
+            /* A partial capture would publish its gaps as zeros */
+            if (!capture_failing) {
+                fprintf(stderr, "Warning: Capture failed (errors: %d), still serving the last refresh\n",
+                        fp.probe_errors);
+                capture_failing = 1;
+            }
+            fingerprint_free(&fp);
+            if (keep_running) {
+                sleep(interval);
+            }
+            continue;
+        }
+        if (capture_failing) {
+            fprintf(stderr, "Capture recovered, refreshing metrics again\n");
+            capture_failing = 0;
+        }
+        if (network_mode) {
+            probe_fingerprint_network(&fp);
+        }
+        archive_fingerprint(&fp);
+
+        quick_analysis_t analysis;
+        analyze_fingerprint_quick(&fp, &analysis);
+
+        /* Read every time, so a new --learn is picked up */
+        deviation_report_t report;
+        int have_baseline = baseline_load(&baseline) == 0;
+        if (have_baseline) {
+            baseline_compare(&baseline, &fp, &report);
+        }
+
+        report_audit_t *audit = audit_mode ? probe_report_audit() : NULL;
+
+        metrics_input_t in;
+        memset(&in, 0, sizeof(in));
+        in.fp = &fp;
+        in.analysis = &analysis;
+        in.deviations = have_baseline ? &report : NULL;
+        in.audit = audit;
+        in.status = fingerprint_status(&analysis, audit);
+        in.refreshes = ++refreshes;
+
+        metrics_page_t *page = metrics_render(&in);
+        if (page) {
+            metrics_server_publish(&server, page);
+        } else {
+            fprintf(stderr, "Warning: Cannot render metrics, still serving the last refresh\n");
+        }
+
+#ifdef _AIX
+        /* Process SIEM events if enabled */
+        if (siem_is_enabled()) {
+            siem_process_fingerprint(&fp);
+        }
+#endif
+        release_audit(audit);
+        fingerprint_free(&fp);
+
+        if (keep_running) {
+            sleep(interval);
         }
     }
 
-    if (audit) {
-        free_audit_summary(audit);
-        g_audit_summary = NULL;
+    metrics_server_stop(&server);
+#ifdef _AIX
+    if (siem_is_enabled()) {
+        siem_cleanup();
     }
 #endif
-
-    return exit_code;
+    return EXIT_OK;
 }
 
 int main(int argc, char *argv[]) {
     int quick_mode = 0;
     int json_mode = 0;
     int watch_mode = 0;
+    int poll_mode = 0;    /* Watch by sleeping rather than on change events */
     int network_mode = 0;
     int audit_mode = 0;
     int audit_learn = 0;
@@ -552,13 +689,16 @@ int main(int argc, char *argv[]) {
     int init_config = 0;
     int full_mode = 0;    /* AIX: use full critical files list */
     int interval = 60;
+    int keyframe_every = 10;  /* Watch mode JSON: full document every N */
     int force_color = 0;  /* 0=auto, 1=force on, -1=force off */
+    const char *metrics_addr = NULL;  /* Exporter mode: [HOST]:PORT */
     int opt;
 
     /* SIEM integration options */
     char siem_syslog[256] = {0};
     char siem_format[16] = "cef";
     char siem_logfile[512] = {0};
+    char siem_logopts[256] = {0};
     char siem_email[256] = {0};
     int siem_threshold = 50;
 
@@ -571,6 +711,11 @@ int main(int argc, char *argv[]) {
         {"json",        no_argument,       0, 'j'},
         {"watch",       no_argument,       0, 'w'},
         {"interval",    required_argument, 0, 'i'},
+        {"jobs",        required_argument, 0, 'J'},
+        {"poll",        no_argument,       0, 'P'},
+        {"keyframe",    required_argument, 0, 'k'},
+        {"archive",     required_argument, 0, 'B'},
+        {"sanitize",    no_argument,       0, 'Z'},
         {"network",     no_argument,       0, 'n'},
         {"audit",       no_argument,       0, 'a'},
         {"baseline",    no_argument,       0, 'b'},
@@ -582,14 +727,15 @@ int main(int argc, char *argv[]) {
         {"colour",      no_argument,       0, 'K'},
         {"no-color",    no_argument,       0, 'N'},
         {"no-colour",   no_argument,       0, 'N'},
+        {"serve-metrics", required_argument, 0, 'E'},
         {0, 0, 0, 0}
     };
 
-    while ((opt = getopt_long(argc, argv, "hqvjwi:nablcCAKN", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hqvjwi:J:Pk:B:ZnablcCAKNE:", long_options, NULL)) != -1) {
 #else
     /* AIX: Use basic getopt (short options only) */
     /* SIEM options: S=syslog, R=format, L=logfile, M=mail, T=threshold */
-    while ((opt = getopt(argc, argv, "hqvjwi:nablcCAFKNS:R:L:M:T:")) != -1) {
+    while ((opt = getopt(argc, argv, "hqvjwi:J:k:B:ZnablcCAFKNE:S:R:L:O:M:T:")) != -1) {
 #endif
         switch (opt) {
             case 'h':
@@ -612,6 +758,23 @@ int main(int argc, char *argv[]) {
                 if (interval < 1) interval = 1;
                 if (interval > 86400) interval = 86400;
                 break;
+            case 'J':
+                workpool_set_jobs(atoi(optarg));
+                break;
+            case 'P':
+                poll_mode = 1;
+                break;
+            case 'k':
+                keyframe_every = atoi(optarg);
+                if (keyframe_every < 1) keyframe_every = 1;
+                if (keyframe_every > 10000) keyframe_every = 10000;
+                break;
+            case 'B':
+                g_archive_path = optarg;
+                break;
+            case 'Z':
+                g_sanitize = 1;
+                break;
             case 'n':
                 network_mode = 1;
                 break;
@@ -639,6 +802,9 @@ int main(int argc, char *argv[]) {
             case 'N':
                 force_color = -1;
                 break;
+            case 'E':
+                metrics_addr = optarg;
+                break;
             case 'F':
 #ifdef _AIX
                 full_mode = 1;
@@ -658,6 +824,10 @@ int main(int argc, char *argv[]) {
                 /* SIEM log file path */
                 strncpy(siem_logfile, optarg, sizeof(siem_logfile) - 1);
                 break;
+            case 'O':
+                /* SIEM log file rotation and commit options */
+                strncpy(siem_logopts, optarg, sizeof(siem_logopts) - 1);
+                break;
             case 'M':
                 /* SIEM email alerts */
                 strncpy(siem_email, optarg, sizeof(siem_email) - 1);
@@ -682,22 +852,30 @@ int main(int argc, char *argv[]) {
     if (siem_syslog[0] || siem_logfile[0] || siem_email[0]) {
         char syslog_host[256] = {0};
         int syslog_port = 514;
+        int syslog_tcp = 0;
 
-        /* Parse syslog option (host:port) */
+        /* Parse syslog option ([tcp://|udp://]host:port) */
         if (siem_syslog[0]) {
-            char *colon = strchr(siem_syslog, ':');
+            char *target = siem_syslog;
+            if (strncmp(target, "tcp://", 6) == 0) {
+                syslog_tcp = 1;
+                target += 6;
+            } else if (strncmp(target, "udp://", 6) == 0) {
+                target += 6;
+            }
+            char *colon = strchr(target, ':');
             if (colon) {
                 *colon = '\0';
-                strncpy(syslog_host, siem_syslog, sizeof(syslog_host) - 1);
+                strncpy(syslog_host, target, sizeof(syslog_host) - 1);
                 syslog_port = atoi(colon + 1);
                 if (syslog_port <= 0 || syslog_port > 65535) syslog_port = 514;
             } else {
-                strncpy(syslog_host, siem_syslog, sizeof(syslog_host) - 1);
+                strncpy(syslog_host, target, sizeof(syslog_host) - 1);
             }
         }
 
-        siem_init(syslog_host, syslog_port, siem_format,
-                  siem_logfile, siem_email, siem_threshold);
+        siem_init(syslog_host, syslog_port, syslog_tcp, siem_format,
+                  siem_logfile, siem_logopts, siem_email, siem_threshold);
 
         if (siem_is_enabled()) {
             siem_print_config();
@@ -758,6 +936,12 @@ int main(int argc, char *argv[]) {
 #endif
     }
     
+    /* Secrets in the environment are redacted too */
+    if (g_sanitize && sanitize_init() != 0) {
+        fprintf(stderr, "Error: Cannot initialise the sanitizer\n");
+        return EXIT_ERROR;
+    }
+    
     /* Determine config files to probe */
     const char **configs;
     int config_count;
@@ -787,12 +971,17 @@ int main(int argc, char *argv[]) {
         while (default_configs[config_count]) config_count++;
     }
     
+    /* Index socket ownership in the same /proc walk as the process list */
+    if (network_mode) {
+        proc_snapshot_request(PROC_SNAP_SOCKETS);
+    }
+    
     /* Handle --learn */
     if (learn_mode) {
         fingerprint_t fp;
         capture_fingerprint(&fp, configs, config_count);
         if (network_mode) {
-            probe_network(&fp.network);
+            probe_fingerprint_network(&fp);
         }
         
         /* Load existing baseline or create new */
@@ -806,6 +995,7 @@ int main(int argc, char *argv[]) {
         }
         
         baseline_learn(&baseline, &fp);
+        fingerprint_free(&fp);
         
         if (baseline_save(&baseline) == 0) {
             printf("Baseline saved to ~/.sentinel/baseline.dat\n");
@@ -829,7 +1019,7 @@ int main(int argc, char *argv[]) {
         fingerprint_t fp;
         capture_fingerprint(&fp, configs, config_count);
         if (network_mode) {
-            probe_network(&fp.network);
+            probe_fingerprint_network(&fp);
         }
         
         /* Run quick analysis */
@@ -850,6 +1040,7 @@ int main(int argc, char *argv[]) {
         
         int deviations = baseline_compare(&baseline, &fp, &report);
         baseline_print_report(&baseline, &report);
+        fingerprint_free(&fp);
         
         /* Also show audit if requested */
         if (audit_mode) {
@@ -867,7 +1058,7 @@ int main(int argc, char *argv[]) {
 #else
             audit_summary_t *audit = probe_audit(300);
             print_audit_summary_quick(audit);
-            if (audit) free_audit_summary(audit);
+            release_audit(audit);
 #endif
         }
         
@@ -877,6 +1068,12 @@ int main(int argc, char *argv[]) {
         return EXIT_OK;
     }
     
+    /* Exporter mode - serve the latest capture to Prometheus */
+    if (metrics_addr) {
+        return run_metrics_exporter(metrics_addr, configs, config_count,
+                                    interval, network_mode, audit_mode);
+    }
+    
     /* Watch mode - continuous monitoring */
     if (watch_mode) {
         /* Setup signal handler for clean shutdown */
@@ -884,18 +1081,91 @@ int main(int argc, char *argv[]) {
         signal(SIGTERM, signal_handler);
         
         fprintf(stderr, "C-Sentinel v%s - Watch Mode (Ctrl+C to stop)\n", SENTINEL_VERSION);
-        fprintf(stderr, "Interval: %d seconds\n", interval);
+        
+        /* Event sources; none (or --poll) means probing every interval */
+        int sources = poll_mode ? 0 : watch_init(configs, config_count);
+        if (sources) {
+            fprintf(stderr, "Events: %s%s%s, full resync every %d seconds\n",
+                    (sources & WATCH_EVENT_CONFIG) ? "config files" : "",
+                    sources == (WATCH_EVENT_CONFIG | WATCH_EVENT_PROCESS) ? " + " : "",
+                    (sources & WATCH_EVENT_PROCESS) ? "processes" : "",
+                    interval);
+        } else {
+            fprintf(stderr, "Interval: %d seconds\n", interval);
+        }
         if (audit_mode) {
             fprintf(stderr, "Audit: enabled\n");
         }
         fprintf(stderr, "\n");
         
         int worst_exit = EXIT_OK;
+        fingerprint_t current, prev;
+        int have_current = 0, have_prev = 0;
+        unsigned long sequence = 0;
         
         while (keep_running) {
+            watch_result_t changes;
+            unsigned events = WATCH_EVENT_RESYNC;
+            
+            if (have_current) {
+                events = sources ? watch_wait(interval * 1000, &changes) : WATCH_EVENT_RESYNC;
+                if (!keep_running) break;
+                if (events == 0) continue;
+            }
+            
+            /* Re-probe only what changed; a resync probes everything */
+            unsigned mask = FP_PROBE_SYSTEM;
+            if (events & (WATCH_EVENT_CONFIG | WATCH_EVENT_RESYNC)) mask |= FP_PROBE_CONFIGS;
+            if (events & (WATCH_EVENT_PROCESS | WATCH_EVENT_RESYNC)) {
+                mask |= FP_PROBE_PROCESSES;
+                if (network_mode) mask |= FP_PROBE_NETWORK;
+            }
+            
+            fingerprint_t next;
+            capture_fingerprint_partial(&next, have_current ? &current : NULL, mask,
+                                        configs, config_count);
+            if (mask & FP_PROBE_NETWORK) {
+                probe_fingerprint_network(&next);
+            }
+            if (have_prev) {
+                fingerprint_free(&prev);
+            }
+            prev = current;         /* Kept for the next delta */
+            have_prev = have_current;
+            current = next;
+            have_current = 1;
+            archive_fingerprint(&current);
+            
             print_timestamp();
-            int exit_code = run_analysis(configs, config_count, 
-                                         quick_mode || 1, json_mode, network_mode, audit_mode);
+            if (sources) {
+                if (events & WATCH_EVENT_RESYNC) {
+                    printf("(resync) ");
+                } else {
+                    if (events & WATCH_EVENT_CONFIG) {
+                        for (int i = 0; i < config_count; i++) {
+                            if (changes.config_changed && changes.config_changed[i]) {
+                                printf("(changed: %s) ", configs[i]);
+                            }
+                        }
+                    }
+                    if (events & WATCH_EVENT_PROCESS) {
+                        printf("(process events: %d) ", changes.process_events);
+                    }
+                }
+            }
+            /* JSON: a keyframe every keyframe_every documents, deltas between */
+            json_doc_t doc = { ++sequence, NULL };
+            fingerprint_delta_t delta;
+            int have_delta = 0;
+            if (json_mode && have_prev && (sequence - 1) % keyframe_every != 0) {
+                have_delta = fingerprint_delta(&delta, &prev, &current) == 0;
+                if (have_delta) doc.delta = &delta;
+            }
+            int exit_code = report_fingerprint(&current, &doc, quick_mode || 1, json_mode,
+                                               network_mode, audit_mode);
+            if (have_delta) {
+                fingerprint_delta_free(&delta);
+            }
             
             if (exit_code > worst_exit) worst_exit = exit_code;
             
@@ -906,11 +1176,20 @@ int main(int argc, char *argv[]) {
             } else {
                 printf(" [OK]\n");
             }
+            fflush(stdout);
             
-            if (keep_running) {
+            if (keep_running && !sources) {
                 sleep(interval);
             }
         }
+        
+        if (have_current) {
+            fingerprint_free(&current);
+        }
+        if (have_prev) {
+            fingerprint_free(&prev);
+        }
+        watch_close();
 
 #ifdef _AIX
         /* Cleanup SIEM resources */
@@ -0,0 +1,242 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * metrics.c - Render a fingerprint as OpenMetrics text
+ *
+ * Every family is a gauge: each page describes one refresh, and gauge
+ * families read the same in OpenMetrics and in the Prometheus 0.0.4
+ * text format, so one rendering serves both content types.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "metrics.h"
+
+#define PAGE_INITIAL 8192
+
+/* ============================================================
+ * Page buffer
+ * ============================================================ */
+
+static int page_reserve(metrics_page_t *p, size_t more) {
+    if (p->len + more + 1 <= p->cap) return 0;
+    size_t cap = p->cap ? p->cap : PAGE_INITIAL;
+    while (cap < p->len + more + 1) cap *= 2;
+    char *data = realloc(p->data, cap);
+    if (!data) {
+        p->failed = 1;
+        return -1;
+    }
+    p->data = data;
+    p->cap = cap;
+    return 0;
+}
+
+static int page_printf(metrics_page_t *p, const char *fmt, ...) {
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(p->data + p->len, p->cap - p->len, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        p->failed = 1;
+        return -1;
+    }
+    if ((size_t)n >= p->cap - p->len) {
+        if (page_reserve(p, (size_t)n) != 0) return -1;
+        va_start(ap, fmt);
+        vsnprintf(p->data + p->len, p->cap - p->len, fmt, ap);
+        va_end(ap);
+    }
+    p->len += (size_t)n;
+    return 0;
+}
+
+/* Label values escape backslash, double quote and newline */
+static int page_label_value(metrics_page_t *p, const char *s) {
+    if (page_reserve(p, strlen(s) * 2) != 0) return -1;
+    for (; *s; s++) {
+        if (*s == '\\' || *s == '"') {
+            p->data[p->len++] = '\\';
+            p->data[p->len++] = *s;
+        } else if (*s == '\n') {
+            p->data[p->len++] = '\\';
+            p->data[p->len++] = 'n';
+        } else {
+            p->data[p->len++] = *s;
+        }
+    }
+    p->data[p->len] = '\0';
+    return 0;
+}
+
+/* ============================================================
+ * Families
+ * ============================================================ */
+
+static void family(metrics_page_t *p, const char *name, const char *help) {
+    page_printf(p, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+/* Integral values print without a fraction */
+static void sample(metrics_page_t *p, const char *name, double value) {
+    page_printf(p, "%s %.15g\n", name, value);
+}
+
+static void sample_label(metrics_page_t *p, const char *name, const char *label,
+                         const char *label_value, double value) {
+    page_printf(p, "%s{%s=\"%s\"} %.15g\n", name, label, label_value, value);
+}
+
+static void gauge(metrics_page_t *p, const char *name, const char *help, double value) {
+    family(p, name, help);
+    sample(p, name, value);
+}
+
+static void render_system(metrics_page_t *p, const metrics_input_t *in) {
+    const fingerprint_t *fp = in->fp;
+
+    family(p, "sentinel_info", "Build and host identity");
+    page_printf(p, "sentinel_info{version=\"%s\",hostname=\"", SENTINEL_VERSION);
+    page_label_value(p, fp->system.hostname);
+    page_printf(p, "\",kernel=\"");
+    page_label_value(p, fp->system.kernel_version);
+    page_printf(p, "\"} 1\n");
+
+    gauge(p, "sentinel_status", "Overall result: 0 ok, 1 warnings, 2 critical (the one-shot exit code)",
+          in->status);
+    gauge(p, "sentinel_last_refresh_timestamp_seconds", "When the data on this page was captured",
+          (double)fp->system.probe_time);
+    gauge(p, "sentinel_refreshes", "Refreshes since the exporter started", (double)in->refreshes);
+    gauge(p, "sentinel_probe_duration_seconds", "Fingerprint capture time",
+          fp->probe_duration_ms / 1000.0);
+    gauge(p, "sentinel_probe_errors", "Probes that failed in the last capture", fp->probe_errors);
+
+    gauge(p, "sentinel_uptime_seconds", "System uptime", (double)fp->system.uptime_seconds);
+    family(p, "sentinel_load_average", "Load average");
+    sample_label(p, "sentinel_load_average", "period", "1m", fp->system.load_avg[0]);
+    sample_label(p, "sentinel_load_average", "period", "5m", fp->system.load_avg[1]);
+    sample_label(p, "sentinel_load_average", "period", "15m", fp->system.load_avg[2]);
+    gauge(p, "sentinel_memory_total_bytes", "Physical memory", (double)fp->system.total_ram);
+    gauge(p, "sentinel_memory_free_bytes", "Free physical memory", (double)fp->system.free_ram);
+
+    gauge(p, "sentinel_processes", "Processes", fp->process_count);
+    gauge(p, "sentinel_config_files", "Config files checked", fp->config_count);
+    gauge(p, "sentinel_listening_sockets", "Listening sockets (with -n)",
+          fp->network.total_listening);
+    gauge(p, "sentinel_established_connections", "Established connections (with -n)",
+          fp->network.total_established);
+}
+
+static void render_analysis(metrics_page_t *p, const quick_analysis_t *a) {
+    gauge(p, "sentinel_zombie_processes", "Zombie processes", a->zombie_process_count);
+    gauge(p, "sentinel_high_fd_processes", "Processes with more than 100 open files",
+          a->high_fd_process_count);
+    gauge(p, "sentinel_long_running_processes", "Processes running more than 7 days",
+          a->long_running_process_count);
+    gauge(p, "sentinel_config_permission_issues", "World-writable or otherwise unsafe config files",
+          a->config_permission_issues);
+    gauge(p, "sentinel_unusual_listeners", "Listeners on ports outside the common services",
+          a->unusual_listeners);
+    gauge(p, "sentinel_external_connections", "Connections to non-local addresses",
+          a->external_connections);
+    gauge(p, "sentinel_issues", "Issues found by the quick analysis", a->total_issues);
+}
+
+static void render_deviations(metrics_page_t *p, const deviation_report_t *d) {
+    gauge(p, "sentinel_baseline_loaded", "1 if a learned baseline was compared against", d != NULL);
+    if (!d) return;
+
+    family(p, "sentinel_baseline_deviations", "Deviations from the learned baseline");
+    sample_label(p, "sentinel_baseline_deviations", "kind", "new_listeners", d->new_listeners);
+    sample_label(p, "sentinel_baseline_deviations", "kind", "missing_listeners", d->missing_listeners);
+    sample_label(p, "sentinel_baseline_deviations", "kind", "config_changes", d->config_changes);
+    sample_label(p, "sentinel_baseline_deviations", "kind", "process_count", d->process_count_anomaly);
+    sample_label(p, "sentinel_baseline_deviations", "kind", "memory", d->memory_anomaly);
+    sample_label(p, "sentinel_baseline_deviations", "kind", "load", d->load_anomaly);
+}
+
+static void render_audit(metrics_page_t *p, const metrics_input_t *in) {
+    const char *events = "sentinel_audit_events";
+
+    if (!in->audit) return;
+    gauge(p, "sentinel_audit_enabled", "1 if the audit subsystem could be read", in->audit->enabled);
+    if (!in->audit->enabled) return;
+
+    gauge(p, "sentinel_audit_risk_score", "Audit risk score", in->audit->risk_score);
+    gauge(p, "sentinel_audit_brute_force_detected", "1 if a brute force pattern was seen",
+          in->audit->brute_force_detected);
+
+    family(p, events, "Audit events in the last 5 minutes");
+#ifdef _AIX
+    const aix_audit_summary_t *a = in->audit;
+    sample_label(p, events, "kind", "all", a->total_events);
+    sample_label(p, events, "kind", "auth_success", a->auth_success);
+    sample_label(p, events, "kind", "auth_failure", a->auth_failures);
+    sample_label(p, events, "kind", "su_success", a->su_success);
+    sample_label(p, events, "kind", "su_failure", a->su_failures);
+    sample_label(p, events, "kind", "sudo", a->sudo_count);
+    sample_label(p, events, "kind", "sensitive_read", a->sensitive_reads);
+    sample_label(p, events, "kind", "sensitive_write", a->sensitive_writes);
+    sample_label(p, events, "kind", "access_denied", a->file_access_denied);
+    sample_label(p, events, "kind", "exec", a->process_execs);
+#else
+    const audit_summary_t *a = in->audit;
+    sample_label(p, events, "kind", "auth_failure", a->auth_failures);
+    sample_label(p, events, "kind", "sudo", a->sudo_count);
+    sample_label(p, events, "kind", "su", a->su_count);
+    sample_label(p, events, "kind", "setuid_exec", a->setuid_executions);
+    sample_label(p, events, "kind", "capability_change", a->capability_changes);
+    sample_label(p, events, "kind", "permission_change", a->permission_changes);
+    sample_label(p, events, "kind", "ownership_change", a->ownership_changes);
+    sample_label(p, events, "kind", "sensitive_file", a->sensitive_file_count);
+    sample_label(p, events, "kind", "tmp_exec", a->tmp_executions);
+    sample_label(p, events, "kind", "devshm_exec", a->devshm_executions);
+    sample_label(p, events, "kind", "shell_spawn", a->shell_spawns);
+    sample_label(p, events, "kind", "selinux_denial", a->selinux_avc_denials);
+    sample_label(p, events, "kind", "apparmor_denial", a->apparmor_denials);
+
+    gauge(p, "sentinel_audit_anomalies", "Audit anomalies against the audit baseline",
+          a->anomaly_count);
+#endif
+}
+
+metrics_page_t *metrics_render(const metrics_input_t *in) {
+    metrics_page_t *p = calloc(1, sizeof(*p));
+    if (!p || page_reserve(p, PAGE_INITIAL - 1) != 0) {
+        metrics_page_free(p);
+        return NULL;
+    }
+    p->refs = 1;
+
+    render_system(p, in);
+    if (in->analysis) render_analysis(p, in->analysis);
+    render_deviations(p, in->deviations);
+    render_audit(p, in);
+    page_printf(p, "# EOF\n");
+
+    if (p->failed) {
+        metrics_page_free(p);
+        return NULL;
+    }
+    return p;
+}
+
+void metrics_page_free(metrics_page_t *page) {
+    if (!page) return;
+    free(page->data);
+    free(page);
+}
@@ -0,0 +1,462 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * metrics_server.c - HTTP server for /metrics
+ *
+ * A connection reads one request head at a time and answers it from the
+ * page current when the request completed, holding a reference until
+ * the response is sent. GET and HEAD only; a request body is not
+ * expected, so anything but GET/HEAD closes the connection after the
+ * 405. Sockets are non-blocking and never block the loop.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+#include "metrics.h"
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define CT_OPENMETRICS "application/openmetrics-text; version=1.0.0; charset=utf-8"
+#define CT_PROMETHEUS "text/plain; version=0.0.4; charset=utf-8"
+
+static const char INDEX_BODY[] = "C-Sentinel exporter: metrics are at /metrics\n";
+static const char NOT_READY_BODY[] = "No data yet: the first refresh has not finished\n";
+
+typedef struct {
+    int fd;
+    int64_t last_ms;            /* Last activity, for the idle timeout */
+
+    char in[METRICS_REQUEST_MAX];
+    size_t in_len;
+
+    /* Response being sent: head, then body from page or a static string */
+    int writing;
+    int close_after;
+    char head[256];
+    size_t head_len;
+    metrics_page_t *page;       /* Referenced while the body is sent */
+    const char *body;
+    size_t body_len;
+    size_t sent;                /* Of head + body */
+} conn_t;
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void page_put(metrics_server_t *s, metrics_page_t *page) {
+    if (!page) return;
+    pthread_mutex_lock(&s->lock);
+    int refs = --page->refs;
+    pthread_mutex_unlock(&s->lock);
+    if (refs == 0) metrics_page_free(page);
+}
+
+static void conn_close(metrics_server_t *s, conn_t *c) {
+    page_put(s, c->page);
+    close(c->fd);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+/* ============================================================
+ * Requests
+ * ============================================================ */
+
+/* Value of header name in the request head, or NULL */
+static const char *find_header(const char *head, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    const char *line = strstr(head, "\r\n");
+
+    while (line && line[2] != '\r') {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *v = line + name_len + 1;
+            while (*v == ' ' || *v == '\t') v++;
+            *len = strcspn(v, "\r");
+            return v;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return NULL;
+}
+
+static int header_has(const char *head, const char *name, const char *token) {
+    size_t len;
+    const char *v = find_header(head, name, &len);
+    size_t token_len = strlen(token);
+
+    for (; v && len >= token_len; v++, len--) {
+        if (strncasecmp(v, token, token_len) == 0) return 1;
+    }
+    return 0;
+}
+
+static void respond(conn_t *c, int status, const char *reason, const char *type,
+                    const char *body, size_t body_len, int head_only) {
+    int n = snprintf(c->head, sizeof(c->head),
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %lu\r\n"
+                     "%s"
+                     "\r\n",
+                     status, reason, type, (unsigned long)body_len,
+                     c->close_after ? "Connection: close\r\n" : "");
+    c->head_len = (size_t)n;
+    c->body = head_only ? NULL : body;
+    c->body_len = head_only ? 0 : body_len;
+    c->sent = 0;
+    c->writing = 1;
+}
+
+/* Parse the request head ending at end; sets up the response */
+static void handle_request(metrics_server_t *s, conn_t *c, char *end) {
+    char method[8], target[256], version[16];
+    int head_only;
+
+    *end = '\0';
+    if (sscanf(c->in, "%7s %255s %15s", method, target, version) != 3 ||
+        strncmp(version, "HTTP/1.", 7) != 0) {
+        c->close_after = 1;
+        respond(c, 400, "Bad Request", "text/plain", "Bad request\n", 12, 0);
+        return;
+    }
+
+    /* HTTP/1.1 keeps the connection unless told otherwise; 1.0 the reverse */
+    if (strcmp(version, "HTTP/1.0") == 0) {
+        c->close_after = !header_has(c->in, "Connection", "keep-alive");
+    } else {
+        c->close_after = header_has(c->in, "Connection", "close");
+    }
+
+    head_only = strcmp(method, "HEAD") == 0;
+    if (!head_only && strcmp(method, "GET") != 0) {
+        c->close_after = 1;
+        respond(c, 405, "Method Not Allowed", "text/plain", "GET only\n", 9, 0);
+        return;
+    }
+
+    target[strcspn(target, "?")] = '\0';
+    if (strcmp(target, "/metrics") == 0) {
+        pthread_mutex_lock(&s->lock);
+        metrics_page_t *page = s->page;
+        if (page) page->refs++;
+        pthread_mutex_unlock(&s->lock);
+
+        if (!page) {
+            respond(c, 503, "Service Unavailable", "text/plain",
+                    NOT_READY_BODY, sizeof(NOT_READY_BODY) - 1, head_only);
+            return;
+        }
+        c->page = page;
+        s->scrapes++;
+        respond(c, 200, "OK",
+                header_has(c->in, "Accept", "application/openmetrics-text") ?
+                    CT_OPENMETRICS : CT_PROMETHEUS,
+                page->data, page->len, head_only);
+    } else if (strcmp(target, "/") == 0) {
+        respond(c, 200, "OK", "text/plain", INDEX_BODY, sizeof(INDEX_BODY) - 1, head_only);
+    } else {
+        respond(c, 404, "Not Found", "text/plain", "Not found\n", 10, head_only);
+    }
+}
+
+/* Answer the request at the front of the input, if it is complete */
+static int take_request(metrics_server_t *s, conn_t *c) {
+    char *end = strstr(c->in, "\r\n\r\n");
+    if (!end) return 0;
+
+    size_t used = (size_t)(end + 4 - c->in);
+    handle_request(s, c, end + 2);
+    memmove(c->in, c->in + used, c->in_len - used);
+    c->in_len -= used;
+    c->in[c->in_len] = '\0';
+    return 1;
+}
+
+/* Read what is there; returns -1 when the connection is done */
+static int conn_read(metrics_server_t *s, conn_t *c) {
+    for (;;) {
+        if (c->in_len == sizeof(c->in) - 1) {
+            c->close_after = 1;
+            respond(c, 431, "Request Header Fields Too Large", "text/plain",
+                    "Request too large\n", 18, 0);
+            return 0;
+        }
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        c->in_len += (size_t)n;
+        c->in[c->in_len] = '\0';
+        c->last_ms = now_ms();
+
+        /* A pipelined request waits until this response is out */
+        if (take_request(s, c)) return 0;
+    }
+}
+
+/* Send what the socket takes; returns -1 when the connection is done */
+static int conn_write(metrics_server_t *s, conn_t *c) {
+    while (c->writing) {
+        struct iovec iov[2];
+        struct msghdr msg;
+        int cnt = 0;
+
+        if (c->sent < c->head_len) {
+            iov[cnt].iov_base = c->head + c->sent;
+            iov[cnt++].iov_len = c->head_len - c->sent;
+        }
+        size_t body_off = c->sent > c->head_len ? c->sent - c->head_len : 0;
+        if (body_off < c->body_len) {
+            iov[cnt].iov_base = (char *)c->body + body_off;
+            iov[cnt++].iov_len = c->body_len - body_off;
+        }
+
+        if (cnt == 0) {
+            /* Response complete */
+            page_put(s, c->page);
+            c->page = NULL;
+            c->writing = 0;
+            if (c->close_after) return -1;
+            take_request(s, c);
+            continue;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = cnt;
+        ssize_t n = sendmsg(c->fd, &msg, SEND_FLAGS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        c->sent += (size_t)n;
+        c->last_ms = now_ms();
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Server thread
+ * ============================================================ */
+
+static void accept_all(metrics_server_t *s, conn_t *conns) {
+    for (;;) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+
+        conn_t *c = NULL;
+        for (int i = 0; i < METRICS_MAX_CONNS && !c; i++) {
+            if (conns[i].fd < 0) c = &conns[i];
+        }
+        if (!c) {
+            close(fd);
+            s->rejected++;
+            continue;
+        }
+        set_nonblocking(fd);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        memset(c, 0, sizeof(*c));
+        c->fd = fd;
+        c->last_ms = now_ms();
+        s->connections++;
+    }
+}
+
+static void *server_main(void *arg) {
+    metrics_server_t *s = arg;
+    conn_t *conns = s->conns;
+    struct pollfd pfds[METRICS_MAX_CONNS + 2];
+    int slot_of[METRICS_MAX_CONNS + 2];
+
+    for (;;) {
+        int n = 0;
+        pfds[n].fd = s->wake[0];
+        pfds[n++].events = POLLIN;
+        pfds[n].fd = s->listen_fd;
+        pfds[n++].events = POLLIN;
+        for (int i = 0; i < METRICS_MAX_CONNS; i++) {
+            if (conns[i].fd < 0) continue;
+            slot_of[n] = i;
+            pfds[n].fd = conns[i].fd;
+            pfds[n++].events = conns[i].writing ? POLLOUT : POLLIN;
+        }
+
+        if (poll(pfds, (nfds_t)n, 1000) < 0 && errno != EINTR) break;
+        if (pfds[0].revents) break;
+        if (pfds[1].revents & POLLIN) accept_all(s, conns);
+
+        for (int k = 2; k < n; k++) {
+            conn_t *c = &conns[slot_of[k]];
+            if (!pfds[k].revents) continue;
+            int rc = 0;
+            if (!c->writing && (pfds[k].revents & (POLLIN | POLLHUP | POLLERR))) rc = conn_read(s, c);
+            if (rc == 0 && c->writing) rc = conn_write(s, c);
+            if (rc != 0) conn_close(s, c);
+        }
+
+        /* Idle keep-alives and stalled requests */
+        int64_t now = now_ms();
+        for (int i = 0; i < METRICS_MAX_CONNS; i++) {
+            if (conns[i].fd >= 0 && now - conns[i].last_ms > METRICS_IDLE_MS) {
+                conn_close(s, &conns[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < METRICS_MAX_CONNS; i++) {
+        if (conns[i].fd >= 0) conn_close(s, &conns[i]);
+    }
+    return NULL;
+}
+
+/* ============================================================
+ * Lifecycle
+ * ============================================================ */
+
+static int open_listener(const char *listen_addr) {
+    struct addrinfo hints, *res, *ai;
+    char host[128];
+    const char *colon = strrchr(listen_addr, ':');
+    const char *port;
+    int fd = -1;
+
+    if (!colon || colon[1] == '\0') return -1;
+    port = colon + 1;
+    size_t host_len = (size_t)(colon - listen_addr);
+    /* [::1]:9464 */
+    if (host_len >= 2 && listen_addr[0] == '[' && listen_addr[host_len - 1] == ']') {
+        listen_addr++;
+        host_len -= 2;
+    }
+    if (host_len >= sizeof(host)) return -1;
+    memcpy(host, listen_addr, host_len);
+    host[host_len] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host_len ? host : NULL, port, &hints, &res) != 0) return -1;
+
+    for (ai = res; ai && fd < 0; ai = ai->ai_next) {
+        int one = 1;
+        fd = socket(ai->ai_family, SOCK_STREAM, 0);
+        if (fd < 0) continue;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 64) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) set_nonblocking(fd);
+    return fd;
+}
+
+int metrics_server_start(metrics_server_t *s, const char *listen_addr) {
+    sigset_t all, old;
+
+    memset(s, 0, sizeof(*s));
+    s->wake[0] = s->wake[1] = -1;
+    snprintf(s->addr, sizeof(s->addr), "%s", listen_addr);
+
+    errno = 0;
+    s->listen_fd = open_listener(listen_addr);
+    if (s->listen_fd < 0) {
+        fprintf(stderr, "Error: Cannot listen on %s: %s\n", listen_addr,
+                errno ? strerror(errno) : "expected [HOST]:PORT");
+        return -1;
+    }
+    s->conns = calloc(METRICS_MAX_CONNS, sizeof(conn_t));
+    if (!s->conns || pipe(s->wake) != 0) {
+        free(s->conns);
+        close(s->listen_fd);
+        return -1;
+    }
+    for (int i = 0; i < METRICS_MAX_CONNS; i++) ((conn_t *)s->conns)[i].fd = -1;
+    pthread_mutex_init(&s->lock, NULL);
+
+#if !defined(MSG_NOSIGNAL) && !defined(SO_NOSIGPIPE)
+    /* A scraper going away mid-response must not kill the process */
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    /* Signals stay with the main thread, whose sleep they interrupt */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int rc = pthread_create(&s->thread, NULL, server_main, s);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        free(s->conns);
+        close(s->listen_fd);
+        close(s->wake[0]);
+        close(s->wake[1]);
+        pthread_mutex_destroy(&s->lock);
+        return -1;
+    }
+    s->running = 1;
+    return 0;
+}
+
+void metrics_server_publish(metrics_server_t *s, metrics_page_t *page) {
+    pthread_mutex_lock(&s->lock);
+    metrics_page_t *old = s->page;
+    s->page = page;
+    int refs = old ? --old->refs : 1;
+    pthread_mutex_unlock(&s->lock);
+    if (refs == 0) metrics_page_free(old);
+}
+
+void metrics_server_stop(metrics_server_t *s) {
+    if (!s->running) return;
+    while (write(s->wake[1], "x", 1) < 0 && errno == EINTR) {}
+    pthread_join(s->thread, NULL);
+    s->running = 0;
+    free(s->conns);
+
+    close(s->listen_fd);
+    close(s->wake[0]);
+    close(s->wake[1]);
+    metrics_server_publish(s, NULL);
+    pthread_mutex_destroy(&s->lock);
+}
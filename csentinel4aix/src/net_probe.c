@@ -16,6 +16,7 @@
 #include <string.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <time.h>
 #include <arpa/inet.h>
 #ifdef _AIX
 #include <libperfstat.h>
@@ -23,6 +24,12 @@
 #include <netinet/in.h>
 #include <sys/procfs.h>
 #include <fcntl.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
 #endif
 
 #include "sentinel.h"
@@ -75,8 +82,14 @@ static void hex_to_ip(const char *hex, char *ip, size_t ip_len, int is_ipv6) {
     }
 }
 
-/* Get process name from pid */
+/* Get process name from pid - snapshot first, /proc for late arrivals */
 static void get_process_name(pid_t pid, char *name, size_t name_len) {
+    const proc_entry_t *pe = proc_snapshot_find(proc_snapshot_current(), pid);
+    if (pe) {
+        snprintf(name, name_len, "%s", pe->info.name);
+        return;
+    }
+
 #ifdef _AIX
     /* AIX: Read from /proc/<pid>/psinfo */
     char path[64];
@@ -115,50 +128,109 @@ static void get_process_name(pid_t pid, char *name, size_t name_len) {
 #endif
 }
 
-/* Find PID for a given inode from /proc/[pid]/fd/ */
-static pid_t find_pid_for_inode(unsigned long inode) {
-    DIR *proc_dir;
-    struct dirent *proc_entry;
-    char path[512], link_target[512];
-    char inode_str[64];
-    
-    snprintf(inode_str, sizeof(inode_str), "socket:[%lu]", inode);
-    
-    proc_dir = opendir("/proc");
-    if (!proc_dir) return 0;
-    
-    while ((proc_entry = readdir(proc_dir)) != NULL) {
-        /* Only look at numeric directories (PIDs) */
-        if (proc_entry->d_name[0] < '0' || proc_entry->d_name[0] > '9')
-            continue;
-            
-        pid_t pid = atoi(proc_entry->d_name);
-        char fd_path[128];
-        DIR *fd_dir;
-        struct dirent *fd_entry;
-        
-        snprintf(fd_path, sizeof(fd_path), "/proc/%d/fd", pid);
-        fd_dir = opendir(fd_path);
-        if (!fd_dir) continue;
-        
-        while ((fd_entry = readdir(fd_dir)) != NULL) {
-            snprintf(path, sizeof(path), "%s/%s", fd_path, fd_entry->d_name);
-            ssize_t len = readlink(path, link_target, sizeof(link_target) - 1);
-            if (len > 0) {
-                link_target[len] = '\0';
-                if (strcmp(link_target, inode_str) == 0) {
-                    closedir(fd_dir);
-                    closedir(proc_dir);
-                    return pid;
-                }
-            }
+/* ============================================================
+ * Socket Owner Index
+ * ============================================================
+ * An open-addressed inode -> pid table built once per probe from the
+ * process snapshot. Parsing only records each socket's inode; owners
+ * are resolved in one pass afterwards so the cost stays linear in the
+ * number of sockets and can be timed as a whole.
+ */
+
+typedef struct {
+    unsigned long inode;        /* 0 marks an empty slot */
+    pid_t pid;
+} inode_slot_t;
+
+static inode_slot_t *inode_index = NULL;
+static int inode_index_size = 0;
+
+/* Arena the current probe allocates socket arrays and strings from */
+static arena_t *net_arena = NULL;
+
+static unsigned inode_hash(unsigned long inode) {
+    /* 64-bit mix so sequential inodes spread across the table */
+    uint64_t h = (uint64_t)inode;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (unsigned)h;
+}
+
+static int build_inode_index(const proc_snapshot_t *snap) {
+    int needed = 64;
+    int sockets = snap ? snap->socket_count : 0;
+    while (needed < sockets * 2) needed *= 2;
+
+    /* Keep the table between probes, only grow it */
+    if (needed > inode_index_size) {
+        inode_slot_t *grown = realloc(inode_index, needed * sizeof(*grown));
+        if (!grown) {
+            /* Leave an empty table so every lookup misses cleanly */
+            free(inode_index);
+            inode_index = NULL;
+            inode_index_size = 0;
+            return -1;
+        }
+        inode_index = grown;
+        inode_index_size = needed;
+    }
+    memset(inode_index, 0, inode_index_size * sizeof(*inode_index));
+
+    unsigned mask = (unsigned)inode_index_size - 1;
+    for (int i = 0; i < sockets; i++) {
+        const proc_socket_t *sk = &snap->sockets[i];
+        unsigned slot = inode_hash(sk->inode) & mask;
+
+        /* Shared sockets keep their first owner in /proc order */
+        while (inode_index[slot].inode != 0 && inode_index[slot].inode != sk->inode) {
+            slot = (slot + 1) & mask;
+        }
+        if (inode_index[slot].inode == 0) {
+            inode_index[slot].inode = sk->inode;
+            inode_index[slot].pid = sk->pid;
         }
-        closedir(fd_dir);
     }
-    closedir(proc_dir);
     return 0;
 }
 
+/* Find PID for a given socket inode */
+static pid_t find_pid_for_inode(unsigned long inode) {
+    if (inode == 0 || inode_index_size == 0) return 0;
+
+    unsigned mask = (unsigned)inode_index_size - 1;
+    unsigned slot = inode_hash(inode) & mask;
+    while (inode_index[slot].inode != 0) {
+        if (inode_index[slot].inode == inode) return inode_index[slot].pid;
+        slot = (slot + 1) & mask;
+    }
+    return 0;
+}
+
+/* Interned name of the process owning pid, "[kernel]" for pid 0 */
+static const char *owner_name(pid_t pid) {
+    char name[256];
+    if (pid <= 0) {
+        return arena_intern(net_arena, "[kernel]");
+    }
+    get_process_name(pid, name, sizeof(name));
+    return arena_intern(net_arena, name);
+}
+
+/* Resolve owner pid and name for everything the backends collected */
+static void attribute_socket_owners(network_info_t *net) {
+    for (int i = 0; i < net->listener_count; i++) {
+        net_listener_t *l = &net->listeners[i];
+        l->pid = find_pid_for_inode(l->inode);
+        l->process_name = owner_name(l->pid);
+    }
+    for (int i = 0; i < net->connection_count; i++) {
+        net_connection_t *c = &net->connections[i];
+        c->pid = find_pid_for_inode(c->inode);
+        c->process_name = owner_name(c->pid);
+    }
+}
+
 /* TCP state names */
 static const char *tcp_state_name(int state) {
     static const char *states[] = {
@@ -179,6 +251,125 @@ static const char *tcp_state_name(int state) {
     return "UNKNOWN";
 }
 
+/* ============================================================
+ * Socket Recording - Shared by the procfs and netlink backends
+ * ============================================================ */
+
+#define TCP_STATE_ESTABLISHED 0x01
+#define TCP_STATE_CLOSE       0x07
+#define TCP_STATE_LISTEN      0x0A
+
+/* Append a zeroed listener slot, growing the arena-backed array */
+static net_listener_t *add_listener(network_info_t *net) {
+    net_listener_t *grown = arena_grow(net_arena, net->listeners, sizeof(net_listener_t),
+                                       net->listener_count, &net->listener_capacity);
+    if (!grown) return NULL;
+    net->listeners = grown;
+    return &net->listeners[net->listener_count++];
+}
+
+/* Append a zeroed connection slot, growing the arena-backed array */
+static net_connection_t *add_connection(network_info_t *net) {
+    net_connection_t *grown = arena_grow(net_arena, net->connections, sizeof(net_connection_t),
+                                         net->connection_count, &net->connection_capacity);
+    if (!grown) return NULL;
+    net->connections = grown;
+    return &net->connections[net->connection_count++];
+}
+
+/* Record a TCP socket: listeners and established connections only */
+static void record_tcp_socket(network_info_t *net, int is_ipv6,
+                              const char *local_addr, unsigned int local_port,
+                              const char *remote_addr, unsigned int remote_port,
+                              unsigned int state, unsigned long inode) {
+    /* Is this a listener? */
+    if (state == TCP_STATE_LISTEN) {
+        net_listener_t *l = add_listener(net);
+        if (!l) return;
+        
+        l->protocol = arena_intern(net_arena, is_ipv6 ? "tcp6" : "tcp");
+        l->local_addr = arena_intern(net_arena, local_addr);
+        l->local_port = local_port;
+        l->state = arena_intern(net_arena, tcp_state_name(state));
+        
+        /* Owner is resolved later by attribute_socket_owners() */
+        l->inode = inode;
+        
+        net->total_listening++;
+        
+        if (!is_common_port(local_port)) {
+            net->unusual_port_count++;
+        }
+    }
+    /* Is this an established connection? */
+    else if (state == TCP_STATE_ESTABLISHED) {
+        net_connection_t *c = add_connection(net);
+        if (!c) return;
+        
+        c->protocol = arena_intern(net_arena, is_ipv6 ? "tcp6" : "tcp");
+        c->local_addr = arena_intern(net_arena, local_addr);
+        c->local_port = local_port;
+        c->remote_addr = arena_intern(net_arena, remote_addr);
+        c->remote_port = remote_port;
+        c->state = arena_intern(net_arena, tcp_state_name(state));
+        c->inode = inode;
+        
+        net->total_established++;
+    }
+}
+
+/* Record a UDP socket as a listener if it is bound */
+static void record_udp_socket(network_info_t *net, int is_ipv6,
+                              const char *local_addr, unsigned int local_port,
+                              unsigned int state, unsigned long inode) {
+    /* UDP sockets with state 07 are listening */
+    if (state == TCP_STATE_CLOSE || local_port > 0) {
+        net_listener_t *l = add_listener(net);
+        if (!l) return;
+        
+        l->protocol = arena_intern(net_arena, is_ipv6 ? "udp6" : "udp");
+        l->local_addr = arena_intern(net_arena, local_addr);
+        l->local_port = local_port;
+        l->state = arena_intern(net_arena, "LISTEN");
+        l->inode = inode;
+        
+        net->total_listening++;
+        
+        if (!is_common_port(local_port)) {
+            net->unusual_port_count++;
+        }
+    }
+}
+
+/* ============================================================
+ * procfs Backend - Text /proc/net/{tcp,udp}{,6}
+ * ============================================================ */
+
+/* Parse one socket line; both tcp and udp files share the layout */
+static int parse_socket_line(const char *line, int is_ipv6,
+                             char *local_addr, char *remote_addr, size_t addr_len,
+                             unsigned int *local_port, unsigned int *remote_port,
+                             unsigned int *state, unsigned long *inode) {
+    char local_addr_hex[64], remote_addr_hex[64];
+    
+    /* Parse the line - format varies slightly between v4 and v6 */
+    if (is_ipv6) {
+        if (sscanf(line, "%*d: %32[0-9A-Fa-f]:%X %32[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
+                   local_addr_hex, local_port,
+                   remote_addr_hex, remote_port,
+                   state, inode) != 6) return -1;
+    } else {
+        if (sscanf(line, "%*d: %8[0-9A-Fa-f]:%X %8[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
+                   local_addr_hex, local_port,
+                   remote_addr_hex, remote_port,
+                   state, inode) != 6) return -1;
+    }
+    
+    hex_to_ip(local_addr_hex, local_addr, addr_len, is_ipv6);
+    hex_to_ip(remote_addr_hex, remote_addr, addr_len, is_ipv6);
+    return 0;
+}
+
 /* Parse /proc/net/tcp or /proc/net/tcp6 */
 static int parse_tcp_file(const char *filename, network_info_t *net, int is_ipv6) {
     FILE *f = fopen(filename, "r");
@@ -192,69 +383,16 @@ static int parse_tcp_file(const char *filename, network_info_t *net, int is_ipv6
     }
     
     while (fgets(line, sizeof(line), f)) {
-        char local_addr_hex[64], remote_addr_hex[64];
+        char local_addr[64], remote_addr[64];
         unsigned int local_port, remote_port;
         unsigned int state;
         unsigned long inode;
         
-        /* Parse the line - format varies slightly between tcp and tcp6 */
-        if (is_ipv6) {
-            if (sscanf(line, "%*d: %32[0-9A-Fa-f]:%X %32[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
-                       local_addr_hex, &local_port,
-                       remote_addr_hex, &remote_port,
-                       &state, &inode) != 6) continue;
-        } else {
-            if (sscanf(line, "%*d: %8[0-9A-Fa-f]:%X %8[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
-                       local_addr_hex, &local_port,
-                       remote_addr_hex, &remote_port,
-                       &state, &inode) != 6) continue;
-        }
+        if (parse_socket_line(line, is_ipv6, local_addr, remote_addr, sizeof(local_addr),
+                              &local_port, &remote_port, &state, &inode) != 0) continue;
         
-        /* Is this a listener? */
-        if (state == 0x0A && net->listener_count < MAX_LISTENERS) {
-            net_listener_t *l = &net->listeners[net->listener_count];
-            
-            snprintf(l->protocol, sizeof(l->protocol), is_ipv6 ? "tcp6" : "tcp");
-            hex_to_ip(local_addr_hex, l->local_addr, sizeof(l->local_addr), is_ipv6);
-            l->local_port = local_port;
-            snprintf(l->state, sizeof(l->state), "%s", tcp_state_name(state));
-            
-            /* Find owning process */
-            l->pid = find_pid_for_inode(inode);
-            if (l->pid > 0) {
-                get_process_name(l->pid, l->process_name, sizeof(l->process_name));
-            } else {
-                snprintf(l->process_name, sizeof(l->process_name), "[kernel]");
-            }
-            
-            net->listener_count++;
-            net->total_listening++;
-            
-            if (!is_common_port(local_port)) {
-                net->unusual_port_count++;
-            }
-        }
-        /* Is this an established connection? */
-        else if (state == 0x01 && net->connection_count < MAX_CONNECTIONS) {
-            net_connection_t *c = &net->connections[net->connection_count];
-            
-            snprintf(c->protocol, sizeof(c->protocol), is_ipv6 ? "tcp6" : "tcp");
-            hex_to_ip(local_addr_hex, c->local_addr, sizeof(c->local_addr), is_ipv6);
-            c->local_port = local_port;
-            hex_to_ip(remote_addr_hex, c->remote_addr, sizeof(c->remote_addr), is_ipv6);
-            c->remote_port = remote_port;
-            snprintf(c->state, sizeof(c->state), "%s", tcp_state_name(state));
-            
-            c->pid = find_pid_for_inode(inode);
-            if (c->pid > 0) {
-                get_process_name(c->pid, c->process_name, sizeof(c->process_name));
-            } else {
-                snprintf(c->process_name, sizeof(c->process_name), "[kernel]");
-            }
-            
-            net->connection_count++;
-            net->total_established++;
-        }
+        record_tcp_socket(net, is_ipv6, local_addr, local_port,
+                          remote_addr, remote_port, state, inode);
     }
     
     fclose(f);
@@ -273,52 +411,147 @@ static int parse_udp_file(const char *filename, network_info_t *net, int is_ipv6
         return -1;
     }
     
-    while (fgets(line, sizeof(line), f) && net->listener_count < MAX_LISTENERS) {
-        char local_addr_hex[64], remote_addr_hex[64];
+    while (fgets(line, sizeof(line), f)) {
+        char local_addr[64], remote_addr[64];
         unsigned int local_port, remote_port;
         unsigned int state;
         unsigned long inode;
         
-        if (is_ipv6) {
-            if (sscanf(line, "%*d: %32[0-9A-Fa-f]:%X %32[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
-                       local_addr_hex, &local_port,
-                       remote_addr_hex, &remote_port,
-                       &state, &inode) != 6) continue;
-        } else {
-            if (sscanf(line, "%*d: %8[0-9A-Fa-f]:%X %8[0-9A-Fa-f]:%X %X %*s %*s %*s %*d %*d %lu",
-                       local_addr_hex, &local_port,
-                       remote_addr_hex, &remote_port,
-                       &state, &inode) != 6) continue;
-        }
+        if (parse_socket_line(line, is_ipv6, local_addr, remote_addr, sizeof(local_addr),
+                              &local_port, &remote_port, &state, &inode) != 0) continue;
         
-        /* UDP sockets with state 07 are listening */
-        if (state == 0x07 || local_port > 0) {
-            net_listener_t *l = &net->listeners[net->listener_count];
-            
-            snprintf(l->protocol, sizeof(l->protocol), is_ipv6 ? "udp6" : "udp");
-            hex_to_ip(local_addr_hex, l->local_addr, sizeof(l->local_addr), is_ipv6);
-            l->local_port = local_port;
-            snprintf(l->state, sizeof(l->state), "LISTEN");
-            
-            l->pid = find_pid_for_inode(inode);
-            if (l->pid > 0) {
-                get_process_name(l->pid, l->process_name, sizeof(l->process_name));
-            } else {
-                snprintf(l->process_name, sizeof(l->process_name), "[kernel]");
+        record_udp_socket(net, is_ipv6, local_addr, local_port, state, inode);
+    }
+    
+    fclose(f);
+    return 0;
+}
+
+static int probe_network_procfs(network_info_t *net) {
+    /* Probe TCP */
+    parse_tcp_file("/proc/net/tcp", net, 0);
+    parse_tcp_file("/proc/net/tcp6", net, 1);
+
+    /* Probe UDP */
+    parse_udp_file("/proc/net/udp", net, 0);
+    parse_udp_file("/proc/net/udp6", net, 1);
+
+    return 0;
+}
+
+#ifndef _AIX
+/* ============================================================
+ * Netlink Backend - NETLINK_INET_DIAG (sock_diag)
+ * ============================================================
+ * The kernel streams binary inet_diag_msg records in batches and
+ * applies the state filter itself, so only sockets we would keep
+ * ever cross into user space.
+ */
+
+#define DIAG_RECV_BUF_SIZE 32768
+
+/* Format an address exactly as the procfs backend would show it */
+static void diag_addr_to_string(int family, const uint32_t addr[4],
+                                char *ip, size_t ip_len) {
+    if (family == AF_INET6) {
+        /* Same words /proc/net/tcp6 prints, so both backends agree */
+        snprintf(ip, ip_len, "%08X%08X%08X%08X",
+                 (unsigned int)addr[0], (unsigned int)addr[1],
+                 (unsigned int)addr[2], (unsigned int)addr[3]);
+    } else {
+        const unsigned char *b = (const unsigned char *)addr;
+        snprintf(ip, ip_len, "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+    }
+}
+
+/* Dump one family/protocol pair; returns 0 on success, -1 on failure */
+static int diag_dump(network_info_t *net, int family, int protocol, uint32_t states) {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_INET_DIAG);
+    if (fd < 0) return -1;
+
+    struct {
+        struct nlmsghdr nlh;
+        struct inet_diag_req_v2 req;
+    } request;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = 1;
+    request.req.sdiag_family = family;
+    request.req.sdiag_protocol = protocol;
+    request.req.idiag_states = states;
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    if (sendto(fd, &request, sizeof(request), 0,
+               (struct sockaddr *)&kernel, sizeof(kernel)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    int is_ipv6 = (family == AF_INET6);
+    long buf[DIAG_RECV_BUF_SIZE / sizeof(long)];    /* long-aligned for nlmsghdr */
+    int result = -1;
+
+    for (;;) {
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+        if (len <= 0) break;
+
+        struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+        for (; NLMSG_OK(nlh, (size_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_DONE) {
+                result = 0;
+                goto done;
+            }
+            if (nlh->nlmsg_type == NLMSG_ERROR) {
+                goto done;
             }
-            
-            net->listener_count++;
-            net->total_listening++;
-            
-            if (!is_common_port(local_port)) {
-                net->unusual_port_count++;
+            if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg))) {
+                continue;
+            }
+
+            const struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+            char local_addr[64], remote_addr[64];
+            diag_addr_to_string(family, msg->id.idiag_src, local_addr, sizeof(local_addr));
+            diag_addr_to_string(family, msg->id.idiag_dst, remote_addr, sizeof(remote_addr));
+
+            if (protocol == IPPROTO_UDP) {
+                record_udp_socket(net, is_ipv6, local_addr, ntohs(msg->id.idiag_sport),
+                                  msg->idiag_state, msg->idiag_inode);
+            } else {
+                record_tcp_socket(net, is_ipv6, local_addr, ntohs(msg->id.idiag_sport),
+                                  remote_addr, ntohs(msg->id.idiag_dport),
+                                  msg->idiag_state, msg->idiag_inode);
             }
         }
     }
-    
-    fclose(f);
+
+done:
+    close(fd);
+    return result;
+}
+
+static int probe_network_netlink(network_info_t *net) {
+    static const int families[] = { AF_INET, AF_INET6 };
+
+    /* TCP: the kernel drops everything but listeners and established */
+    uint32_t tcp_states = (1u << TCP_STATE_LISTEN) | (1u << TCP_STATE_ESTABLISHED);
+    for (int i = 0; i < 2; i++) {
+        if (diag_dump(net, families[i], IPPROTO_TCP, tcp_states) != 0) return -1;
+    }
+
+    /* UDP: any state, record_udp_socket() decides what counts */
+    for (int i = 0; i < 2; i++) {
+        if (diag_dump(net, families[i], IPPROTO_UDP, 0xFFFFFFFFu) != 0) return -1;
+    }
+
     return 0;
 }
+#endif
 
 #ifdef _AIX
 /* AIX doesn't have strcasestr, so implement it */
@@ -443,70 +676,28 @@ static const well_known_port_t well_known_ports[] = {
     {0, NULL}
 };
 
-/* Check if process has open sockets by examining /proc/[pid]/fd */
-static int process_has_sockets(pid_t pid) {
-    char fd_path[128];
-    DIR *fd_dir;
-    struct dirent *fd_entry;
-    int has_socket = 0;
-
-    snprintf(fd_path, sizeof(fd_path), "/proc/%d/fd", pid);
-    fd_dir = opendir(fd_path);
-    if (!fd_dir) return 0;
-
-    /* Check if any FD is a socket (starts with 's' in ls -l output) */
-    while ((fd_entry = readdir(fd_dir)) != NULL) {
-        if (fd_entry->d_name[0] == '.') continue;
-
-        char fd_full_path[256];
-        struct stat st;
-        snprintf(fd_full_path, sizeof(fd_full_path), "%s/%s", fd_path, fd_entry->d_name);
-
-        if (stat(fd_full_path, &st) == 0) {
-            /* Check if it's a socket (S_IFSOCK) */
-            if (S_ISSOCK(st.st_mode)) {
-                has_socket = 1;
-                break;
-            }
-        }
-    }
-
-    closedir(fd_dir);
-    return has_socket;
-}
-
 /* Build map of processes that have sockets open */
 static void build_pid_port_map(void) {
-    DIR *proc_dir;
-    struct dirent *proc_entry;
+    const proc_snapshot_t *snap = proc_snapshot_current();
     pid_port_map_count = 0;
 
-    proc_dir = opendir("/proc");
-    if (!proc_dir) return;
-
-    while ((proc_entry = readdir(proc_dir)) != NULL && pid_port_map_count < 512) {
-        /* Only look at numeric directories (PIDs) */
-        if (proc_entry->d_name[0] < '0' || proc_entry->d_name[0] > '9')
-            continue;
+    if (!snap) return;
 
-        pid_t pid = atoi(proc_entry->d_name);
+    for (int i = 0; i < snap->count && pid_port_map_count < 512; i++) {
+        const proc_entry_t *pe = &snap->procs[i];
 
         /* Check if this process has sockets open */
-        if (!process_has_sockets(pid))
+        if (!pe->has_sockets)
             continue;
 
-        char proc_name[64] = "[unknown]";
-        get_process_name(pid, proc_name, sizeof(proc_name));
-
         /* Store this PID and process name */
-        pid_port_map[pid_port_map_count].pid = pid;
+        pid_port_map[pid_port_map_count].pid = pe->info.pid;
         pid_port_map[pid_port_map_count].port = 0; /* Port unknown at this stage */
         snprintf(pid_port_map[pid_port_map_count].process_name,
                 sizeof(pid_port_map[pid_port_map_count].process_name),
-                "%s", proc_name);
+                "%s", pe->info.name);
         pid_port_map_count++;
     }
-    closedir(proc_dir);
 }
 
 /* Try to find PID for a given port using heuristics */
@@ -564,8 +755,7 @@ static int probe_network_aix_netstat(network_info_t *net) {
     fp = popen("/usr/bin/netstat -an -f inet -f inet6 | grep -E '(LISTEN|ESTABLISHED)'", "r");
     if (!fp) return -1;
 
-    while (fgets(line, sizeof(line), fp) &&
-           (net->listener_count < MAX_LISTENERS || net->connection_count < MAX_CONNECTIONS)) {
+    while (fgets(line, sizeof(line), fp)) {
         char proto[16], local[128], remote[128], state[32];
 
         /* Parse netstat output: tcp4  0  0  127.0.0.1.22  *.*  LISTEN */
@@ -579,24 +769,26 @@ static int probe_network_aix_netstat(network_info_t *net) {
             port = atoi(port_str + 1);
             *port_str = '\0'; /* Null-terminate address part */
 
-            if (strncmp(state, "LISTEN", 6) == 0 && net->listener_count < MAX_LISTENERS) {
+            if (strncmp(state, "LISTEN", 6) == 0) {
                 /* Add listener */
-                net_listener_t *l = &net->listeners[net->listener_count];
-                snprintf(l->protocol, sizeof(l->protocol), "%s", proto);
-                snprintf(l->local_addr, sizeof(l->local_addr), "%s", local);
+                net_listener_t *l = add_listener(net);
+                if (!l) continue;
+                l->protocol = arena_intern(net_arena, proto);
+                l->local_addr = arena_intern(net_arena, local);
                 l->local_port = port;
-                snprintf(l->state, sizeof(l->state), "LISTEN");
+                l->state = arena_intern(net_arena, "LISTEN");
 
                 /* Try to find PID using well-known port heuristics */
-                l->pid = find_pid_for_port(port, l->process_name, sizeof(l->process_name));
+                char proc_name[256];
+                l->pid = find_pid_for_port(port, proc_name, sizeof(proc_name));
+                l->process_name = arena_intern(net_arena, proc_name);
 
-                net->listener_count++;
                 net->total_listening++;
 
                 if (!is_common_port(port)) {
                     net->unusual_port_count++;
                 }
-            } else if (strncmp(state, "ESTABLISHED", 11) == 0 && net->connection_count < MAX_CONNECTIONS) {
+            } else if (strncmp(state, "ESTABLISHED", 11) == 0) {
                 /* Add connection */
                 char *remote_port_str = strrchr(remote, '.');
                 uint16_t remote_port = 0;
@@ -605,18 +797,20 @@ static int probe_network_aix_netstat(network_info_t *net) {
                     *remote_port_str = '\0';
                 }
 
-                net_connection_t *c = &net->connections[net->connection_count];
-                snprintf(c->protocol, sizeof(c->protocol), "%s", proto);
-                snprintf(c->local_addr, sizeof(c->local_addr), "%s", local);
+                net_connection_t *c = add_connection(net);
+                if (!c) continue;
+                c->protocol = arena_intern(net_arena, proto);
+                c->local_addr = arena_intern(net_arena, local);
                 c->local_port = port;
-                snprintf(c->remote_addr, sizeof(c->remote_addr), "%s", remote);
+                c->remote_addr = arena_intern(net_arena, remote);
                 c->remote_port = remote_port;
-                snprintf(c->state, sizeof(c->state), "ESTABLISHED");
+                c->state = arena_intern(net_arena, "ESTABLISHED");
 
                 /* Try to find PID using well-known port heuristics */
-                c->pid = find_pid_for_port(port, c->process_name, sizeof(c->process_name));
+                char proc_name[256];
+                c->pid = find_pid_for_port(port, proc_name, sizeof(proc_name));
+                c->process_name = arena_intern(net_arena, proc_name);
 
-                net->connection_count++;
                 net->total_established++;
             }
         }
@@ -627,24 +821,72 @@ static int probe_network_aix_netstat(network_info_t *net) {
 }
 #endif
 
+#ifndef _AIX
+/* Wall time, like probe_duration_ms; clock() would count CPU time only */
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 +
+           (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+#endif
+
 /* Main network probe function */
-int probe_network(network_info_t *net) {
+int probe_network(arena_t *arena, network_info_t *net) {
+    return probe_network_with(arena, net, NET_BACKEND_AUTO);
+}
+
+int probe_network_with(arena_t *arena, network_info_t *net, net_backend_t backend) {
+    if (!arena || !net) return -1;
+
     memset(net, 0, sizeof(network_info_t));
+    net_arena = arena;
+
+    /* Socket ownership comes from the shared process snapshot. Reuse the
+     * one taken by capture_fingerprint() when it already indexed sockets. */
+    const proc_snapshot_t *snap = proc_snapshot_current();
+    if (!snap || !(snap->flags & PROC_SNAP_SOCKETS)) {
+        proc_snapshot_request(PROC_SNAP_SOCKETS);
+        proc_snapshot_refresh();
+    }
 
 #ifdef _AIX
     /* AIX: Use netstat parsing as primary method
      * libperfstat doesn't provide the granular per-connection data we need */
+    (void)backend;
+    snprintf(net->backend, sizeof(net->backend), "netstat");
     return probe_network_aix_netstat(net);
 #else
-    /* Linux: Parse /proc/net files */
-
-    /* Probe TCP */
-    parse_tcp_file("/proc/net/tcp", net, 0);
-    parse_tcp_file("/proc/net/tcp6", net, 1);
+    /* Linux: netlink sock_diag, with the /proc/net text files as fallback */
+    int probed = -1;
+    if (backend != NET_BACKEND_PROCFS) {
+        probed = probe_network_netlink(net);
+        if (probed == 0) {
+            snprintf(net->backend, sizeof(net->backend), "netlink");
+        } else if (backend == NET_BACKEND_NETLINK) {
+            return -1;
+        } else {
+            /* Start over from a clean table on the text parser */
+            memset(net, 0, sizeof(network_info_t));
+        }
+    }
+    if (probed != 0) {
+        probe_network_procfs(net);
+        snprintf(net->backend, sizeof(net->backend), "procfs");
+    }
 
-    /* Probe UDP */
-    parse_udp_file("/proc/net/udp", net, 0);
-    parse_udp_file("/proc/net/udp6", net, 1);
+    /*
+     * Attribute sockets to processes: one index build, one lookup pass.
+     * Without memory for the index every lookup misses and the sockets
+     * are kept unattributed; the socket probe itself still succeeded.
+     */
+    struct timespec t0, t1, t2;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    build_inode_index(proc_snapshot_current());
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    attribute_socket_owners(net);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    net->owner_index_ms = elapsed_ms(&t0, &t1);
+    net->owner_lookup_ms = elapsed_ms(&t1, &t2);
 
     return 0;
 #endif
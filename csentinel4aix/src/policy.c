@@ -8,15 +8,21 @@
  * https://github.com/williamofai/c-sentinel
  *
  * policy.c - Deterministic Safety Gate Implementation
+ *
+ * Checks only read the compiled rules, so policy_check_batch() runs
+ * them on the worker pool. Audit entries go into a ring that any
+ * number of threads append to without a lock (see Audit Ring below).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <time.h>
 
 #include "policy.h"
+#include "sentinel.h"
 
 /* ============================================================
  * Built-in Rules - The "Battle Scars" List
@@ -145,9 +151,8 @@ static const char *PROTECTED_PATHS[] = {
 static policy_mode_t current_mode = MODE_NORMAL;
 static int audit_enabled = 0;
 
-#define MAX_AUDIT_ENTRIES 100
-static audit_entry_t audit_log[MAX_AUDIT_ENTRIES];
-static int audit_count = 0;
+/* Commands per worker pool item in policy_check_batch() */
+#define POLICY_BATCH_CHUNK 1024
 
 /* Custom rules storage */
 #define MAX_CUSTOM_RULES 50
@@ -161,30 +166,283 @@ typedef struct {
 
 static custom_rule_t custom_rules[MAX_CUSTOM_RULES];
 static int custom_rule_count = 0;
+static int rules_dirty = 1;
 
 /* ============================================================
- * Helper Functions
- * ============================================================ */
+ * Audit Ring
+ * ============================================================
+ * Writers claim a position with one atomic add and overwrite the
+ * oldest entry. Each slot's sequence number is odd while it is being
+ * written and 2 * (position + 1) once entry holds that position, so a
+ * reader copying a slot can tell whether the copy is whole and is the
+ * entry it wanted. A writer that finds its slot taken by a newer
+ * position drops its own entry, which would be overwritten anyway.
+ */
+
+#define MAX_AUDIT_ENTRIES 100
+
+typedef struct {
+    unsigned long seq;
+    audit_entry_t entry;
+} audit_slot_t;
 
-/* Case-insensitive substring search */
-static const char* strcasestr_local(const char *haystack, const char *needle) {
-    if (!*needle) return haystack;
+static audit_slot_t audit_ring[MAX_AUDIT_ENTRIES];
+static unsigned long audit_head = 0;   /* Positions claimed so far */
+
+static void log_audit(const char *command, policy_result_t *result) {
+    if (!audit_enabled) return;
     
-    for (; *haystack; haystack++) {
-        const char *h = haystack;
-        const char *n = needle;
-        
-        while (*h && *n && (tolower((unsigned char)*h) == tolower((unsigned char)*n))) {
-            h++;
-            n++;
+    unsigned long pos = __atomic_fetch_add(&audit_head, 1, __ATOMIC_RELAXED);
+    audit_slot_t *slot = &audit_ring[pos % MAX_AUDIT_ENTRIES];
+    unsigned long writing = 2 * pos + 1;
+    unsigned long seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    
+    /* Wait out an older writer still in this slot (it wrapped a full ring ago) */
+    for (;;) {
+        if (seq >= writing) return;
+        if (seq & 1) {
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&slot->seq, &seq, writing, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    slot->entry.timestamp = (uint64_t)time(NULL);
+    slot->entry.command = command;  /* Note: should strdup for safety */
+    slot->entry.result = *result;
+    __atomic_store_n(&slot->seq, writing + 1, __ATOMIC_RELEASE);
+}
+
+static void audit_reset(void) {
+    memset(audit_ring, 0, sizeof(audit_ring));
+    __atomic_store_n(&audit_head, 0, __ATOMIC_RELEASE);
+}
+
+/* ============================================================
+ * Compiled Rules
+ * ============================================================
+ * Each rule gets a rank from the order the checks have always run
+ * in: blocked commands, blocked patterns, custom rules, the strict
+ * mode safe list, then warning patterns. "Contains" rules are
+ * compiled into a case-folded Aho-Corasick automaton; exact and
+ * prefix rules and the safe list go into a case-sensitive trie.
+ * One pass over the command walks both, and the lowest rank seen
+ * decides the result.
+ */
+
+#define LIST_COUNT(list) ((int)(sizeof(list) / sizeof((list)[0])) - 1)
+
+#define RANK_BLOCKED_COMMAND 0
+#define RANK_BLOCKED_PATTERN (RANK_BLOCKED_COMMAND + LIST_COUNT(BLOCKED_COMMANDS))
+#define RANK_CUSTOM          (RANK_BLOCKED_PATTERN + LIST_COUNT(BLOCKED_PATTERNS))
+#define RANK_STRICT          (RANK_CUSTOM + MAX_CUSTOM_RULES)
+#define RANK_WARN            (RANK_STRICT + 1)
+#define RANK_NONE            INT_MAX
+
+#define MAX_RULE_REFS (RANK_WARN + LIST_COUNT(WARN_PATTERNS) + LIST_COUNT(SAFE_COMMANDS))
+
+/* First word of a command as the safe list sees it, in bytes */
+#define FIRST_CMD_MAX 127
+
+typedef enum {
+    MATCH_CONTAINS,         /* Anywhere, any case */
+    MATCH_PREFIX,           /* At the start */
+    MATCH_EXACT,            /* The whole command */
+    MATCH_SAFE              /* The whole first word */
+} match_kind_t;
+
+typedef struct {
+    const char *pattern;
+    int rank;
+    match_kind_t kind;
+} rule_ref_t;
+
+typedef struct {
+    unsigned char cls[256];     /* Byte -> class; 0 for bytes no rule uses */
+    int classes;
+    int *next;                  /* nodes x classes; -1 for no edge in the trie */
+    int *rank;                  /* Contains or prefix rule ending here */
+    int *exact;                 /* Exact rule ending here */
+    unsigned char *safe;        /* Safe command ending here */
+    int nodes;
+} matcher_t;
+
+static matcher_t contains_matcher;     /* Case-folded, with failure links */
+static matcher_t prefix_matcher;       /* Case-sensitive trie */
+
+static void matcher_free(matcher_t *m) {
+    free(m->next);
+    free(m->rank);
+    free(m->exact);
+    free(m->safe);
+    memset(m, 0, sizeof(*m));
+}
+
+/*
+ * Build a trie of refs; with fold_case, ignore case and complete it
+ * into an automaton whose ranks include those of every suffix.
+ */
+static int matcher_build(matcher_t *m, const rule_ref_t *refs, int count, int fold_case) {
+    size_t max_nodes = 1;
+    
+    matcher_free(m);
+    
+    int classes = 1;
+    for (int r = 0; r < count; r++) {
+        for (const unsigned char *c = (const unsigned char *)refs[r].pattern; *c; c++) {
+            unsigned char b = fold_case ? (unsigned char)tolower(*c) : *c;
+            if (!m->cls[b]) {
+                m->cls[b] = (unsigned char)classes++;
+                if (fold_case) m->cls[toupper(b)] = m->cls[b];
+            }
+            max_nodes++;
+        }
+    }
+    m->classes = classes;
+    
+    m->next = malloc(max_nodes * classes * sizeof(int));
+    m->rank = malloc(max_nodes * sizeof(int));
+    m->exact = malloc(max_nodes * sizeof(int));
+    m->safe = calloc(max_nodes, 1);
+    int *fail = fold_case ? calloc(max_nodes, sizeof(int)) : NULL;
+    int *queue = fold_case ? malloc(max_nodes * sizeof(int)) : NULL;
+    if (!m->next || !m->rank || !m->exact || !m->safe ||
+        (fold_case && (!fail || !queue))) {
+        free(fail);
+        free(queue);
+        matcher_free(m);
+        return -1;
+    }
+    
+    /* Trie */
+    m->nodes = 1;
+    for (int i = 0; i < classes; i++) m->next[i] = -1;
+    m->rank[0] = m->exact[0] = RANK_NONE;
+    for (int r = 0; r < count; r++) {
+        int node = 0;
+        for (const unsigned char *c = (const unsigned char *)refs[r].pattern; *c; c++) {
+            int *slot = &m->next[node * classes + m->cls[*c]];
+            if (*slot < 0) {
+                *slot = m->nodes;
+                for (int i = 0; i < classes; i++) m->next[m->nodes * classes + i] = -1;
+                m->rank[m->nodes] = m->exact[m->nodes] = RANK_NONE;
+                m->nodes++;
+            }
+            node = *slot;
+        }
+        switch (refs[r].kind) {
+            case MATCH_CONTAINS:
+            case MATCH_PREFIX:
+                if (refs[r].rank < m->rank[node]) m->rank[node] = refs[r].rank;
+                break;
+            case MATCH_EXACT:
+                if (refs[r].rank < m->exact[node]) m->exact[node] = refs[r].rank;
+                break;
+            case MATCH_SAFE:
+                m->safe[node] = 1;
+                break;
+        }
+    }
+    
+    if (!fold_case) return 0;
+    
+    /* Breadth-first: failure links, inherited ranks, missing transitions */
+    int head = 0, tail = 0;
+    for (int i = 0; i < classes; i++) {
+        int child = m->next[i];
+        if (child < 0) {
+            m->next[i] = 0;
+        } else {
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    while (head < tail) {
+        int node = queue[head++];
+        int f = fail[node];
+        if (m->rank[f] < m->rank[node]) m->rank[node] = m->rank[f];
+        for (int i = 0; i < classes; i++) {
+            int *slot = &m->next[node * classes + i];
+            if (*slot < 0) {
+                *slot = m->next[f * classes + i];
+            } else {
+                fail[*slot] = m->next[f * classes + i];
+                queue[tail++] = *slot;
+            }
         }
+    }
+    
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+static void add_list(rule_ref_t *refs, int *count, const char **list,
+                     int rank, match_kind_t kind) {
+    for (int i = 0; list[i]; i++) {
+        refs[*count].pattern = list[i];
+        refs[*count].rank = rank + i;
+        refs[*count].kind = kind;
+        (*count)++;
+    }
+}
+
+static int compile_rules(void) {
+    rule_ref_t contains[MAX_RULE_REFS];
+    rule_ref_t prefix[MAX_RULE_REFS];
+    int n_contains = 0, n_prefix = 0;
+    
+    add_list(contains, &n_contains, BLOCKED_COMMANDS, RANK_BLOCKED_COMMAND, MATCH_CONTAINS);
+    add_list(contains, &n_contains, BLOCKED_PATTERNS, RANK_BLOCKED_PATTERN, MATCH_CONTAINS);
+    add_list(contains, &n_contains, WARN_PATTERNS, RANK_WARN, MATCH_CONTAINS);
+    add_list(prefix, &n_prefix, SAFE_COMMANDS, RANK_STRICT, MATCH_SAFE);
+    
+    for (int i = 0; i < custom_rule_count; i++) {
+        const custom_rule_t *rule = &custom_rules[i];
+        rule_ref_t ref = { rule->pattern, RANK_CUSTOM + i, MATCH_PREFIX };
         
-        if (!*n) return haystack;
+        if (!rule->active) continue;
+        switch (rule->type) {
+            case RULE_BLOCK_COMMAND:
+                ref.kind = MATCH_EXACT;
+                prefix[n_prefix++] = ref;
+                break;
+            case RULE_BLOCK_PREFIX:
+            case RULE_ALLOW_COMMAND:
+                prefix[n_prefix++] = ref;
+                break;
+            case RULE_BLOCK_CONTAINS:
+                ref.kind = MATCH_CONTAINS;
+                contains[n_contains++] = ref;
+                break;
+            default:
+                break;          /* Not command rules */
+        }
     }
     
-    return NULL;
+    if (matcher_build(&contains_matcher, contains, n_contains, 1) != 0 ||
+        matcher_build(&prefix_matcher, prefix, n_prefix, 0) != 0) {
+        matcher_free(&contains_matcher);
+        matcher_free(&prefix_matcher);
+        rules_dirty = 1;
+        return -1;
+    }
+    rules_dirty = 0;
+    return 0;
+}
+
+static int ensure_compiled(void) {
+    return rules_dirty ? compile_rules() : 0;
 }
 
+/* ============================================================
+ * Helper Functions
+ * ============================================================ */
+
 /* Check if string starts with prefix */
 static int starts_with(const char *str, const char *prefix) {
     return strncmp(str, prefix, strlen(prefix)) == 0;
@@ -196,34 +454,13 @@ static const char* trim_left(const char *str) {
     return str;
 }
 
-/* Extract first "word" (command) from a string */
-static void extract_command(const char *input, char *cmd, size_t cmd_size) {
-    const char *trimmed = trim_left(input);
-    size_t i = 0;
-    
-    while (trimmed[i] && !isspace((unsigned char)trimmed[i]) && i < cmd_size - 1) {
-        cmd[i] = trimmed[i];
-        i++;
-    }
-    cmd[i] = '\0';
-}
-
-/* Log an audit entry */
-static void log_audit(const char *command, policy_result_t *result) {
-    if (!audit_enabled) return;
-    
-    int idx = audit_count % MAX_AUDIT_ENTRIES;
-    audit_log[idx].timestamp = (uint64_t)time(NULL);
-    audit_log[idx].command = command;  /* Note: should strdup for safety */
-    audit_log[idx].result = *result;
-    audit_count++;
-}
 
 /* ============================================================
  * Core Validation Logic
  * ============================================================ */
 
-policy_result_t policy_check_command(const char *command) {
+/* The result a rank stands for */
+static policy_result_t rank_result(int rank) {
     policy_result_t result = {
         .decision = POLICY_ALLOW,
         .risk = RISK_NONE,
@@ -231,115 +468,126 @@ policy_result_t policy_check_command(const char *command) {
         .matched_rule = NULL
     };
     
-    if (!command || !*command) {
+    if (rank < RANK_BLOCKED_PATTERN) {
         result.decision = POLICY_BLOCK;
-        result.reason = "Empty command";
-        return result;
+        result.risk = RISK_CRITICAL;
+        result.reason = "Command matches blocked list - potential system damage";
+        result.matched_rule = BLOCKED_COMMANDS[rank - RANK_BLOCKED_COMMAND];
+    } else if (rank < RANK_CUSTOM) {
+        result.decision = POLICY_BLOCK;
+        result.risk = RISK_HIGH;
+        result.reason = "Command contains dangerous pattern";
+        result.matched_rule = BLOCKED_PATTERNS[rank - RANK_BLOCKED_PATTERN];
+    } else if (rank < RANK_STRICT) {
+        const custom_rule_t *rule = &custom_rules[rank - RANK_CUSTOM];
+        if (rule->type == RULE_ALLOW_COMMAND) {
+            result.decision = POLICY_ALLOW;
+            result.risk = RISK_NONE;
+        } else {
+            result.decision = POLICY_BLOCK;
+            result.risk = rule->risk;
+        }
+        result.reason = rule->reason;
+        result.matched_rule = rule->pattern;
+    } else if (rank == RANK_STRICT) {
+        result.decision = POLICY_REVIEW;
+        result.risk = RISK_MEDIUM;
+        result.reason = "Command not in safe list (strict mode)";
+        result.matched_rule = "STRICT_MODE";
+    } else if (rank != RANK_NONE) {
+        result.decision = (current_mode == MODE_PERMISSIVE) ? POLICY_ALLOW : POLICY_WARN;
+        result.risk = RISK_MEDIUM;
+        result.reason = "Command may modify system state - review carefully";
+        result.matched_rule = WARN_PATTERNS[rank - RANK_WARN];
     }
     
-    const char *trimmed = trim_left(command);
-    char first_cmd[128];
-    extract_command(trimmed, first_cmd, sizeof(first_cmd));
+    return result;
+}
+
+policy_result_t policy_check_command(const char *command) {
+    policy_result_t result = {
+        .decision = POLICY_BLOCK,
+        .risk = RISK_NONE,
+        .reason = "Empty command",
+        .matched_rule = NULL
+    };
     
-    /* Phase 1: Check for explicitly blocked commands */
-    for (int i = 0; BLOCKED_COMMANDS[i]; i++) {
-        if (strcasestr_local(trimmed, BLOCKED_COMMANDS[i])) {
-            result.decision = POLICY_BLOCK;
-            result.risk = RISK_CRITICAL;
-            result.reason = "Command matches blocked list - potential system damage";
-            result.matched_rule = BLOCKED_COMMANDS[i];
-            log_audit(command, &result);
-            return result;
-        }
+    if (!command || !*command) {
+        return result;
     }
     
-    /* Phase 2: Check for dangerous patterns anywhere in command */
-    for (int i = 0; BLOCKED_PATTERNS[i]; i++) {
-        if (strcasestr_local(trimmed, BLOCKED_PATTERNS[i])) {
-            result.decision = POLICY_BLOCK;
-            result.risk = RISK_HIGH;
-            result.reason = "Command contains dangerous pattern";
-            result.matched_rule = BLOCKED_PATTERNS[i];
-            log_audit(command, &result);
-            return result;
-        }
+    if (ensure_compiled() != 0) {
+        result.risk = RISK_HIGH;
+        result.reason = "Policy rules could not be compiled";
+        return result;
     }
     
-    /* Phase 3: Check custom rules */
-    for (int i = 0; i < custom_rule_count; i++) {
-        if (!custom_rules[i].active) continue;
+    const matcher_t *ac = &contains_matcher;
+    const matcher_t *trie = &prefix_matcher;
+    const char *trimmed = trim_left(command);
+    int best = ac->rank[0] < trie->rank[0] ? ac->rank[0] : trie->rank[0];
+    int state = 0, node = 0;
+    int safe = -1;              /* Unknown until the first word ends */
+    size_t i;
+    
+    /* One pass: every contains rule, and the trie while a rule could still match */
+    for (i = 0; trimmed[i] && best > 0; i++) {
+        unsigned char c = (unsigned char)trimmed[i];
         
-        int matched = 0;
-        switch (custom_rules[i].type) {
-            case RULE_BLOCK_COMMAND:
-                matched = (strcmp(trimmed, custom_rules[i].pattern) == 0);
-                break;
-            case RULE_BLOCK_PREFIX:
-                matched = starts_with(trimmed, custom_rules[i].pattern);
-                break;
-            case RULE_BLOCK_CONTAINS:
-                matched = (strcasestr_local(trimmed, custom_rules[i].pattern) != NULL);
-                break;
-            case RULE_ALLOW_COMMAND:
-                if (starts_with(trimmed, custom_rules[i].pattern)) {
-                    result.decision = POLICY_ALLOW;
-                    result.risk = RISK_NONE;
-                    result.reason = custom_rules[i].reason;
-                    result.matched_rule = custom_rules[i].pattern;
-                    log_audit(command, &result);
-                    return result;
-                }
-                break;
-            default:
-                break;
+        if (safe < 0 && (isspace(c) || i == FIRST_CMD_MAX)) {
+            safe = node >= 0 && trie->safe[node];
         }
         
-        if (matched && custom_rules[i].type != RULE_ALLOW_COMMAND) {
-            result.decision = POLICY_BLOCK;
-            result.risk = custom_rules[i].risk;
-            result.reason = custom_rules[i].reason;
-            result.matched_rule = custom_rules[i].pattern;
-            log_audit(command, &result);
-            return result;
-        }
-    }
-    
-    /* Phase 4: In strict mode, only allow explicitly safe commands */
-    if (current_mode == MODE_STRICT) {
-        int is_safe = 0;
-        for (int i = 0; SAFE_COMMANDS[i]; i++) {
-            if (strcmp(first_cmd, SAFE_COMMANDS[i]) == 0) {
-                is_safe = 1;
-                break;
-            }
-        }
+        state = ac->next[state * ac->classes + ac->cls[c]];
+        if (ac->rank[state] < best) best = ac->rank[state];
         
-        if (!is_safe) {
-            result.decision = POLICY_REVIEW;
-            result.risk = RISK_MEDIUM;
-            result.reason = "Command not in safe list (strict mode)";
-            result.matched_rule = "STRICT_MODE";
-            log_audit(command, &result);
-            return result;
+        if (node >= 0) {
+            node = trie->next[node * trie->classes + trie->cls[c]];
+            if (node >= 0 && trie->rank[node] < best) best = trie->rank[node];
         }
     }
+    if (!trimmed[i]) {
+        if (safe < 0) safe = node >= 0 && trie->safe[node];
+        if (node >= 0 && trie->exact[node] < best) best = trie->exact[node];
+    }
     
-    /* Phase 5: Check for warning patterns */
-    for (int i = 0; WARN_PATTERNS[i]; i++) {
-        if (strcasestr_local(trimmed, WARN_PATTERNS[i])) {
-            result.decision = (current_mode == MODE_PERMISSIVE) ? POLICY_ALLOW : POLICY_WARN;
-            result.risk = RISK_MEDIUM;
-            result.reason = "Command may modify system state - review carefully";
-            result.matched_rule = WARN_PATTERNS[i];
-            log_audit(command, &result);
-            return result;
-        }
+    if (current_mode == MODE_STRICT && !safe && RANK_STRICT < best) {
+        best = RANK_STRICT;
     }
     
+    result = rank_result(best);
     log_audit(command, &result);
     return result;
 }
 
+typedef struct {
+    const char *const *commands;
+    int count;
+    policy_result_t *results;
+} batch_job_t;
+
+static void check_chunk(int index, void *ctx) {
+    batch_job_t *job = ctx;
+    int end = (index + 1) * POLICY_BATCH_CHUNK;
+    if (end > job->count) end = job->count;
+    
+    for (int i = index * POLICY_BATCH_CHUNK; i < end; i++) {
+        job->results[i] = policy_check_command(job->commands[i]);
+    }
+}
+
+int policy_check_batch(const char *const *commands, int count,
+                       policy_result_t *results) {
+    if (count < 0 || (count > 0 && (!commands || !results))) return -1;
+    
+    /* Compile once here; the workers then only read the rules */
+    if (ensure_compiled() != 0) return -1;
+    
+    batch_job_t job = { commands, count, results };
+    return workpool_for((count + POLICY_BATCH_CHUNK - 1) / POLICY_BATCH_CHUNK,
+                        check_chunk, &job);
+}
+
 policy_result_t policy_check_path(const char *path) {
     policy_result_t result = {
         .decision = POLICY_ALLOW,
@@ -388,11 +636,16 @@ int policy_add_rule(rule_type_t type, const char *pattern,
     rule->active = 1;
     
     custom_rule_count++;
+    if (compile_rules() != 0) {
+        custom_rule_count--;
+        return -1;
+    }
     return 0;
 }
 
 void policy_clear_custom_rules(void) {
     custom_rule_count = 0;
+    rules_dirty = 1;
 }
 
 int policy_count_rules(rule_type_t type) {
@@ -414,12 +667,20 @@ void policy_set_audit(int enabled) {
 }
 
 int policy_get_audit_log(audit_entry_t *entries, int max_entries) {
-    int start = (audit_count > MAX_AUDIT_ENTRIES) ? 
-                audit_count - MAX_AUDIT_ENTRIES : 0;
+    unsigned long head = __atomic_load_n(&audit_head, __ATOMIC_ACQUIRE);
+    unsigned long start = (head > MAX_AUDIT_ENTRIES) ? 
+                          head - MAX_AUDIT_ENTRIES : 0;
     int count = 0;
     
-    for (int i = start; i < audit_count && count < max_entries; i++) {
-        entries[count] = audit_log[i % MAX_AUDIT_ENTRIES];
+    /* Entries still being written, or overwritten while copied, are skipped */
+    for (unsigned long pos = start; pos < head && count < max_entries; pos++) {
+        const audit_slot_t *slot = &audit_ring[pos % MAX_AUDIT_ENTRIES];
+        unsigned long want = 2 * pos + 2;
+        
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != want) continue;
+        entries[count] = slot->entry;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != want) continue;
         count++;
     }
     
@@ -438,11 +699,13 @@ int policy_init(void) {
     current_mode = MODE_NORMAL;
     audit_enabled = 0;
     custom_rule_count = 0;
-    audit_count = 0;
-    return 0;
+    audit_reset();
+    return compile_rules();
 }
 
 void policy_cleanup(void) {
     policy_clear_custom_rules();
-    audit_count = 0;
+    audit_reset();
+    matcher_free(&contains_matcher);
+    matcher_free(&prefix_matcher);
 }
@@ -31,6 +31,7 @@
 #include <errno.h>
 
 #include "sentinel.h"
+#include "sha256.h"
 
 /* ============================================================
  * Helper Functions
@@ -43,26 +44,6 @@ static void safe_strcpy(char *dest, const char *src, size_t dest_size) {
     dest[dest_size - 1] = '\0';
 }
 
-/* Count open file descriptors for a process */
-static int count_fds(pid_t pid) {
-    char path[128];
-    snprintf(path, sizeof(path), "/proc/%d/fd", pid);
-    
-    DIR *dir = opendir(path);
-    if (!dir) return -1;
-    
-    int count = 0;
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_name[0] != '.') {
-            count++;
-        }
-    }
-    
-    closedir(dir);
-    return count;
-}
-
 /* ============================================================
  * System Info Probing
  * ============================================================ */
@@ -132,165 +113,32 @@ int probe_system_info(system_info_t *info) {
  * Process Probing
  * ============================================================ */
 
-/* Parse /proc/[pid]/stat (Linux) or /proc/[pid]/psinfo (AIX) for process info */
-static int parse_proc_stat(pid_t pid, process_info_t *proc) {
-    char path[128];
-
-#ifdef _AIX
-    /* AIX: Read binary psinfo structure */
-    struct psinfo psi;
-    int fd;
-
-    /* Initialize psinfo to zero to avoid garbage data */
-    memset(&psi, 0, sizeof(psi));
-
-    snprintf(path, sizeof(path), "/proc/%d/psinfo", (int)pid);
-    fd = open(path, O_RDONLY);
-    if (fd < 0) return -1;
-
-    if (read(fd, &psi, sizeof(psi)) != sizeof(psi)) {
-        close(fd);
-        return -1;
-    }
-    close(fd);
-
-    /* Extract process info from psinfo */
-    proc->pid = pid;
-    proc->ppid = psi.pr_ppid;
-    safe_strcpy(proc->name, psi.pr_fname, sizeof(proc->name));
-
-    /* AIX: Validate state character - must be printable ASCII */
-    /* pr_lwp.pr_sname can be invalid for kernel processes without LWPs */
-    char state = psi.pr_lwp.pr_sname;
-    if (state >= 'A' && state <= 'Z') {
-        proc->state = state;  /* Valid state: S, R, Z, T, O, I, etc. */
-    } else if (psi.pr_nlwp == 0) {
-        proc->state = 'I';  /* Idle/kernel process with no LWPs */
-    } else {
-        proc->state = '?';  /* Unknown state */
-    }
-
-    proc->thread_count = psi.pr_nlwp;  /* Number of LWPs (threads) */
-    proc->vsize_bytes = psi.pr_size * 1024;  /* Size in KB -> bytes */
-    proc->rss_bytes = psi.pr_rssize * 1024;  /* RSS in KB -> bytes */
-
-    /* Calculate process age from start time */
-    time_t now = time(NULL);
-    proc->start_time = psi.pr_start.tv_sec;
-
-    /* Validate start time - kernel processes may have epoch or invalid times */
-    if (proc->start_time > 0 && proc->start_time < now) {
-        proc->age_seconds = now - proc->start_time;
-    } else {
-        proc->age_seconds = 0;  /* Invalid or future start time */
-    }
-
-#else
-    /* Linux: Read text stat file */
-    char buf[2048];
-
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-
-    FILE *f = fopen(path, "r");
-    if (!f) return -1;
-
-    if (!fgets(buf, sizeof(buf), f)) {
-        fclose(f);
-        return -1;
-    }
-    fclose(f);
-
-    /* Parse the stat line - format is complex due to comm field */
-    /* pid (comm) state ppid ... */
-    char *start = strchr(buf, '(');
-    char *end = strrchr(buf, ')');
-
-    if (!start || !end) return -1;
-
-    /* Extract comm (process name) */
-    size_t name_len = end - start - 1;
-    if (name_len >= sizeof(proc->name)) {
-        name_len = sizeof(proc->name) - 1;
-    }
-    memcpy(proc->name, start + 1, name_len);
-    proc->name[name_len] = '\0';
-
-    /* Parse fields after the comm */
-    unsigned long vsize;
-    long rss;
-    unsigned long long starttime;
-
-    int thread_count_tmp;
-
-    int parsed = sscanf(end + 2,
-        "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
-        "%*u %*u %*d %*d %*d %*d %d %*d %llu %lu %ld",
-        &proc->state,
-        &proc->ppid,
-        &thread_count_tmp,
-        &starttime,
-        &vsize,
-        &rss);
-
-    if (parsed < 6) return -1;
-
-    proc->pid = pid;
-    proc->thread_count = (uint32_t)thread_count_tmp;
-    proc->vsize_bytes = vsize;
-    proc->rss_bytes = rss * sysconf(_SC_PAGESIZE);
-
-    /* Calculate process age */
-    /* starttime is in clock ticks since boot */
-    long ticks_per_sec = sysconf(_SC_CLK_TCK);
-    time_t now = time(NULL);
-    struct sysinfo si;
-    if (sysinfo(&si) == 0) {
-        time_t boot_time = now - si.uptime;
-        proc->start_time = boot_time + (starttime / ticks_per_sec);
-        proc->age_seconds = now - proc->start_time;
-    }
-#endif
-    
-    /* Heuristic: process might be stuck if it's old and in certain states */
-    /* D = uninterruptible sleep, often indicates I/O issues */
-    if (proc->state == 'D' && proc->age_seconds > 300) {
-        proc->is_potentially_stuck = 1;
-    }
-    /* Z = zombie */
-    if (proc->state == 'Z') {
-        proc->is_potentially_stuck = 1;
-    }
-    
-    return 0;
-}
-
-int probe_processes(process_info_t *procs, int max_procs, int *count) {
-    if (!procs || !count) return -1;
+/*
+ * Fill procs from the shared process snapshot. The snapshot is
+ * refreshed here so that the network probe and the audit chain
+ * builder see the same process table as the fingerprint.
+ */
+int probe_processes(arena_t *arena, process_info_t **procs, int *count) {
+    if (!arena || !procs || !count) return -1;
     
+    *procs = NULL;
     *count = 0;
     
-    DIR *proc_dir = opendir("/proc");
-    if (!proc_dir) return -1;
+    const proc_snapshot_t *snap = proc_snapshot_refresh();
+    if (!snap) return -1;
     
-    struct dirent *entry;
-    while ((entry = readdir(proc_dir)) != NULL && *count < max_procs) {
-        /* Skip non-numeric entries (not PIDs) */
-        if (!isdigit(entry->d_name[0])) continue;
-        
-        pid_t pid = atoi(entry->d_name);
-        if (pid <= 0) continue;
-        
-        process_info_t *proc = &procs[*count];
-        memset(proc, 0, sizeof(*proc));
-        
-        if (parse_proc_stat(pid, proc) == 0) {
-            /* Count open file descriptors */
-            proc->open_fd_count = count_fds(pid);
-            (*count)++;
-        }
+    /* Sized to the live process table - nothing is dropped */
+    *procs = arena_alloc(arena, (size_t)(snap->count ? snap->count : 1) * sizeof(process_info_t));
+    if (!*procs) return -1;
+    
+    for (int i = 0; i < snap->count; i++) {
+        process_info_t *proc = &(*procs)[*count];
+        *proc = snap->procs[i].info;
+        /* Names move from the snapshot's arena into the caller's */
+        proc->name = arena_intern(arena, snap->procs[i].info.name);
+        (*count)++;
     }
     
-    closedir(proc_dir);
     return 0;
 }
 
@@ -298,33 +146,106 @@ int probe_processes(process_info_t *procs, int max_procs, int *count) {
  * Config File Probing
  * ============================================================ */
 
-int probe_config_files(const char **paths, int path_count,
-                       config_file_t *configs, int *config_count) {
-    if (!configs || !config_count) return -1;
+/* One config file per index; workers write only their own slot */
+typedef struct {
+    const char **paths;
+    config_file_t *slots;
+    struct stat *stats;
+    char *found;                /* 0 = missing, 1 = rehashed, 2 = cache hit */
+    int *misses;                /* Indices that need hashing */
+    int miss_count;
+    int batch;                  /* Files per sha256_file_batch() call */
+} config_job_t;
+
+static void probe_config_one(int index, void *arg) {
+    config_job_t *job = arg;
+    config_file_t *cfg = &job->slots[index];
+    struct stat *st = &job->stats[index];
+    
+    if (stat(job->paths[index], st) != 0) return;
+    
+    cfg->size = st->st_size;
+    cfg->mtime = st->st_mtime;
+    cfg->ctime = st->st_ctime;
+    cfg->permissions = st->st_mode;
+    cfg->owner = st->st_uid;
+    cfg->group = st->st_gid;
+    
+    /* Reuse the checksum if the file is unchanged since it was last hashed */
+    job->found[index] = hash_cache_lookup(st, cfg->checksum, sizeof(cfg->checksum)) ? 2 : 1;
+}
+
+/* Hash one batch of cache misses; multi-buffer backends take them together */
+static void hash_config_batch(int index, void *arg) {
+    config_job_t *job = arg;
+    const char *paths[SHA256_MAX_LANES];
+    char *out[SHA256_MAX_LANES];
+    int first = index * job->batch;
+    int n = 0;
+    
+    for (int i = first; i < job->miss_count && n < job->batch; i++, n++) {
+        paths[n] = job->paths[job->misses[i]];
+        out[n] = job->slots[job->misses[i]].checksum;
+    }
+    sha256_file_batch(paths, n, out);
+}
+
+int probe_config_files(arena_t *arena, const char **paths, int path_count,
+                       config_file_t **configs, int *config_count,
+                       int *cache_hits, int *cache_misses) {
+    if (!arena || !configs || !config_count) return -1;
     
     *config_count = 0;
+    if (cache_hits) *cache_hits = 0;
+    if (cache_misses) *cache_misses = 0;
+    *configs = arena_alloc(arena, (size_t)(path_count > 0 ? path_count : 1) * sizeof(config_file_t));
+    if (!*configs) return -1;
+    if (path_count <= 0) return 0;
     
-    for (int i = 0; i < path_count && *config_count < MAX_CONFIG_FILES; i++) {
-        struct stat st;
-        if (stat(paths[i], &st) != 0) continue;
-        
-        config_file_t *cfg = &configs[*config_count];
-        memset(cfg, 0, sizeof(*cfg));
-        
-        safe_strcpy(cfg->path, paths[i], sizeof(cfg->path));
-        cfg->size = st.st_size;
-        cfg->mtime = st.st_mtime;
-        cfg->ctime = st.st_ctime;
-        cfg->permissions = st.st_mode;
-        cfg->owner = st.st_uid;
-        cfg->group = st.st_gid;
+    char *found = calloc((size_t)path_count, 1);
+    struct stat *stats = malloc((size_t)path_count * sizeof(struct stat));
+    int *misses = malloc((size_t)path_count * sizeof(int));
+    if (!found || !stats || !misses) {
+        free(found);
+        free(stats);
+        free(misses);
+        return -1;
+    }
+    
+    /* Loaded once per process; lookups below are read-only */
+    hash_cache_load();
+    
+    config_job_t job = { paths, *configs, stats, found, misses, 0, sha256_batch_size() };
+    workpool_for(path_count, probe_config_one, &job);
+    
+    /* Hashing dominates - spread the misses over the worker pool */
+    for (int i = 0; i < path_count; i++) {
+        if (found[i] == 1) misses[job.miss_count++] = i;
+    }
+    workpool_for((job.miss_count + job.batch - 1) / job.batch, hash_config_batch, &job);
+    
+    /* Compact in path order; the arena and cache are only touched here */
+    time_t now = time(NULL);
+    for (int i = 0; i < path_count; i++) {
+        if (!found[i]) continue;
         
-        /* Compute SHA256 checksum */
-        sha256_file(paths[i], cfg->checksum, sizeof(cfg->checksum));
+        if (found[i] == 2) {
+            if (cache_hits) (*cache_hits)++;
+        } else if (cache_misses) {
+            (*cache_misses)++;
+        }
+        hash_cache_store(&stats[i], (*configs)[i].checksum, now);
         
+        config_file_t *cfg = &(*configs)[*config_count];
+        if (cfg != &(*configs)[i]) *cfg = (*configs)[i];
+        cfg->path = arena_intern(arena, paths[i]);
         (*config_count)++;
     }
+    hash_cache_save();
     
+    free(found);
+    free(stats);
+    free(misses);
     return 0;
 }
 
@@ -335,41 +256,190 @@ int probe_config_files(const char **paths, int path_count,
 int fingerprint_init(fingerprint_t *fp) {
     if (!fp) return -1;
     memset(fp, 0, sizeof(*fp));
+    arena_init(&fp->arena);
+    return 0;
+}
+
+void fingerprint_free(fingerprint_t *fp) {
+    if (!fp) return;
+    arena_free(&fp->arena);
+    memset(fp, 0, sizeof(*fp));
+}
+
+/* Copy helpers: scalars come across with the struct copy; strings are re-interned */
+static int copy_processes(arena_t *a, fingerprint_t *dst, const fingerprint_t *src) {
+    if (src->process_count <= 0) return 0;
+    
+    dst->processes = arena_alloc(a, src->process_count * sizeof(process_info_t));
+    if (!dst->processes) return -1;
+    for (int i = 0; i < src->process_count; i++) {
+        dst->processes[i] = src->processes[i];
+        dst->processes[i].name = arena_intern(a, src->processes[i].name);
+    }
+    dst->process_count = src->process_count;
+    return 0;
+}
+
+static int copy_configs(arena_t *a, fingerprint_t *dst, const fingerprint_t *src) {
+    if (src->config_count <= 0) return 0;
+    
+    dst->configs = arena_alloc(a, src->config_count * sizeof(config_file_t));
+    if (!dst->configs) return -1;
+    for (int i = 0; i < src->config_count; i++) {
+        dst->configs[i] = src->configs[i];
+        dst->configs[i].path = arena_intern(a, src->configs[i].path);
+    }
+    dst->config_count = src->config_count;
+    return 0;
+}
+
+static int copy_network(arena_t *a, fingerprint_t *dst, const fingerprint_t *src) {
+    dst->network = src->network;
+    dst->network.listeners = NULL;
+    dst->network.connections = NULL;
+    dst->network.listener_count = dst->network.listener_capacity = 0;
+    dst->network.connection_count = dst->network.connection_capacity = 0;
+    
+    if (src->network.listener_count > 0) {
+        int n = src->network.listener_count;
+        dst->network.listeners = arena_alloc(a, n * sizeof(net_listener_t));
+        if (!dst->network.listeners) return -1;
+        for (int i = 0; i < n; i++) {
+            net_listener_t *l = &dst->network.listeners[i];
+            *l = src->network.listeners[i];
+            l->protocol = arena_intern(a, l->protocol);
+            l->local_addr = arena_intern(a, l->local_addr);
+            l->state = arena_intern(a, l->state);
+            l->process_name = arena_intern(a, l->process_name);
+        }
+        dst->network.listener_count = dst->network.listener_capacity = n;
+    }
+    
+    if (src->network.connection_count > 0) {
+        int n = src->network.connection_count;
+        dst->network.connections = arena_alloc(a, n * sizeof(net_connection_t));
+        if (!dst->network.connections) return -1;
+        for (int i = 0; i < n; i++) {
+            net_connection_t *c = &dst->network.connections[i];
+            *c = src->network.connections[i];
+            c->protocol = arena_intern(a, c->protocol);
+            c->local_addr = arena_intern(a, c->local_addr);
+            c->remote_addr = arena_intern(a, c->remote_addr);
+            c->state = arena_intern(a, c->state);
+            c->process_name = arena_intern(a, c->process_name);
+        }
+        dst->network.connection_count = dst->network.connection_capacity = n;
+    }
+    return 0;
+}
+
+int fingerprint_copy(fingerprint_t *dst, const fingerprint_t *src) {
+    if (!dst || !src) return -1;
+    
+    fingerprint_init(dst);
+    arena_t *a = &dst->arena;
+    
+    dst->system = src->system;
+    dst->probe_duration_ms = src->probe_duration_ms;
+    dst->probe_errors = src->probe_errors;
+    dst->config_cache_hits = src->config_cache_hits;
+    dst->config_cache_misses = src->config_cache_misses;
+    
+    if (copy_processes(a, dst, src) != 0 ||
+        copy_configs(a, dst, src) != 0 ||
+        copy_network(a, dst, src) != 0) {
+        fingerprint_free(dst);
+        return -1;
+    }
+    
     return 0;
 }
 
 int capture_fingerprint(fingerprint_t *fp, const char **config_paths,
                         int config_path_count) {
+    return capture_fingerprint_partial(fp, NULL, FP_PROBE_SYSTEM | FP_PROBE_PROCESSES |
+                                       FP_PROBE_CONFIGS, config_paths, config_path_count);
+}
+
+/*
+ * Capture into fp, probing only the subsystems in probe_mask and carrying
+ * the rest over from prev. Watch mode uses this to re-probe just what an
+ * event touched; with prev == NULL unprobed subsystems are left empty.
+ */
+int capture_fingerprint_partial(fingerprint_t *fp, const fingerprint_t *prev,
+                                unsigned probe_mask, const char **config_paths,
+                                int config_path_count) {
     if (!fp) return -1;
     
     fingerprint_init(fp);
     
-    clock_t start = clock();
+    /* Wall time, not clock(): with --jobs CPU time is summed over threads */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     
     /* Capture system info */
-    if (probe_system_info(&fp->system) != 0) {
-        fp->probe_errors++;
+    if (probe_mask & FP_PROBE_SYSTEM) {
+        if (probe_system_info(&fp->system) != 0) {
+            fp->probe_errors++;
+        }
+    } else if (prev) {
+        fp->system = prev->system;
     }
     
     /* Capture process list */
-    if (probe_processes(fp->processes, MAX_PROCS, &fp->process_count) != 0) {
+    if (probe_mask & FP_PROBE_PROCESSES) {
+        if (probe_processes(&fp->arena, &fp->processes, &fp->process_count) != 0) {
+            fp->probe_errors++;
+        }
+    } else if (prev && copy_processes(&fp->arena, fp, prev) != 0) {
         fp->probe_errors++;
     }
     
     /* Capture config files if specified */
-    if (config_paths && config_path_count > 0) {
-        if (probe_config_files(config_paths, config_path_count,
-                               fp->configs, &fp->config_count) != 0) {
-            fp->probe_errors++;
+    if (probe_mask & FP_PROBE_CONFIGS) {
+        if (config_paths && config_path_count > 0) {
+            if (probe_config_files(&fp->arena, config_paths, config_path_count,
+                                   &fp->configs, &fp->config_count,
+                                   &fp->config_cache_hits, &fp->config_cache_misses) != 0) {
+                fp->probe_errors++;
+            }
         }
+    } else if (prev && copy_configs(&fp->arena, fp, prev) != 0) {
+        fp->probe_errors++;
+    }
+    
+    /* Network is probed separately (probe_fingerprint_network) */
+    if (prev && !(probe_mask & FP_PROBE_NETWORK) &&
+        copy_network(&fp->arena, fp, prev) != 0) {
+        fp->probe_errors++;
     }
     
-    clock_t end = clock();
-    fp->probe_duration_ms = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fp->probe_duration_ms = (end.tv_sec - start.tv_sec) * 1000.0 +
+                            (end.tv_nsec - start.tv_nsec) / 1000000.0;
     
     return fp->probe_errors > 0 ? -1 : 0;
 }
 
+int probe_fingerprint_network(fingerprint_t *fp) {
+    if (!fp) return -1;
+    
+    /* The whole network probe, owner attribution included, is part of the cost */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int result = probe_network(&fp->arena, &fp->network);
+    if (result != 0) {
+        fp->probe_errors++;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fp->probe_duration_ms += (end.tv_sec - start.tv_sec) * 1000.0 +
+                             (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    
+    return result;
+}
+
 /* ============================================================
  * Quick Analysis - Deterministic Pre-checks
  * ============================================================ */
@@ -0,0 +1,497 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * proc_snapshot.c - Single-pass /proc walker shared by all probes
+ *
+ * One capture reads each pid's stat (Linux) or psinfo (AIX) and its
+ * fd directory exactly once. The process prober, the network probe
+ * and the audit process-chain builder all consume the indexed views
+ * built here instead of walking /proc again. With --jobs the per-pid
+ * reads run on the worker pool and are merged back in /proc order.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#ifdef _AIX
+#include <sys/procfs.h>
+#else
+#include <sys/sysinfo.h>
+#endif
+#include <time.h>
+
+#include "sentinel.h"
+
+#define SNAP_INITIAL_PROCS   256
+#define SNAP_INITIAL_SOCKETS 256
+
+/* The shared snapshot for the current probe cycle */
+static proc_snapshot_t g_snapshot;
+static int g_snapshot_valid = 0;
+static unsigned g_requested_flags = 0;
+
+/* ============================================================
+ * Per-process Readers
+ * ============================================================ */
+
+/* Values that are constant for the whole capture */
+typedef struct {
+    time_t now;
+    time_t boot_time;
+    long ticks_per_sec;
+    long page_size;
+} capture_ctx_t;
+
+static void capture_ctx_init(capture_ctx_t *ctx) {
+    ctx->now = time(NULL);
+    ctx->boot_time = 0;
+    ctx->ticks_per_sec = sysconf(_SC_CLK_TCK);
+    ctx->page_size = sysconf(_SC_PAGESIZE);
+#ifndef _AIX
+    struct sysinfo si;
+    if (sysinfo(&si) == 0) {
+        ctx->boot_time = ctx->now - si.uptime;
+    }
+#endif
+    if (ctx->ticks_per_sec <= 0) ctx->ticks_per_sec = 100;
+}
+
+/* Parse /proc/[pid]/stat (Linux) or /proc/[pid]/psinfo (AIX) for process info */
+static int read_proc_stat(const capture_ctx_t *ctx, pid_t pid, process_info_t *proc,
+                          char *name, size_t name_size) {
+    char path[128];
+
+#ifdef _AIX
+    /* AIX: Read binary psinfo structure */
+    struct psinfo psi;
+    int fd;
+
+    /* Initialize psinfo to zero to avoid garbage data */
+    memset(&psi, 0, sizeof(psi));
+
+    snprintf(path, sizeof(path), "/proc/%d/psinfo", (int)pid);
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    if (read(fd, &psi, sizeof(psi)) != sizeof(psi)) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    /* Extract process info from psinfo */
+    proc->pid = pid;
+    proc->ppid = psi.pr_ppid;
+    snprintf(name, name_size, "%s", psi.pr_fname);
+
+    /* AIX: Validate state character - must be printable ASCII */
+    /* pr_lwp.pr_sname can be invalid for kernel processes without LWPs */
+    char state = psi.pr_lwp.pr_sname;
+    if (state >= 'A' && state <= 'Z') {
+        proc->state = state;  /* Valid state: S, R, Z, T, O, I, etc. */
+    } else if (psi.pr_nlwp == 0) {
+        proc->state = 'I';  /* Idle/kernel process with no LWPs */
+    } else {
+        proc->state = '?';  /* Unknown state */
+    }
+
+    proc->thread_count = psi.pr_nlwp;  /* Number of LWPs (threads) */
+    proc->vsize_bytes = psi.pr_size * 1024;  /* Size in KB -> bytes */
+    proc->rss_bytes = psi.pr_rssize * 1024;  /* RSS in KB -> bytes */
+
+    /* Calculate process age from start time */
+    proc->start_time = psi.pr_start.tv_sec;
+
+    /* Validate start time - kernel processes may have epoch or invalid times */
+    if (proc->start_time > 0 && proc->start_time < ctx->now) {
+        proc->age_seconds = ctx->now - proc->start_time;
+    } else {
+        proc->age_seconds = 0;  /* Invalid or future start time */
+    }
+
+#else
+    /* Linux: Read text stat file */
+    char buf[2048];
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    if (!fgets(buf, sizeof(buf), f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    /* Parse the stat line - format is complex due to comm field */
+    /* pid (comm) state ppid ... */
+    char *start = strchr(buf, '(');
+    char *end = strrchr(buf, ')');
+
+    if (!start || !end) return -1;
+
+    /* Extract comm (process name) */
+    size_t name_len = end - start - 1;
+    if (name_len >= name_size) {
+        name_len = name_size - 1;
+    }
+    memcpy(name, start + 1, name_len);
+    name[name_len] = '\0';
+
+    /* Parse fields after the comm */
+    unsigned long vsize;
+    long rss;
+    unsigned long long starttime;
+
+    int thread_count_tmp;
+
+    int parsed = sscanf(end + 2,
+        "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+        "%*u %*u %*d %*d %*d %*d %d %*d %llu %lu %ld",
+        &proc->state,
+        &proc->ppid,
+        &thread_count_tmp,
+        &starttime,
+        &vsize,
+        &rss);
+
+    if (parsed < 6) return -1;
+
+    proc->pid = pid;
+    proc->thread_count = (uint32_t)thread_count_tmp;
+    proc->vsize_bytes = vsize;
+    proc->rss_bytes = rss * ctx->page_size;
+
+    /* Calculate process age */
+    /* starttime is in clock ticks since boot */
+    if (ctx->boot_time > 0) {
+        proc->start_time = ctx->boot_time + (starttime / ctx->ticks_per_sec);
+        proc->age_seconds = ctx->now - proc->start_time;
+    }
+#endif
+
+    /* Heuristic: process might be stuck if it's old and in certain states */
+    /* D = uninterruptible sleep, often indicates I/O issues */
+    if (proc->state == 'D' && proc->age_seconds > 300) {
+        proc->is_potentially_stuck = 1;
+    }
+    /* Z = zombie */
+    if (proc->state == 'Z') {
+        proc->is_potentially_stuck = 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Per-pid capture slot. Workers fill slots independently; the results
+ * are merged into the snapshot in /proc order afterwards.
+ */
+typedef struct {
+    pid_t pid;
+    int valid;
+    proc_entry_t entry;
+    char name[256];
+    unsigned long *inodes;
+    int inode_count;
+    int inode_capacity;
+} pid_slot_t;
+
+typedef struct {
+    const capture_ctx_t *ctx;
+    pid_slot_t *slots;
+    unsigned flags;
+} capture_job_t;
+
+/* Record a socket inode owned by the slot's process */
+static int slot_add_inode(pid_slot_t *slot, unsigned long inode) {
+    if (slot->inode_count >= slot->inode_capacity) {
+        int new_cap = slot->inode_capacity ? slot->inode_capacity * 2 : 16;
+        unsigned long *grown = realloc(slot->inodes, new_cap * sizeof(*grown));
+        if (!grown) return -1;
+        slot->inodes = grown;
+        slot->inode_capacity = new_cap;
+    }
+    slot->inodes[slot->inode_count++] = inode;
+    return 0;
+}
+
+/* Record a socket inode owned by pid */
+static int add_socket(proc_snapshot_t *snap, unsigned long inode, pid_t pid) {
+    if (snap->socket_count >= snap->socket_capacity) {
+        int new_cap = snap->socket_capacity ? snap->socket_capacity * 2 : SNAP_INITIAL_SOCKETS;
+        proc_socket_t *grown = realloc(snap->sockets, new_cap * sizeof(*grown));
+        if (!grown) return -1;
+        snap->sockets = grown;
+        snap->socket_capacity = new_cap;
+    }
+    snap->sockets[snap->socket_count].inode = inode;
+    snap->sockets[snap->socket_count].pid = pid;
+    snap->socket_count++;
+    return 0;
+}
+
+/*
+ * Walk /proc/[pid]/fd once: count descriptors and, when requested,
+ * note which of them are sockets. Returns the fd count or -1.
+ */
+static int scan_fds(pid_slot_t *slot, unsigned flags) {
+    proc_entry_t *entry = &slot->entry;
+    char fd_path[128];
+    snprintf(fd_path, sizeof(fd_path), "/proc/%d/fd", (int)entry->info.pid);
+
+    DIR *dir = opendir(fd_path);
+    if (!dir) return -1;
+
+    int count = 0;
+    struct dirent *fd_entry;
+    while ((fd_entry = readdir(dir)) != NULL) {
+        if (fd_entry->d_name[0] == '.') continue;
+        count++;
+
+        if (!(flags & PROC_SNAP_SOCKETS)) continue;
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", fd_path, fd_entry->d_name);
+#ifdef _AIX
+        /* AIX has no socket:[inode] links - only note that a socket is open */
+        struct stat st;
+        if (!entry->has_sockets && stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+            entry->has_sockets = 1;
+        }
+#else
+        char target[64];
+        ssize_t len = readlink(path, target, sizeof(target) - 1);
+        if (len > 8 && strncmp(target, "socket:[", 8) == 0) {
+            target[len] = '\0';
+            unsigned long inode = strtoul(target + 8, NULL, 10);
+            if (inode > 0) {
+                entry->has_sockets = 1;
+                slot_add_inode(slot, inode);
+            }
+        }
+#endif
+    }
+
+    closedir(dir);
+    return count;
+}
+
+/* Worker body: everything that touches /proc for one pid */
+static void capture_pid(int index, void *arg) {
+    capture_job_t *job = arg;
+    pid_slot_t *slot = &job->slots[index];
+
+    if (read_proc_stat(job->ctx, slot->pid, &slot->entry.info,
+                       slot->name, sizeof(slot->name)) != 0) {
+        return;
+    }
+    /* uint32 -1 marks "could not read" for the quick analysis checks */
+    slot->entry.info.open_fd_count = (uint32_t)scan_fds(slot, job->flags);
+    slot->valid = 1;
+}
+
+/* Collect the numeric /proc entries in directory order */
+static int list_pids(pid_slot_t **out) {
+    DIR *proc_dir = opendir("/proc");
+    if (!proc_dir) return -1;
+
+    pid_slot_t *slots = NULL;
+    int count = 0, capacity = 0;
+
+    struct dirent *entry;
+    while ((entry = readdir(proc_dir)) != NULL) {
+        /* Skip non-numeric entries (not PIDs) */
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+
+        pid_t pid = atoi(entry->d_name);
+        if (pid <= 0) continue;
+
+        if (count >= capacity) {
+            int new_cap = capacity ? capacity * 2 : SNAP_INITIAL_PROCS;
+            pid_slot_t *grown = realloc(slots, new_cap * sizeof(*grown));
+            if (!grown) break;
+            slots = grown;
+            capacity = new_cap;
+        }
+        memset(&slots[count], 0, sizeof(slots[count]));
+        slots[count].pid = pid;
+        count++;
+    }
+    closedir(proc_dir);
+
+    *out = slots;
+    return count;
+}
+
+/* ============================================================
+ * Index Construction
+ * ============================================================ */
+
+static unsigned pid_hash(pid_t pid) {
+    return (unsigned)pid * 2654435761u;
+}
+
+static int build_pid_index(proc_snapshot_t *snap) {
+    int size = 64;
+    while (size < snap->count * 2) size *= 2;
+
+    snap->pid_index = malloc(size * sizeof(int));
+    if (!snap->pid_index) return -1;
+    snap->pid_index_size = size;
+
+    for (int i = 0; i < size; i++) snap->pid_index[i] = -1;
+
+    for (int i = 0; i < snap->count; i++) {
+        unsigned slot = pid_hash(snap->procs[i].info.pid) & (size - 1);
+        while (snap->pid_index[slot] >= 0) {
+            slot = (slot + 1) & (size - 1);
+        }
+        snap->pid_index[slot] = i;
+    }
+    return 0;
+}
+
+/* Link each process into its parent's child list */
+static void build_child_links(proc_snapshot_t *snap) {
+    for (int i = 0; i < snap->count; i++) {
+        snap->procs[i].first_child = -1;
+        snap->procs[i].next_sibling = -1;
+    }
+    /* Walk backwards so child lists come out in /proc order */
+    for (int i = snap->count - 1; i >= 0; i--) {
+        const proc_entry_t *parent = proc_snapshot_find(snap, snap->procs[i].info.ppid);
+        if (!parent || parent == &snap->procs[i]) continue;
+        int parent_idx = (int)(parent - snap->procs);
+        snap->procs[i].next_sibling = snap->procs[parent_idx].first_child;
+        snap->procs[parent_idx].first_child = i;
+    }
+}
+
+/* ============================================================
+ * Public API
+ * ============================================================ */
+
+int proc_snapshot_capture(proc_snapshot_t *snap, unsigned flags) {
+    if (!snap) return -1;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->flags = flags;
+
+    capture_ctx_t ctx;
+    capture_ctx_init(&ctx);
+    snap->capture_time = ctx.now;
+
+    pid_slot_t *slots = NULL;
+    int pid_count = list_pids(&slots);
+    if (pid_count < 0) return -1;
+
+    /* The per-pid reads are independent - fan them out */
+    capture_job_t job = { &ctx, slots, flags };
+    workpool_for(pid_count, capture_pid, &job);
+
+    /* Merge in /proc order so the result is identical for any job count */
+    if (pid_count > 0) {
+        snap->procs = malloc(pid_count * sizeof(*snap->procs));
+        snap->capacity = snap->procs ? pid_count : 0;
+    }
+    for (int i = 0; i < pid_count; i++) {
+        pid_slot_t *slot = &slots[i];
+        if (slot->valid && snap->procs) {
+            proc_entry_t *pe = &snap->procs[snap->count++];
+            *pe = slot->entry;
+            pe->info.name = arena_intern(&snap->names, slot->name);
+            for (int j = 0; j < slot->inode_count; j++) {
+                add_socket(snap, slot->inodes[j], pe->info.pid);
+            }
+        }
+        free(slot->inodes);
+    }
+    free(slots);
+
+    if (build_pid_index(snap) != 0) {
+        proc_snapshot_free(snap);
+        return -1;
+    }
+    build_child_links(snap);
+
+    return 0;
+}
+
+void proc_snapshot_free(proc_snapshot_t *snap) {
+    if (!snap) return;
+    free(snap->procs);
+    free(snap->pid_index);
+    free(snap->sockets);
+    arena_free(&snap->names);
+    memset(snap, 0, sizeof(*snap));
+}
+
+const proc_entry_t* proc_snapshot_find(const proc_snapshot_t *snap, pid_t pid) {
+    if (!snap || !snap->pid_index || pid <= 0) return NULL;
+
+    int mask = snap->pid_index_size - 1;
+    unsigned slot = pid_hash(pid) & mask;
+    while (snap->pid_index[slot] >= 0) {
+        const proc_entry_t *pe = &snap->procs[snap->pid_index[slot]];
+        if (pe->info.pid == pid) return pe;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+const proc_entry_t* proc_snapshot_first_child(const proc_snapshot_t *snap, pid_t ppid) {
+    const proc_entry_t *parent = proc_snapshot_find(snap, ppid);
+    if (!parent || parent->first_child < 0) return NULL;
+    return &snap->procs[parent->first_child];
+}
+
+const proc_entry_t* proc_snapshot_next_sibling(const proc_snapshot_t *snap,
+                                               const proc_entry_t *entry) {
+    if (!snap || !entry || entry->next_sibling < 0) return NULL;
+    return &snap->procs[entry->next_sibling];
+}
+
+/* ============================================================
+ * Shared Snapshot for the Current Probe Cycle
+ * ============================================================ */
+
+void proc_snapshot_request(unsigned flags) {
+    g_requested_flags |= flags;
+}
+
+const proc_snapshot_t* proc_snapshot_refresh(void) {
+    if (g_snapshot_valid) {
+        proc_snapshot_free(&g_snapshot);
+        g_snapshot_valid = 0;
+    }
+    if (proc_snapshot_capture(&g_snapshot, g_requested_flags) != 0) {
+        return NULL;
+    }
+    g_snapshot_valid = 1;
+    return &g_snapshot;
+}
+
+const proc_snapshot_t* proc_snapshot_current(void) {
+    return g_snapshot_valid ? &g_snapshot : NULL;
+}
+
+void proc_snapshot_release(void) {
+    if (g_snapshot_valid) {
+        proc_snapshot_free(&g_snapshot);
+        g_snapshot_valid = 0;
+    }
+}
@@ -1,7 +1,8 @@
 /*
  * process_chain.c - Process ancestry tracking for C-Sentinel
  *
- * Walks /proc/<pid>/stat (Linux) or /proc/<pid>/psinfo (AIX) to build process chain.
+ * Walks the shared process snapshot to build process chain, falling back to
+ * /proc/<pid>/stat (Linux) or /proc/<pid>/psinfo (AIX) for pids it missed.
  * Enables semantic analysis like "python3 spawned by apache2 accessed /etc/shadow"
  */
 
@@ -83,6 +84,17 @@ static const suspicious_pattern_t SUSPICIOUS_PATTERNS[] = {
  * Format (AIX): binary struct psinfo
  */
 static int read_proc_stat(pid_t pid, char *comm, size_t comm_len, pid_t *ppid) {
+    /* Live processes come from the probe cycle's snapshot */
+    const proc_entry_t *pe = proc_snapshot_find(proc_snapshot_current(), pid);
+    if (pe) {
+        size_t len = strlen(pe->info.name);
+        if (len >= comm_len) len = comm_len - 1;
+        memcpy(comm, pe->info.name, len);
+        comm[len] = '\0';
+        *ppid = pe->info.ppid;
+        return 0;
+    }
+
 #ifdef _AIX
     /* AIX: Read binary /proc/<pid>/psinfo */
     char path[64];
@@ -14,8 +14,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#if defined(_AIX)
+#include <sys/systemcfg.h>
+#elif defined(__linux__) && defined(__powerpc64__)
+#include <sys/auxv.h>
+#endif
 
 #include "sanitize.h"
+#include "sanitize_scan.h"
 
 /* ============================================================
  * State and Configuration
@@ -111,187 +118,583 @@ static int looks_like_homedir(const char *str) {
             strncmp(str, "/root", 5) == 0);
 }
 
-/* Safe string replacement in a buffer */
-static int replace_range(char *buf, size_t buf_size, size_t pos, 
-                         size_t old_len, const char *replacement) {
-    size_t current_len = strlen(buf);
-    size_t repl_len = strlen(replacement);
-    size_t new_len = current_len - old_len + repl_len;
-    
-    if (new_len >= buf_size) return -1;  /* Would overflow */
-    
-    /* Move tail of string */
-    memmove(buf + pos + repl_len, 
-            buf + pos + old_len,
-            current_len - pos - old_len + 1);  /* +1 for null terminator */
-    
-    /* Insert replacement */
-    memcpy(buf + pos, replacement, repl_len);
-    
-    return 0;
+/* Bytes that end a "word" (IP, hostname, etc.) */
+static int is_word_byte(unsigned char c) {
+    return c && !isspace(c) && 
+           c != '"' && c != '\'' && 
+           c != ',' && c != ';' &&
+           c != ')' && c != ']' && c != '}';
 }
 
-/* Find end of a "word" (IP, hostname, etc.) */
-static size_t find_word_end(const char *str) {
+/* Length of the word at str, at most n bytes */
+static size_t word_length(const char *str, size_t n) {
     size_t i = 0;
-    while (str[i] && !isspace((unsigned char)str[i]) && 
-           str[i] != '"' && str[i] != '\'' && 
-           str[i] != ',' && str[i] != ';' &&
-           str[i] != ')' && str[i] != ']' && str[i] != '}') {
+    while (i < n && is_word_byte((unsigned char)str[i])) {
         i++;
     }
     return i;
 }
 
 /* ============================================================
- * Core Sanitization
- * ============================================================ */
+ * Candidate Pre-filter
+ * ============================================================
+ * Only words holding a trigger byte can be IPs or home directories
+ * (see sanitize_scan.h). The vector kernels in sanitize_simd.c skip
+ * the text between triggers; this file pins each one down.
+ */
 
-int sanitize_string(char *str, size_t max_len, sanitize_flags_t flags) {
-    if (!str || max_len == 0) return -1;
+/* Bytes checked one at a time after each kernel call; at least one vector */
+#define SCAN_CHECK_BYTES 32
+
+typedef size_t (*scan_skip_fn)(const char *s, size_t from, size_t len);
+
+static sanitize_scan_t g_scan = SANITIZE_SCAN_SCALAR;
+static scan_skip_fn g_skip = NULL;          /* NULL: every byte checked here */
+static pthread_once_t g_scan_once = PTHREAD_ONCE_INIT;
+
+static const char *scan_names[SANITIZE_SCAN_COUNT] = {
+    "auto", "scalar", "sse2", "avx2", "vsx"
+};
+
+static int is_hex(unsigned char c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+static int is_trigger(const char *s, size_t i, size_t len) {
+    unsigned char c = (unsigned char)s[i];
+    if (c == '.' || c == ':') {
+        return (i > 0 && is_hex((unsigned char)s[i - 1])) ||
+               (i + 1 < len && is_hex((unsigned char)s[i + 1]));
+    }
+    if (c == '/') {
+        return i + 1 < len && (s[i + 1] == 'h' || s[i + 1] == 'U' || s[i + 1] == 'r');
+    }
+    return 0;
+}
+
+/* Checked here rather than in sanitize_simd.c, which may be built for POWER8 */
+static int cpu_has_vsx(void) {
+    if (!sanitize_vsx_built()) return 0;
+#if defined(_AIX) && defined(__power_8_andup)
+    return __power_8_andup() ? 1 : 0;
+#elif defined(__linux__) && defined(__powerpc64__) && defined(PPC_FEATURE2_ARCH_2_07)
+    return (getauxval(AT_HWCAP2) & PPC_FEATURE2_ARCH_2_07) != 0;
+#else
+    return 0;
+#endif
+}
+
+int sanitize_scan_available(sanitize_scan_t scan) {
+    switch (scan) {
+        case SANITIZE_SCAN_AUTO:
+        case SANITIZE_SCAN_SCALAR:
+            return 1;
+        case SANITIZE_SCAN_SSE2:
+            return sanitize_cpu_has_sse2();
+        case SANITIZE_SCAN_AVX2:
+            return sanitize_cpu_has_avx2();
+        case SANITIZE_SCAN_VSX:
+            return cpu_has_vsx();
+        default:
+            return 0;
+    }
+}
+
+static void apply_scan(sanitize_scan_t scan) {
+    if (scan == SANITIZE_SCAN_AUTO) {
+        if (sanitize_cpu_has_avx2()) scan = SANITIZE_SCAN_AVX2;
+        else if (sanitize_cpu_has_sse2()) scan = SANITIZE_SCAN_SSE2;
+        else if (cpu_has_vsx()) scan = SANITIZE_SCAN_VSX;
+        else scan = SANITIZE_SCAN_SCALAR;
+    }
     
-    memset(&last_stats, 0, sizeof(last_stats));
+    g_scan = scan;
+    switch (scan) {
+        case SANITIZE_SCAN_SSE2: g_skip = sanitize_skip_sse2; break;
+        case SANITIZE_SCAN_AVX2: g_skip = sanitize_skip_avx2; break;
+        case SANITIZE_SCAN_VSX:  g_skip = sanitize_skip_vsx;  break;
+        default:                 g_skip = NULL;               break;
+    }
+}
+
+static void select_auto_scan(void) {
+    apply_scan(SANITIZE_SCAN_AUTO);
+}
+
+static void ensure_scan(void) {
+    pthread_once(&g_scan_once, select_auto_scan);
+}
+
+/* Force a backend; call before sanitizing on other threads */
+int sanitize_set_scan(sanitize_scan_t scan) {
+    if (!sanitize_scan_available(scan)) return -1;
+    ensure_scan();
+    apply_scan(scan);
+    return 0;
+}
+
+sanitize_scan_t sanitize_get_scan(void) {
+    ensure_scan();
+    return g_scan;
+}
+
+const char* sanitize_scan_name(sanitize_scan_t scan) {
+    if ((int)scan < 0 || scan >= SANITIZE_SCAN_COUNT) return "unknown";
+    return scan_names[scan];
+}
+
+static size_t next_candidate(const char *s, size_t i, size_t len) {
+    while (i < len) {
+        if (g_skip) i = g_skip(s, i, len);
+        /* The kernel stops at or before the trigger: find the byte */
+        size_t stop = len - i > SCAN_CHECK_BYTES ? i + SCAN_CHECK_BYTES : len;
+        for (; i < stop; i++) {
+            if (is_trigger(s, i, len)) return i;
+        }
+    }
+    return len;
+}
+
+size_t sanitize_next_candidate(const char *s, size_t from, size_t len) {
+    ensure_scan();
+    return next_candidate(s, from, len);
+}
+
+/* ============================================================
+ * Pattern Automaton
+ * ============================================================
+ * Secret keys, secret values and custom patterns are compiled into
+ * Aho-Corasick automata, so one pass over the input finds every
+ * occurrence of every pattern. Input bytes are first mapped to
+ * classes (bytes no pattern uses share class 0), which keeps the
+ * full transition table small. Secret keys are matched without
+ * regard to case by giving both cases of a letter the same class.
+ */
+
+typedef struct {
+    unsigned char cls[256];     /* Byte -> class */
+    int classes;
+    int *next;                  /* nodes x classes, complete after build */
+    int *match;                 /* Pattern ending at each node, or -1 */
+    int *dict;                  /* Nearest suffix node with a match, or 0 */
+    int *depth;                 /* Pattern bytes matched on reaching each node */
+    int nodes;
+    int pattern_count;
+} automaton_t;
+
+static void automaton_free(automaton_t *ac) {
+    free(ac->next);
+    free(ac->match);
+    free(ac->dict);
+    free(ac->depth);
+    memset(ac, 0, sizeof(*ac));
+}
+
+static int automaton_build(automaton_t *ac, const char **patterns, int count, int fold_case) {
+    size_t max_nodes = 1;
+
+    automaton_free(ac);
+    ac->pattern_count = count;
+
+    /* Byte classes: one per distinct pattern byte (per letter when folding) */
+    int classes = 1;
+    for (int p = 0; p < count; p++) {
+        for (const unsigned char *c = (const unsigned char *)patterns[p]; *c; c++) {
+            unsigned char b = fold_case ? (unsigned char)tolower(*c) : *c;
+            if (!ac->cls[b]) {
+                ac->cls[b] = (unsigned char)classes++;
+                if (fold_case) ac->cls[toupper(b)] = ac->cls[b];
+            }
+            max_nodes++;
+        }
+    }
+    ac->classes = classes;
+
+    ac->next = malloc(max_nodes * classes * sizeof(int));
+    ac->match = malloc(max_nodes * sizeof(int));
+    ac->dict = calloc(max_nodes, sizeof(int));
+    ac->depth = calloc(max_nodes, sizeof(int));
+    int *fail = calloc(max_nodes, sizeof(int));
+    int *queue = malloc(max_nodes * sizeof(int));
+    if (!ac->next || !ac->match || !ac->dict || !ac->depth || !fail || !queue) {
+        free(fail);
+        free(queue);
+        automaton_free(ac);
+        return -1;
+    }
+
+    /* Trie */
+    ac->nodes = 1;
+    for (int i = 0; i < classes; i++) ac->next[i] = -1;
+    ac->match[0] = -1;
+    for (int p = 0; p < count; p++) {
+        int node = 0;
+        for (const unsigned char *c = (const unsigned char *)patterns[p]; *c; c++) {
+            int *slot = &ac->next[node * classes + ac->cls[*c]];
+            if (*slot < 0) {
+                *slot = ac->nodes;
+                for (int i = 0; i < classes; i++) ac->next[ac->nodes * classes + i] = -1;
+                ac->depth[ac->nodes] = ac->depth[node] + 1;
+                ac->match[ac->nodes++] = -1;
+            }
+            node = *slot;
+        }
+        /* A duplicate pattern keeps the first id */
+        if (ac->match[node] < 0) ac->match[node] = p;
+    }
+
+    /* Breadth-first: failure links, dictionary links, missing transitions */
+    int head = 0, tail = 0;
+    for (int i = 0; i < classes; i++) {
+        int child = ac->next[i];
+        if (child < 0) {
+            ac->next[i] = 0;
+        } else {
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    while (head < tail) {
+        int node = queue[head++];
+        int f = fail[node];
+        ac->dict[node] = ac->match[f] >= 0 ? f : ac->dict[f];
+        for (int i = 0; i < classes; i++) {
+            int *slot = &ac->next[node * classes + i];
+            if (*slot < 0) {
+                *slot = ac->next[f * classes + i];
+            } else {
+                fail[*slot] = ac->next[f * classes + i];
+                queue[tail++] = *slot;
+            }
+        }
+    }
+
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+/* ============================================================
+ * Compiled Patterns
+ * ============================================================ */
+
+/* What a match redacts */
+typedef enum {
+    SPAN_IPV4,
+    SPAN_IPV6,
+    SPAN_HOMEDIR,
+    SPAN_SECRET,
+    SPAN_CUSTOM
+} span_kind_t;
+
+typedef struct {
+    size_t start;
+    size_t end;
+    span_kind_t kind;
+    const char *replacement;
+} span_t;
+
+typedef struct {
+    span_t *spans;
+    size_t count;
+    size_t capacity;
+} span_list_t;
+
+static automaton_t key_automaton;       /* SECRET_PATTERNS, any case */
+static automaton_t literal_automaton;   /* Secret values, then custom patterns */
+static int patterns_dirty = 1;
+static int patterns_have_space = 0;     /* Some pattern could span whitespace */
+
+/* A secret key without '=' must be followed by one within this reach */
+#define SECRET_KEY_REACH 32
+
+static int compile_patterns(void) {
+    const char *literals[MAX_SECRET_VARS + MAX_CUSTOM_PATTERNS];
+    int n = 0;
+
+    for (int i = 0; i < secret_value_count; i++) {
+        literals[n++] = secret_values[i];
+    }
+    for (int i = 0; i < custom_pattern_count; i++) {
+        literals[n++] = custom_patterns[i].pattern;
+    }
+
+    int key_count = 0;
+    while (SECRET_PATTERNS[key_count]) key_count++;
     
+    patterns_have_space = 0;
+    for (int i = 0; i < n; i++) {
+        for (const char *c = literals[i]; *c; c++) {
+            if (isspace((unsigned char)*c)) patterns_have_space = 1;
+        }
+    }
+
+    if (automaton_build(&key_automaton, SECRET_PATTERNS, key_count, 1) != 0 ||
+        automaton_build(&literal_automaton, literals, n, 0) != 0) {
+        return -1;
+    }
+    patterns_dirty = 0;
+    return 0;
+}
+
+static int ensure_compiled(void) {
+    return patterns_dirty ? compile_patterns() : 0;
+}
+
+static int add_span(span_list_t *list, size_t start, size_t end, span_kind_t kind,
+                    const char *replacement) {
+    if (list->count == list->capacity) {
+        size_t cap = list->capacity ? list->capacity * 2 : 32;
+        span_t *grown = realloc(list->spans, cap * sizeof(span_t));
+        if (!grown) return -1;
+        list->spans = grown;
+        list->capacity = cap;
+    }
+    span_t *s = &list->spans[list->count++];
+    s->start = start;
+    s->end = end;
+    s->kind = kind;
+    s->replacement = replacement;
+    return 0;
+}
+
+/* IPs and home directories, checked in the words holding a trigger */
+static int find_word_spans(const char *str, size_t len, sanitize_flags_t flags,
+                           span_list_t *list) {
     size_t pos = 0;
-    size_t len = strlen(str);
+    
+    if (!(flags & (SANITIZE_IPV4 | SANITIZE_IPV6 | SANITIZE_HOMEDIR))) return 0;
+    ensure_scan();
     
     while (pos < len) {
-        /* Skip whitespace */
-        if (isspace((unsigned char)str[pos])) {
-            pos++;
-            continue;
-        }
+        size_t trigger = next_candidate(str, pos, len);
+        if (trigger >= len) break;
         
-        size_t word_end = find_word_end(str + pos);
-        if (word_end == 0) {
-            pos++;
-            continue;
+        /* Back to the start of its word, but never behind the scan */
+        while (trigger > pos && is_word_byte((unsigned char)str[trigger - 1])) {
+            trigger--;
         }
+        pos = trigger;
+        size_t word_end = word_length(str + pos, len - pos);
         
-        /* Check for IPv4 */
         if ((flags & SANITIZE_IPV4) && looks_like_ipv4(str + pos, word_end)) {
-            if (replace_range(str, max_len, pos, word_end, REDACT_IP) == 0) {
-                last_stats.ipv4_count++;
-                last_stats.total_redactions++;
-                len = strlen(str);
-                pos += strlen(REDACT_IP);
+            if (add_span(list, pos, pos + word_end, SPAN_IPV4, REDACT_IP) != 0) return -1;
+        } else if ((flags & SANITIZE_IPV6) && looks_like_ipv6(str + pos, word_end)) {
+            if (add_span(list, pos, pos + word_end, SPAN_IPV6, REDACT_IP) != 0) return -1;
+        } else if ((flags & SANITIZE_HOMEDIR) && word_end >= 5 &&
+                   looks_like_homedir(str + pos)) {
+            /* Only the username portion goes; the rest of the path is scanned on */
+            size_t user = (word_end >= 6 && strncmp(str + pos, "/home/", 6) == 0) ? 6 :
+                          (word_end >= 7 && strncmp(str + pos, "/Users/", 7) == 0) ? 7 : 0;
+            if (user) {
+                size_t end = pos + user;
+                while (end < len && str[end] && str[end] != '/' &&
+                       !isspace((unsigned char)str[end])) {
+                    end++;
+                }
+                if (add_span(list, pos, end, SPAN_HOMEDIR, REDACT_PATH) != 0) return -1;
+                pos = end;
                 continue;
             }
         }
         
-        /* Check for IPv6 */
-        if ((flags & SANITIZE_IPV6) && looks_like_ipv6(str + pos, word_end)) {
-            if (replace_range(str, max_len, pos, word_end, REDACT_IP) == 0) {
-                last_stats.ipv6_count++;
-                last_stats.total_redactions++;
-                len = strlen(str);
-                pos += strlen(REDACT_IP);
-                continue;
-            }
-        }
+        pos += word_end;
+    }
+    return 0;
+}
+
+/* Secret keys ("password=...") redact their value; literals redact themselves */
+static int find_pattern_spans(const char *str, size_t len, sanitize_flags_t flags,
+                              span_list_t *list) {
+    const automaton_t *keys = &key_automaton;
+    const automaton_t *lits = &literal_automaton;
+    int scan_keys = (flags & SANITIZE_SECRETS) && keys->pattern_count > 0;
+    int scan_lits = lits->pattern_count > 0;
+    int key_node = 0, lit_node = 0;
+    size_t value_end = 0;       /* End of the last secret value found */
+    
+    for (size_t i = 0; i < len && (scan_keys || scan_lits); i++) {
+        unsigned char c = (unsigned char)str[i];
         
-        /* Check for home directories */
-        if ((flags & SANITIZE_HOMEDIR) && looks_like_homedir(str + pos)) {
-            /* Find the username portion */
-            const char *start = str + pos;
-            const char *user_start = NULL;
-            
-            if (strncmp(start, "/home/", 6) == 0) {
-                user_start = start + 6;
-            } else if (strncmp(start, "/Users/", 7) == 0) {
-                user_start = start + 7;
-            }
-            
-            if (user_start) {
-                /* Find end of username */
-                const char *user_end = user_start;
-                while (*user_end && *user_end != '/' && 
-                       !isspace((unsigned char)*user_end)) {
-                    user_end++;
+        if (scan_keys) {
+            key_node = keys->next[key_node * keys->classes + keys->cls[c]];
+            for (int n = key_node; n; n = keys->dict[n]) {
+                if (keys->match[n] < 0) continue;
+                /* The value starts after the '=' within this word */
+                size_t value = i + 1;
+                if (str[i] != '=') {
+                    size_t reach = value + SECRET_KEY_REACH < len ? value + SECRET_KEY_REACH : len;
+                    while (value < reach && str[value] != '=' &&
+                           word_length(str + value, 1) == 1) {
+                        value++;
+                    }
+                    if (value >= reach || str[value] != '=') continue;
+                    value++;
                 }
-                
-                size_t path_len = user_end - start;
-                if (replace_range(str, max_len, pos, path_len, REDACT_PATH) == 0) {
-                    last_stats.homedir_count++;
-                    last_stats.total_redactions++;
-                    len = strlen(str);
-                    pos += strlen(REDACT_PATH);
-                    continue;
+                /* Values inside the last one end where it did: skip the rescan */
+                if (value < value_end) continue;
+                size_t vlen = word_length(str + value, len - value);
+                if (vlen > 0) {
+                    value_end = value + vlen;
+                    if (add_span(list, value, value_end, SPAN_SECRET, REDACT_SECRET) != 0) {
+                        return -1;
+                    }
                 }
             }
         }
         
-        pos += word_end;
-    }
-    
-    /* Check for secrets (case-insensitive substring search) */
-    if (flags & SANITIZE_SECRETS) {
-        for (int i = 0; SECRET_PATTERNS[i]; i++) {
-            char *found = str;
-            while ((found = strstr(found, SECRET_PATTERNS[i])) != NULL) {
-                /* Find the value after the = sign */
-                char *eq = strchr(found, '=');
-                if (eq && *(eq + 1)) {
-                    char *value_start = eq + 1;
-                    size_t value_len = find_word_end(value_start);
-                    if (value_len > 0) {
-                        if (replace_range(str, max_len, value_start - str, 
-                                          value_len, REDACT_SECRET) == 0) {
-                            last_stats.secret_count++;
-                            last_stats.total_redactions++;
-                            len = strlen(str);
-                        }
+        if (scan_lits) {
+            lit_node = lits->next[lit_node * lits->classes + lits->cls[c]];
+            for (int n = lit_node; n; n = lits->dict[n]) {
+                int p = lits->match[n];
+                if (p < 0) continue;
+                if (p < secret_value_count) {
+                    if (!(flags & SANITIZE_SECRETS)) continue;
+                    size_t plen = strlen(secret_values[p]);
+                    if (add_span(list, i + 1 - plen, i + 1, SPAN_SECRET, REDACT_SECRET) != 0) {
+                        return -1;
                     }
+                } else {
+                    const custom_pattern_t *cp = &custom_patterns[p - secret_value_count];
+                    size_t plen = strlen(cp->pattern);
+                    const char *repl = cp->replacement[0] ? cp->replacement : "[REDACTED]";
+                    if (add_span(list, i + 1 - plen, i + 1, SPAN_CUSTOM, repl) != 0) return -1;
                 }
-                found++;
             }
         }
-        
-        /* Check custom secret values */
-        for (int i = 0; i < secret_value_count; i++) {
-            char *found;
-            while ((found = strstr(str, secret_values[i])) != NULL) {
-                size_t secret_len = strlen(secret_values[i]);
-                if (replace_range(str, max_len, found - str, 
-                                  secret_len, REDACT_SECRET) == 0) {
-                    last_stats.secret_count++;
-                    last_stats.total_redactions++;
-                    len = strlen(str);
-                }
-            }
+    }
+    return 0;
+}
+
+/* Leftmost first; of spans starting together, the longest */
+static int cmp_span(const void *x, const void *y) {
+    const span_t *a = x, *b = y;
+    if (a->start != b->start) return a->start < b->start ? -1 : 1;
+    if (a->end != b->end) return a->end > b->end ? -1 : 1;
+    return 0;
+}
+
+static void count_redaction(span_kind_t kind) {
+    switch (kind) {
+        case SPAN_IPV4:    last_stats.ipv4_count++;    break;
+        case SPAN_IPV6:    last_stats.ipv6_count++;    break;
+        case SPAN_HOMEDIR: last_stats.homedir_count++; break;
+        case SPAN_SECRET:  last_stats.secret_count++;  break;
+        case SPAN_CUSTOM:  last_stats.custom_count++;  break;
+    }
+    last_stats.total_redactions++;
+}
+
+/* ============================================================
+ * Core Sanitization
+ * ============================================================ */
+
+/*
+ * Find every span, then copy input and replacements to out in one
+ * pass. With a fixed out_size, a replacement is made only if the rest
+ * of the input would still fit unchanged after it; otherwise (and if
+ * *out is NULL) the buffer is allocated to fit. Returns the number of
+ * redactions, or -1.
+ */
+static int sanitize_into(const char *in, size_t len, char **out, size_t out_size,
+                         sanitize_flags_t flags) {
+    span_list_t list = { NULL, 0, 0 };
+    
+    memset(&last_stats, 0, sizeof(last_stats));
+    if (ensure_compiled() != 0 ||
+        find_word_spans(in, len, flags, &list) != 0 ||
+        find_pattern_spans(in, len, flags, &list) != 0) {
+        free(list.spans);
+        return -1;
+    }
+    if (list.count > 1) qsort(list.spans, list.count, sizeof(span_t), cmp_span);
+    
+    /* Drop spans that overlap one already taken */
+    size_t kept = 0, covered = 0;
+    size_t growth = 0;
+    for (size_t i = 0; i < list.count; i++) {
+        span_t *s = &list.spans[i];
+        if (s->start < covered) continue;
+        covered = s->end;
+        size_t rlen = strlen(s->replacement);
+        if (rlen > s->end - s->start) growth += rlen - (s->end - s->start);
+        list.spans[kept++] = *s;
+    }
+    
+    char *buf = *out;
+    if (!buf) {
+        out_size = len + growth + 1;
+        buf = malloc(out_size);
+        if (!buf) {
+            free(list.spans);
+            return -1;
         }
+    } else if (out_size == 0) {
+        free(list.spans);
+        return -1;
     }
     
-    /* Check custom patterns */
-    for (int i = 0; i < custom_pattern_count; i++) {
-        if (!custom_patterns[i].active) continue;
+    size_t o = 0, pos = 0;
+    for (size_t i = 0; i < kept && o < out_size; i++) {
+        const span_t *s = &list.spans[i];
+        size_t plain = s->start - pos;
+        size_t rlen = strlen(s->replacement);
+        if (o + plain >= out_size) break;
+        memcpy(buf + o, in + pos, plain);
+        o += plain;
         
-        char *found;
-        while ((found = strstr(str, custom_patterns[i].pattern)) != NULL) {
-            size_t pattern_len = strlen(custom_patterns[i].pattern);
-            const char *repl = custom_patterns[i].replacement[0] ? 
-                               custom_patterns[i].replacement : "[REDACTED]";
-            
-            if (replace_range(str, max_len, found - str, pattern_len, repl) == 0) {
-                last_stats.custom_count++;
-                last_stats.total_redactions++;
-                len = strlen(str);
-            }
+        /* Only if what remains still fits unchanged */
+        if (o + rlen + (len - s->end) < out_size) {
+            memcpy(buf + o, s->replacement, rlen);
+            o += rlen;
+            count_redaction(s->kind);
+        } else if (o + (s->end - s->start) < out_size) {
+            memcpy(buf + o, in + s->start, s->end - s->start);
+            o += s->end - s->start;
         }
+        pos = s->end;
+    }
+    if (pos < len) {
+        size_t rest = len - pos;
+        if (o + rest >= out_size) rest = out_size - 1 - o;
+        memcpy(buf + o, in + pos, rest);
+        o += rest;
     }
+    buf[o] = '\0';
     
+    free(list.spans);
+    *out = buf;
     return last_stats.total_redactions;
 }
 
+int sanitize_string(char *str, size_t max_len, sanitize_flags_t flags) {
+    if (!str || max_len == 0) return -1;
+    
+    /* Sanitize to a scratch copy, then copy back */
+    char *out = malloc(max_len);
+    if (!out) return -1;
+    int n = sanitize_into(str, strlen(str), &out, max_len, flags);
+    if (n >= 0) memcpy(str, out, strlen(out) + 1);
+    free(out);
+    return n;
+}
+
 int sanitize_string_copy(const char *input, char *output,
                          size_t out_size, sanitize_flags_t flags) {
     if (!input || !output || out_size == 0) return -1;
     
-    /* Copy input to output buffer */
-    strncpy(output, input, out_size - 1);
-    output[out_size - 1] = '\0';
-    
-    return sanitize_string(output, out_size, flags);
+    /* Never read past what fits: the old strncpy bound */
+    size_t len = strlen(input);
+    if (len > out_size - 1) len = out_size - 1;
+    return sanitize_into(input, len, &output, out_size, flags);
+}
+
+char* sanitize_alloc(const char *input, size_t len, sanitize_flags_t flags, int *redactions) {
+    char *out = NULL;
+    if (!input) return NULL;
+    int n = sanitize_into(input, len, &out, 0, flags);
+    if (redactions) *redactions = n;
+    return n < 0 ? NULL : out;
 }
 
 int sanitize_json(char *json, size_t max_len, sanitize_flags_t flags) {
@@ -300,6 +703,143 @@ int sanitize_json(char *json, size_t max_len, sanitize_flags_t flags) {
     return sanitize_string(json, max_len, flags);
 }
 
+/* ============================================================
+ * Streaming Sanitization
+ * ============================================================
+ * Input is held back only as far as the last safe cut: just after
+ * whitespace, with neither automaton part-way through a pattern.
+ * Words, home directories and secret values all end at whitespace,
+ * so nothing redacted can straddle a safe cut, and the text before
+ * it is sanitized exactly as it would be inside the whole document.
+ */
+
+struct sanitize_stream {
+    sanitize_flags_t flags;
+    sanitize_sink_fn sink;
+    void *ctx;
+    char *pending;              /* SANITIZE_STREAM_HOLD bytes */
+    size_t len;
+    size_t scanned;             /* Bytes of pending already scanned */
+    int key_node;               /* Automaton states after them, if tracked */
+    int lit_node;
+    size_t cut;                 /* Last safe cut, or 0 */
+    size_t boundary;            /* Last word boundary outside a pattern, or 0 */
+    int redactions;
+    int forced_cuts;            /* Cuts made with no safe cut in the buffer */
+    int error;                  /* Sticky; reported by sanitize_stream_finish() */
+};
+
+sanitize_stream_t* sanitize_stream_new(sanitize_flags_t flags,
+                                       sanitize_sink_fn sink, void *ctx) {
+    if (!sink || ensure_compiled() != 0) return NULL;
+    
+    sanitize_stream_t *st = calloc(1, sizeof(*st));
+    if (!st) return NULL;
+    st->pending = malloc(SANITIZE_STREAM_HOLD);
+    if (!st->pending) {
+        free(st);
+        return NULL;
+    }
+    st->flags = flags;
+    st->sink = sink;
+    st->ctx = ctx;
+    return st;
+}
+
+/* Note safe cuts and boundaries in the bytes not yet scanned */
+static void scan_pending(sanitize_stream_t *st) {
+    const automaton_t *keys = &key_automaton;
+    const automaton_t *lits = &literal_automaton;
+    int key_node = st->key_node, lit_node = st->lit_node;
+    
+    /* No pattern holds whitespace (SECRET_PATTERNS never do): any is safe */
+    if (!patterns_have_space) {
+        for (size_t i = st->len; i > st->scanned; i--) {
+            unsigned char c = (unsigned char)st->pending[i - 1];
+            if (isspace(c)) {
+                st->cut = i;
+                break;
+            }
+            if (!st->boundary && !is_word_byte(c)) st->boundary = i;
+        }
+        st->scanned = st->len;
+        return;
+    }
+    
+    /* Otherwise carry the automata over them */
+    for (size_t i = st->scanned; i < st->len; i++) {
+        unsigned char c = (unsigned char)st->pending[i];
+        key_node = keys->next[key_node * keys->classes + keys->cls[c]];
+        lit_node = lits->next[lit_node * lits->classes + lits->cls[c]];
+        if (keys->depth[key_node] == 0 && lits->depth[lit_node] == 0) {
+            if (isspace(c)) st->cut = i + 1;
+            else if (!is_word_byte(c)) st->boundary = i + 1;
+        }
+    }
+    st->key_node = key_node;
+    st->lit_node = lit_node;
+    st->scanned = st->len;
+}
+
+/* Sanitize and pass on pending[0, cut) */
+static void emit(sanitize_stream_t *st, size_t cut) {
+    if (cut == 0) return;
+    
+    int n;
+    char *out = sanitize_alloc(st->pending, cut, st->flags, &n);
+    if (!out) {
+        st->error = 1;
+    } else {
+        st->redactions += n;
+        if (st->sink(st->ctx, out, strlen(out)) != 0) st->error = 1;
+        free(out);
+    }
+    memmove(st->pending, st->pending + cut, st->len - cut);
+    st->len -= cut;
+    st->scanned -= cut;
+    st->cut = st->cut > cut ? st->cut - cut : 0;
+    st->boundary = st->boundary > cut ? st->boundary - cut : 0;
+}
+
+int sanitize_stream_write(sanitize_stream_t *st, const char *chunk, size_t len) {
+    if (!st || (!chunk && len > 0)) return -1;
+    
+    while (len > 0) {
+        size_t room = SANITIZE_STREAM_HOLD - st->len;
+        size_t take = len < room ? len : room;
+        memcpy(st->pending + st->len, chunk, take);
+        st->len += take;
+        chunk += take;
+        len -= take;
+        scan_pending(st);
+        
+        /* A full buffer must give way even without a safe cut */
+        size_t cut = st->cut;
+        if (cut == 0 && st->len == SANITIZE_STREAM_HOLD) {
+            cut = st->boundary ? st->boundary : st->len;
+            st->forced_cuts++;
+        }
+        emit(st, cut);
+    }
+    return st->error ? -1 : 0;
+}
+
+int sanitize_stream_finish(sanitize_stream_t *st) {
+    if (!st) return -1;
+    emit(st, st->len);
+    return st->error ? -1 : st->redactions;
+}
+
+int sanitize_stream_forced_cuts(const sanitize_stream_t *st) {
+    return st ? st->forced_cuts : 0;
+}
+
+void sanitize_stream_free(sanitize_stream_t *st) {
+    if (!st) return;
+    free(st->pending);
+    free(st);
+}
+
 /* ============================================================
  * Pattern Management
  * ============================================================ */
@@ -321,6 +861,7 @@ int sanitize_add_pattern(const char *pattern, const char *replacement) {
     
     p->active = 1;
     custom_pattern_count++;
+    patterns_dirty = 1;
     
     return 0;
 }
@@ -336,6 +877,7 @@ int sanitize_add_secret_var(const char *var_name) {
     strncpy(secret_values[secret_value_count], value, MAX_PATTERN_LEN - 1);
     secret_values[secret_value_count][MAX_PATTERN_LEN - 1] = '\0';
     secret_value_count++;
+    patterns_dirty = 1;
     
     return 0;
 }
@@ -343,6 +885,7 @@ int sanitize_add_secret_var(const char *var_name) {
 void sanitize_clear_patterns(void) {
     custom_pattern_count = 0;
     secret_value_count = 0;
+    patterns_dirty = 1;
 }
 
 /* ============================================================
@@ -357,17 +900,15 @@ sanitize_flags_t sanitize_detect(const char *str, sanitize_flags_t flags) {
     size_t len = strlen(str);
     size_t pos = 0;
     
+    ensure_scan();
     while (pos < len) {
-        if (isspace((unsigned char)str[pos])) {
-            pos++;
-            continue;
-        }
-        
-        size_t word_end = find_word_end(str + pos);
-        if (word_end == 0) {
-            pos++;
-            continue;
+        size_t trigger = next_candidate(str, pos, len);
+        if (trigger >= len) break;
+        while (trigger > pos && is_word_byte((unsigned char)str[trigger - 1])) {
+            trigger--;
         }
+        pos = trigger;
+        size_t word_end = word_length(str + pos, len - pos);
         
         if ((flags & SANITIZE_IPV4) && looks_like_ipv4(str + pos, word_end)) {
             found |= SANITIZE_IPV4;
@@ -377,17 +918,20 @@ sanitize_flags_t sanitize_detect(const char *str, sanitize_flags_t flags) {
             found |= SANITIZE_IPV6;
         }
         
-        if ((flags & SANITIZE_HOMEDIR) && looks_like_homedir(str + pos)) {
+        if ((flags & SANITIZE_HOMEDIR) && word_end >= 5 && looks_like_homedir(str + pos)) {
             found |= SANITIZE_HOMEDIR;
         }
         
         pos += word_end;
     }
     
-    /* Check for secret patterns */
-    if (flags & SANITIZE_SECRETS) {
-        for (int i = 0; SECRET_PATTERNS[i]; i++) {
-            if (strstr(str, SECRET_PATTERNS[i])) {
+    /* Check for secret patterns: the first key found is enough */
+    if ((flags & SANITIZE_SECRETS) && ensure_compiled() == 0) {
+        const automaton_t *keys = &key_automaton;
+        int node = 0;
+        for (size_t i = 0; i < len && keys->pattern_count > 0; i++) {
+            node = keys->next[node * keys->classes + keys->cls[(unsigned char)str[i]]];
+            if (keys->match[node] >= 0 || keys->dict[node]) {
                 found |= SANITIZE_SECRETS;
                 break;
             }
@@ -417,9 +961,12 @@ int sanitize_init(void) {
     sanitize_add_secret_var("DATABASE_PASSWORD");
     sanitize_add_secret_var("DB_PASSWORD");
     
-    return 0;
+    /* Compile now so the first sanitization does not pay for it */
+    return compile_patterns();
 }
 
 void sanitize_cleanup(void) {
     sanitize_clear_patterns();
+    automaton_free(&key_automaton);
+    automaton_free(&literal_automaton);
 }
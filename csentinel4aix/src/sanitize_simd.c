@@ -0,0 +1,235 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * sanitize_simd.c - Vector skip kernels for the sanitizer pre-filter
+ *
+ * Each vector of input is compared with its neighbours one byte either
+ * side, so a trigger is found without a scalar look at every byte:
+ *
+ *   ('.' or ':') and (previous or next byte is a hex digit)
+ *   or '/' and next byte is 'h', 'U' or 'r'
+ *
+ * x86:    SSE2 and AVX2, built with per-function target attributes and
+ *         selected after the CPUID checks below.
+ * POWER8: VSX. This file is compiled with -mcpu=power8 on POWER, so the
+ *         hardware check lives in sanitize.c.
+ *
+ * Kernels for other architectures are stubs that are never selected.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sanitize_scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_HAVE_X86 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__powerpc64__) || defined(_ARCH_PPC64)) && defined(__POWER8_VECTOR__)
+#define SCAN_HAVE_VSX 1
+#include <altivec.h>
+#endif
+
+/* ============================================================
+ * x86 CPU Detection
+ * ============================================================ */
+
+#ifdef SCAN_HAVE_X86
+
+/* AVX state must be enabled by the OS, not just present in the CPU */
+static int os_saves_ymm(void) {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+    if (!(c & (1u << 27))) return 0;            /* OSXSAVE */
+    unsigned lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    (void)hi;
+    return (lo & 0x6) == 0x6;                   /* XMM and YMM state */
+}
+
+int sanitize_cpu_has_sse2(void) {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+    return (d & (1u << 26)) != 0;                          /* SSE2 */
+}
+
+int sanitize_cpu_has_avx2(void) {
+    unsigned a, b, c, d;
+    if (!os_saves_ymm()) return 0;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return 0;
+    return (b & (1u << 5)) != 0;                           /* AVX2 */
+}
+
+#else
+
+int sanitize_cpu_has_sse2(void) { return 0; }
+int sanitize_cpu_has_avx2(void) { return 0; }
+
+#endif
+
+/* ============================================================
+ * SSE2 - 16 Bytes
+ * ============================================================ */
+
+#ifdef SCAN_HAVE_X86
+
+/* x <= limit, unsigned, per byte */
+#define SSE2_LE(x, limit) _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(limit)), x)
+
+__attribute__((target("sse2")))
+static __m128i hex_sse2(__m128i v) {
+    __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    return _mm_or_si128(SSE2_LE(digit, 9), SSE2_LE(alpha, 5));
+}
+
+__attribute__((target("sse2")))
+size_t sanitize_skip_sse2(const char *s, size_t from, size_t len) {
+    size_t i = from;
+
+    if (from == 0) return 0;        /* Each vector reads the byte before it */
+    for (; i + 17 <= len; i += 16) {
+        __m128i cur = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i prev = _mm_loadu_si128((const __m128i *)(s + i - 1));
+        __m128i next = _mm_loadu_si128((const __m128i *)(s + i + 1));
+
+        __m128i sep = _mm_or_si128(_mm_cmpeq_epi8(cur, _mm_set1_epi8('.')),
+                                   _mm_cmpeq_epi8(cur, _mm_set1_epi8(':')));
+        __m128i near_hex = _mm_or_si128(hex_sse2(prev), hex_sse2(next));
+        __m128i home = _mm_or_si128(_mm_cmpeq_epi8(next, _mm_set1_epi8('h')),
+                                    _mm_or_si128(_mm_cmpeq_epi8(next, _mm_set1_epi8('U')),
+                                                 _mm_cmpeq_epi8(next, _mm_set1_epi8('r'))));
+        __m128i slash = _mm_and_si128(_mm_cmpeq_epi8(cur, _mm_set1_epi8('/')), home);
+        __m128i hit = _mm_or_si128(_mm_and_si128(sep, near_hex), slash);
+
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) return i + __builtin_ctz((unsigned)mask);
+    }
+    return i;
+}
+
+#else
+
+size_t sanitize_skip_sse2(const char *s, size_t from, size_t len) {
+    (void)s;
+    (void)len;
+    return from;
+}
+
+#endif
+
+/* ============================================================
+ * AVX2 - 32 Bytes
+ * ============================================================ */
+
+#ifdef SCAN_HAVE_X86
+
+#define AVX2_LE(x, limit) _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(limit)), x)
+
+__attribute__((target("avx2")))
+static __m256i hex_avx2(__m256i v) {
+    __m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)),
+                                    _mm256_set1_epi8('a'));
+    return _mm256_or_si256(AVX2_LE(digit, 9), AVX2_LE(alpha, 5));
+}
+
+__attribute__((target("avx2")))
+size_t sanitize_skip_avx2(const char *s, size_t from, size_t len) {
+    size_t i = from;
+
+    if (from == 0) return 0;
+    for (; i + 33 <= len; i += 32) {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i prev = _mm256_loadu_si256((const __m256i *)(s + i - 1));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(s + i + 1));
+
+        __m256i sep = _mm256_or_si256(_mm256_cmpeq_epi8(cur, _mm256_set1_epi8('.')),
+                                      _mm256_cmpeq_epi8(cur, _mm256_set1_epi8(':')));
+        __m256i near_hex = _mm256_or_si256(hex_avx2(prev), hex_avx2(next));
+        __m256i home = _mm256_or_si256(_mm256_cmpeq_epi8(next, _mm256_set1_epi8('h')),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(next, _mm256_set1_epi8('U')),
+                                                       _mm256_cmpeq_epi8(next, _mm256_set1_epi8('r'))));
+        __m256i slash = _mm256_and_si256(_mm256_cmpeq_epi8(cur, _mm256_set1_epi8('/')), home);
+        __m256i hit = _mm256_or_si256(_mm256_and_si256(sep, near_hex), slash);
+
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i;
+}
+
+#else
+
+size_t sanitize_skip_avx2(const char *s, size_t from, size_t len) {
+    (void)s;
+    (void)len;
+    return from;
+}
+
+#endif
+
+/* ============================================================
+ * POWER8 VSX - 16 Bytes
+ * ============================================================ */
+
+#ifdef SCAN_HAVE_VSX
+
+int sanitize_vsx_built(void) { return 1; }
+
+typedef __vector unsigned char v16u8_t;
+typedef __vector __bool char v16b8_t;
+
+static inline v16b8_t hex_vsx(v16u8_t v) {
+    v16u8_t digit = vec_sub(v, vec_splats((unsigned char)'0'));
+    v16u8_t alpha = vec_sub(vec_or(v, vec_splats((unsigned char)0x20)),
+                            vec_splats((unsigned char)'a'));
+    return vec_or(vec_cmplt(digit, vec_splats((unsigned char)10)),
+                  vec_cmplt(alpha, vec_splats((unsigned char)6)));
+}
+
+/* No cheap movemask here: stop at the vector, the scalar check finds the byte */
+size_t sanitize_skip_vsx(const char *s, size_t from, size_t len) {
+    const unsigned char *u = (const unsigned char *)s;
+    size_t i = from;
+
+    if (from == 0) return 0;
+    for (; i + 17 <= len; i += 16) {
+        v16u8_t cur = vec_vsx_ld(0, u + i);
+        v16u8_t prev = vec_vsx_ld(0, u + i - 1);
+        v16u8_t next = vec_vsx_ld(0, u + i + 1);
+
+        v16b8_t sep = vec_or(vec_cmpeq(cur, vec_splats((unsigned char)'.')),
+                             vec_cmpeq(cur, vec_splats((unsigned char)':')));
+        v16b8_t near_hex = vec_or(hex_vsx(prev), hex_vsx(next));
+        v16b8_t home = vec_or(vec_cmpeq(next, vec_splats((unsigned char)'h')),
+                              vec_or(vec_cmpeq(next, vec_splats((unsigned char)'U')),
+                                     vec_cmpeq(next, vec_splats((unsigned char)'r'))));
+        v16b8_t slash = vec_and(vec_cmpeq(cur, vec_splats((unsigned char)'/')), home);
+        v16b8_t hit = vec_or(vec_and(sep, near_hex), slash);
+
+        if (vec_any_ne((v16u8_t)hit, vec_splats((unsigned char)0))) return i;
+    }
+    return i;
+}
+
+#else
+
+int sanitize_vsx_built(void) { return 0; }
+
+size_t sanitize_skip_vsx(const char *s, size_t from, size_t len) {
+    (void)s;
+    (void)len;
+    return from;
+}
+
+#endif
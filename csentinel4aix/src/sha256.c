@@ -10,12 +10,32 @@
  * sha256.c - SHA256 implementation (no external dependencies)
  *
  * Based on RFC 6234 / FIPS 180-4
+ *
+ * The portable round function here is the reference backend. At first
+ * use the fastest kernel for this CPU is selected (see sha256_simd.c):
+ * SHA-NI hashes one stream quickly, AVX2 and POWER8 hash 8 or 4 files
+ * side by side through sha256_file_batch().
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#if defined(_AIX)
+#include <sys/systemcfg.h>
+#elif defined(__linux__) && defined(__powerpc64__)
+#include <sys/auxv.h>
+#endif
+
+#include "sha256.h"
+
+#define SHA256_READ_SIZE   (128 * 1024)   /* Single-stream read buffer */
+#define SHA256_LANE_READ   (64 * 1024)    /* Per-lane read buffer */
 
 /* SHA256 context structure */
 typedef struct {
@@ -25,7 +45,7 @@ typedef struct {
 } sha256_ctx_t;
 
 /* SHA256 constants (first 32 bits of the fractional parts of the cube roots of the first 64 primes) */
-static const uint32_t K[64] = {
+const uint32_t sha256_K[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
     0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -44,6 +64,11 @@ static const uint32_t K[64] = {
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+static const uint32_t sha256_H0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
 /* Rotate right */
 #define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
 
@@ -55,69 +80,172 @@ static const uint32_t K[64] = {
 #define SIG0(x)      (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
 #define SIG1(x)      (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
 
-/* Process a 64-byte block */
-static void sha256_transform(sha256_ctx_t *ctx, const uint8_t *data) {
+/* Process 64-byte blocks - the reference backend */
+void sha256_blocks_generic(uint32_t state[8], const uint8_t *data, size_t blocks) {
     uint32_t a, b, c, d, e, f, g, h;
     uint32_t t1, t2;
     uint32_t W[64];
     int i;
     
-    /* Prepare message schedule */
-    for (i = 0; i < 16; i++) {
-        W[i] = ((uint32_t)data[i * 4] << 24) |
-               ((uint32_t)data[i * 4 + 1] << 16) |
-               ((uint32_t)data[i * 4 + 2] << 8) |
-               ((uint32_t)data[i * 4 + 3]);
-    }
-    for (i = 16; i < 64; i++) {
-        W[i] = SIG1(W[i - 2]) + W[i - 7] + SIG0(W[i - 15]) + W[i - 16];
-    }
-    
-    /* Initialize working variables */
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
-    
-    /* Main loop */
-    for (i = 0; i < 64; i++) {
-        t1 = h + EP1(e) + CH(e, f, g) + K[i] + W[i];
-        t2 = EP0(a) + MAJ(a, b, c);
-        h = g;
-        g = f;
-        f = e;
-        e = d + t1;
-        d = c;
-        c = b;
-        b = a;
-        a = t1 + t2;
-    }
-    
-    /* Add to state */
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
+    for (; blocks > 0; blocks--, data += 64) {
+        /* Prepare message schedule */
+        for (i = 0; i < 16; i++) {
+            W[i] = ((uint32_t)data[i * 4] << 24) |
+                   ((uint32_t)data[i * 4 + 1] << 16) |
+                   ((uint32_t)data[i * 4 + 2] << 8) |
+                   ((uint32_t)data[i * 4 + 3]);
+        }
+        for (i = 16; i < 64; i++) {
+            W[i] = SIG1(W[i - 2]) + W[i - 7] + SIG0(W[i - 15]) + W[i - 16];
+        }
+        
+        /* Initialize working variables */
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+        
+        /* Main loop */
+        for (i = 0; i < 64; i++) {
+            t1 = h + EP1(e) + CH(e, f, g) + sha256_K[i] + W[i];
+            t2 = EP0(a) + MAJ(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        
+        /* Add to state */
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+/* ============================================================
+ * Backend Selection
+ * ============================================================ */
+
+typedef void (*sha256_blocks_fn)(uint32_t state[8], const uint8_t *data, size_t blocks);
+typedef void (*sha256_lanes_fn)(uint32_t *state, const uint8_t *const *blocks);
+
+static sha256_backend_t g_backend = SHA256_BACKEND_GENERIC;
+static sha256_blocks_fn g_blocks = sha256_blocks_generic;
+static sha256_lanes_fn g_lanes = NULL;     /* NULL for single-stream backends */
+static int g_lane_count = 1;
+static pthread_once_t g_backend_once = PTHREAD_ONCE_INIT;
+
+static const char *backend_names[SHA256_BACKEND_COUNT] = {
+    "auto", "generic", "sha-ni", "avx2", "power8"
+};
+
+/* Checked here rather than in sha256_simd.c, which may be built for POWER8 */
+static int cpu_has_power8_crypto(void) {
+    if (!sha256_power8_built()) return 0;
+#if defined(_AIX) && defined(__power_8_andup)
+    return __power_8_andup() ? 1 : 0;
+#elif defined(__linux__) && defined(__powerpc64__) && defined(PPC_FEATURE2_VEC_CRYPTO)
+    return (getauxval(AT_HWCAP2) & PPC_FEATURE2_VEC_CRYPTO) != 0;
+#else
+    return 0;
+#endif
+}
+
+int sha256_backend_available(sha256_backend_t backend) {
+    switch (backend) {
+        case SHA256_BACKEND_AUTO:
+        case SHA256_BACKEND_GENERIC:
+            return 1;
+        case SHA256_BACKEND_SHANI:
+            return sha256_cpu_has_shani();
+        case SHA256_BACKEND_AVX2:
+            return sha256_cpu_has_avx2();
+        case SHA256_BACKEND_POWER8:
+            return cpu_has_power8_crypto();
+        default:
+            return 0;
+    }
+}
+
+static void apply_backend(sha256_backend_t backend) {
+    if (backend == SHA256_BACKEND_AUTO) {
+        /* SHA-NI beats 8-lane AVX2 without the lane-balancing overhead */
+        if (sha256_cpu_has_shani()) backend = SHA256_BACKEND_SHANI;
+        else if (sha256_cpu_has_avx2()) backend = SHA256_BACKEND_AVX2;
+        else if (cpu_has_power8_crypto()) backend = SHA256_BACKEND_POWER8;
+        else backend = SHA256_BACKEND_GENERIC;
+    }
+    
+    g_backend = backend;
+    g_blocks = sha256_blocks_generic;
+    g_lanes = NULL;
+    g_lane_count = 1;
+    
+    switch (backend) {
+        case SHA256_BACKEND_SHANI:
+            g_blocks = sha256_blocks_shani;
+            break;
+        case SHA256_BACKEND_AVX2:
+            g_lanes = sha256_lanes_avx2;
+            g_lane_count = 8;
+            break;
+        case SHA256_BACKEND_POWER8:
+            g_lanes = sha256_lanes_power8;
+            g_lane_count = 4;
+            break;
+        default:
+            break;
+    }
+}
+
+static void select_auto_backend(void) {
+    apply_backend(SHA256_BACKEND_AUTO);
+}
+
+static void ensure_backend(void) {
+    pthread_once(&g_backend_once, select_auto_backend);
+}
+
+/* Force a backend; call before hashing starts on worker threads */
+int sha256_set_backend(sha256_backend_t backend) {
+    if (!sha256_backend_available(backend)) return -1;
+    ensure_backend();
+    apply_backend(backend);
+    return 0;
+}
+
+sha256_backend_t sha256_get_backend(void) {
+    ensure_backend();
+    return g_backend;
+}
+
+const char* sha256_backend_name(sha256_backend_t backend) {
+    if ((int)backend < 0 || backend >= SHA256_BACKEND_COUNT) return "unknown";
+    return backend_names[backend];
+}
+
+int sha256_batch_size(void) {
+    ensure_backend();
+    return g_lane_count;
 }
 
 /* Initialize SHA256 context */
 void sha256_init(sha256_ctx_t *ctx) {
-    ctx->state[0] = 0x6a09e667;
-    ctx->state[1] = 0xbb67ae85;
-    ctx->state[2] = 0x3c6ef372;
-    ctx->state[3] = 0xa54ff53a;
-    ctx->state[4] = 0x510e527f;
-    ctx->state[5] = 0x9b05688c;
-    ctx->state[6] = 0x1f83d9ab;
-    ctx->state[7] = 0x5be0cd19;
+    ensure_backend();
+    memcpy(ctx->state, sha256_H0, sizeof(ctx->state));
     ctx->count = 0;
 }
 
@@ -135,16 +263,16 @@ void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t len) {
             return;
         }
         memcpy(ctx->buffer + index, data, left);
-        sha256_transform(ctx, ctx->buffer);
+        g_blocks(ctx->state, ctx->buffer, 1);
         data += left;
         len -= left;
     }
     
-    /* Transform full blocks */
-    while (len >= 64) {
-        sha256_transform(ctx, data);
-        data += 64;
-        len -= 64;
+    /* Transform full blocks in one call */
+    if (len >= 64) {
+        g_blocks(ctx->state, data, len / 64);
+        data += len & ~(size_t)63;
+        len &= 63;
     }
     
     /* Buffer remaining */
@@ -153,6 +281,18 @@ void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t len) {
     }
 }
 
+static void state_to_digest(const uint32_t state[8], uint8_t *hash) {
+    int i;
+    
+    /* Output hash (big-endian) */
+    for (i = 0; i < 8; i++) {
+        hash[i * 4]     = (state[i] >> 24) & 0xff;
+        hash[i * 4 + 1] = (state[i] >> 16) & 0xff;
+        hash[i * 4 + 2] = (state[i] >> 8) & 0xff;
+        hash[i * 4 + 3] = state[i] & 0xff;
+    }
+}
+
 /* Finalize SHA256 and output hash */
 void sha256_final(sha256_ctx_t *ctx, uint8_t *hash) {
     uint8_t pad[64];
@@ -172,58 +312,365 @@ void sha256_final(sha256_ctx_t *ctx, uint8_t *hash) {
     }
     sha256_update(ctx, pad, 8);
     
-    /* Output hash (big-endian) */
+    state_to_digest(ctx->state, hash);
+}
+
+static void digest_to_hex(const uint8_t hash[32], char *out) {
+    static const char hex[] = "0123456789abcdef";
+    int i;
+    
+    for (i = 0; i < 32; i++) {
+        out[i * 2] = hex[hash[i] >> 4];
+        out[i * 2 + 1] = hex[hash[i] & 0x0f];
+    }
+    out[64] = '\0';
+}
+
+/* ============================================================
+ * Block Streams
+ * ============================================================
+ * A stream hands out whole 64-byte blocks from a file or a memory
+ * buffer, then one or two padded final blocks. Files are read with
+ * large read() calls rather than mmap: a config file truncated while
+ * being hashed must not SIGBUS a long-running monitor.
+ */
+
+typedef struct {
+    int fd;                     /* -1 for in-memory input */
+    uint8_t *storage;           /* Read buffer (file input) */
+    size_t cap;
+    const uint8_t *buf;         /* storage, or the caller's data */
+    size_t len;                 /* Valid bytes in buf */
+    size_t pos;                 /* Next unconsumed byte */
+    uint64_t total;             /* Bytes consumed so far */
+    int eof;
+    int error;
+    uint8_t tail[128];          /* Final padded block(s) */
+    int tail_blocks;            /* -1 until the tail is built */
+    int tail_pos;
+} sha256_stream_t;
+
+static void stream_init_memory(sha256_stream_t *s, const uint8_t *data, size_t len) {
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+    s->buf = data;
+    s->len = len;
+    s->eof = 1;
+    s->tail_blocks = -1;
+}
+
+static int stream_open_file(sha256_stream_t *s, const char *path,
+                            uint8_t *storage, size_t cap) {
+    memset(s, 0, sizeof(*s));
+    s->fd = open(path, O_RDONLY);
+    if (s->fd < 0) return -1;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(s->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    s->storage = storage;
+    s->cap = cap;
+    s->buf = storage;
+    s->tail_blocks = -1;
+    return 0;
+}
+
+static void stream_close(sha256_stream_t *s) {
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
+}
+
+/* Keep the unconsumed remainder and read until the buffer is full */
+static void stream_fill(sha256_stream_t *s) {
+    size_t rem = s->len - s->pos;
+    memmove(s->storage, s->buf + s->pos, rem);
+    s->buf = s->storage;
+    s->pos = 0;
+    s->len = rem;
+    
+    while (s->len < s->cap) {
+        ssize_t n = read(s->fd, s->storage + s->len, s->cap - s->len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            s->error = 1;
+            s->eof = 1;
+            return;
+        }
+        if (n == 0) {
+            s->eof = 1;
+            return;
+        }
+        s->len += (size_t)n;
+    }
+}
+
+static void stream_build_tail(sha256_stream_t *s) {
+    size_t rem = s->len - s->pos;
+    uint64_t bits;
+    int i;
+    
+    memset(s->tail, 0, sizeof(s->tail));
+    memcpy(s->tail, s->buf + s->pos, rem);
+    s->tail[rem] = 0x80;
+    s->tail_blocks = rem < 56 ? 1 : 2;
+    s->total += rem;
+    s->pos = s->len;
+    
+    /* Append length (big-endian) */
+    bits = s->total * 8;
     for (i = 0; i < 8; i++) {
-        hash[i * 4]     = (ctx->state[i] >> 24) & 0xff;
-        hash[i * 4 + 1] = (ctx->state[i] >> 16) & 0xff;
-        hash[i * 4 + 2] = (ctx->state[i] >> 8) & 0xff;
-        hash[i * 4 + 3] = ctx->state[i] & 0xff;
+        s->tail[s->tail_blocks * 64 - 8 + i] = (bits >> (56 - i * 8)) & 0xff;
+    }
+}
+
+/* Point *p at up to max_blocks contiguous blocks; 0 once the message is done */
+static size_t stream_next(sha256_stream_t *s, const uint8_t **p, size_t max_blocks) {
+    for (;;) {
+        if (s->tail_blocks >= 0) {
+            if (s->tail_pos >= s->tail_blocks) return 0;
+            *p = s->tail + 64 * s->tail_pos++;
+            return 1;
+        }
+        
+        size_t avail = (s->len - s->pos) / 64;
+        if (avail > 0) {
+            if (avail > max_blocks) avail = max_blocks;
+            *p = s->buf + s->pos;
+            s->pos += avail * 64;
+            s->total += avail * 64;
+            return avail;
+        }
+        
+        if (!s->eof) {
+            stream_fill(s);
+        } else {
+            stream_build_tail(s);
+        }
     }
 }
 
+static int hash_stream(sha256_stream_t *s, uint8_t digest[32]) {
+    uint32_t state[8];
+    const uint8_t *p;
+    size_t n;
+    
+    memcpy(state, sha256_H0, sizeof(state));
+    while ((n = stream_next(s, &p, (size_t)-1 / 64)) > 0) {
+        g_blocks(state, p, n);
+    }
+    state_to_digest(state, digest);
+    return s->error ? -1 : 0;
+}
+
+/* ============================================================
+ * Multi-buffer Scheduling
+ * ============================================================
+ * Each lane hashes one message; when it finishes, the next message
+ * takes its place, so lanes stay busy across files of mixed sizes.
+ * The last message left running finishes on the single-stream kernel.
+ */
+
+typedef struct {
+    /* Open message job into s; non-zero if it cannot be read */
+    int (*open)(void *ctx, int job, sha256_stream_t *s, uint8_t *storage, size_t cap);
+    /* Receive the digest (NULL on error) */
+    void (*done)(void *ctx, int job, const uint8_t *digest);
+    void *ctx;
+} sha256_jobs_t;
+
+static int lane_assign(const sha256_jobs_t *jobs, int n, int *next_job,
+                       sha256_stream_t *s, uint8_t *storage, size_t cap) {
+    while (*next_job < n) {
+        int job = (*next_job)++;
+        if (jobs->open(jobs->ctx, job, s, storage, cap) == 0) return job;
+        jobs->done(jobs->ctx, job, NULL);
+    }
+    return -1;
+}
+
+static void lane_finish(const sha256_jobs_t *jobs, int job, sha256_stream_t *s,
+                        const uint32_t state[8]) {
+    uint8_t digest[32];
+    state_to_digest(state, digest);
+    stream_close(s);
+    jobs->done(jobs->ctx, job, s->error ? NULL : digest);
+}
+
+static void hash_jobs(const sha256_jobs_t *jobs, int n) {
+    int lanes = g_lane_count;
+    sha256_stream_t streams[SHA256_MAX_LANES];
+    int lane_job[SHA256_MAX_LANES];
+    uint32_t state[8 * SHA256_MAX_LANES];
+    const uint8_t *blocks[SHA256_MAX_LANES];
+    static const uint8_t idle_block[64];
+    int next_job = 0, active = 0;
+    
+    uint8_t *storage = malloc((size_t)lanes * SHA256_LANE_READ);
+    if (!storage) {
+        lanes = 0;  /* Still report every job as failed below */
+    }
+    
+    for (int l = 0; l < lanes; l++) {
+        lane_job[l] = lane_assign(jobs, n, &next_job, &streams[l],
+                                  storage + (size_t)l * SHA256_LANE_READ, SHA256_LANE_READ);
+        if (lane_job[l] >= 0) active++;
+        for (int w = 0; w < 8; w++) state[w * lanes + l] = sha256_H0[w];
+    }
+    
+    while (active > 1 || (active == 1 && next_job < n)) {
+        for (int l = 0; l < lanes; l++) {
+            blocks[l] = idle_block;
+            while (lane_job[l] >= 0 && stream_next(&streams[l], &blocks[l], 1) == 0) {
+                uint32_t lane_state[8];
+                for (int w = 0; w < 8; w++) lane_state[w] = state[w * lanes + l];
+                lane_finish(jobs, lane_job[l], &streams[l], lane_state);
+                
+                lane_job[l] = lane_assign(jobs, n, &next_job, &streams[l],
+                                          storage + (size_t)l * SHA256_LANE_READ,
+                                          SHA256_LANE_READ);
+                for (int w = 0; w < 8; w++) state[w * lanes + l] = sha256_H0[w];
+                if (lane_job[l] < 0) {
+                    active--;
+                    blocks[l] = idle_block;
+                }
+            }
+        }
+        if (active == 0) break;
+        g_lanes(state, blocks);
+    }
+    
+    /* A single straggler is faster on the scalar kernel */
+    for (int l = 0; l < lanes; l++) {
+        if (lane_job[l] < 0) continue;
+        uint32_t lane_state[8];
+        const uint8_t *p;
+        size_t nb;
+        for (int w = 0; w < 8; w++) lane_state[w] = state[w * lanes + l];
+        while ((nb = stream_next(&streams[l], &p, (size_t)-1 / 64)) > 0) {
+            g_blocks(lane_state, p, nb);
+        }
+        lane_finish(jobs, lane_job[l], &streams[l], lane_state);
+    }
+    
+    /* Allocation failure: nothing was hashed */
+    while (next_job < n) jobs->done(jobs->ctx, next_job++, NULL);
+    free(storage);
+}
+
+/* ============================================================
+ * Public Hashing API
+ * ============================================================ */
+
 /* Compute SHA256 of a file, output as hex string */
 int sha256_file(const char *path, char *out, size_t out_size) {
-    FILE *f;
-    sha256_ctx_t ctx;
-    uint8_t buffer[4096];
+    sha256_stream_t s;
     uint8_t hash[32];
-    size_t bytes;
-    int i;
+    uint8_t *buffer;
+    int result;
     
     if (out_size < 65) {
         return -1;  /* Need 64 chars + null */
     }
     
-    f = fopen(path, "rb");
-    if (!f) {
-        strncpy(out, "error", out_size - 1);
-        out[out_size - 1] = '\0';
+    ensure_backend();
+    buffer = malloc(SHA256_READ_SIZE);
+    if (!buffer || stream_open_file(&s, path, buffer, SHA256_READ_SIZE) != 0) {
+        free(buffer);
+        snprintf(out, out_size, "error");
         return -1;
     }
     
-    sha256_init(&ctx);
+    result = hash_stream(&s, hash);
+    stream_close(&s);
+    free(buffer);
     
-    while ((bytes = fread(buffer, 1, sizeof(buffer), f)) > 0) {
-        sha256_update(&ctx, buffer, bytes);
+    if (result != 0) {
+        snprintf(out, out_size, "error");
+        return -1;
     }
     
-    fclose(f);
-    sha256_final(&ctx, hash);
-    
     /* Convert to hex string */
-    for (i = 0; i < 32; i++) {
-        sprintf(out + i * 2, "%02x", hash[i]);
+    digest_to_hex(hash, out);
+    
+    return 0;
+}
+
+typedef struct {
+    const char **paths;
+    char **out;
+    int errors;
+} file_batch_t;
+
+static int file_batch_open(void *ctx, int job, sha256_stream_t *s, uint8_t *storage, size_t cap) {
+    file_batch_t *fb = ctx;
+    return stream_open_file(s, fb->paths[job], storage, cap);
+}
+
+static void file_batch_done(void *ctx, int job, const uint8_t *digest) {
+    file_batch_t *fb = ctx;
+    if (digest) {
+        digest_to_hex(digest, fb->out[job]);
+    } else {
+        snprintf(fb->out[job], 65, "error");
+        fb->errors++;
     }
-    out[64] = '\0';
+}
+
+int sha256_file_batch(const char **paths, int n, char **out) {
+    int errors = 0;
     
+    ensure_backend();
+    if (!g_lanes || n < 2) {
+        for (int i = 0; i < n; i++) {
+            if (sha256_file(paths[i], out[i], 65) != 0) errors++;
+        }
+        return errors;
+    }
+    
+    file_batch_t fb = { paths, out, 0 };
+    sha256_jobs_t jobs = { file_batch_open, file_batch_done, &fb };
+    hash_jobs(&jobs, n);
+    return fb.errors;
+}
+
+typedef struct {
+    const uint8_t **data;
+    const size_t *len;
+    uint8_t (*digest)[32];
+} buffer_batch_t;
+
+static int buffer_batch_open(void *ctx, int job, sha256_stream_t *s, uint8_t *storage, size_t cap) {
+    buffer_batch_t *bb = ctx;
+    (void)storage;
+    (void)cap;
+    stream_init_memory(s, bb->data[job], bb->len[job]);
     return 0;
 }
 
+static void buffer_batch_done(void *ctx, int job, const uint8_t *digest) {
+    buffer_batch_t *bb = ctx;
+    if (digest) memcpy(bb->digest[job], digest, 32);
+}
+
+void sha256_buffers(const uint8_t **data, const size_t *len, int n, uint8_t (*digest)[32]) {
+    ensure_backend();
+    if (!g_lanes || n < 2) {
+        for (int i = 0; i < n; i++) {
+            sha256_stream_t s;
+            stream_init_memory(&s, data[i], len[i]);
+            hash_stream(&s, digest[i]);
+        }
+        return;
+    }
+    
+    buffer_batch_t bb = { data, len, digest };
+    sha256_jobs_t jobs = { buffer_batch_open, buffer_batch_done, &bb };
+    hash_jobs(&jobs, n);
+}
+
 /* Compute SHA256 of a string, output as hex string */
 int sha256_string(const char *str, char *out, size_t out_size) {
     sha256_ctx_t ctx;
     uint8_t hash[32];
-    int i;
     
     if (out_size < 65) {
         return -1;
@@ -233,10 +680,7 @@ int sha256_string(const char *str, char *out, size_t out_size) {
     sha256_update(&ctx, (const uint8_t *)str, strlen(str));
     sha256_final(&ctx, hash);
     
-    for (i = 0; i < 32; i++) {
-        sprintf(out + i * 2, "%02x", hash[i]);
-    }
-    out[64] = '\0';
+    digest_to_hex(hash, out);
     
     return 0;
 }
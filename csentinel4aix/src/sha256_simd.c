@@ -0,0 +1,343 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * sha256_simd.c - Hardware SHA256 kernels
+ *
+ * x86:    SHA-NI (one stream) and AVX2 (eight streams). Built with
+ *         per-function target attributes, so the rest of the binary
+ *         keeps the baseline ISA; sha256.c only calls them after the
+ *         CPUID checks below pass.
+ * POWER8: vshasigmaw over four streams. This file is compiled with
+ *         -mcpu=power8 on POWER, so the hardware check lives in sha256.c.
+ *
+ * Kernels for other architectures are stubs that are never selected.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "sha256.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_HAVE_X86 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__powerpc64__) || defined(_ARCH_PPC64)) && defined(__POWER8_VECTOR__)
+#define SHA256_HAVE_POWER8 1
+#include <altivec.h>
+#endif
+
+/* ============================================================
+ * x86 CPU Detection
+ * ============================================================ */
+
+#ifdef SHA256_HAVE_X86
+
+/* AVX state must be enabled by the OS, not just present in the CPU */
+static int os_saves_ymm(void) {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+    if (!(c & (1u << 27))) return 0;            /* OSXSAVE */
+    unsigned lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    (void)hi;
+    return (lo & 0x6) == 0x6;                   /* XMM and YMM state */
+}
+
+int sha256_cpu_has_shani(void) {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+    if (!(c & (1u << 19)) || !(c & (1u << 9))) return 0;   /* SSE4.1, SSSE3 */
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return 0;
+    return (b & (1u << 29)) != 0;                          /* SHA */
+}
+
+int sha256_cpu_has_avx2(void) {
+    unsigned a, b, c, d;
+    if (!os_saves_ymm()) return 0;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return 0;
+    return (b & (1u << 5)) != 0;                           /* AVX2 */
+}
+
+#else
+
+int sha256_cpu_has_shani(void) { return 0; }
+int sha256_cpu_has_avx2(void) { return 0; }
+
+#endif
+
+/* ============================================================
+ * SHA-NI - One Stream
+ * ============================================================ */
+
+#ifdef SHA256_HAVE_X86
+
+/* Four rounds: message words m plus K[i..i+3] */
+#define SHANI_RNDS(m, i) do { \
+    MSG = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *)&sha256_K[i])); \
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG); \
+    MSG = _mm_shuffle_epi32(MSG, 0x0E); \
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG); \
+} while (0)
+
+/* Finish the schedule for the group after cur */
+#define SHANI_SCHED2(next, cur, prev) do { \
+    TMP = _mm_alignr_epi8(cur, prev, 4); \
+    next = _mm_add_epi32(next, TMP); \
+    next = _mm_sha256msg2_epu32(next, cur); \
+} while (0)
+
+#define SHANI_SCHED1(prev, cur) prev = _mm_sha256msg1_epu32(prev, cur)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i STATE0, STATE1, MSG, TMP, M0, M1, M2, M3, ABEF_SAVE, CDGH_SAVE;
+
+    /* state[] is ABCDEFGH; the instructions want ABEF / CDGH */
+    TMP = _mm_loadu_si128((const __m128i *)&state[0]);
+    STATE1 = _mm_loadu_si128((const __m128i *)&state[4]);
+    TMP = _mm_shuffle_epi32(TMP, 0xB1);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0x1B);
+    STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        ABEF_SAVE = STATE0;
+        CDGH_SAVE = STATE1;
+
+        M0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 0)), MASK);
+        SHANI_RNDS(M0, 0);
+        M1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), MASK);
+        SHANI_RNDS(M1, 4);
+        SHANI_SCHED1(M0, M1);
+        M2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), MASK);
+        SHANI_RNDS(M2, 8);
+        SHANI_SCHED1(M1, M2);
+        M3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), MASK);
+        SHANI_RNDS(M3, 12);
+        SHANI_SCHED2(M0, M3, M2);
+        SHANI_SCHED1(M2, M3);
+
+        SHANI_RNDS(M0, 16); SHANI_SCHED2(M1, M0, M3); SHANI_SCHED1(M3, M0);
+        SHANI_RNDS(M1, 20); SHANI_SCHED2(M2, M1, M0); SHANI_SCHED1(M0, M1);
+        SHANI_RNDS(M2, 24); SHANI_SCHED2(M3, M2, M1); SHANI_SCHED1(M1, M2);
+        SHANI_RNDS(M3, 28); SHANI_SCHED2(M0, M3, M2); SHANI_SCHED1(M2, M3);
+        SHANI_RNDS(M0, 32); SHANI_SCHED2(M1, M0, M3); SHANI_SCHED1(M3, M0);
+        SHANI_RNDS(M1, 36); SHANI_SCHED2(M2, M1, M0); SHANI_SCHED1(M0, M1);
+        SHANI_RNDS(M2, 40); SHANI_SCHED2(M3, M2, M1); SHANI_SCHED1(M1, M2);
+        SHANI_RNDS(M3, 44); SHANI_SCHED2(M0, M3, M2); SHANI_SCHED1(M2, M3);
+        SHANI_RNDS(M0, 48); SHANI_SCHED2(M1, M0, M3); SHANI_SCHED1(M3, M0);
+        SHANI_RNDS(M1, 52); SHANI_SCHED2(M2, M1, M0);
+        SHANI_RNDS(M2, 56); SHANI_SCHED2(M3, M2, M1);
+        SHANI_RNDS(M3, 60);
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    }
+
+    /* Back to ABCDEFGH */
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);
+    STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0);
+    STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);
+    _mm_storeu_si128((__m128i *)&state[0], STATE0);
+    _mm_storeu_si128((__m128i *)&state[4], STATE1);
+}
+
+#else
+
+void sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    sha256_blocks_generic(state, data, blocks);
+}
+
+#endif
+
+/* ============================================================
+ * AVX2 - Eight Streams
+ * ============================================================ */
+
+#ifdef SHA256_HAVE_X86
+
+#define V8_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define V8_EP0(x)  _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(x, 2), V8_ROTR(x, 13)), V8_ROTR(x, 22))
+#define V8_EP1(x)  _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(x, 6), V8_ROTR(x, 11)), V8_ROTR(x, 25))
+#define V8_SIG0(x) _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(x, 7), V8_ROTR(x, 18)), _mm256_srli_epi32(x, 3))
+#define V8_SIG1(x) _mm256_xor_si256(_mm256_xor_si256(V8_ROTR(x, 17), V8_ROTR(x, 19)), _mm256_srli_epi32(x, 10))
+
+/* Load 8 words from each lane's block and transpose to word-major */
+__attribute__((target("avx2")))
+static void avx2_load_words(__m256i out[8], const uint8_t *const *blocks, int offset) {
+    const __m256i bswap = _mm256_set_epi8(
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i r[8], t[8], u[8];
+
+    for (int l = 0; l < 8; l++) {
+        r[l] = _mm256_loadu_si256((const __m256i *)(blocks[l] + offset));
+    }
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int w = 0; w < 4; w++) {
+        out[w] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[w], u[w + 4], 0x20), bswap);
+        out[w + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[w], u[w + 4], 0x31), bswap);
+    }
+}
+
+__attribute__((target("avx2")))
+void sha256_lanes_avx2(uint32_t *state, const uint8_t *const *blocks) {
+    __m256i W[16], s[8];
+    __m256i a, b, c, d, e, f, g, h, t1, t2;
+
+    avx2_load_words(&W[0], blocks, 0);
+    avx2_load_words(&W[8], blocks, 32);
+
+    for (int w = 0; w < 8; w++) {
+        s[w] = _mm256_loadu_si256((const __m256i *)&state[w * 8]);
+    }
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    for (int i = 0; i < 64; i++) {
+        __m256i wi;
+        if (i < 16) {
+            wi = W[i];
+        } else {
+            wi = _mm256_add_epi32(
+                _mm256_add_epi32(V8_SIG1(W[(i - 2) & 15]), W[(i - 7) & 15]),
+                _mm256_add_epi32(V8_SIG0(W[(i - 15) & 15]), W[i & 15]));
+            W[i & 15] = wi;
+        }
+
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b),
+                                      _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        t1 = _mm256_add_epi32(_mm256_add_epi32(h, V8_EP1(e)),
+                              _mm256_add_epi32(ch, _mm256_add_epi32(
+                                  _mm256_set1_epi32((int)sha256_K[i]), wi)));
+        t2 = _mm256_add_epi32(V8_EP0(a), maj);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    for (int w = 0; w < 8; w++) {
+        _mm256_storeu_si256((__m256i *)&state[w * 8], s[w]);
+    }
+}
+
+#else
+
+void sha256_lanes_avx2(uint32_t *state, const uint8_t *const *blocks) {
+    (void)state;
+    (void)blocks;
+}
+
+#endif
+
+/* ============================================================
+ * POWER8 - Four Streams
+ * ============================================================ */
+
+#ifdef SHA256_HAVE_POWER8
+
+int sha256_power8_built(void) { return 1; }
+
+typedef __vector unsigned int v4u32_t;
+
+/* vshasigmaw: (x, 0, 0) = sigma0, (x, 0, 0xf) = sigma1, (x, 1, *) = Sigma */
+#define V4_EP0(x)  __builtin_crypto_vshasigmaw(x, 1, 0)
+#define V4_EP1(x)  __builtin_crypto_vshasigmaw(x, 1, 0xf)
+#define V4_SIG0(x) __builtin_crypto_vshasigmaw(x, 0, 0)
+#define V4_SIG1(x) __builtin_crypto_vshasigmaw(x, 0, 0xf)
+
+static uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void sha256_lanes_power8(uint32_t *state, const uint8_t *const *blocks) {
+    v4u32_t W[16], s[8];
+    v4u32_t a, b, c, d, e, f, g, h, t1, t2;
+    uint32_t col[4];
+
+    for (int w = 0; w < 16; w++) {
+        for (int l = 0; l < 4; l++) col[l] = load_be32(blocks[l] + w * 4);
+        memcpy(&W[w], col, sizeof(col));
+    }
+    for (int w = 0; w < 8; w++) {
+        memcpy(&s[w], &state[w * 4], sizeof(s[w]));
+    }
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    for (int i = 0; i < 64; i++) {
+        v4u32_t wi;
+        if (i < 16) {
+            wi = W[i];
+        } else {
+            wi = vec_add(vec_add(V4_SIG1(W[(i - 2) & 15]), W[(i - 7) & 15]),
+                         vec_add(V4_SIG0(W[(i - 15) & 15]), W[i & 15]));
+            W[i & 15] = wi;
+        }
+
+        v4u32_t ch = vec_sel(g, f, e);
+        v4u32_t maj = vec_sel(b, c, vec_xor(a, b));
+        t1 = vec_add(vec_add(h, V4_EP1(e)),
+                     vec_add(ch, vec_add(vec_splats(sha256_K[i]), wi)));
+        t2 = vec_add(V4_EP0(a), maj);
+        h = g;
+        g = f;
+        f = e;
+        e = vec_add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = vec_add(t1, t2);
+    }
+
+    s[0] = vec_add(s[0], a); s[1] = vec_add(s[1], b);
+    s[2] = vec_add(s[2], c); s[3] = vec_add(s[3], d);
+    s[4] = vec_add(s[4], e); s[5] = vec_add(s[5], f);
+    s[6] = vec_add(s[6], g); s[7] = vec_add(s[7], h);
+    for (int w = 0; w < 8; w++) {
+        memcpy(&state[w * 4], &s[w], sizeof(s[w]));
+    }
+}
+
+#else
+
+int sha256_power8_built(void) { return 0; }
+
+void sha256_lanes_power8(uint32_t *state, const uint8_t *const *blocks) {
+    (void)state;
+    (void)blocks;
+}
+
+#endif
@@ -3,8 +3,8 @@
  * Copyright (c) 2025 William Murray / LibrePower
  *
  * Generates security events for SIEM integration:
- * - Syslog (UDP/TCP) with CEF or JSON format
- * - Log file (JSON lines) for Wazuh/Filebeat/agents
+ * - Syslog (UDP/TCP) with CEF or JSON format, over one connection
+ * - Log file (JSON lines) for Wazuh/Filebeat/agents, buffered and rotated
  * - Email alerts for critical events
  */
 
@@ -21,6 +21,9 @@
 #include <errno.h>
 
 #include "sentinel.h"
+#include "syslog_transport.h"
+#include "siem_queue.h"
+#include "log_writer.h"
 
 /* Event severity levels */
 #define SEV_INFO     1
@@ -66,38 +69,89 @@ typedef struct {
     int enabled;
     char syslog_host[256];
     int syslog_port;
-    int syslog_proto;       /* SOCK_DGRAM (UDP) or SOCK_STREAM (TCP) */
+    int syslog_tcp;         /* TCP with octet counting, else UDP */
     char syslog_format[16]; /* "cef" or "json" */
     char logfile_path[512];
-    int logfile_fd;
     char alert_email[256];
     int alert_threshold;
     char smtp_host[256];
 } siem_config_t;
 
 static siem_config_t g_siem_config = {0};
+static syslog_transport_t g_syslog = { .fd = -1 };
+static siem_queue_t g_queue;
+static log_writer_t g_logfile = { .fd = -1 };
 static fingerprint_t g_last_fingerprint = {0};
 static int g_has_last_fingerprint = 0;
 
+/*
+ * Sender thread: the batch goes out in one flush; what is left is spooled.
+ * Returns the messages handed to the socket. A message the transport
+ * refuses ends the batch there, so it and those after it are spooled in
+ * order. One cut off by a failed connection counts in the transport's
+ * dropped, which siem_cleanup() moves from sent to dropped.
+ */
+static int deliver_syslog(void *ctx, const char *const *msgs, const size_t *lens, int count) {
+    syslog_transport_t *t = ctx;
+    int queued = 0;
+
+    while (queued < count && syslog_transport_send(t, msgs[queued], lens[queued]) == 0) {
+        queued++;
+    }
+    if (syslog_transport_flush(t) == 0) return queued;
+
+    if (t->connect_failures == 1) {
+        fprintf(stderr, "Syslog: cannot reach %s:%d, spooling and retrying with backoff\n",
+                t->host, t->port);
+    }
+    int unsent = (int)syslog_transport_pending(t);
+    syslog_transport_discard(t);
+    return queued - unsent;
+}
+
 /* Initialize SIEM module */
-int siem_init(const char *syslog_host, int syslog_port, const char *format,
-              const char *logfile, const char *alert_email, int threshold) {
+int siem_init(const char *syslog_host, int syslog_port, int syslog_tcp, const char *format,
+              const char *logfile, const char *logfile_opts,
+              const char *alert_email, int threshold) {
 
     memset(&g_siem_config, 0, sizeof(g_siem_config));
 
     if (syslog_host && syslog_host[0]) {
         strncpy(g_siem_config.syslog_host, syslog_host, sizeof(g_siem_config.syslog_host) - 1);
         g_siem_config.syslog_port = syslog_port > 0 ? syslog_port : 514;
-        g_siem_config.syslog_proto = SOCK_DGRAM; /* Default UDP */
+        g_siem_config.syslog_tcp = syslog_tcp;
         strncpy(g_siem_config.syslog_format, format ? format : "cef",
                 sizeof(g_siem_config.syslog_format) - 1);
         g_siem_config.enabled = 1;
+
+        /* One connection for the life of the process, opened on first flush */
+        syslog_transport_init(&g_syslog, g_siem_config.syslog_host,
+                              g_siem_config.syslog_port, syslog_tcp);
+
+        /* Probes only queue; a sender thread talks to the collector */
+        char spool_path[768] = "";
+        if (sentinel_ensure_state_dir() == 0) {
+            char dir[512];
+            sentinel_state_dir(dir, sizeof(dir));
+            snprintf(spool_path, sizeof(spool_path), "%s/siem_spool.dat", dir);
+        }
+        if (siem_queue_start(&g_queue, spool_path, deliver_syslog, &g_syslog) != 0) {
+            fprintf(stderr, "Warning: Cannot start SIEM sender, syslog disabled\n");
+            g_siem_config.syslog_host[0] = '\0';
+            g_siem_config.enabled = 0;
+        }
     }
 
     if (logfile && logfile[0]) {
         strncpy(g_siem_config.logfile_path, logfile, sizeof(g_siem_config.logfile_path) - 1);
-        g_siem_config.logfile_fd = open(logfile, O_WRONLY | O_CREAT | O_APPEND, 0640);
-        if (g_siem_config.logfile_fd < 0) {
+        log_writer_opts_t opts;
+        log_writer_defaults(&opts);
+        if (log_writer_parse_opts(&opts, logfile_opts) != 0) {
+            fprintf(stderr, "Warning: Bad log file options '%s', using defaults\n", logfile_opts);
+            log_writer_defaults(&opts);
+        }
+        /* Events are buffered and written once per probe (siem_process_fingerprint) */
+        if (log_writer_open(&g_logfile, logfile, &opts) != 0) {
             fprintf(stderr, "Warning: Cannot open logfile %s: %s\n", logfile, strerror(errno));
         }
         g_siem_config.enabled = 1;
@@ -113,9 +167,22 @@ int siem_init(const char *syslog_host, int syslog_port, const char *format,
 
 /* Cleanup */
 void siem_cleanup(void) {
-    if (g_siem_config.logfile_fd > 0) {
-        close(g_siem_config.logfile_fd);
+    if (g_siem_config.syslog_host[0]) {
+        siem_queue_stats_t st;
+        siem_queue_stop(&g_queue);
+        siem_queue_get_stats(&g_queue, &st);
+        /* The sender has stopped: its transport counters are stable */
+        st.sent -= g_syslog.dropped;
+        st.dropped += g_syslog.dropped;
+        if (st.spooled || st.dropped) {
+            fprintf(stderr, "SIEM: %lu queued, %lu sent, %lu spooled, %lu dropped\n",
+                    st.queued, st.sent, st.spooled, st.dropped);
+        }
     }
+    syslog_transport_close(&g_syslog);
+    log_writer_close(&g_logfile);
+    fingerprint_free(&g_last_fingerprint);
+    g_has_last_fingerprint = 0;
 }
 
 /* Get current timestamp in ISO8601 */
@@ -221,7 +288,7 @@ static int format_json(const siem_event_t *evt, char *buf, size_t len) {
     return n;
 }
 
-/* Send event via syslog (UDP/TCP) */
+/* Queue event for syslog (UDP/TCP) */
 static int send_syslog(const siem_event_t *evt) {
     if (!g_siem_config.syslog_host[0]) return 0;
 
@@ -246,54 +313,22 @@ static int send_syslog(const siem_event_t *evt) {
 
     int len = snprintf(buf, sizeof(buf), "<%d>1 %s %s csentinel - - - %s",
                        pri, timestamp, evt->hostname, msg);
+    if (len >= (int)sizeof(buf)) len = sizeof(buf) - 1;
 
-    /* Create socket and send */
-    int sock = socket(AF_INET, g_siem_config.syslog_proto, 0);
-    if (sock < 0) {
-        fprintf(stderr, "Syslog socket error: %s\n", strerror(errno));
-        return -1;
-    }
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(g_siem_config.syslog_port);
-
-    struct hostent *he = gethostbyname(g_siem_config.syslog_host);
-    if (!he) {
-        fprintf(stderr, "Cannot resolve syslog host: %s\n", g_siem_config.syslog_host);
-        close(sock);
-        return -1;
-    }
-    memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-    int ret;
-    if (g_siem_config.syslog_proto == SOCK_STREAM) {
-        /* TCP - connect first */
-        if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-            fprintf(stderr, "Syslog connect error: %s\n", strerror(errno));
-            close(sock);
-            return -1;
-        }
-        ret = send(sock, buf, len, 0);
-    } else {
-        /* UDP - sendto */
-        ret = sendto(sock, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
-    }
-
-    close(sock);
-    return ret > 0 ? 0 : -1;
+    /* Handed to the sender thread; never waits on the collector */
+    return siem_queue_push(&g_queue, buf, (size_t)len);
 }
 
 /* Write event to log file */
 static int write_logfile(const siem_event_t *evt) {
-    if (g_siem_config.logfile_fd <= 0) return 0;
+    if (g_logfile.fd < 0) return 0;
 
     char buf[4096];
-    int len = format_json(evt, buf, sizeof(buf) - 1);
-    buf[len++] = '\n';
+    int len = format_json(evt, buf, sizeof(buf));
+    if (len >= (int)sizeof(buf)) len = sizeof(buf) - 1;
 
-    return write(g_siem_config.logfile_fd, buf, len) > 0 ? 0 : -1;
+    /* Buffered; written when the probe's events are committed */
+    return log_writer_append(&g_logfile, buf, (size_t)len);
 }
 
 /* Send email alert */
@@ -312,7 +347,7 @@ static int send_email_alert(const siem_event_t *evt) {
         "Event: %s\n"
         "Risk Score: %d\n"
         "Details: %s\n"
-        "\n--\nC-Sentinel SIEM Integration' | /usr/sbin/sendmail %s 2>/dev/null",
+        "\n--\nC-Sentinel SIEM Integration' | /usr/sbin/sendmail %s >/dev/null 2>&1 &",
         evt->severity >= SEV_HIGH ? "CRITICAL" : "Warning",
         evt->hostname,
         timestamp,
@@ -323,6 +358,7 @@ static int send_email_alert(const siem_event_t *evt) {
         g_siem_config.alert_email
     );
 
+    /* In the background: sendmail can take seconds to hand off */
     return system(cmd);
 }
 
@@ -345,6 +381,7 @@ void siem_emit(event_type_t type, int severity, const char *hostname,
     strncpy(evt.message, message, sizeof(evt.message) - 1);
 
     emit_event(&evt);
+    if (g_logfile.fd >= 0) log_writer_flush(&g_logfile);
 }
 
 /* Compare fingerprints and generate events for changes */
@@ -448,9 +485,10 @@ int siem_process_fingerprint(const fingerprint_t *fp) {
         }
     }
 
-    /* Store current fingerprint for next comparison */
-    memcpy(&g_last_fingerprint, fp, sizeof(fingerprint_t));
-    g_has_last_fingerprint = 1;
+    /* Store current fingerprint for next comparison - a deep copy, since
+     * the caller frees fp (and the strings it points at) after we return */
+    fingerprint_free(&g_last_fingerprint);
+    g_has_last_fingerprint = (fingerprint_copy(&g_last_fingerprint, fp) == 0);
 
     /* Emit periodic fingerprint event (for SIEM baseline) */
     evt.type = EVT_FINGERPRINT;
@@ -483,6 +521,9 @@ int siem_process_fingerprint(const fingerprint_t *fp) {
     emit_event(&evt);
     events_generated++;
 
+    /* Group commit: the probe's log lines go out in one write */
+    if (g_logfile.fd >= 0) log_writer_flush(&g_logfile);
+
     return events_generated;
 }
 
@@ -495,13 +536,25 @@ int siem_is_enabled(void) {
 void siem_print_config(void) {
     fprintf(stderr, "SIEM Integration:\n");
     if (g_siem_config.syslog_host[0]) {
-        fprintf(stderr, "  Syslog: %s:%d (%s format)\n",
+        fprintf(stderr, "  Syslog: %s:%d (%s, %s format)\n",
                 g_siem_config.syslog_host,
                 g_siem_config.syslog_port,
+                g_siem_config.syslog_tcp ? "tcp" : "udp",
                 g_siem_config.syslog_format);
+        if (g_queue.spool_path[0]) {
+            fprintf(stderr, "  Spool: %s (while the collector is down)\n", g_queue.spool_path);
+        }
     }
     if (g_siem_config.logfile_path[0]) {
         fprintf(stderr, "  Logfile: %s\n", g_siem_config.logfile_path);
+        if (g_logfile.fd >= 0) {
+            const log_writer_opts_t *o = &g_logfile.opts;
+            fprintf(stderr, "  Rotation: %llu MB, %d h, keep %d%s, fsync %s\n",
+                    (unsigned long long)(o->max_bytes / (1024 * 1024)), o->max_age_s / 3600,
+                    o->keep, o->compress ? " (gzip)" : "",
+                    o->fsync == LOG_FSYNC_COMMIT ? "commit" :
+                    o->fsync == LOG_FSYNC_ROTATE ? "rotate" : "never");
+        }
     }
     if (g_siem_config.alert_email[0]) {
         fprintf(stderr, "  Email alerts: %s (threshold: %d)\n",
@@ -0,0 +1,432 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * siem_queue.c - Ring, sender thread and disk spool for SIEM messages
+ *
+ * The sender thread replays and compacts the spool; both it and a push
+ * that overflows the ring append to it, under spool_lock. While the
+ * spool holds messages, everything new is appended behind them, so the
+ * collector sees events in the order they happened; the one exception is
+ * a batch in flight when the ring overflowed, which lands behind the
+ * overflow if its delivery then fails. After a failed delivery the
+ * thread does not try again for SIEM_QUEUE_RETRY_MS; batches meanwhile
+ * go straight to the spool.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "siem_queue.h"
+
+/* Room for a batch of frames read back from the spool */
+#define REPLAY_BUF (SIEM_QUEUE_BATCH * (SIEM_QUEUE_MSG_MAX + 24))
+
+typedef struct {
+    char *batch;                /* Messages taken from the ring */
+    const char *msgs[SIEM_QUEUE_BATCH];
+    size_t lens[SIEM_QUEUE_BATCH];
+    char *replay;               /* Frames read back from the spool */
+    int64_t retry_at_ms;        /* No delivery attempt before this */
+} sender_t;
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void count_stat(siem_queue_t *q, unsigned long *stat, unsigned long n) {
+    pthread_mutex_lock(&q->lock);
+    *stat += n;
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* ============================================================
+ * Spool
+ * ============================================================ */
+
+/* Called without spool_lock */
+static int spool_pending(siem_queue_t *q) {
+    pthread_mutex_lock(&q->spool_lock);
+    int pending = q->spool_read < q->spool_size;
+    pthread_mutex_unlock(&q->spool_lock);
+    return pending;
+}
+
+/* Append one frame; called with spool_lock held. Returns 0, or -1 */
+static int spool_write(siem_queue_t *q, const char *msg, size_t len) {
+    char prefix[24];
+    int plen = snprintf(prefix, sizeof(prefix), "%lu ", (unsigned long)len);
+    struct iovec iov[2] = {
+        { prefix, (size_t)plen },
+        { (void *)msg, len }
+    };
+
+    if (q->spool_fd < 0 || q->spool_broken ||
+        q->spool_size + (size_t)plen + len > SIEM_SPOOL_MAX) {
+        return -1;
+    }
+    ssize_t n = writev(q->spool_fd, iov, 2);
+    if (n != (ssize_t)((size_t)plen + len)) {
+        /*
+         * Cut off a partial frame, or replay would misread the rest. If
+         * that fails the torn bytes stay past spool_size, where replay
+         * does not look, and nothing more may be appended behind them.
+         */
+        if (n > 0 && ftruncate(q->spool_fd, (off_t)q->spool_size) != 0) {
+            q->spool_broken = 1;
+        }
+        return -1;
+    }
+    q->spool_size += (uint64_t)n;
+    return 0;
+}
+
+/* Spool a batch the collector did not take, from the sender thread */
+static void spool_append(siem_queue_t *q, const char *const *msgs, const size_t *lens, int count) {
+    int spooled = 0;
+
+    pthread_mutex_lock(&q->spool_lock);
+    while (spooled < count && spool_write(q, msgs[spooled], lens[spooled]) == 0) {
+        spooled++;
+    }
+    pthread_mutex_unlock(&q->spool_lock);
+
+    if (spooled) count_stat(q, &q->stats.spooled, (unsigned long)spooled);
+    if (spooled < count) count_stat(q, &q->stats.dropped, (unsigned long)(count - spooled));
+}
+
+/* Move the ring to the spool, oldest first; called with lock held */
+static void spool_ring(siem_queue_t *q) {
+    pthread_mutex_lock(&q->spool_lock);
+    while (q->count > 0 && spool_write(q, q->slots + (size_t)q->head * SIEM_QUEUE_MSG_MAX,
+                                       q->lens[q->head]) == 0) {
+        q->head = (q->head + 1) % SIEM_QUEUE_SLOTS;
+        q->count--;
+        q->stats.spooled++;
+    }
+    pthread_mutex_unlock(&q->spool_lock);
+}
+
+/* Split frames from the start of buf; returns how many, and their total bytes */
+static int parse_frames(const char *buf, size_t len, const char **msgs, size_t *lens,
+                        size_t *frame_ends, int *corrupt) {
+    size_t pos = 0;
+    int count = 0;
+
+    *corrupt = 0;
+    while (count < SIEM_QUEUE_BATCH && pos < len) {
+        size_t p = pos, mlen = 0;
+        while (p < len && p - pos < 12 && buf[p] >= '0' && buf[p] <= '9') {
+            mlen = mlen * 10 + (size_t)(buf[p++] - '0');
+        }
+        if (p == len) break;
+        if (p == pos || buf[p] != ' ' || mlen == 0 || mlen > SIEM_QUEUE_MSG_MAX) {
+            *corrupt = 1;
+            break;
+        }
+        if (p + 1 + mlen > len) break;
+
+        msgs[count] = buf + p + 1;
+        lens[count] = mlen;
+        pos = p + 1 + mlen;
+        frame_ends[count++] = pos;
+    }
+    return count;
+}
+
+/* Offer the spool to the collector, oldest first, until it is empty or refused */
+static void spool_replay(siem_queue_t *q, sender_t *s) {
+    const char *msgs[SIEM_QUEUE_BATCH];
+    size_t lens[SIEM_QUEUE_BATCH];
+    size_t ends[SIEM_QUEUE_BATCH];
+
+    for (;;) {
+        /* Frames before spool_size are complete and only this thread moves spool_read */
+        pthread_mutex_lock(&q->spool_lock);
+        uint64_t pos = q->spool_read;
+        uint64_t want = q->spool_size - pos;
+        pthread_mutex_unlock(&q->spool_lock);
+        if (want == 0) break;
+        if (want > REPLAY_BUF) want = REPLAY_BUF;
+
+        ssize_t got = pread(q->spool_fd, s->replay, (size_t)want, (off_t)pos);
+        if (got <= 0) break;
+
+        int corrupt;
+        int count = parse_frames(s->replay, (size_t)got, msgs, lens, ends, &corrupt);
+        if (count == 0) {
+            /* A damaged frame, or one cut short at the end: give up the rest */
+            pthread_mutex_lock(&q->spool_lock);
+            q->spool_read = q->spool_size;
+            pthread_mutex_unlock(&q->spool_lock);
+            count_stat(q, &q->stats.dropped, 1);
+            break;
+        }
+
+        int done = q->send(q->ctx, msgs, lens, count);
+        if (done > 0) {
+            pthread_mutex_lock(&q->spool_lock);
+            q->spool_read += ends[done - 1];
+            pthread_mutex_unlock(&q->spool_lock);
+            count_stat(q, &q->stats.sent, (unsigned long)done);
+        }
+        if (done < count) {
+            s->retry_at_ms = now_ms() + SIEM_QUEUE_RETRY_MS;
+            return;
+        }
+    }
+
+    /* Emptied (an overflowing push may have appended meanwhile): start over */
+    pthread_mutex_lock(&q->spool_lock);
+    if (q->spool_read == q->spool_size && q->spool_size > 0 &&
+        ftruncate(q->spool_fd, 0) == 0) {
+        q->spool_read = q->spool_size = 0;
+        q->spool_broken = 0;
+    }
+    pthread_mutex_unlock(&q->spool_lock);
+}
+
+/* Keep only what is still to be delivered, for the next run; pushes have stopped */
+static void spool_compact(siem_queue_t *q, sender_t *s) {
+    if (q->spool_read == 0) return;
+    if (q->spool_read == q->spool_size) {
+        if (ftruncate(q->spool_fd, 0) == 0) q->spool_read = q->spool_size = 0;
+        return;
+    }
+
+    char tmp_path[sizeof(q->spool_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", q->spool_path);
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return;
+
+    uint64_t pos = q->spool_read;
+    while (pos < q->spool_size) {
+        uint64_t want = q->spool_size - pos;
+        if (want > REPLAY_BUF) want = REPLAY_BUF;
+        ssize_t n = pread(q->spool_fd, s->replay, (size_t)want, (off_t)pos);
+        if (n <= 0 || write(fd, s->replay, (size_t)n) != n) break;
+        pos += (uint64_t)n;
+    }
+    if (close(fd) != 0 || pos != q->spool_size || rename(tmp_path, q->spool_path) != 0) {
+        unlink(tmp_path);
+    }
+}
+
+/* ============================================================
+ * Sender thread
+ * ============================================================ */
+
+static void deliver(siem_queue_t *q, sender_t *s, int count) {
+    int64_t now = now_ms();
+
+    if (spool_pending(q)) {
+        if (now >= s->retry_at_ms) spool_replay(q, s);
+        if (spool_pending(q)) {
+            spool_append(q, s->msgs, s->lens, count);
+            return;
+        }
+    }
+    if (count == 0) return;
+    if (now < s->retry_at_ms) {
+        spool_append(q, s->msgs, s->lens, count);
+        return;
+    }
+
+    int done = q->send(q->ctx, s->msgs, s->lens, count);
+    if (done > 0) count_stat(q, &q->stats.sent, (unsigned long)done);
+    if (done < count) {
+        s->retry_at_ms = now_ms() + SIEM_QUEUE_RETRY_MS;
+        spool_append(q, s->msgs + done, s->lens + done, count - done);
+    }
+}
+
+/* Copy up to a batch out of the ring; called with the lock held */
+static int take_batch(siem_queue_t *q, sender_t *s) {
+    int count = 0;
+    while (q->count > 0 && count < SIEM_QUEUE_BATCH) {
+        char *dst = s->batch + (size_t)count * SIEM_QUEUE_MSG_MAX;
+        memcpy(dst, q->slots + (size_t)q->head * SIEM_QUEUE_MSG_MAX, q->lens[q->head]);
+        s->msgs[count] = dst;
+        s->lens[count] = q->lens[q->head];
+        q->head = (q->head + 1) % SIEM_QUEUE_SLOTS;
+        q->count--;
+        count++;
+    }
+    return count;
+}
+
+static void wait_for_work(siem_queue_t *q) {
+    if (!spool_pending(q)) {
+        pthread_cond_wait(&q->wake, &q->lock);
+        return;
+    }
+
+    /* Spooled messages to retry: wake up for them too */
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += (long)SIEM_QUEUE_RETRY_MS * 1000000L;
+    until.tv_sec += until.tv_nsec / 1000000000L;
+    until.tv_nsec %= 1000000000L;
+    pthread_cond_timedwait(&q->wake, &q->lock, &until);
+}
+
+static void* sender_run(void *arg) {
+    siem_queue_t *q = arg;
+    sender_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.batch = malloc((size_t)SIEM_QUEUE_BATCH * SIEM_QUEUE_MSG_MAX);
+    s.replay = malloc(REPLAY_BUF);
+
+    pthread_mutex_lock(&q->lock);
+    for (;;) {
+        if (q->count == 0 && !q->stop) wait_for_work(q);
+        int stopping = q->stop;
+        int count = s.batch && s.replay ? take_batch(q, &s) : 0;
+        if (!s.batch || !s.replay) {
+            /* No memory to deliver with: account for the ring and idle */
+            q->stats.dropped += q->count;
+            q->head = (q->head + q->count) % SIEM_QUEUE_SLOTS;
+            q->count = 0;
+            if (stopping) break;
+            continue;
+        }
+        pthread_mutex_unlock(&q->lock);
+
+        deliver(q, &s, count);
+
+        pthread_mutex_lock(&q->lock);
+        if (stopping && q->count == 0) break;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    if (s.replay && q->spool_fd >= 0) spool_compact(q, &s);
+    free(s.batch);
+    free(s.replay);
+    return NULL;
+}
+
+/* ============================================================
+ * Public API
+ * ============================================================ */
+
+int siem_queue_start(siem_queue_t *q, const char *spool_path, siem_send_fn send, void *ctx) {
+    memset(q, 0, sizeof(*q));
+    q->spool_fd = -1;
+    q->send = send;
+    q->ctx = ctx;
+
+    q->slots = malloc((size_t)SIEM_QUEUE_SLOTS * SIEM_QUEUE_MSG_MAX);
+    q->lens = calloc(SIEM_QUEUE_SLOTS, sizeof(size_t));
+    if (!q->slots || !q->lens) goto fail;
+
+    if (spool_path && spool_path[0]) {
+        struct stat st;
+        snprintf(q->spool_path, sizeof(q->spool_path), "%s", spool_path);
+        q->spool_fd = open(spool_path, O_RDWR | O_CREAT | O_APPEND, 0600);
+        if (q->spool_fd >= 0 && fstat(q->spool_fd, &st) == 0) {
+            /* Left by the last run: replayed before anything new */
+            q->spool_size = (uint64_t)st.st_size;
+        }
+    }
+
+    if (pthread_mutex_init(&q->lock, NULL) != 0) goto fail;
+    if (pthread_mutex_init(&q->spool_lock, NULL) != 0) {
+        pthread_mutex_destroy(&q->lock);
+        goto fail;
+    }
+    if (pthread_cond_init(&q->wake, NULL) != 0) {
+        pthread_mutex_destroy(&q->spool_lock);
+        pthread_mutex_destroy(&q->lock);
+        goto fail;
+    }
+    if (pthread_create(&q->thread, NULL, sender_run, q) != 0) {
+        pthread_cond_destroy(&q->wake);
+        pthread_mutex_destroy(&q->spool_lock);
+        pthread_mutex_destroy(&q->lock);
+        goto fail;
+    }
+    q->running = 1;
+    return 0;
+
+fail:
+    if (q->spool_fd >= 0) close(q->spool_fd);
+    q->spool_fd = -1;
+    free(q->slots);
+    free(q->lens);
+    q->slots = NULL;
+    q->lens = NULL;
+    return -1;
+}
+
+int siem_queue_push(siem_queue_t *q, const char *msg, size_t len) {
+    if (!q->running) return -1;
+
+    pthread_mutex_lock(&q->lock);
+    /* Sender stuck on the collector: overflow to the spool, ahead of this one */
+    if (q->count == SIEM_QUEUE_SLOTS && !q->stop) spool_ring(q);
+    if (len == 0 || len > SIEM_QUEUE_MSG_MAX || q->count == SIEM_QUEUE_SLOTS || q->stop) {
+        q->stats.dropped++;
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+
+    unsigned slot = (q->head + q->count) % SIEM_QUEUE_SLOTS;
+    memcpy(q->slots + (size_t)slot * SIEM_QUEUE_MSG_MAX, msg, len);
+    q->lens[slot] = len;
+    q->count++;
+    q->stats.queued++;
+
+    /* The sender only sleeps on an empty ring (also right after an overflow) */
+    if (q->count == 1) pthread_cond_signal(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+void siem_queue_stop(siem_queue_t *q) {
+    if (!q->running) return;
+
+    pthread_mutex_lock(&q->lock);
+    q->stop = 1;
+    pthread_cond_signal(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+    pthread_join(q->thread, NULL);
+    q->running = 0;
+
+    pthread_cond_destroy(&q->wake);
+    pthread_mutex_destroy(&q->spool_lock);
+    pthread_mutex_destroy(&q->lock);
+    if (q->spool_fd >= 0) close(q->spool_fd);
+    q->spool_fd = -1;
+    free(q->slots);
+    free(q->lens);
+    q->slots = NULL;
+    q->lens = NULL;
+}
+
+void siem_queue_get_stats(siem_queue_t *q, siem_queue_stats_t *stats) {
+    if (!q->running) {
+        *stats = q->stats;
+        return;
+    }
+    pthread_mutex_lock(&q->lock);
+    *stats = q->stats;
+    pthread_mutex_unlock(&q->lock);
+}
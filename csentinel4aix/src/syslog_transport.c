@@ -0,0 +1,281 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * syslog_transport.c - Long-lived, batched syslog connection
+ *
+ * Queued messages are kept framed as "LEN SP MSG" whatever the protocol,
+ * so the queue can always be cut at a message boundary. Over TCP the
+ * frames go out as they are, in one send() per flush; over UDP each
+ * message is sent alone.
+ *
+ * A collector that has closed the connection is noticed before the next
+ * flush (the socket turns readable at end of file), so a batch is not
+ * written into a dead connection. If a connection fails part way
+ * through a message, that message is dropped rather than resent as a
+ * fragment the collector could not frame.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/time.h>
+
+#include "syslog_transport.h"
+
+/* Queued bytes that trigger a flush from syslog_transport_send() */
+#define SYSLOG_BATCH_BYTES (64 * 1024)
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int syslog_transport_init(syslog_transport_t *t, const char *host, int port, int tcp) {
+    memset(t, 0, sizeof(*t));
+    t->fd = -1;
+    if (!host || !host[0] || port <= 0 || port > 65535) return -1;
+
+    snprintf(t->host, sizeof(t->host), "%s", host);
+    t->port = port;
+    t->tcp = tcp;
+
+#if !defined(MSG_NOSIGNAL) && !defined(SO_NOSIGPIPE)
+    /* A collector closing the connection must not kill the process */
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    return 0;
+}
+
+/* ============================================================
+ * Framing
+ * ============================================================ */
+
+/* Offset just past the frame at pos; *msg and *msg_len locate its message */
+static size_t frame_end(const syslog_transport_t *t, size_t pos,
+                        const char **msg, size_t *msg_len) {
+    size_t len = 0;
+    while (t->pending[pos] != ' ') len = len * 10 + (size_t)(t->pending[pos++] - '0');
+    pos++;
+    if (msg) *msg = t->pending + pos;
+    if (msg_len) *msg_len = len;
+    return pos + len;
+}
+
+int syslog_transport_send(syslog_transport_t *t, const char *msg, size_t len) {
+    char prefix[24];
+    int plen = snprintf(prefix, sizeof(prefix), "%lu ", (unsigned long)len);
+
+    if (t->pending_len + (size_t)plen + len > SYSLOG_MAX_PENDING) {
+        t->refused++;
+        return -1;
+    }
+    if (t->pending_len + (size_t)plen + len > t->pending_cap) {
+        size_t cap = t->pending_cap ? t->pending_cap : 16384;
+        while (cap < t->pending_len + (size_t)plen + len) cap *= 2;
+        char *p = realloc(t->pending, cap);
+        if (!p) {
+            t->refused++;
+            return -1;
+        }
+        t->pending = p;
+        t->pending_cap = cap;
+    }
+
+    memcpy(t->pending + t->pending_len, prefix, (size_t)plen);
+    memcpy(t->pending + t->pending_len + plen, msg, len);
+    t->pending_len += (size_t)plen + len;
+    t->messages++;
+
+    if (t->pending_len >= SYSLOG_BATCH_BYTES) syslog_transport_flush(t);
+    return 0;
+}
+
+/* ============================================================
+ * Connection
+ * ============================================================ */
+
+static int resolve(syslog_transport_t *t) {
+    struct addrinfo hints, *res;
+    char port[16];
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = t->tcp ? SOCK_STREAM : SOCK_DGRAM;
+    snprintf(port, sizeof(port), "%d", t->port);
+
+    if (getaddrinfo(t->host, port, &hints, &res) != 0 || !res) return -1;
+    memcpy(&t->addr, res->ai_addr, res->ai_addrlen);
+    t->addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return 0;
+}
+
+/* Connect with a timeout, so a silent collector cannot stall a probe */
+static int open_socket(syslog_transport_t *t) {
+    int fd = socket(t->addr.ss_family, t->tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    int rc = connect(fd, (struct sockaddr *)&t->addr, t->addr_len);
+    if (rc < 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        int err = 0;
+        socklen_t err_len = sizeof(err);
+        if (poll(&pfd, 1, SYSLOG_CONNECT_TIMEOUT_MS) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0 && err == 0) {
+            rc = 0;
+        }
+    }
+    if (rc < 0) {
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, flags);
+    struct timeval tv = { SYSLOG_CONNECT_TIMEOUT_MS / 1000, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    return fd;
+}
+
+/* Wait before the next attempt: 0.5 s, doubling up to a minute */
+static void back_off(syslog_transport_t *t) {
+    t->backoff_ms = t->backoff_ms ? t->backoff_ms * 2 : SYSLOG_BACKOFF_MIN_MS;
+    if (t->backoff_ms > SYSLOG_BACKOFF_MAX_MS) t->backoff_ms = SYSLOG_BACKOFF_MAX_MS;
+    t->retry_at_ms = now_ms() + t->backoff_ms;
+}
+
+static int connect_collector(syslog_transport_t *t) {
+    if (now_ms() < t->retry_at_ms) return -1;
+
+    if (t->addr_len == 0 && resolve(t) != 0) {
+        t->connect_failures++;
+        back_off(t);
+        return -1;
+    }
+
+    t->fd = open_socket(t);
+    if (t->fd < 0) {
+        /* The name may point somewhere else by the next attempt */
+        t->addr_len = 0;
+        t->connect_failures++;
+        back_off(t);
+        return -1;
+    }
+
+    t->connects++;
+    t->backoff_ms = 0;
+    t->retry_at_ms = 0;
+    t->sent = 0;
+    return 0;
+}
+
+/* A syslog collector never writes, so a readable socket means it has gone */
+static int collector_gone(syslog_transport_t *t) {
+    struct pollfd pfd = { t->fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 0) <= 0) return 0;
+    if (pfd.revents & (POLLERR | POLLHUP)) return 1;
+
+    char junk[256];
+    return recv(t->fd, junk, sizeof(junk), 0) <= 0;
+}
+
+/* Close, keeping the messages not yet sent whole */
+static void disconnect(syslog_transport_t *t) {
+    size_t keep = 0;
+
+    while (keep < t->sent) {
+        size_t end = frame_end(t, keep, NULL, NULL);
+        if (end > t->sent) t->dropped++;
+        keep = end;
+    }
+    memmove(t->pending, t->pending + keep, t->pending_len - keep);
+    t->pending_len -= keep;
+    t->sent = 0;
+
+    close(t->fd);
+    t->fd = -1;
+}
+
+static int write_pending(syslog_transport_t *t) {
+    while (t->sent < t->pending_len) {
+        const char *data = t->pending + t->sent;
+        size_t len = t->pending_len - t->sent;
+        size_t end = t->pending_len;
+
+        if (!t->tcp) end = frame_end(t, t->sent, &data, &len);
+
+        ssize_t n = send(t->fd, data, len, SEND_FLAGS);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        t->sent = t->tcp ? t->sent + (size_t)n : end;
+    }
+
+    t->pending_len = 0;
+    t->sent = 0;
+    return 0;
+}
+
+int syslog_transport_flush(syslog_transport_t *t) {
+    if (t->pending_len == 0) return 0;
+
+    if (t->fd >= 0 && t->tcp && collector_gone(t)) disconnect(t);
+    if (t->fd < 0 && connect_collector(t) != 0) return -1;
+
+    if (write_pending(t) != 0) {
+        disconnect(t);
+        back_off(t);
+        return -1;
+    }
+    return 0;
+}
+
+unsigned long syslog_transport_pending(const syslog_transport_t *t) {
+    unsigned long count = 0;
+    for (size_t pos = t->sent; pos < t->pending_len; pos = frame_end(t, pos, NULL, NULL)) {
+        count++;
+    }
+    return count;
+}
+
+void syslog_transport_discard(syslog_transport_t *t) {
+    t->pending_len = 0;
+    t->sent = 0;
+}
+
+void syslog_transport_close(syslog_transport_t *t) {
+    syslog_transport_flush(t);
+    if (t->fd >= 0) close(t->fd);
+    t->fd = -1;
+    free(t->pending);
+    t->pending = NULL;
+    t->pending_len = t->pending_cap = 0;
+}
@@ -0,0 +1,397 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * watch.c - Change notification for event-driven watch mode
+ *
+ * On Linux, config files are watched with inotify and process exec/exit
+ * with the netlink process connector, so --watch can re-probe only the
+ * subsystem that changed. Each file's parent directory is watched rather
+ * than the file itself, which also catches editors that save by writing
+ * a new file and renaming it over the old one. A directory that goes
+ * away (and with it the watch) is watched again from the next resync.
+ *
+ * The process connector needs CAP_NET_ADMIN; without it (and on AIX)
+ * the corresponding source is simply not active and the periodic
+ * resync covers it.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+
+#ifndef _AIX
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#endif
+
+#include "sentinel.h"
+
+#define WATCH_SETTLE_MS       100   /* Coalesce bursts (editor saves, fork storms) */
+#define WATCH_PROCESS_MIN_MS  1000  /* At most one process re-probe per second */
+
+#ifndef _AIX
+
+static struct {
+    int inotify_fd;
+    int proc_fd;
+    const char **paths;
+    int path_count;
+    int *path_wd;               /* Parent directory watch per path, -1 if none */
+    const char **basenames;     /* Points into paths */
+    char *changed;              /* Per-path flags handed out by watch_wait() */
+    int rewatch;                /* Some path_wd is -1: retry on the next resync */
+    long long last_process_ms;
+    long long last_resync_ms;   /* The full resync is due interval after this */
+} g_watch = { -1, -1, NULL, 0, NULL, NULL, NULL, 0, 0, 0 };
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ============================================================
+ * Config Files - inotify
+ * ============================================================ */
+
+/* Watch the directory holding paths[i]; returns the wd or -1 */
+static int watch_path(int i) {
+    const char *path = g_watch.paths[i];
+    const char *slash = strrchr(path, '/');
+    char dir[1024];
+
+    if (!slash) {
+        snprintf(dir, sizeof(dir), ".");
+    } else if (slash == path) {
+        snprintf(dir, sizeof(dir), "/");
+    } else {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+    }
+
+    /* The kernel hands back the same wd for a directory already watched */
+    g_watch.path_wd[i] = inotify_add_watch(g_watch.inotify_fd, dir,
+                                           IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                           IN_CREATE | IN_DELETE | IN_ATTRIB | IN_ONLYDIR);
+    if (g_watch.path_wd[i] < 0) {
+        g_watch.path_wd[i] = -1;
+        g_watch.rewatch = 1;
+    }
+    return g_watch.path_wd[i];
+}
+
+static int inotify_open(const char **paths, int count) {
+    g_watch.path_wd = malloc(count * sizeof(int));
+    g_watch.basenames = malloc(count * sizeof(char *));
+    g_watch.changed = calloc(count, 1);
+    if (!g_watch.path_wd || !g_watch.basenames || !g_watch.changed) return -1;
+
+    g_watch.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_watch.inotify_fd < 0) return -1;
+
+    int watched = 0;
+    for (int i = 0; i < count; i++) {
+        const char *slash = strrchr(paths[i], '/');
+
+        g_watch.basenames[i] = slash ? slash + 1 : paths[i];
+        if (watch_path(i) >= 0) watched++;
+    }
+
+    if (watched == 0) {
+        close(g_watch.inotify_fd);
+        g_watch.inotify_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/* Re-add the watches dropped since the last resync (directory removed and recreated) */
+static void inotify_rewatch(void) {
+    if (g_watch.inotify_fd < 0 || !g_watch.rewatch) return;
+
+    g_watch.rewatch = 0;
+    for (int i = 0; i < g_watch.path_count; i++) {
+        if (g_watch.path_wd[i] < 0) watch_path(i);
+    }
+}
+
+/* Mark changed paths; returns WATCH_EVENT_* bits seen */
+static unsigned inotify_drain(void) {
+    union {
+        struct inotify_event ev;
+        char buf[8192];
+    } u;
+    unsigned events = 0;
+
+    for (;;) {
+        ssize_t n = read(g_watch.inotify_fd, u.buf, sizeof(u.buf));
+        if (n <= 0) break;
+
+        for (char *p = u.buf; p < u.buf + n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+
+            /* Lost events or a watched directory went away: resync fully */
+            if (ev->mask & (IN_Q_OVERFLOW | IN_IGNORED)) {
+                events |= WATCH_EVENT_RESYNC;
+            }
+            /* The kernel dropped that watch; it is re-added at the resync */
+            if (ev->mask & IN_IGNORED) {
+                for (int i = 0; i < g_watch.path_count; i++) {
+                    if (g_watch.path_wd[i] == ev->wd) {
+                        g_watch.path_wd[i] = -1;
+                        g_watch.rewatch = 1;
+                    }
+                }
+            }
+            if (ev->mask & (IN_Q_OVERFLOW | IN_IGNORED)) continue;
+            if (ev->len == 0) continue;
+
+            for (int i = 0; i < g_watch.path_count; i++) {
+                if (g_watch.path_wd[i] == ev->wd &&
+                    strcmp(g_watch.basenames[i], ev->name) == 0) {
+                    g_watch.changed[i] = 1;
+                    events |= WATCH_EVENT_CONFIG;
+                }
+            }
+        }
+    }
+    return events;
+}
+
+/* ============================================================
+ * Processes - Netlink Process Connector
+ * ============================================================ */
+
+static int proc_connector_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = CN_IDX_PROC;
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    /* Subscribe: nlmsghdr + cn_msg + PROC_CN_MCAST_LISTEN */
+    union {
+        struct nlmsghdr nl;
+        char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(int))];
+    } req;
+    memset(&req, 0, sizeof(req));
+    req.nl.nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(int));
+    req.nl.nlmsg_type = NLMSG_DONE;
+    req.nl.nlmsg_pid = (unsigned)getpid();
+
+    struct cn_msg *cn = NLMSG_DATA(&req.nl);
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(int);
+    int op = PROC_CN_MCAST_LISTEN;
+    memcpy(cn->data, &op, sizeof(op));
+
+    if (send(fd, &req, req.nl.nlmsg_len, 0) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Count exec and process (not thread) exit events */
+static int proc_connector_drain(void) {
+    union {
+        struct nlmsghdr nl;
+        char buf[8192];
+    } u;
+    int count = 0;
+
+    for (;;) {
+        ssize_t n = recv(g_watch.proc_fd, u.buf, sizeof(u.buf), 0);
+        if (n < 0 && errno == ENOBUFS) {
+            count++;            /* Overran the socket buffer - treat as "something changed" */
+            continue;
+        }
+        if (n <= 0) break;
+
+        int len = (int)n;
+        for (struct nlmsghdr *nl = &u.nl; NLMSG_OK(nl, len); nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type != NLMSG_DONE) continue;
+
+            const struct cn_msg *cn = NLMSG_DATA(nl);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+
+            /* cn->data sits at offset 36, too loose for proc_event's 64-bit fields */
+            struct proc_event ev;
+            memset(&ev, 0, sizeof(ev));
+            memcpy(&ev, cn->data, cn->len < sizeof(ev) ? cn->len : sizeof(ev));
+            if (ev.what == PROC_EVENT_EXEC) {
+                count++;
+            } else if (ev.what == PROC_EVENT_EXIT &&
+                       ev.event_data.exit.process_pid == ev.event_data.exit.process_tgid) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* ============================================================
+ * Public Interface
+ * ============================================================ */
+
+int watch_init(const char **paths, int count) {
+    int sources = 0;
+
+    watch_close();
+    g_watch.paths = paths;
+    g_watch.path_count = count;
+    g_watch.last_resync_ms = now_ms();
+
+    if (count > 0 && inotify_open(paths, count) == 0) {
+        sources |= WATCH_EVENT_CONFIG;
+    }
+
+    g_watch.proc_fd = proc_connector_open();
+    if (g_watch.proc_fd >= 0) {
+        sources |= WATCH_EVENT_PROCESS;
+    }
+
+    return sources;
+}
+
+unsigned watch_wait(int timeout_ms, watch_result_t *result) {
+    struct pollfd fds[2];
+    int nfds = 0;
+    unsigned events = 0;
+    long long first_config = 0, first_process = 0;
+    /* From the last resync, so a steady trickle of events cannot postpone it */
+    long long deadline = g_watch.last_resync_ms + timeout_ms;
+
+    memset(result, 0, sizeof(*result));
+    if (g_watch.changed) memset(g_watch.changed, 0, g_watch.path_count);
+    result->config_changed = g_watch.changed;
+
+    if (g_watch.inotify_fd >= 0) {
+        fds[nfds].fd = g_watch.inotify_fd;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+    if (g_watch.proc_fd >= 0) {
+        fds[nfds].fd = g_watch.proc_fd;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+
+    for (;;) {
+        long long now = now_ms();
+        long long wake = deadline;
+
+        /* Hold events back until the burst settles */
+        if (events & WATCH_EVENT_CONFIG) {
+            long long ready = first_config + WATCH_SETTLE_MS;
+            if (ready < wake) wake = ready;
+        }
+        if (events & WATCH_EVENT_PROCESS) {
+            long long ready = first_process + WATCH_SETTLE_MS;
+            if (ready < g_watch.last_process_ms + WATCH_PROCESS_MIN_MS) {
+                ready = g_watch.last_process_ms + WATCH_PROCESS_MIN_MS;
+            }
+            if (ready < wake) wake = ready;
+        }
+        if (events & WATCH_EVENT_RESYNC) wake = now;
+        if (now >= wake) break;
+
+        int rc = poll(fds, nfds, (int)(wake - now));
+        if (rc < 0) {
+            if (errno == EINTR) break;  /* Let the caller check for shutdown */
+            events |= WATCH_EVENT_RESYNC;
+            break;
+        }
+
+        for (int i = 0; i < nfds; i++) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            if (fds[i].fd == g_watch.inotify_fd) {
+                unsigned seen = inotify_drain();
+                if ((seen & WATCH_EVENT_CONFIG) && !(events & WATCH_EVENT_CONFIG)) {
+                    first_config = now_ms();
+                }
+                events |= seen;
+            } else {
+                int seen = proc_connector_drain();
+                if (seen > 0 && !(events & WATCH_EVENT_PROCESS)) {
+                    first_process = now_ms();
+                    events |= WATCH_EVENT_PROCESS;
+                }
+                result->process_events += seen;
+            }
+        }
+    }
+
+    if (now_ms() >= deadline) {
+        events |= WATCH_EVENT_RESYNC;
+    }
+    if (events & (WATCH_EVENT_PROCESS | WATCH_EVENT_RESYNC)) {
+        g_watch.last_process_ms = now_ms();
+    }
+    if (events & WATCH_EVENT_RESYNC) {
+        g_watch.last_resync_ms = now_ms();
+        inotify_rewatch();
+    }
+
+    result->events = events;
+    return events;
+}
+
+void watch_close(void) {
+    if (g_watch.inotify_fd >= 0) close(g_watch.inotify_fd);
+    if (g_watch.proc_fd >= 0) close(g_watch.proc_fd);
+    free(g_watch.path_wd);
+    free(g_watch.basenames);
+    free(g_watch.changed);
+    memset(&g_watch, 0, sizeof(g_watch));
+    g_watch.inotify_fd = -1;
+    g_watch.proc_fd = -1;
+}
+
+#else /* _AIX */
+
+/*
+ * AIX has AHAFS for file events but no process exec/exit feed that works
+ * without the audit subsystem; watch mode keeps polling there.
+ */
+
+int watch_init(const char **paths, int count) {
+    (void)paths;
+    (void)count;
+    return 0;
+}
+
+unsigned watch_wait(int timeout_ms, watch_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    if (sleep((unsigned)((timeout_ms + 999) / 1000)) != 0) {
+        return 0;               /* Interrupted by a signal */
+    }
+    result->events = WATCH_EVENT_RESYNC;
+    return result->events;
+}
+
+void watch_close(void) {
+}
+
+#endif /* _AIX */
@@ -0,0 +1,213 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * workpool.c - Fixed worker pool for parallel fingerprint capture
+ *
+ * workpool_for() runs fn(i) for every i in [0, count) across the
+ * configured number of threads and returns once all are done. Each
+ * index writes only its own output slot, so callers merge results in
+ * index order and the capture stays deterministic regardless of how
+ * the work was scheduled. With one job (the default) no threads are
+ * created and the loop runs inline.
+ *
+ * There is one pool and it runs one batch at a time: callers on other
+ * threads wait their turn on g_batch_lock, and a call from inside a
+ * batch (fn itself calling workpool_for) runs inline on its thread.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "sentinel.h"
+
+#define WORKPOOL_MAX_JOBS 64
+
+typedef struct {
+    pthread_t threads[WORKPOOL_MAX_JOBS];
+    int thread_count;
+    int started;
+    int shutting_down;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    /* The batch currently being run */
+    unsigned long generation;
+    workpool_fn fn;
+    void *ctx;
+    int count;
+    int next;                   /* Next unclaimed index */
+    int busy;                   /* Workers still inside the batch */
+} workpool_t;
+
+static workpool_t g_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_ready = PTHREAD_COND_INITIALIZER,
+    .work_done = PTHREAD_COND_INITIALIZER
+};
+static int g_jobs = 1;
+
+/* Held for the whole of a parallel workpool_for(); taken before g_pool.lock */
+static pthread_mutex_t g_batch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Set on pool workers, and on a caller while its batch runs */
+static pthread_key_t g_in_batch;
+static pthread_once_t g_in_batch_once = PTHREAD_ONCE_INIT;
+
+static void create_in_batch_key(void) {
+    pthread_key_create(&g_in_batch, NULL);
+}
+
+/* ============================================================
+ * Configuration
+ * ============================================================ */
+
+void workpool_set_jobs(int jobs) {
+    if (jobs <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (int)cpus : 1;
+    }
+    if (jobs > WORKPOOL_MAX_JOBS) jobs = WORKPOOL_MAX_JOBS;
+    g_jobs = jobs;
+}
+
+int workpool_jobs(void) {
+    return g_jobs;
+}
+
+/* ============================================================
+ * Workers
+ * ============================================================ */
+
+/* Claim and run indices until the batch is exhausted (lock held on entry/exit) */
+static void drain_batch(void) {
+    while (g_pool.next < g_pool.count) {
+        int index = g_pool.next++;
+        workpool_fn fn = g_pool.fn;
+        void *ctx = g_pool.ctx;
+
+        pthread_mutex_unlock(&g_pool.lock);
+        fn(index, ctx);
+        pthread_mutex_lock(&g_pool.lock);
+    }
+}
+
+static void *worker_main(void *arg) {
+    unsigned long seen = 0;
+    (void)arg;
+
+    pthread_setspecific(g_in_batch, &g_pool);
+    pthread_mutex_lock(&g_pool.lock);
+    for (;;) {
+        while (!g_pool.shutting_down && g_pool.generation == seen) {
+            pthread_cond_wait(&g_pool.work_ready, &g_pool.lock);
+        }
+        if (g_pool.shutting_down) break;
+
+        seen = g_pool.generation;
+        g_pool.busy++;
+        drain_batch();
+        if (--g_pool.busy == 0) {
+            pthread_cond_signal(&g_pool.work_done);
+        }
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+    return NULL;
+}
+
+void workpool_shutdown(void) {
+    /* exit() from inside a batch: the pool cannot wait for itself */
+    pthread_once(&g_in_batch_once, create_in_batch_key);
+    if (pthread_getspecific(g_in_batch)) return;
+
+    pthread_mutex_lock(&g_batch_lock);
+    pthread_mutex_lock(&g_pool.lock);
+    if (!g_pool.started) {
+        pthread_mutex_unlock(&g_pool.lock);
+        pthread_mutex_unlock(&g_batch_lock);
+        return;
+    }
+    g_pool.shutting_down = 1;
+    pthread_cond_broadcast(&g_pool.work_ready);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    for (int i = 0; i < g_pool.thread_count; i++) {
+        pthread_join(g_pool.threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    g_pool.thread_count = 0;
+    g_pool.started = 0;
+    g_pool.shutting_down = 0;
+    pthread_mutex_unlock(&g_pool.lock);
+    pthread_mutex_unlock(&g_batch_lock);
+}
+
+/* Start jobs-1 workers; the calling thread is the last one */
+static void workpool_start(void) {
+    if (g_pool.started) return;
+
+    for (int i = 0; i < g_jobs - 1; i++) {
+        if (pthread_create(&g_pool.threads[g_pool.thread_count], NULL,
+                           worker_main, NULL) != 0) {
+            break;
+        }
+        g_pool.thread_count++;
+    }
+    g_pool.started = 1;
+    atexit(workpool_shutdown);
+}
+
+/* ============================================================
+ * Parallel Loop
+ * ============================================================ */
+
+int workpool_for(int count, workpool_fn fn, void *ctx) {
+    if (count <= 0 || !fn) return 0;
+
+    /* Sequential path: no threads, no locking; nested calls stay on their thread */
+    pthread_once(&g_in_batch_once, create_in_batch_key);
+    if (g_jobs <= 1 || count == 1 || pthread_getspecific(g_in_batch)) {
+        for (int i = 0; i < count; i++) {
+            fn(i, ctx);
+        }
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_batch_lock);
+    pthread_setspecific(g_in_batch, &g_pool);
+    pthread_mutex_lock(&g_pool.lock);
+    workpool_start();
+
+    g_pool.fn = fn;
+    g_pool.ctx = ctx;
+    g_pool.count = count;
+    g_pool.next = 0;
+    g_pool.generation++;
+    pthread_cond_broadcast(&g_pool.work_ready);
+
+    /* The caller works too, then waits for stragglers */
+    drain_batch();
+    while (g_pool.busy > 0) {
+        pthread_cond_wait(&g_pool.work_done, &g_pool.lock);
+    }
+
+    g_pool.fn = NULL;
+    g_pool.ctx = NULL;
+    g_pool.count = 0;
+    pthread_mutex_unlock(&g_pool.lock);
+    pthread_setspecific(g_in_batch, NULL);
+    pthread_mutex_unlock(&g_batch_lock);
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_audit_log.c - Native audit.log reader
+ *
+ * Writes a small synthetic audit.log and checks every summary count
+ * it feeds, then that the cursor picks up only records appended
+ * since, follows a rotation to audit.log.1, and leaves a half-written
+ * record for the next read. Then times one pass over a large log.
+ *
+ * Usage: bench_audit_log [megabytes]   (default: 64)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audit.h"
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+static unsigned long serial = 100;
+static char log_path[64];
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+/* One of each event the summary uses; returns bytes written */
+static size_t write_events(FILE *fp, long t) {
+    long start = ftell(fp);
+    unsigned long s;
+
+    s = serial++;
+    fprintf(fp, "type=USER_AUTH msg=audit(%ld.101:%lu): pid=900 uid=0 auid=4294967295 "
+            "ses=4294967295 msg='op=PAM:authentication grantors=? acct=\"alice\" "
+            "exe=\"/usr/sbin/sshd\" hostname=10.0.0.9 addr=10.0.0.9 terminal=ssh res=failed'\n", t, s);
+    s = serial++;
+    fprintf(fp, "node=db1 type=USER_AUTH msg=audit(%ld.102:%lu): pid=901 uid=0 msg='op=PAM:authentication "
+            "grantors=pam_unix acct=\"bob\" exe=\"/usr/sbin/sshd\" terminal=ssh res=success'\n", t, s);
+    s = serial++;
+    fprintf(fp, "type=USER_CMD msg=audit(%ld.103:%lu): pid=902 uid=1000 msg='cwd=\"/home/x\" "
+            "cmd=6C73 exe=\"/usr/bin/sudo\" terminal=pts/0 res=success'\n", t, s);
+    s = serial++;
+    fprintf(fp, "type=USER_CMD msg=audit(%ld.104:%lu): pid=903 uid=1000 msg='cwd=\"/\" "
+            "cmd=6964 exe=\"/usr/bin/su\" terminal=pts/0 res=success'\n", t, s);
+
+    /* A watched identity file, and the directory entry that is not counted */
+    s = serial++;
+    fprintf(fp, "type=SYSCALL msg=audit(%ld.105:%lu): arch=c000003e syscall=257 success=yes "
+            "exit=3 ppid=1 pid=904 auid=1000 uid=0 comm=\"vi\" exe=\"/usr/bin/vi\" key=\"identity\"\n", t, s);
+    fprintf(fp, "type=CWD msg=audit(%ld.105:%lu): cwd=\"/root\"\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.105:%lu): item=0 name=\"/etc/\" inode=2 nametype=PARENT\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.105:%lu): item=1 name=\"/etc/shadow\" inode=3 nametype=NORMAL\n", t, s);
+
+    /* A PATH outside any identity or exec event */
+    s = serial++;
+    fprintf(fp, "type=SYSCALL msg=audit(%ld.106:%lu): syscall=2 ppid=1 pid=905 comm=\"cat\" key=(null)\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.106:%lu): item=0 name=\"/tmp/notes\" nametype=NORMAL\n", t, s);
+
+    /* Executions: /tmp (hex-encoded name with a space), /dev/shm, a shell */
+    s = serial++;
+    fprintf(fp, "type=SYSCALL msg=audit(%ld.107:%lu): syscall=59 ppid=1 pid=906 comm=\"sh\" key=(null)\n", t, s);
+    fprintf(fp, "type=EXECVE msg=audit(%ld.107:%lu): argc=1 a0=\"x\"\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.107:%lu): item=0 name=2F746D702F6D7920782E7368 nametype=NORMAL\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.107:%lu): item=1 name=\"/lib64/ld-linux-x86-64.so.2\" nametype=NORMAL\n", t, s);
+    s = serial++;
+    fprintf(fp, "type=EXECVE msg=audit(%ld.108:%lu): argc=1 a0=\"y\"\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.108:%lu): item=0 name=\"/dev/shm/.y\" nametype=NORMAL\n", t, s);
+    s = serial++;
+    fprintf(fp, "type=EXECVE msg=audit(%ld.109:%lu): argc=2 a0=\"bash\" a1=\"-i\"\n", t, s);
+    fprintf(fp, "type=PATH msg=audit(%ld.109:%lu): item=0 name=\"/usr/bin/bash\" nametype=NORMAL\n", t, s);
+
+    s = serial++;
+    fprintf(fp, "type=AVC msg=audit(%ld.110:%lu): avc:  denied  { read } for pid=907 comm=\"httpd\"\n", t, s);
+    s = serial++;
+    fprintf(fp, "type=APPARMOR_DENIED msg=audit(%ld.111:%lu): operation=\"open\" name=\"/etc/x\"\n", t, s);
+    fprintf(fp, "garbage line\n");
+
+    return (size_t)(ftell(fp) - start);
+}
+
+static FILE* open_log(const char *path, const char *mode) {
+    FILE *fp = fopen(path, mode);
+    if (!fp) {
+        printf("FAIL: cannot write %s\n", path);
+        exit(1);
+    }
+    return fp;
+}
+
+static void check_counts(const char *label, const audit_summary_t *s, int n) {
+    char what[96];
+    int auth = n < 50 ? n : 50;     /* Last 100 USER_AUTH records, two per event */
+#define EXPECT(field, per) \
+    snprintf(what, sizeof(what), "%s: " #field, label); \
+    expect(what, s->field, (long)(per) * n)
+    EXPECT(sudo_count, 1);
+    EXPECT(su_count, 1);
+    EXPECT(tmp_executions, 1);
+    EXPECT(devshm_executions, 1);
+    EXPECT(shell_spawns, 1);
+    EXPECT(selinux_avc_denials, 1);
+    EXPECT(apparmor_denials, 1);
+#undef EXPECT
+    snprintf(what, sizeof(what), "%s: auth_failures", label);
+    expect(what, s->auth_failures, auth);
+    snprintf(what, sizeof(what), "%s: auth_successes", label);
+    expect(what, s->auth_successes, auth);
+    if (n > 0) {
+        snprintf(what, sizeof(what), "%s: sensitive files", label);
+        expect(what, s->sensitive_file_count, 1);
+        if (s->sensitive_file_count == 1 &&
+            (strcmp(s->sensitive_files[0].path, "/etc/shadow") != 0 ||
+             strcmp(s->sensitive_files[0].process, "vi") != 0 ||
+             s->sensitive_files[0].count != n)) {
+            printf("FAIL: %s: sensitive file %s by %s x%d\n", label,
+                   s->sensitive_files[0].path, s->sensitive_files[0].process,
+                   s->sensitive_files[0].count);
+            failures++;
+        }
+        snprintf(what, sizeof(what), "%s: failure users", label);
+        expect(what, s->failure_user_count, 1);
+    }
+}
+
+static long scan(audit_log_cursor_t *cursor, time_t since, audit_summary_t *s) {
+    memset(s, 0, sizeof(*s));
+    return audit_scan_log(log_path, cursor, since, s);
+}
+
+static void check_cursor(void) {
+    audit_log_cursor_t cursor = {0, 0, 0};
+    audit_summary_t *s = calloc(1, sizeof(*s));
+    char rotated[80];
+    long t = (long)time(NULL);
+
+    snprintf(rotated, sizeof(rotated), "%s.1", log_path);
+    unlink(rotated);
+
+    /* Two old events before since, two after */
+    FILE *fp = open_log(log_path, "w");
+    write_events(fp, t - 1000);
+    write_events(fp, t - 1000);
+    write_events(fp, t);
+    write_events(fp, t);
+    fclose(fp);
+    scan(&cursor, t - 10, s);
+    check_counts("first read", s, 2);
+
+    /* Nothing new */
+    expect("records with nothing new", scan(&cursor, 0, s), 0);
+    check_counts("nothing new", s, 0);
+
+    /* Appended, with a half-written record at the end */
+    fp = open_log(log_path, "a");
+    write_events(fp, t - 5000);
+    fprintf(fp, "type=USER_CMD msg=audit(%ld.200:%lu): exe=\"/usr/bin/sudo\"", t, serial++);
+    fclose(fp);
+    scan(&cursor, t, s);
+    check_counts("appended", s, 1);
+
+    /* Rotated: the rest of the old file, then the new one */
+    fp = open_log(log_path, "a");
+    fprintf(fp, " res=success'\n");
+    write_events(fp, t);
+    fclose(fp);
+    if (rename(log_path, rotated) != 0) {
+        printf("FAIL: cannot rotate %s\n", log_path);
+        failures++;
+    }
+    fp = open_log(log_path, "w");
+    write_events(fp, t);
+    fclose(fp);
+    scan(&cursor, t + 1000, s);
+    expect("rotated: sudo with completed record", s->sudo_count, 3);
+    s->sudo_count--;
+    check_counts("rotated", s, 2);
+
+    /* Truncated in place: everything from since again */
+    fp = open_log(log_path, "w");
+    write_events(fp, t - 1000);
+    fclose(fp);
+    scan(&cursor, t, s);
+    check_counts("truncated", s, 0);
+
+    unlink(rotated);
+    free(s);
+}
+
+int main(int argc, char *argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 64;
+    if (megabytes < 1) megabytes = 1;
+
+    snprintf(log_path, sizeof(log_path), "/tmp/bench_audit_%d.log", (int)getpid());
+    check_cursor();
+
+    /* Large log: same events, one pass */
+    FILE *fp = open_log(log_path, "w");
+    size_t bytes = 0;
+    int events = 0;
+    long t = (long)time(NULL);
+    while (bytes < megabytes << 20) {
+        bytes += write_events(fp, t);
+        events++;
+    }
+    fclose(fp);
+
+    audit_log_cursor_t cursor = {0, 0, 0};
+    audit_summary_t *s = calloc(1, sizeof(*s));
+    double start = now_us();
+    long records = scan(&cursor, 0, s);
+    double elapsed = now_us() - start;
+    check_counts("large log", s, events);
+    expect("large log: cursor at end", (long)cursor.offset, (long)bytes);
+
+    printf("Audit log reader (%zu MB synthetic log)\n", bytes >> 20);
+    printf("  one pass    %8.1f ms, %7.1f MB/s, %ld records\n",
+           elapsed / 1000.0, bytes / elapsed, records);
+
+    unlink(log_path);
+    free(s);
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
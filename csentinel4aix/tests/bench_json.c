@@ -0,0 +1,203 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_json.c - JSON serialization of a large synthetic fingerprint
+ *
+ * Builds a fingerprint with thousands of processes (a fifth of them
+ * notable, so they are all serialized), config files and sockets, then
+ * checks the fd, FILE* and memory sinks produce identical documents
+ * and times each. The fd sink writes to /dev/null, so the figure is
+ * pure formatting cost.
+ *
+ * Usage: bench_json [processes]   (default: 5000)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sentinel.h"
+#include "json_writer.h"
+
+#define BENCH_ITERATIONS 20
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static void build_fingerprint(fingerprint_t *fp, int processes) {
+    static const char *names[] = { "httpd", "sshd", "java", "postgres", "cron",
+                                   "name with \"quotes\"\tand tab" };
+    static const char states[] = { 'S', 'R', 'Z', 'D', 'S' };
+    char buf[64];
+
+    memset(fp, 0, sizeof(*fp));
+    arena_init(&fp->arena);
+    snprintf(fp->system.hostname, sizeof(fp->system.hostname), "bench-host");
+    snprintf(fp->system.kernel_version, sizeof(fp->system.kernel_version), "6.1.0");
+    fp->system.probe_time = 1735689600;
+    fp->system.uptime_seconds = 86400 * 42;
+    fp->system.load_avg[0] = 1.25;
+    fp->system.load_avg[1] = 0.5;
+    fp->system.load_avg[2] = 0.125;
+    fp->system.total_ram = 64ULL << 30;
+    fp->system.free_ram = 17ULL << 30;
+    fp->probe_duration_ms = 12.345;
+
+    fp->processes = arena_alloc(&fp->arena, processes * sizeof(process_info_t));
+    fp->process_count = processes;
+    for (int i = 0; i < processes; i++) {
+        process_info_t *p = &fp->processes[i];
+        memset(p, 0, sizeof(*p));
+        p->pid = 100 + i;
+        p->ppid = 1;
+        p->name = arena_intern(&fp->arena, names[i % 6]);
+        p->state = states[i % 5];
+        p->rss_bytes = (uint64_t)(i % 97) << 20;
+        p->open_fd_count = (uint32_t)(i % 50);
+        p->thread_count = (uint32_t)(1 + i % 16);
+        p->age_seconds = (uint64_t)i * 60;
+    }
+
+    fp->config_count = 64;
+    fp->configs = arena_alloc(&fp->arena, fp->config_count * sizeof(config_file_t));
+    for (int i = 0; i < fp->config_count; i++) {
+        config_file_t *c = &fp->configs[i];
+        memset(c, 0, sizeof(*c));
+        snprintf(buf, sizeof(buf), "/etc/bench/file%02d.conf", i);
+        c->path = arena_intern(&fp->arena, buf);
+        c->size = 1000 + i;
+        c->mtime = 1700000000 + i;
+        c->permissions = (i % 8 == 0) ? 0666 : 0644;
+        memset(c->checksum, 'a' + i % 6, 64);
+    }
+
+    network_info_t *net = &fp->network;
+    snprintf(net->backend, sizeof(net->backend), "netlink");
+    net->listener_count = net->total_listening = 200;
+    net->listeners = arena_alloc(&fp->arena, net->listener_count * sizeof(net_listener_t));
+    for (int i = 0; i < net->listener_count; i++) {
+        net_listener_t *l = &net->listeners[i];
+        memset(l, 0, sizeof(*l));
+        l->protocol = arena_intern(&fp->arena, i % 2 ? "tcp6" : "tcp");
+        l->local_addr = arena_intern(&fp->arena, i % 2 ? "::" : "0.0.0.0");
+        l->local_port = (uint16_t)(1024 + i);
+        l->pid = 100 + i;
+        l->process_name = fp->processes[i % processes].name;
+    }
+    net->connection_count = net->total_established = 2000;
+    net->connections = arena_alloc(&fp->arena,
+                                   net->connection_count * sizeof(net_connection_t));
+    for (int i = 0; i < net->connection_count; i++) {
+        net_connection_t *c = &net->connections[i];
+        memset(c, 0, sizeof(*c));
+        c->protocol = arena_intern(&fp->arena, "tcp");
+        c->local_addr = arena_intern(&fp->arena, "10.0.0.1");
+        c->local_port = 443;
+        snprintf(buf, sizeof(buf), "192.168.%d.%d", (i >> 8) & 255, i & 255);
+        c->remote_addr = arena_intern(&fp->arena, buf);
+        c->remote_port = (uint16_t)(30000 + i);
+        c->state = arena_intern(&fp->arena, "ESTABLISHED");
+        c->pid = 100 + i % processes;
+        c->process_name = fp->processes[i % processes].name;
+    }
+}
+
+static void write_document(json_writer_t *w, const fingerprint_t *fp) {
+    json_object_begin(w, NULL);
+    fingerprint_json_members(w, fp, 0);
+    json_object_end(w);
+}
+
+/* Whole contents of a FILE* written by the file sink */
+static char* slurp(FILE *f) {
+    long size = ftell(f);
+    char *s = malloc(size + 1);
+    if (!s) return NULL;
+    rewind(f);
+    if (fread(s, 1, size, f) != (size_t)size) {
+        free(s);
+        return NULL;
+    }
+    s[size] = '\0';
+    return s;
+}
+
+int main(int argc, char *argv[]) {
+    int processes = argc > 1 ? atoi(argv[1]) : 5000;
+    if (processes < 1) processes = 1;
+    int failures = 0;
+
+    fingerprint_t fp;
+    build_fingerprint(&fp, processes);
+
+    static json_writer_t w;
+
+    /* Every sink must produce the same bytes */
+    char *from_memory = fingerprint_to_json(&fp);
+    FILE *tmp = tmpfile();
+    char *from_file = NULL;
+    if (tmp) {
+        json_writer_file(&w, tmp);
+        write_document(&w, &fp);
+        if (json_writer_finish(&w) == 0) from_file = slurp(tmp);
+        fclose(tmp);
+    }
+    if (!from_memory || !from_file || strcmp(from_memory, from_file) != 0) {
+        printf("FAIL: memory and FILE* sinks disagree\n");
+        failures++;
+    }
+    if (from_memory && !strstr(from_memory, "\"name with \\\"quotes\\\"\\tand tab\"")) {
+        printf("FAIL: process name not escaped\n");
+        failures++;
+    }
+    size_t doc_size = from_memory ? strlen(from_memory) : 0;
+    free(from_memory);
+    free(from_file);
+
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull < 0) {
+        perror("/dev/null");
+        arena_free(&fp.arena);
+        return 1;
+    }
+
+    double fd_best = -1, mem_best = -1;
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        double start = now_us();
+        json_writer_fd(&w, devnull);
+        write_document(&w, &fp);
+        if (json_writer_finish(&w) != 0) failures++;
+        double elapsed = now_us() - start;
+        if (fd_best < 0 || elapsed < fd_best) fd_best = elapsed;
+
+        start = now_us();
+        char *doc = fingerprint_to_json(&fp);
+        elapsed = now_us() - start;
+        free(doc);
+        if (mem_best < 0 || elapsed < mem_best) mem_best = elapsed;
+    }
+    close(devnull);
+
+    printf("JSON serialization (%d processes, %d connections, %zu KB document, best of %d runs)\n",
+           processes, fp.network.connection_count, doc_size / 1024, BENCH_ITERATIONS);
+    printf("  fd sink       %10.1f us   %8.1f MB/s   (%d byte buffer)\n",
+           fd_best, doc_size / fd_best, JSON_WRITER_BUF_SIZE);
+    printf("  memory sink   %10.1f us   %8.1f MB/s\n",
+           mem_best, doc_size / mem_best);
+
+    arena_free(&fp.arena);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,454 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_log_writer.c - Buffered, rotating SIEM log file
+ *
+ * Checks that lines are held until a commit (explicit, buffer full, or
+ * flush_ms reached), that a line longer than the buffer goes out whole,
+ * and that rotation by size and by age keeps every line exactly once, in
+ * order, across PATH.keep ... PATH.1 and PATH, removing older segments
+ * (gzipped ones too when built with ZLIB=1). Then times a probe's worth
+ * of events at a time written with one write() per event, as before,
+ * against the writer committing once per probe, and (with zlib) the
+ * flush that rotates a 16 MB segment against its compression, which
+ * runs in the background.
+ *
+ * Usage: bench_log_writer [events]   (default: 200000)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "log_writer.h"
+
+#define EVENTS_PER_PROBE 40
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+static char dir[64];
+static char path[128];
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+/* An event line much like the SIEM JSON */
+static int make_line(char *buf, size_t size, int seq) {
+    return snprintf(buf, size,
+        "{\"timestamp\":\"2025-01-01T00:00:00Z\",\"source\":\"csentinel\",\"host\":\"aix01\","
+        "\"event\":\"auth_failure\",\"severity\":5,\"risk_score\":40,\"seq\":%d}", seq);
+}
+
+static long file_size(const char *p) {
+    struct stat st;
+    return stat(p, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void clean(void) {
+    char name[160];
+    unlink(path);
+    for (int n = 1; n <= 8; n++) {
+        snprintf(name, sizeof(name), "%s.%d", path, n);
+        unlink(name);
+        snprintf(name, sizeof(name), "%s.%d.gz", path, n);
+        unlink(name);
+    }
+}
+
+/*
+ * Read the "seq" of every line in a segment, checking each follows the
+ * last. Returns the lines read, or -1 if the file is missing.
+ */
+static long check_segment(const char *name, int gz, int *next) {
+    char line[4096];
+    long count = 0;
+    FILE *f;
+
+#ifdef HAVE_ZLIB
+    if (gz) {
+        gzFile g = gzopen(name, "rb");
+        if (!g) return -1;
+        while (gzgets(g, line, sizeof(line))) {
+            const char *s = strstr(line, "\"seq\":");
+            if (!s || atoi(s + 6) != *next) {
+                printf("FAIL: %s: line %ld is not seq %d\n", name, count, *next);
+                failures++;
+                break;
+            }
+            (*next)++;
+            count++;
+        }
+        gzclose(g);
+        return count;
+    }
+#endif
+    (void)gz;
+    f = fopen(name, "r");
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        const char *s = strstr(line, "\"seq\":");
+        if (!s || atoi(s + 6) != *next || line[strlen(line) - 1] != '\n') {
+            printf("FAIL: %s: line %ld is not seq %d\n", name, count, *next);
+            failures++;
+            break;
+        }
+        (*next)++;
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/* PATH.keep ... PATH.1, PATH: every line from first to last, once */
+static void check_chain(const char *label, int keep, int gz, int last) {
+    char name[160], what[256];
+    int next = -1;
+    long total = 0;
+
+    for (int n = keep; n >= 0; n--) {
+        if (n) snprintf(name, sizeof(name), "%s.%d%s", path, n, gz ? ".gz" : "");
+        else snprintf(name, sizeof(name), "%s", path);
+
+        if (next < 0) {
+            /* The oldest kept segment may start anywhere */
+            char line[512];
+            FILE *f;
+#ifdef HAVE_ZLIB
+            if (gz && n) {
+                gzFile g = gzopen(name, "rb");
+                if (!g || !gzgets(g, line, sizeof(line))) line[0] = '\0';
+                if (g) gzclose(g);
+            } else
+#endif
+            {
+                f = fopen(name, "r");
+                if (!f || !fgets(line, sizeof(line), f)) line[0] = '\0';
+                if (f) fclose(f);
+            }
+            const char *s = strstr(line, "\"seq\":");
+            next = s ? atoi(s + 6) : 0;
+        }
+
+        long got = check_segment(name, gz && n, &next);
+        snprintf(what, sizeof(what), "%s: %s present", label, name);
+        expect(what, got >= 0, 1);
+        if (got > 0) total += got;
+    }
+    snprintf(what, sizeof(what), "%s: last line", label);
+    expect(what, next - 1, last);
+
+    snprintf(name, sizeof(name), "%s.%d%s", path, keep + 1, gz ? ".gz" : "");
+    snprintf(what, sizeof(what), "%s: %s removed", label, name);
+    expect(what, file_size(name), -1);
+    snprintf(name, sizeof(name), "%s.1", path);
+    if (gz) {
+        snprintf(what, sizeof(what), "%s: %s compressed away", label, name);
+        expect(what, file_size(name), -1);
+    }
+    (void)total;
+}
+
+static void test_commit(void) {
+    log_writer_t w;
+    log_writer_opts_t opts;
+    char line[512];
+    int next;
+
+    clean();
+    log_writer_defaults(&opts);
+    opts.flush_ms = 60000;
+    expect("open", log_writer_open(&w, path, &opts), 0);
+    for (int i = 0; i < 10; i++) {
+        int len = make_line(line, sizeof(line), i);
+        log_writer_append(&w, line, (size_t)len);
+    }
+    expect("bytes before commit", file_size(path), 0);
+    log_writer_flush(&w);
+    expect("commits", (long)w.commits, 1);
+    next = 0;
+    expect("lines after commit", check_segment(path, 0, &next), 10);
+    log_writer_close(&w);
+
+    /* Buffer full */
+    clean();
+    opts.buffer_size = 1024;
+    log_writer_open(&w, path, &opts);
+    for (int i = 0; i < 100; i++) {
+        int len = make_line(line, sizeof(line), i);
+        log_writer_append(&w, line, (size_t)len);
+    }
+    expect("commits on a full buffer", w.commits >= 10 && w.commits <= 20, 1);
+    {
+        long held = 0;
+        for (size_t i = 0; i < w.len; i++) held += w.buf[i] == '\n';
+        next = 0;
+        expect("whole lines committed", check_segment(path, 0, &next) + held, 100);
+    }
+    log_writer_close(&w);
+    next = 0;
+    expect("lines after close", check_segment(path, 0, &next), 100);
+
+    /* Oldest line older than flush_ms */
+    clean();
+    opts.buffer_size = LOG_WRITER_BUFFER;
+    opts.flush_ms = 50;
+    log_writer_open(&w, path, &opts);
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 0));
+    expect("held within flush_ms", file_size(path), 0);
+    usleep(60000);
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 1));
+    expect("committed after flush_ms", (long)w.commits, 1);
+    next = 0;
+    expect("lines after flush_ms", check_segment(path, 0, &next), 2);
+    log_writer_close(&w);
+
+    /* A line longer than the buffer */
+    clean();
+    opts.buffer_size = 1024;
+    opts.flush_ms = 60000;
+    log_writer_open(&w, path, &opts);
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 0));
+    {
+        char big[3000];
+        int len = make_line(big, sizeof(big), 1);
+        memset(big + len, ' ', sizeof(big) - len);
+        memcpy(big + sizeof(big) - 2, "x}", 2);
+        log_writer_append(&w, big, sizeof(big));
+    }
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 2));
+    log_writer_close(&w);
+    next = 0;
+    expect("lines around a long one", check_segment(path, 0, &next), 3);
+    expect("long line size", file_size(path), 2 * (long)(strlen(line) + 1) + 3001);
+
+    /* Reopening appends and counts what is there */
+    log_writer_open(&w, path, NULL);
+    expect("size on reopen", (long)w.size, file_size(path));
+    log_writer_close(&w);
+}
+
+static void run_rotation(const char *label, int compress) {
+    log_writer_t w;
+    log_writer_opts_t opts;
+    char line[512], name[160], what[128];
+    int seq = 0;
+
+    clean();
+    log_writer_defaults(&opts);
+    opts.max_bytes = 8192;
+    opts.keep = 3;
+    opts.compress = compress;
+    log_writer_open(&w, path, &opts);
+    for (int p = 0; p < 100; p++) {
+        for (int i = 0; i < 10; i++, seq++) {
+            int len = make_line(line, sizeof(line), seq);
+            log_writer_append(&w, line, (size_t)len);
+        }
+        log_writer_flush(&w);
+    }
+    log_writer_close(&w);
+
+    snprintf(what, sizeof(what), "%s: rotations", label);
+    expect(what, w.rotations > 3, 1);
+    snprintf(what, sizeof(what), "%s: errors", label);
+    expect(what, (long)w.errors, 0);
+    check_chain(label, 3, compress, seq - 1);
+    if (!compress) {
+        snprintf(name, sizeof(name), "%s.1", path);
+        snprintf(what, sizeof(what), "%s: rotated at max_bytes", label);
+        expect(what, file_size(name) >= 8192 && file_size(name) < 8192 + 2048, 1);
+    }
+
+    /* Age: rotated at the next commit once the segment is old enough */
+    clean();
+    opts.max_bytes = 0;
+    opts.max_age_s = 3600;
+    log_writer_open(&w, path, &opts);
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 0));
+    log_writer_flush(&w);
+    snprintf(what, sizeof(what), "%s: young segment kept", label);
+    expect(what, (long)w.rotations, 0);
+    w.segment_start -= 3600;
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 1));
+    log_writer_flush(&w);
+    snprintf(what, sizeof(what), "%s: old segment rotated", label);
+    expect(what, (long)w.rotations, 1);
+    log_writer_append(&w, line, (size_t)make_line(line, sizeof(line), 2));
+    log_writer_close(&w);
+    check_chain(label, 1, compress, 2);
+
+    /* A restart keeps the age of the segment, from the last rotation */
+    log_writer_open(&w, path, &opts);
+    snprintf(what, sizeof(what), "%s: segment age on reopen", label);
+    expect(what, time(NULL) - w.segment_start < 5, 1);
+    log_writer_close(&w);
+}
+
+static void test_opts(void) {
+    log_writer_opts_t o;
+
+    log_writer_defaults(&o);
+    expect("parse", log_writer_parse_opts(&o, "size=50,age=24,keep=7,gzip,fsync=commit,flush=200"), 0);
+    expect("size", (long)(o.max_bytes / (1024 * 1024)), 50);
+    expect("age", o.max_age_s, 24 * 3600);
+    expect("keep", o.keep, 7);
+    expect("gzip", o.compress, 1);
+    expect("fsync", o.fsync, LOG_FSYNC_COMMIT);
+    expect("flush", o.flush_ms, 200);
+    expect("empty spec", log_writer_parse_opts(&o, ""), 0);
+    expect("unknown item", log_writer_parse_opts(&o, "size=5,colour=red"), -1);
+    expect("bad number", log_writer_parse_opts(&o, "size=5M"), -1);
+    expect("keep too large", log_writer_parse_opts(&o, "keep=1000"), -1);
+    expect("bad fsync", log_writer_parse_opts(&o, "fsync=always"), -1);
+    expect("gzip with a value", log_writer_parse_opts(&o, "gzip=9"), -1);
+}
+
+/* ============================================================
+ * Timing
+ * ============================================================ */
+
+static double time_write_per_event(int events) {
+    char line[512];
+    double t0;
+    int fd;
+
+    clean();
+    fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0640);
+    t0 = now_us();
+    for (int i = 0; i < events; i++) {
+        int len = make_line(line, sizeof(line) - 1, i);
+        line[len++] = '\n';
+        if (write(fd, line, (size_t)len) != len) failures++;
+    }
+    close(fd);
+    return now_us() - t0;
+}
+
+static double time_writer(int events, unsigned long *commits) {
+    log_writer_t w;
+    char line[512];
+    double t0;
+    int next = 0;
+
+    clean();
+    log_writer_open(&w, path, NULL);
+    t0 = now_us();
+    for (int i = 0; i < events; i++) {
+        int len = make_line(line, sizeof(line), i);
+        log_writer_append(&w, line, (size_t)len);
+        if ((i + 1) % EVENTS_PER_PROBE == 0) log_writer_flush(&w);
+    }
+    log_writer_close(&w);
+    t0 = now_us() - t0;
+    *commits = w.commits;
+
+    expect("timed run: lines", check_segment(path, 0, &next), events);
+    return t0;
+}
+
+#ifdef HAVE_ZLIB
+/* The flush that rotates returns before the segment is compressed */
+static double time_gzip_rotation(double *compress_us) {
+    log_writer_t w;
+    log_writer_opts_t opts;
+    char line[512], name[160];
+    double flush_us = 0, t0;
+    int seq = 0;
+
+    clean();
+    log_writer_defaults(&opts);
+    opts.max_bytes = 16ULL * 1024 * 1024;
+    opts.compress = 1;
+    log_writer_open(&w, path, &opts);
+    while (w.rotations == 0) {
+        for (int i = 0; i < EVENTS_PER_PROBE; i++, seq++) {
+            int len = make_line(line, sizeof(line), seq);
+            log_writer_append(&w, line, (size_t)len);
+        }
+        t0 = now_us();
+        log_writer_flush(&w);
+        flush_us = now_us() - t0;
+    }
+    t0 = now_us();
+    log_writer_close(&w);
+    *compress_us = now_us() - t0;
+
+    expect("16 MB gzip rotation: errors", (long)w.errors, 0);
+    snprintf(name, sizeof(name), "%s.1", path);
+    expect("16 MB gzip rotation: plain segment removed", file_size(name), -1);
+    snprintf(name, sizeof(name), "%s.1.gz", path);
+    expect("16 MB gzip rotation: compressed", file_size(name) > 0, 1);
+    return flush_us;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    int events = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned long commits = 0;
+    double per_event, writer;
+
+    if (events < EVENTS_PER_PROBE) events = EVENTS_PER_PROBE;
+
+    snprintf(dir, sizeof(dir), "/tmp/bench_logw.XXXXXX");
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/sentinel.log", dir);
+
+    test_opts();
+    test_commit();
+    run_rotation("rotation", 0);
+#ifdef HAVE_ZLIB
+    run_rotation("gzip rotation", 1);
+#endif
+
+    per_event = time_write_per_event(events);
+    writer = time_writer(events, &commits);
+#ifdef HAVE_ZLIB
+    double compress_us;
+    double rotate_us = time_gzip_rotation(&compress_us);
+#endif
+
+    clean();
+    rmdir(dir);
+
+    printf("SIEM log file (%d events, %d per probe)\n", events, EVENTS_PER_PROBE);
+    printf("  %-28s %8.3f us per event, %8d write()s\n", "write() per event",
+           per_event / events, events);
+    printf("  %-28s %8.3f us per event, %8lu write()s\n", "buffered, commit per probe",
+           writer / events, commits);
+#ifdef HAVE_ZLIB
+    printf("  %-28s %8.0f us, compression waited at close %.0f us\n",
+           "flush rotating 16 MB, gzip", rotate_us, compress_us);
+#else
+    printf("  (built without zlib: gzip rotation not checked)\n");
+#endif
+
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,470 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_metrics.c - Prometheus exporter page and /metrics server
+ *
+ * Checks the rendered page is well formed (every sample after its
+ * family's HELP and TYPE, label values escaped, "# EOF" last) and that
+ * the server answers 503 before the first page, GET and HEAD on
+ * /metrics, 404 and 405, keeps connections alive, answers pipelined
+ * requests in order, honours Connection: close and HTTP/1.0, rejects
+ * an oversized request, and finishes a response from the page it
+ * started with while a new one is published. Then times a render, a
+ * scrape on a new and on a kept-alive connection, and scrapers in
+ * parallel; given the sentinel binary, also a capture per scrape.
+ *
+ * Usage: bench_metrics [path/to/sentinel]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "sentinel.h"
+#include "metrics.h"
+
+#define SCRAPES 2000
+#define SCRAPER_THREADS 8
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+static int port;
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+static void build_fingerprint(fingerprint_t *fp) {
+    memset(fp, 0, sizeof(*fp));
+    arena_init(&fp->arena);
+    snprintf(fp->system.hostname, sizeof(fp->system.hostname), "bench\"host\\\n");
+    snprintf(fp->system.kernel_version, sizeof(fp->system.kernel_version), "AIX 7.3");
+    fp->system.probe_time = 1735689600;
+    fp->system.uptime_seconds = 86400 * 42;
+    fp->system.load_avg[0] = 1.25;
+    fp->system.total_ram = 64ULL << 30;
+    fp->system.free_ram = 17ULL << 30;
+    fp->process_count = 812;
+    fp->config_count = 12;
+    fp->probe_duration_ms = 12.5;
+}
+
+/* ============================================================
+ * Page checks
+ * ============================================================ */
+
+/* Family names seen, in order; a sample must belong to the last one */
+static void check_page(const char *label, const metrics_page_t *page) {
+    char family[128] = "";
+    char what[160];
+    const char *line = page->data;
+    const char *end = page->data + page->len;
+    int bad = 0, eof = 0, samples = 0;
+
+    while (line < end && !bad) {
+        const char *nl = memchr(line, '\n', (size_t)(end - line));
+        if (!nl) {
+            bad = 1;
+            break;
+        }
+        size_t len = (size_t)(nl - line);
+
+        if (eof) {
+            bad = 1;                            /* Anything after "# EOF" */
+        } else if (len == 5 && memcmp(line, "# EOF", 5) == 0) {
+            eof = 1;
+        } else if (strncmp(line, "# HELP ", 7) == 0) {
+            size_t n = strcspn(line + 7, " \n");
+            if (n >= sizeof(family)) n = sizeof(family) - 1;
+            memcpy(family, line + 7, n);
+            family[n] = '\0';
+        } else if (strncmp(line, "# TYPE ", 7) == 0) {
+            size_t n = strlen(family);
+            if (strncmp(line + 7, family, n) != 0 || strncmp(line + 7 + n, " gauge\n", 7) != 0)
+                bad = 1;
+        } else {
+            size_t n = strlen(family);
+            char *num_end;
+            const char *value = memrchr(line, ' ', len);
+            if (!family[0] || strncmp(line, family, n) != 0 ||
+                (line[n] != ' ' && line[n] != '{') || !value) {
+                bad = 1;
+            } else {
+                strtod(value + 1, &num_end);
+                if (num_end != nl) bad = 1;
+            }
+            samples++;
+        }
+        if (bad) printf("FAIL: %s: bad line: %.*s\n", label, (int)len, line);
+        line = nl + 1;
+    }
+    snprintf(what, sizeof(what), "%s: well formed", label);
+    expect(what, bad, 0);
+    snprintf(what, sizeof(what), "%s: ends with # EOF", label);
+    expect(what, eof, 1);
+    snprintf(what, sizeof(what), "%s: has samples", label);
+    expect(what, samples > 20, 1);
+}
+
+static void test_render(void) {
+    fingerprint_t fp;
+    quick_analysis_t analysis;
+    deviation_report_t report;
+    metrics_input_t in;
+    metrics_page_t *page;
+
+    build_fingerprint(&fp);
+    memset(&analysis, 0, sizeof(analysis));
+    analysis.zombie_process_count = 2;
+    memset(&report, 0, sizeof(report));
+    report.new_listeners = 3;
+
+    memset(&in, 0, sizeof(in));
+    in.fp = &fp;
+    in.analysis = &analysis;
+    in.status = EXIT_CRITICAL;
+    in.refreshes = 7;
+
+    page = metrics_render(&in);
+    expect("render", page != NULL, 1);
+    if (!page) return;
+    check_page("no baseline", page);
+    expect("hostname escaped",
+           strstr(page->data, "hostname=\"bench\\\"host\\\\\\n\"") != NULL, 1);
+    expect("status", strstr(page->data, "\nsentinel_status 2\n") != NULL, 1);
+    expect("zombies", strstr(page->data, "\nsentinel_zombie_processes 2\n") != NULL, 1);
+    expect("memory bytes", strstr(page->data, "\nsentinel_memory_total_bytes 68719476736\n") != NULL, 1);
+    expect("no baseline", strstr(page->data, "\nsentinel_baseline_loaded 0\n") != NULL, 1);
+    expect("no deviations", strstr(page->data, "sentinel_baseline_deviations{") == NULL, 1);
+    expect("no audit", strstr(page->data, "sentinel_audit_") == NULL, 1);
+    metrics_page_free(page);
+
+    in.deviations = &report;
+    page = metrics_render(&in);
+    if (page) {
+        check_page("baseline", page);
+        expect("deviations",
+               strstr(page->data, "\nsentinel_baseline_deviations{kind=\"new_listeners\"} 3\n") != NULL, 1);
+        metrics_page_free(page);
+    }
+    arena_free(&fp.arena);
+}
+
+/* ============================================================
+ * Server checks
+ * ============================================================ */
+
+static int connect_server(void) {
+    struct sockaddr_in sa;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons((uint16_t)port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static void send_all(int fd, const char *data) {
+    size_t len = strlen(data);
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/*
+ * Read one response into body (up to size); returns the status, or -1
+ * if the connection closed first. *closed is set if the server said
+ * Connection: close.
+ */
+typedef struct {
+    char buf[1 << 16];
+    size_t len;
+} reader_t;
+
+static int read_response(int fd, reader_t *r, char *body, size_t size, size_t *body_len,
+                         int head_only, int *closed) {
+    char *end;
+    while (!(end = memmem(r->buf, r->len, "\r\n\r\n", 4))) {
+        ssize_t n = recv(fd, r->buf + r->len, sizeof(r->buf) - r->len, 0);
+        if (n <= 0) return -1;
+        r->len += (size_t)n;
+    }
+    size_t head_len = (size_t)(end + 4 - r->buf);
+    char head[1024];
+    snprintf(head, sizeof(head), "%.*s", (int)head_len, r->buf);
+    int status = atoi(head + 9);
+    const char *cl = strstr(head, "Content-Length: ");
+    size_t need = cl ? strtoul(cl + 16, NULL, 10) : 0;
+    if (head_only) need = 0;
+    if (closed) *closed = strstr(head, "Connection: close") != NULL;
+
+    memmove(r->buf, r->buf + head_len, r->len - head_len);
+    r->len -= head_len;
+
+    size_t got = 0;
+    while (got < need) {
+        if (r->len == 0) {
+            ssize_t n = recv(fd, r->buf, sizeof(r->buf), 0);
+            if (n <= 0) return -1;
+            r->len = (size_t)n;
+        }
+        size_t take = need - got < r->len ? need - got : r->len;
+        if (body && got + take <= size) memcpy(body + got, r->buf, take);
+        got += take;
+        memmove(r->buf, r->buf + take, r->len - take);
+        r->len -= take;
+    }
+    if (body_len) *body_len = got;
+    return status;
+}
+
+/* One request on a fresh connection */
+static int request(const char *req, char *body, size_t size, size_t *body_len) {
+    static reader_t r;
+    int fd = connect_server();
+    if (fd < 0) return -1;
+    r.len = 0;
+    send_all(fd, req);
+    int status = read_response(fd, &r, body, size, body_len, strncmp(req, "HEAD", 4) == 0, NULL);
+    close(fd);
+    return status;
+}
+
+static int peer_closed(int fd) {
+    char c;
+    struct timeval tv = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return recv(fd, &c, 1, 0) == 0;
+}
+
+static metrics_page_t *make_page(size_t len, char fill) {
+    metrics_page_t *p = calloc(1, sizeof(*p));
+    p->data = malloc(len + 1);
+    memset(p->data, fill, len);
+    p->data[len] = '\0';
+    p->len = p->cap = len;
+    p->refs = 1;
+    return p;
+}
+
+static const char GET[] = "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n";
+
+static void test_server(metrics_server_t *s) {
+    static char body[1 << 23];
+    static reader_t r;
+    size_t len = 0;
+    int fd, closed;
+
+    expect("503 before the first page", request(GET, NULL, 0, NULL), 503);
+
+    metrics_page_t *page = make_page(1000, 'a');
+    metrics_server_publish(s, page);
+    expect("GET", request(GET, body, sizeof(body), &len), 200);
+    expect("GET body", len == 1000 && body[0] == 'a' && body[999] == 'a', 1);
+    expect("query string", request("GET /metrics?x=1 HTTP/1.1\r\n\r\n", NULL, 0, NULL), 200);
+    expect("HEAD", request("HEAD /metrics HTTP/1.1\r\n\r\n", NULL, 0, &len), 200);
+    expect("HEAD body", (long)len, 0);
+    expect("index", request("GET / HTTP/1.1\r\n\r\n", NULL, 0, NULL), 200);
+    expect("404", request("GET /other HTTP/1.1\r\n\r\n", NULL, 0, NULL), 404);
+    expect("400", request("nonsense\r\n\r\n", NULL, 0, NULL), 400);
+
+    /* 405 closes the connection */
+    fd = connect_server();
+    r.len = 0;
+    send_all(fd, "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    expect("405", read_response(fd, &r, NULL, 0, NULL, 0, &closed), 405);
+    expect("405 closes", peer_closed(fd), 1);
+    close(fd);
+
+    /* Keep-alive, then pipelined, then Connection: close */
+    unsigned long before = s->connections;
+    fd = connect_server();
+    r.len = 0;
+    for (int i = 0; i < 3; i++) {
+        send_all(fd, GET);
+        expect("kept alive", read_response(fd, &r, NULL, 0, NULL, 0, &closed), 200);
+        expect("not closed", closed, 0);
+    }
+    send_all(fd, "GET /metrics HTTP/1.1\r\n\r\nGET /nope HTTP/1.1\r\n\r\nHEAD /metrics HTTP/1.1\r\n\r\n");
+    expect("pipelined 1", read_response(fd, &r, NULL, 0, NULL, 0, NULL), 200);
+    expect("pipelined 2", read_response(fd, &r, NULL, 0, NULL, 0, NULL), 404);
+    expect("pipelined 3", read_response(fd, &r, NULL, 0, NULL, 1, NULL), 200);
+    send_all(fd, "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+    expect("close", read_response(fd, &r, NULL, 0, NULL, 0, &closed), 200);
+    expect("close acknowledged", closed, 1);
+    expect("closed after close", peer_closed(fd), 1);
+    close(fd);
+    expect("one connection", (long)(s->connections - before), 1);
+
+    fd = connect_server();
+    r.len = 0;
+    send_all(fd, "GET /metrics HTTP/1.0\r\n\r\n");
+    expect("HTTP/1.0", read_response(fd, &r, NULL, 0, NULL, 0, NULL), 200);
+    expect("HTTP/1.0 closes", peer_closed(fd), 1);
+    close(fd);
+
+    /* Oversized request head */
+    {
+        static char big[METRICS_REQUEST_MAX + 100];
+        memcpy(big, "GET /metrics HTTP/1.1\r\nX: ", 26);
+        memset(big + 26, 'x', sizeof(big) - 27);
+        big[sizeof(big) - 1] = '\0';
+        fd = connect_server();
+        r.len = 0;
+        send_all(fd, big);
+        expect("431", read_response(fd, &r, NULL, 0, NULL, 0, NULL), 431);
+        close(fd);
+    }
+
+    /* A new page mid-response: the response finishes from the old one */
+    metrics_server_publish(s, make_page(6 << 20, 'b'));
+    fd = connect_server();
+    r.len = 0;
+    send_all(fd, GET);
+    usleep(50000);                              /* Let the socket buffers fill */
+    metrics_server_publish(s, make_page(100, 'c'));
+    expect("old page", read_response(fd, &r, body, sizeof(body), &len, 0, NULL), 200);
+    {
+        size_t i = 0;
+        while (i < len && body[i] == 'b') i++;
+        expect("old page intact", (long)i, 6 << 20);
+    }
+    send_all(fd, GET);
+    expect("new page", read_response(fd, &r, body, sizeof(body), &len, 0, NULL), 200);
+    expect("new page body", len == 100 && body[0] == 'c', 1);
+    close(fd);
+}
+
+/* ============================================================
+ * Timing
+ * ============================================================ */
+
+static void *scraper(void *arg) {
+    long *done = arg;
+    reader_t *r = calloc(1, sizeof(*r));
+    int fd = connect_server();
+    for (int i = 0; i < SCRAPES / SCRAPER_THREADS * 4; i++) {
+        send_all(fd, GET);
+        if (read_response(fd, r, NULL, 0, NULL, 0, NULL) != 200) break;
+        (*done)++;
+    }
+    close(fd);
+    free(r);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    metrics_server_t server;
+    metrics_input_t in;
+    fingerprint_t fp;
+    quick_analysis_t analysis;
+    metrics_page_t *page;
+    struct sockaddr_in sa;
+    socklen_t sa_len = sizeof(sa);
+    static reader_t r;
+    double t0, render_us, fresh_us, kept_us, parallel_us, capture_us = 0;
+    long done[SCRAPER_THREADS] = {0}, total = 0;
+    size_t page_len;
+
+    test_render();
+
+    if (metrics_server_start(&server, "127.0.0.1:0") != 0) return 1;
+    getsockname(server.listen_fd, (struct sockaddr *)&sa, &sa_len);
+    port = ntohs(sa.sin_port);
+    test_server(&server);
+
+    /* A realistic page */
+    build_fingerprint(&fp);
+    memset(&analysis, 0, sizeof(analysis));
+    memset(&in, 0, sizeof(in));
+    in.fp = &fp;
+    in.analysis = &analysis;
+    t0 = now_us();
+    for (int i = 0; i < SCRAPES; i++) {
+        page = metrics_render(&in);
+        if (i < SCRAPES - 1) metrics_page_free(page);
+    }
+    render_us = (now_us() - t0) / SCRAPES;
+    page_len = page->len;
+    metrics_server_publish(&server, page);
+    arena_free(&fp.arena);
+
+    t0 = now_us();
+    for (int i = 0; i < SCRAPES / 4; i++) {
+        if (request(GET, NULL, 0, NULL) != 200) failures++;
+    }
+    fresh_us = (now_us() - t0) / (SCRAPES / 4);
+
+    int fd = connect_server();
+    t0 = now_us();
+    for (int i = 0; i < SCRAPES; i++) {
+        send_all(fd, GET);
+        if (read_response(fd, &r, NULL, 0, NULL, 0, NULL) != 200) failures++;
+    }
+    kept_us = (now_us() - t0) / SCRAPES;
+    close(fd);
+
+    pthread_t threads[SCRAPER_THREADS];
+    t0 = now_us();
+    for (int i = 0; i < SCRAPER_THREADS; i++) pthread_create(&threads[i], NULL, scraper, &done[i]);
+    for (int i = 0; i < SCRAPER_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        total += done[i];
+    }
+    parallel_us = now_us() - t0;
+    expect("parallel scrapes", total, (long)(SCRAPES / SCRAPER_THREADS * 4 * SCRAPER_THREADS));
+
+    metrics_server_stop(&server);
+
+    if (argc > 1) {
+        char cmd[600];
+        snprintf(cmd, sizeof(cmd), "%s -j >/dev/null 2>&1", argv[1]);
+        t0 = now_us();
+        for (int i = 0; i < 5; i++) {
+            if (system(cmd) == -1) failures++;
+        }
+        capture_us = (now_us() - t0) / 5;
+    }
+
+    printf("Metrics exporter (%lu byte page)\n", (unsigned long)page_len);
+    printf("  %-34s %10.1f us\n", "render (once per refresh)", render_us);
+    printf("  %-34s %10.1f us per scrape\n", "scrape, new connection", fresh_us);
+    printf("  %-34s %10.1f us per scrape\n", "scrape, kept-alive", kept_us);
+    printf("  %-34s %10.1f us per scrape (%d scrapers)\n", "scrape, in parallel",
+           parallel_us / total, SCRAPER_THREADS);
+    if (capture_us > 0) {
+        printf("  %-34s %10.1f us per scrape\n", "fork and capture (sentinel -j)", capture_us);
+    }
+
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_net_probe.c - Compare the netlink and procfs network backends
+ *
+ * Opens N listening TCP sockets on loopback, then times
+ * probe_network_with() on each backend and checks that both
+ * report the same listener and connection counts.
+ *
+ * Usage: bench_net_probe [sockets...]   (default: 10000 100000)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "sentinel.h"
+
+#define BENCH_ITERATIONS 5
+#define PORTS_PER_ADDR 20000    /* Stay inside the ephemeral range per address */
+#define MAX_HOLDERS 64
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Open count listeners spread over 127.0.0.1, 127.0.0.2, ... from first */
+static int open_listeners(int first, int count) {
+    int opened = 0;
+    for (int i = first; i < first + count; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) break;
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = 0;
+        addr.sin_addr.s_addr = htonl(0x7F000001u + (uint32_t)(i / PORTS_PER_ADDR));
+
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+            close(fd);
+            break;
+        }
+        opened++;
+    }
+    return opened;
+}
+
+/*
+ * The socket table is system-wide, so the listeners are held by child
+ * processes. That keeps each one under RLIMIT_NOFILE and leaves the
+ * parent's descriptors free for the probe itself.
+ */
+static int spawn_holders(int sockets, pid_t *holders, int max_holders, int *holder_count) {
+    struct rlimit rl;
+    int per_holder = PORTS_PER_ADDR;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+        (int)rl.rlim_cur - 64 < per_holder) {
+        per_holder = (int)rl.rlim_cur - 64;
+    }
+
+    int total = 0;
+    *holder_count = 0;
+    while (total < sockets && *holder_count < max_holders) {
+        int want = sockets - total < per_holder ? sockets - total : per_holder;
+        int ready[2];
+        if (pipe(ready) != 0) break;
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(ready[0]);
+            close(ready[1]);
+            break;
+        }
+        if (pid == 0) {
+            close(ready[0]);
+            int opened = open_listeners(total, want);
+            if (write(ready[1], &opened, sizeof(opened)) != sizeof(opened)) _exit(1);
+            close(ready[1]);
+            pause();
+            _exit(0);
+        }
+
+        close(ready[1]);
+        int opened = 0;
+        if (read(ready[0], &opened, sizeof(opened)) != sizeof(opened)) opened = 0;
+        close(ready[0]);
+
+        holders[(*holder_count)++] = pid;
+        total += opened;
+        if (opened < want) break;
+    }
+    return total;
+}
+
+static void stop_holders(const pid_t *holders, int holder_count) {
+    for (int i = 0; i < holder_count; i++) {
+        kill(holders[i], SIGTERM);
+        waitpid(holders[i], NULL, 0);
+    }
+}
+
+static double bench_backend(net_backend_t backend, arena_t *arena, network_info_t *net) {
+    double best = -1;
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        /* Fresh arena per run so every run pays for its own allocations */
+        arena_free(arena);
+        double start = now_ms();
+        if (probe_network_with(arena, net, backend) != 0 && backend == NET_BACKEND_NETLINK) {
+            return -1;
+        }
+        double elapsed = now_ms() - start;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static int run_size(int sockets) {
+    pid_t holders[MAX_HOLDERS];
+    int holder_count = 0;
+
+    int opened = spawn_holders(sockets, holders, MAX_HOLDERS, &holder_count);
+    if (opened < sockets) {
+        fprintf(stderr, "  note: only %d of %d sockets could be opened\n", opened, sockets);
+    }
+
+    /* One snapshot for both backends; attribution cost is identical */
+    proc_snapshot_request(PROC_SNAP_SOCKETS);
+    proc_snapshot_refresh();
+
+    arena_t netlink_arena, procfs_arena;
+    network_info_t via_netlink, via_procfs;
+    arena_init(&netlink_arena);
+    arena_init(&procfs_arena);
+    double netlink_ms = bench_backend(NET_BACKEND_NETLINK, &netlink_arena, &via_netlink);
+    double procfs_ms = bench_backend(NET_BACKEND_PROCFS, &procfs_arena, &via_procfs);
+
+    printf("%8d sockets:  netlink %9.2f ms   procfs %9.2f ms", opened, netlink_ms, procfs_ms);
+    if (netlink_ms > 0) {
+        printf("   (%.1fx)", procfs_ms / netlink_ms);
+    }
+    printf("\n");
+
+    int mismatch = netlink_ms >= 0 &&
+                   (via_netlink.listener_count != via_procfs.listener_count ||
+                    via_netlink.connection_count != via_procfs.connection_count);
+    if (netlink_ms < 0) {
+        printf("  netlink backend unavailable\n");
+    } else if (mismatch) {
+        printf("  MISMATCH: netlink %d/%d vs procfs %d/%d listeners/connections\n",
+               via_netlink.listener_count, via_netlink.connection_count,
+               via_procfs.listener_count, via_procfs.connection_count);
+    }
+
+    stop_holders(holders, holder_count);
+    arena_free(&netlink_arena);
+    arena_free(&procfs_arena);
+    proc_snapshot_release();
+    return mismatch ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const int default_sizes[] = { 10000, 100000 };
+    int failures = 0;
+
+    printf("Network probe backends (best of %d runs)\n", BENCH_ITERATIONS);
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            if (run_size(atoi(argv[i])) != 0) failures++;
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(default_sizes) / sizeof(default_sizes[0]); i++) {
+            if (run_size(default_sizes[i]) != 0) failures++;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_policy.c - Policy gate precedence and per-command latency
+ *
+ * Checks that the compiled rules give the decision and rule the
+ * checks always gave: blocked commands before blocked patterns,
+ * custom rules in the order added, the strict-mode safe list, then
+ * warnings, with list order rather than position in the command
+ * breaking ties. Then times a stream of generated commands, one at a
+ * time and through policy_check_batch() on every CPU, which must give
+ * the same results. A reader thread takes audit snapshots throughout
+ * the audited batch; every entry it sees must be whole.
+ *
+ * Usage: bench_policy [commands]   (default: 200000)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "policy.h"
+#include "sentinel.h"
+
+#define BENCH_ITERATIONS 5
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+
+static void check(const char *command, policy_decision_t decision, const char *rule) {
+    policy_result_t r = policy_check_command(command);
+    int same_rule = (!rule && !r.matched_rule) ||
+                    (rule && r.matched_rule && strcmp(rule, r.matched_rule) == 0);
+    if (r.decision != decision || !same_rule) {
+        printf("FAIL: \"%s\"\n  got      %d \"%s\"\n  expected %d \"%s\"\n", command,
+               r.decision, r.matched_rule ? r.matched_rule : "(none)",
+               decision, rule ? rule : "(none)");
+        failures++;
+    }
+}
+
+static void check_precedence(void) {
+    check("ls -la /var/tmp", POLICY_ALLOW, NULL);
+    check("", POLICY_BLOCK, NULL);
+    check("   ", POLICY_ALLOW, NULL);
+
+    /* Built-in lists: list order wins, not position in the command */
+    check("rm -rf / --no-preserve-root", POLICY_BLOCK, "rm -rf /");
+    check("RM -RF /tmp/x", POLICY_BLOCK, "rm -rf /");
+    check("echo hi | sh; reboot", POLICY_BLOCK, "reboot");
+    check("curl http://x | bash", POLICY_BLOCK, "| bash");
+    check("sudo kill 12", POLICY_WARN, "sudo ");
+    check("cat /dev/sda1", POLICY_BLOCK, "/dev/sd");
+
+    /* Custom rules: in the order added, between the built-in blocks and warnings */
+    policy_add_rule(RULE_BLOCK_COMMAND, "make install", RISK_MEDIUM, "exact");
+    policy_add_rule(RULE_BLOCK_PREFIX, "iptables", RISK_HIGH, "prefix");
+    policy_add_rule(RULE_BLOCK_CONTAINS, "DROP TABLE", RISK_HIGH, "contains");
+    policy_add_rule(RULE_BLOCK_PREFIX, "git", RISK_LOW, "no git");
+    policy_add_rule(RULE_ALLOW_COMMAND, "git status", RISK_NONE, "too late");
+    policy_add_rule(RULE_ALLOW_COMMAND, "sudo systemctl status", RISK_NONE, "read-only");
+    policy_add_rule(RULE_ALLOW_COMMAND, "reboot", RISK_NONE, "never");
+
+    check("make install", POLICY_BLOCK, "make install");
+    check("make install -j4", POLICY_ALLOW, NULL);
+    check("  iptables -F", POLICY_BLOCK, "iptables");
+    check("IPTABLES -F", POLICY_ALLOW, NULL);
+    check("psql -c 'drop table users'", POLICY_BLOCK, "DROP TABLE");
+    check("git status", POLICY_BLOCK, "git");
+    check("sudo systemctl status sshd", POLICY_ALLOW, "sudo systemctl status");
+    check("Sudo systemctl status sshd", POLICY_WARN, "sudo ");
+    check("reboot now", POLICY_BLOCK, "reboot");
+
+    /* Strict mode: the safe list sees only the first word */
+    policy_set_mode(MODE_STRICT);
+    check("grep -r x /etc", POLICY_ALLOW, NULL);
+    check("vim /etc/hosts", POLICY_REVIEW, "STRICT_MODE");
+    check("ip addr show", POLICY_REVIEW, "STRICT_MODE");
+    check("sudo ls", POLICY_REVIEW, "STRICT_MODE");
+    check("git log", POLICY_BLOCK, "git");
+    policy_set_mode(MODE_PERMISSIVE);
+    check("sudo ls", POLICY_ALLOW, "sudo ");
+    policy_set_mode(MODE_NORMAL);
+
+    policy_clear_custom_rules();
+    check("git status", POLICY_ALLOW, NULL);
+    check("make install", POLICY_ALLOW, NULL);
+}
+
+/* Each entry must be the result its command gives */
+static int audit_consistent(const audit_entry_t *entries, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!entries[i].command) return 0;
+        policy_result_t r = policy_check_command(entries[i].command);
+        if (r.decision != entries[i].result.decision ||
+            r.matched_rule != entries[i].result.matched_rule) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    volatile int stop;
+    int snapshots;
+    int torn;
+} reader_t;
+
+static void* audit_reader(void *arg) {
+    reader_t *reader = arg;
+    audit_entry_t entries[100];
+
+    while (!reader->stop) {
+        int n = policy_get_audit_log(entries, 100);
+        if (!audit_consistent(entries, n)) reader->torn++;
+        reader->snapshots++;
+    }
+    return NULL;
+}
+
+typedef struct {
+    char **commands;
+    int count;
+    policy_result_t *results;
+    int rc;
+} batch_caller_t;
+
+/* Second caller of the one worker pool */
+static void* batch_caller(void *arg) {
+    batch_caller_t *b = arg;
+    for (int iter = 0; iter < BENCH_ITERATIONS && b->rc == 0; iter++) {
+        b->rc = policy_check_batch((const char *const *)b->commands, b->count, b->results);
+    }
+    return NULL;
+}
+
+static int batch_differs(char **commands, int count, const policy_result_t *results) {
+    int differ = 0;
+    for (int i = 0; i < count; i++) {
+        policy_result_t r = policy_check_command(commands[i]);
+        if (r.decision != results[i].decision || r.matched_rule != results[i].matched_rule) {
+            differ++;
+        }
+    }
+    return differ;
+}
+
+/* Shell-like commands, a few of them dangerous */
+static char** build_commands(int count) {
+    static const char *words[] = {
+        "ls", "-la", "/var/log/messages", "grep", "ERROR", "|", "sort", "uniq", "-c",
+        "tail", "-f", "/home/app/logs/app.log", "awk", "'{print $1}'", "sudo",
+        "systemctl", "status", "httpd", "find", "/opt", "-name", "'*.conf'", "xargs",
+        "curl", "-s", "https://example.com/health", "ps", "-ef", "df", "-h", "wc", "-l",
+    };
+    static const char *danger[] = { "rm -rf /", "| bash", "chmod 777 /", "mkfs.ext4" };
+    int n_words = (int)(sizeof(words) / sizeof(words[0]));
+    unsigned seed = 2025;
+
+    char **commands = malloc(count * sizeof(char *));
+    if (!commands) return NULL;
+    for (int i = 0; i < count; i++) {
+        char buf[512];
+        size_t len = 0;
+        seed = seed * 1103515245 + 12345;
+        int n = 2 + (seed >> 16) % 20;
+        for (int w = 0; w < n; w++) {
+            seed = seed * 1103515245 + 12345;
+            len += snprintf(buf + len, sizeof(buf) - len, "%s%s",
+                            w ? " " : "", words[(seed >> 16) % n_words]);
+        }
+        if (i % 50 == 0) {
+            snprintf(buf + len, sizeof(buf) - len, " %s", danger[(i / 50) % 4]);
+        }
+        commands[i] = strdup(buf);
+        if (!commands[i]) return NULL;
+    }
+    return commands;
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 200000;
+    if (count < 1) count = 1;
+
+    if (policy_init() != 0) {
+        printf("FAIL: policy_init\n");
+        return 1;
+    }
+    check_precedence();
+
+    char **commands = build_commands(count);
+    if (!commands) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) bytes += strlen(commands[i]);
+
+    double best = 0;
+    int blocked = 0, warned = 0;
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        blocked = warned = 0;
+        double start = now_us();
+        for (int i = 0; i < count; i++) {
+            policy_result_t r = policy_check_command(commands[i]);
+            blocked += r.decision == POLICY_BLOCK;
+            warned += r.decision == POLICY_WARN;
+        }
+        double elapsed = now_us() - start;
+        if (iter == 0 || elapsed < best) best = elapsed;
+    }
+
+    printf("Policy gate (%d commands, %zu bytes avg, best of %d runs)\n",
+           count, bytes / count, BENCH_ITERATIONS);
+    printf("  %-12s %8.1f ns per command, %7.1f MB/s (%d blocked, %d warned)\n",
+           "one by one", best * 1000.0 / count, bytes / best, blocked, warned);
+
+    /* The batch gives what the commands give one at a time */
+    workpool_set_jobs(0);
+    policy_result_t *results = malloc(count * sizeof(policy_result_t));
+    if (!results) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    double batch_best = 0;
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        double start = now_us();
+        if (policy_check_batch((const char *const *)commands, count, results) != 0) {
+            printf("FAIL: policy_check_batch\n");
+            failures++;
+            break;
+        }
+        double elapsed = now_us() - start;
+        if (iter == 0 || elapsed < batch_best) batch_best = elapsed;
+    }
+    int differ = batch_differs(commands, count, results);
+    if (differ) {
+        printf("FAIL: %d batch results differ\n", differ);
+        failures++;
+    }
+    printf("  %-12s %8.1f ns per command, %7.1f MB/s (%d jobs)\n",
+           "batch", batch_best * 1000.0 / count, bytes / batch_best, workpool_jobs());
+
+    /* Two threads batching at once take turns with the pool */
+    int jobs = workpool_jobs();
+    workpool_set_jobs(jobs > 1 ? jobs : 4);
+    batch_caller_t other = { commands, count, calloc(count, sizeof(policy_result_t)), 0 };
+    pthread_t caller;
+    if (!other.results || pthread_create(&caller, NULL, batch_caller, &other) != 0) {
+        printf("FAIL: cannot start a second batch caller\n");
+        return 1;
+    }
+    memset(results, 0, count * sizeof(policy_result_t));
+    int rc = 0;
+    for (int iter = 0; iter < BENCH_ITERATIONS && rc == 0; iter++) {
+        rc = policy_check_batch((const char *const *)commands, count, results);
+    }
+    pthread_join(caller, NULL);
+    if (rc != 0 || other.rc != 0 || batch_differs(commands, count, results) ||
+        batch_differs(commands, count, other.results)) {
+        printf("FAIL: concurrent batches gave wrong results\n");
+        failures++;
+    }
+    free(other.results);
+    workpool_set_jobs(jobs);
+
+    /* Audited: snapshots taken while the workers write stay whole */
+    reader_t reader = { 0, 0, 0 };
+    pthread_t thread;
+    policy_set_audit(1);
+    if (pthread_create(&thread, NULL, audit_reader, &reader) != 0) {
+        printf("FAIL: cannot start audit reader\n");
+        return 1;
+    }
+    double start = now_us();
+    policy_check_batch((const char *const *)commands, count, results);
+    double audited = now_us() - start;
+    reader.stop = 1;
+    pthread_join(thread, NULL);
+
+    audit_entry_t entries[100];
+    int n = policy_get_audit_log(entries, 100);
+    if (n != (count < 100 ? count : 100) || !audit_consistent(entries, n)) {
+        printf("FAIL: audit log holds %d entries after the batch\n", n);
+        failures++;
+    }
+    if (reader.torn) {
+        printf("FAIL: %d of %d audit snapshots held a torn entry\n", reader.torn, reader.snapshots);
+        failures++;
+    }
+    printf("  %-12s %8.1f ns per command, %7.1f MB/s (%d snapshots read meanwhile)\n",
+           "audited", audited * 1000.0 / count, bytes / audited, reader.snapshots);
+    policy_set_audit(0);
+    free(results);
+
+    for (int i = 0; i < count; i++) free(commands[i]);
+    free(commands);
+    policy_cleanup();
+    workpool_shutdown();
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_sanitize.c - Sanitization of fingerprint JSON
+ *
+ * Checks each kind of redaction on small inputs first. The corpus is
+ * the fingerprint JSON files given, repeated to at least 4 MB, or a
+ * synthetic document full of addresses, home directories and secrets.
+ * Every pre-filter backend must find the same candidates and give the
+ * same output as the scalar one; each is then timed alone and as part
+ * of sanitize_alloc(), whose time per byte should not grow with the
+ * document. Streaming the corpus in ragged chunks must give the same
+ * output again.
+ *
+ * Usage: bench_sanitize [fingerprint.json ...]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "sanitize.h"
+#include "sanitize_scan.h"
+
+#define BENCH_ITERATIONS 5
+#define CORPUS_MIN_BYTES (4 << 20)
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+
+static void check(const char *input, size_t buf_size, const char *expected) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", input);
+    sanitize_string(buf, buf_size, SANITIZE_DEFAULT);
+    if (strcmp(buf, expected) != 0) {
+        printf("FAIL: \"%s\"\n  got      \"%s\"\n  expected \"%s\"\n", input, buf, expected);
+        failures++;
+    }
+}
+
+static void check_redactions(void) {
+    check("connect 10.1.2.3 ok", 512, "connect " REDACT_IP " ok");
+    check("peer fe80::1:2", 512, "peer " REDACT_IP);
+    check("/home/alice/.ssh/id_rsa", 512, REDACT_PATH "/.ssh/id_rsa");
+    check("\"cmd\": \"db --password=hunter2 -v\"", 512,
+          "\"cmd\": \"db --password=" REDACT_SECRET " -v\"");
+    check("TOKEN=abc AUTH=def", 512, "TOKEN=" REDACT_SECRET " AUTH=" REDACT_SECRET);
+    check("private_key_file=/etc/k.pem", 512, "private_key_file=" REDACT_SECRET);
+    check("credential", 512, "credential");
+
+    /* A secret value that is also an address is redacted once */
+    check("password=10.0.0.1", 512, "password=" REDACT_SECRET);
+
+    /* No room for the placeholder: left as it was, the rest still done */
+    check("x 10.0.0.1 y 10.0.0.2", 28, "x " REDACT_IP " y 10.0.0.2");
+
+    sanitize_add_pattern("corp.example", "[INTERNAL]");
+    sanitize_add_pattern("example", NULL);
+    check("db.corp.example and example", 512, "db.[INTERNAL] and [REDACTED]");
+    sanitize_clear_patterns();
+    check("db.corp.example", 512, "db.corp.example");
+
+    setenv("BENCH_SANITIZE_SECRET", "s3cr3t-value", 1);
+    sanitize_add_secret_var("BENCH_SANITIZE_SECRET");
+    check("key is s3cr3t-value!", 512, "key is " REDACT_SECRET "!");
+    sanitize_clear_patterns();
+
+    char out[64];
+    int n = sanitize_string_copy("a 1.2.3.4 b", out, sizeof(out), SANITIZE_IPV4);
+    if (n != 1 || strcmp(out, "a " REDACT_IP " b") != 0) {
+        printf("FAIL: sanitize_string_copy gave %d \"%s\"\n", n, out);
+        failures++;
+    }
+    if (sanitize_detect("x=1 Password=2", SANITIZE_SECRETS) != SANITIZE_SECRETS ||
+        sanitize_detect("nothing here", SANITIZE_DEFAULT) != SANITIZE_NONE) {
+        printf("FAIL: sanitize_detect\n");
+        failures++;
+    }
+}
+
+/* Process-table-like JSON with something to redact on most lines */
+static char* build_document(size_t target, size_t *len) {
+    static const char *cmds[] = {
+        "/usr/sbin/sshd -D",
+        "java -jar /home/svc%d/app.jar --db.password=pw%d",
+        "postgres: checkpointer",
+        "curl https://10.%d.0.%d/health",
+        "agent --token=t%d --peer fe80::%d:1",
+    };
+    size_t cap = target + 4096;
+    char *doc = malloc(cap);
+    if (!doc) return NULL;
+
+    size_t n = 0;
+    n += snprintf(doc + n, cap - n, "{\"processes\": [\n");
+    for (int i = 0; n < target; i++) {
+        char cmd[128];
+        snprintf(cmd, sizeof(cmd), cmds[i % 5], i % 200, i % 250);
+        n += snprintf(doc + n, cap - n,
+                      "  {\"pid\": %d, \"name\": \"proc%d\", \"cmdline\": \"%s\"},\n",
+                      100 + i, i % 50, cmd);
+    }
+    n += snprintf(doc + n, cap - n, "  {}\n]}\n");
+    *len = n;
+    return doc;
+}
+
+/* The files given, repeated until the corpus is big enough to time */
+static char* load_corpus(char **paths, int count, size_t *len) {
+    size_t n = 0, cap = CORPUS_MIN_BYTES + 65536;
+    char *corpus = malloc(cap);
+    size_t one_pass = 0;
+
+    while (corpus && (n == 0 || n < CORPUS_MIN_BYTES)) {
+        for (int i = 0; i < count; i++) {
+            FILE *f = fopen(paths[i], "rb");
+            if (!f) {
+                perror(paths[i]);
+                free(corpus);
+                return NULL;
+            }
+            for (;;) {
+                if (cap - n < 65536) {
+                    char *grown = realloc(corpus, cap * 2);
+                    if (!grown) {
+                        fclose(f);
+                        free(corpus);
+                        return NULL;
+                    }
+                    corpus = grown;
+                    cap *= 2;
+                }
+                size_t got = fread(corpus + n, 1, cap - n, f);
+                if (got == 0) break;
+                n += got;
+            }
+            fclose(f);
+        }
+        if (one_pass == 0) one_pass = n;
+        if (one_pass == 0) break;       /* Empty files: nothing to repeat */
+    }
+    *len = n;
+    return corpus;
+}
+
+/* Positions of every candidate, folded into a checksum */
+static uint64_t candidate_sum(const char *s, size_t len, size_t *count) {
+    uint64_t sum = 0;
+    size_t n = 0;
+    for (size_t i = sanitize_next_candidate(s, 0, len); i < len;
+         i = sanitize_next_candidate(s, i + 1, len)) {
+        sum = sum * 31 + i;
+        n++;
+    }
+    *count = n;
+    return sum;
+}
+
+/* Stream sink collecting output into a preallocated buffer */
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+} collect_t;
+
+static int collect(void *ctx, const char *data, size_t len) {
+    collect_t *c = ctx;
+    if (c->len + len >= c->cap) return -1;
+    memcpy(c->buf + c->len, data, len);
+    c->len += len;
+    c->buf[c->len] = '\0';
+    return 0;
+}
+
+/* Stream doc in chunks of 1 to max_chunk bytes; returns the output (caller frees) */
+static char* stream_document(const char *doc, size_t len, size_t max_chunk, double *elapsed) {
+    collect_t c = { malloc(len * 2 + 1), 0, len * 2 + 1 };
+    if (!c.buf) return NULL;
+    c.buf[0] = '\0';
+
+    double start = now_us();
+    sanitize_stream_t *st = sanitize_stream_new(SANITIZE_DEFAULT, collect, &c);
+    size_t off = 0;
+    unsigned seed = 12345;
+    while (st && off < len) {
+        seed = seed * 1103515245 + 12345;
+        size_t n = 1 + (seed >> 8) % max_chunk;
+        if (n > len - off) n = len - off;
+        sanitize_stream_write(st, doc + off, n);
+        off += n;
+    }
+    int rc = st ? sanitize_stream_finish(st) : -1;
+    sanitize_stream_free(st);
+    if (elapsed) *elapsed = now_us() - start;
+    if (rc < 0) {
+        free(c.buf);
+        return NULL;
+    }
+    return c.buf;
+}
+
+static double best_of(double a, double b) {
+    return (a < 0 || b < a) ? b : a;
+}
+
+int main(int argc, char *argv[]) {
+    sanitize_init();
+    check_redactions();
+
+    size_t len;
+    char *doc = argc > 1 ? load_corpus(argv + 1, argc - 1, &len)
+                         : build_document(CORPUS_MIN_BYTES, &len);
+    if (!doc) {
+        printf("FAIL: cannot build corpus\n");
+        return 1;
+    }
+
+    size_t ref_count = 0;
+    uint64_t ref_sum = 0;
+    char *ref_out = NULL;
+    int redactions = 0;
+
+    printf("Sanitization (%s, %zu KB, best of %d runs)\n",
+           argc > 1 ? "fingerprint corpus" : "synthetic document", len / 1024, BENCH_ITERATIONS);
+    printf("  %-8s %12s %12s %12s\n", "backend", "candidates", "pre-filter", "sanitize");
+
+    for (int b = SANITIZE_SCAN_SCALAR; b < SANITIZE_SCAN_COUNT; b++) {
+        if (sanitize_set_scan((sanitize_scan_t)b) != 0) continue;
+
+        /* Same candidates and same output as the scalar backend */
+        size_t count;
+        uint64_t sum = candidate_sum(doc, len, &count);
+        char *out = sanitize_alloc(doc, len, SANITIZE_DEFAULT, &redactions);
+        if (!out) {
+            printf("FAIL: sanitize_alloc returned NULL\n");
+            failures++;
+            break;
+        }
+        if (b == SANITIZE_SCAN_SCALAR) {
+            ref_count = count;
+            ref_sum = sum;
+            ref_out = out;
+            if (argc == 1 && (strstr(out, "password=pw") || strstr(out, "/home/svc"))) {
+                printf("FAIL: synthetic document not fully sanitized\n");
+                failures++;
+            }
+        } else {
+            if (count != ref_count || sum != ref_sum || strcmp(out, ref_out) != 0) {
+                printf("FAIL: %s disagrees with scalar\n", sanitize_scan_name(b));
+                failures++;
+            }
+            free(out);
+        }
+
+        double scan_best = -1, full_best = -1;
+        for (int it = 0; it < BENCH_ITERATIONS; it++) {
+            double start = now_us();
+            candidate_sum(doc, len, &count);
+            scan_best = best_of(scan_best, now_us() - start);
+
+            start = now_us();
+            out = sanitize_alloc(doc, len, SANITIZE_DEFAULT, NULL);
+            full_best = best_of(full_best, now_us() - start);
+            free(out);
+        }
+        printf("  %-8s %12zu %7.2f GB/s %7.2f GB/s\n", sanitize_scan_name(b), count,
+               len / scan_best / 1000.0, len / full_best / 1000.0);
+    }
+
+    /* Redacting half the corpus must cost about half as much */
+    sanitize_set_scan(SANITIZE_SCAN_AUTO);
+    double half_best = -1;
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        double start = now_us();
+        free(sanitize_alloc(doc, len / 2, SANITIZE_DEFAULT, NULL));
+        half_best = best_of(half_best, now_us() - start);
+    }
+    double full_best = -1;
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        double start = now_us();
+        free(sanitize_alloc(doc, len, SANITIZE_DEFAULT, &redactions));
+        full_best = best_of(full_best, now_us() - start);
+    }
+
+    sanitize_stats_t stats;
+    sanitize_get_stats(&stats);
+    printf("  %s: half corpus %.1f us, full corpus %.1f us (%d redactions: %d ip, %d path, %d secret)\n",
+           sanitize_scan_name(sanitize_get_scan()), half_best, full_best, redactions,
+           stats.ipv4_count + stats.ipv6_count, stats.homedir_count, stats.secret_count);
+
+    /* Ragged chunks, down to single bytes, change nothing */
+    double stream_time = 0;
+    size_t chunk_sizes[] = { 1, 97, 8192 };
+    for (int i = 0; i < 3; i++) {
+        size_t part = chunk_sizes[i] == 1 ? len / 16 : len;
+        char *whole = sanitize_alloc(doc, part, SANITIZE_DEFAULT, NULL);
+        char *streamed = stream_document(doc, part, chunk_sizes[i], &stream_time);
+        if (!whole || !streamed || strcmp(whole, streamed) != 0) {
+            printf("FAIL: stream in chunks of up to %zu bytes differs\n", chunk_sizes[i]);
+            failures++;
+        }
+        free(whole);
+        free(streamed);
+    }
+
+    /* A pattern holding a space must not be split at it */
+    static const char spaced[] = "host prod cluster 7 in prod clusterless prod\ncluster";
+    sanitize_add_pattern("prod cluster", "[CLUSTER]");
+    char *spaced_out = stream_document(spaced, strlen(spaced), 1, NULL);
+    if (!spaced_out || strcmp(spaced_out, "host [CLUSTER] 7 in [CLUSTER]less prod\ncluster") != 0) {
+        printf("FAIL: stream split a pattern holding a space: \"%s\"\n",
+               spaced_out ? spaced_out : "(null)");
+        failures++;
+    }
+    free(spaced_out);
+    sanitize_clear_patterns();
+
+    printf("  stream (up to 8 KB chunks) %.1f us, %.2f GB/s, holding back at most %d bytes\n",
+           stream_time, len / stream_time / 1000.0, SANITIZE_STREAM_HOLD);
+
+    free(ref_out);
+    free(doc);
+    sanitize_cleanup();
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_sha256.c - SHA256 backend throughput and cross-check
+ *
+ * Every available backend must reproduce the reference digests for
+ * messages of every length around the padding boundaries, batched in
+ * odd group sizes. Then each one hashes one large buffer and a batch
+ * of eight, reported in MB/s.
+ *
+ * Usage: bench_sha256 [megabytes]   (default: 64)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sentinel.h"
+#include "sha256.h"
+
+#define BENCH_ITERATIONS 3
+#define CHECK_MAX_LEN 300
+#define BATCH_STREAMS 8
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void fill_random(uint8_t *buf, size_t len, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* Compare a backend against the generic digests for every length */
+static int cross_check(sha256_backend_t backend, const uint8_t *data,
+                       uint8_t (*expected)[32]) {
+    const uint8_t *ptrs[CHECK_MAX_LEN + 1];
+    size_t lens[CHECK_MAX_LEN + 1];
+    static uint8_t got[CHECK_MAX_LEN + 1][32];
+    int failures = 0;
+
+    sha256_set_backend(backend);
+
+    /* Group sizes that leave lanes idle and force refills mid-batch */
+    static const int groups[] = { 1, 3, 7, 8, 9, 17, CHECK_MAX_LEN + 1 };
+    for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+        int len = 0;
+        while (len <= CHECK_MAX_LEN) {
+            int n = 0;
+            for (; n < groups[g] && len + n <= CHECK_MAX_LEN; n++) {
+                /* Each message starts at a different offset to test unaligned loads */
+                ptrs[n] = data + (len + n) % 13;
+                lens[n] = (size_t)(len + n);
+            }
+            sha256_buffers(ptrs, lens, n, got);
+            for (int i = 0; i < n; i++) {
+                if (memcmp(got[i], expected[len + i], 32) != 0) failures++;
+            }
+            len += n;
+        }
+    }
+    return failures;
+}
+
+static void bench_backend(sha256_backend_t backend, const uint8_t *data, size_t size) {
+    uint8_t digest[BATCH_STREAMS][32];
+    const uint8_t *ptrs[BATCH_STREAMS];
+    size_t lens[BATCH_STREAMS];
+    double single = -1, batch = -1;
+
+    sha256_set_backend(backend);
+
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        double start = now_ms();
+        ptrs[0] = data;
+        lens[0] = size;
+        sha256_buffers(ptrs, lens, 1, digest);
+        double elapsed = now_ms() - start;
+        if (single < 0 || elapsed < single) single = elapsed;
+    }
+
+    for (int i = 0; i < BATCH_STREAMS; i++) {
+        ptrs[i] = data + i * (size / BATCH_STREAMS);
+        lens[i] = size / BATCH_STREAMS;
+    }
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        double start = now_ms();
+        sha256_buffers(ptrs, lens, BATCH_STREAMS, digest);
+        double elapsed = now_ms() - start;
+        if (batch < 0 || elapsed < batch) batch = elapsed;
+    }
+
+    double mb = size / (1024.0 * 1024.0);
+    printf("  %-8s  single %8.1f MB/s   batch of %d %8.1f MB/s\n",
+           sha256_backend_name(backend), mb / (single / 1000.0),
+           BATCH_STREAMS, mb / (batch / 1000.0));
+}
+
+int main(int argc, char *argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 64;
+    if (megabytes < 1) megabytes = 1;
+    size_t size = megabytes * 1024 * 1024;
+    int failures = 0;
+
+    uint8_t *data = malloc(size + 64);
+    if (!data) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    fill_random(data, size + 64, 1);
+
+    /* Known answer first, on whatever AUTO picked */
+    char hex[65];
+    sha256_string("abc", hex, sizeof(hex));
+    if (strcmp(hex, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") != 0) {
+        printf("FAIL: sha256(\"abc\") = %s\n", hex);
+        failures++;
+    }
+
+    /* Reference digests from the portable code */
+    static uint8_t expected[CHECK_MAX_LEN + 1][32];
+    sha256_set_backend(SHA256_BACKEND_GENERIC);
+    for (int len = 0; len <= CHECK_MAX_LEN; len++) {
+        const uint8_t *p = data + len % 13;
+        size_t l = (size_t)len;
+        sha256_buffers(&p, &l, 1, &expected[len]);
+    }
+
+    printf("SHA256 backends (%zu MB, best of %d runs)\n", megabytes, BENCH_ITERATIONS);
+    for (int b = SHA256_BACKEND_GENERIC; b < SHA256_BACKEND_COUNT; b++) {
+        if (!sha256_backend_available((sha256_backend_t)b)) {
+            printf("  %-8s  not available on this CPU\n", sha256_backend_name((sha256_backend_t)b));
+            continue;
+        }
+        int bad = cross_check((sha256_backend_t)b, data, expected);
+        if (bad) {
+            printf("  %-8s  MISMATCH: %d digests differ from generic\n",
+                   sha256_backend_name((sha256_backend_t)b), bad);
+            failures++;
+            continue;
+        }
+        bench_backend((sha256_backend_t)b, data, size);
+    }
+
+    sha256_set_backend(SHA256_BACKEND_AUTO);
+    printf("  auto selects: %s\n", sha256_backend_name(sha256_get_backend()));
+
+    free(data);
+    return failures ? 1 : 0;
+}
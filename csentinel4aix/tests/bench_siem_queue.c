@@ -0,0 +1,301 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_siem_queue.c - SIEM ring, sender thread and disk spool
+ *
+ * The collector is a send callback that can be up, down, slow, or take
+ * only part of a batch. Checks that events arrive once and in order:
+ * straight through, spooled while the collector is down and replayed
+ * before newer ones, cut part way through a batch, overflowing the ring
+ * to the spool while the sender is stuck on a slow collector, and carried
+ * over a restart by the spool (also after a partial replay). Then times how
+ * long a probe's events take to queue with the collector slow or down,
+ * against delivering them in the probe.
+ *
+ * Usage: bench_siem_queue [probes]   (default: 200)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "siem_queue.h"
+
+#define EVENTS_PER_PROBE 40
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+static char spool_path[64];
+
+/* ============================================================
+ * Collector
+ * ============================================================ */
+
+typedef struct {
+    volatile int up;
+    volatile int take;          /* >= 0: take this many more, then go down */
+    volatile int delay_us;      /* Per batch */
+    volatile int delivered;
+    volatile int bad;           /* A message out of order */
+} collector_t;
+
+static int collector_send(void *ctx, const char *const *msgs, const size_t *lens, int count) {
+    collector_t *c = ctx;
+    int done = 0;
+
+    if (c->delay_us) usleep((useconds_t)c->delay_us);
+    while (done < count && c->up) {
+        if (c->take == 0) {
+            c->up = 0;
+            break;
+        }
+        if (c->take > 0) c->take--;
+
+        char want[32];
+        int wlen = snprintf(want, sizeof(want), " event %d", c->delivered);
+        if (lens[done] < (size_t)wlen ||
+            memcmp(msgs[done] + lens[done] - wlen, want, (size_t)wlen) != 0) {
+            c->bad++;
+        }
+        c->delivered++;
+        done++;
+    }
+    return done;
+}
+
+static void collector_reset(collector_t *c, int up) {
+    memset(c, 0, sizeof(*c));
+    c->up = up;
+    c->take = -1;
+}
+
+/* ============================================================
+ * Checks
+ * ============================================================ */
+
+static int next_event = 0;
+
+/* One probe's events; returns the slowest push in us */
+static double push_events(siem_queue_t *q, int count) {
+    double slowest = 0;
+    for (int i = 0; i < count; i++) {
+        char msg[256];
+        int len = snprintf(msg, sizeof(msg),
+                           "<13>1 2026-01-22T16:30:00Z aixhost csentinel - - - "
+                           "CEF:0|LibrePower|C-Sentinel|0.6.0|9|Fingerprint|1|msg=x event %d",
+                           next_event++);
+        double start = now_us();
+        siem_queue_push(q, msg, (size_t)len);
+        double took = now_us() - start;
+        if (took > slowest) slowest = took;
+    }
+    return slowest;
+}
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+/* Wait (up to 5 s) for a condition the sender thread brings about */
+#define WAIT_FOR(cond) \
+    for (int w_ = 0; w_ < 5000 && !(cond); w_++) usleep(1000)
+
+static unsigned long stat_of(siem_queue_t *q, int which) {
+    siem_queue_stats_t st;
+    siem_queue_get_stats(q, &st);
+    return which == 0 ? st.sent : which == 1 ? st.spooled : st.dropped;
+}
+
+static long spool_bytes(void) {
+    struct stat st;
+    return stat(spool_path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void check_queue(void) {
+    collector_t c;
+    siem_queue_t q;
+    siem_queue_stats_t st;
+
+    /* Collector up: straight through */
+    unlink(spool_path);
+    collector_reset(&c, 1);
+    next_event = 0;
+    siem_queue_start(&q, spool_path, collector_send, &c);
+    for (int probe = 0; probe < 50; probe++) {
+        push_events(&q, EVENTS_PER_PROBE);
+        WAIT_FOR(c.delivered == next_event);
+    }
+    expect("delivered", c.delivered, 2000);
+
+    /* Down: spooled; up again: the spool first, then what is new */
+    c.up = 0;
+    push_events(&q, 300);
+    WAIT_FOR(stat_of(&q, 1) == 300);
+    expect("spooled while down", (long)stat_of(&q, 1), 300);
+    expect("spool bytes while down", spool_bytes() > 0, 1);
+    /* Before the retry is due: queued behind the spool, not sent ahead */
+    c.up = 1;
+    push_events(&q, 100);
+    WAIT_FOR(stat_of(&q, 1) == 400 || c.delivered > 2000);
+    expect("spooled behind the outage", (long)stat_of(&q, 1), 400);
+    WAIT_FOR(c.delivered == 2400);
+    expect("delivered after outage", c.delivered, 2400);
+    WAIT_FOR(spool_bytes() == 0);
+    expect("spool bytes once replayed", spool_bytes(), 0);
+
+    /* Cut part way through a batch: the rest is spooled, nothing twice */
+    c.take = 10;
+    push_events(&q, 50);
+    WAIT_FOR(stat_of(&q, 1) == 440);
+    c.take = -1;
+    c.up = 1;
+    WAIT_FOR(c.delivered == 2450);
+    expect("delivered after a partial batch", c.delivered, 2450);
+
+    /* Sender stuck on a slow collector: a burst past the ring goes to the spool */
+    c.delay_us = 50000;
+    push_events(&q, 1);
+    usleep(10000);
+    push_events(&q, SIEM_QUEUE_SLOTS * 3);
+    expect("overflow dropped", (long)stat_of(&q, 2), 0);
+    expect("overflow spooled", stat_of(&q, 1) > 440, 1);
+    c.delay_us = 0;
+    WAIT_FOR(c.delivered == 2451 + SIEM_QUEUE_SLOTS * 3);
+    expect("delivered after overflow", c.delivered, 2451 + SIEM_QUEUE_SLOTS * 3);
+
+    siem_queue_stop(&q);
+    siem_queue_get_stats(&q, &st);
+    expect("queued", (long)st.queued, 2451 + SIEM_QUEUE_SLOTS * 3);
+    expect("sent", (long)st.sent, 2451 + SIEM_QUEUE_SLOTS * 3);
+    expect("dropped", (long)st.dropped, 0);
+    expect("out of order", c.bad, 0);
+
+    /* Down at exit: the next run delivers the spool before anything new */
+    collector_reset(&c, 0);
+    next_event = 0;
+    siem_queue_start(&q, spool_path, collector_send, &c);
+    push_events(&q, 100);
+    WAIT_FOR(stat_of(&q, 1) == 100);
+    siem_queue_stop(&q);
+
+    c.up = 1;
+    siem_queue_start(&q, spool_path, collector_send, &c);
+    push_events(&q, 20);
+    WAIT_FOR(c.delivered == 120);
+    expect("delivered after restart", c.delivered, 120);
+
+    /* Stopped part way through a replay: the rest next run, once */
+    c.up = 0;
+    push_events(&q, 100);
+    WAIT_FOR(stat_of(&q, 1) == 100);
+    c.take = 30;
+    c.up = 1;
+    WAIT_FOR(c.delivered == 150 && !c.up);
+    siem_queue_stop(&q);
+    expect("replayed before stop", c.delivered, 150);
+
+    c.take = -1;
+    c.up = 1;
+    siem_queue_start(&q, spool_path, collector_send, &c);
+    WAIT_FOR(c.delivered == 220);
+    siem_queue_stop(&q);
+    expect("delivered after partial replay", c.delivered, 220);
+    expect("out of order after restart", c.bad, 0);
+    expect("spool bytes at the end", spool_bytes(), 0);
+}
+
+/* Probe time to hand over its events, and the slowest single push */
+static void time_probes(const char *label, collector_t *c, int probes, double *per_probe,
+                        double *slowest) {
+    siem_queue_t q;
+    unlink(spool_path);
+    siem_queue_start(&q, spool_path, collector_send, c);
+
+    double total = 0;
+    *slowest = 0;
+    for (int p = 0; p < probes; p++) {
+        double start = now_us();
+        double s = push_events(&q, EVENTS_PER_PROBE);
+        total += now_us() - start;
+        if (s > *slowest) *slowest = s;
+        /* Probes are seconds apart: let the sender catch up */
+        WAIT_FOR(stat_of(&q, 0) + stat_of(&q, 1) >= (unsigned long)(p + 1) * EVENTS_PER_PROBE);
+    }
+    siem_queue_stop(&q);
+    if (stat_of(&q, 2) != 0) {
+        printf("FAIL: %s: %lu dropped\n", label, stat_of(&q, 2));
+        failures++;
+    }
+    *per_probe = total / probes;
+}
+
+int main(int argc, char *argv[]) {
+    int probes = argc > 1 ? atoi(argv[1]) : 200;
+    if (probes < 1) probes = 1;
+
+    snprintf(spool_path, sizeof(spool_path), "/tmp/bench_siem_spool_%d", (int)getpid());
+    check_queue();
+
+    /* In the probe, as before: every batch waits for the collector */
+    collector_t c;
+    collector_reset(&c, 1);
+    c.delay_us = 2000;
+    const char *msgs[EVENTS_PER_PROBE];
+    size_t lens[EVENTS_PER_PROBE];
+    char bufs[EVENTS_PER_PROBE][128];
+    int sync_probes = probes < 50 ? probes : 50;
+    double start = now_us();
+    for (int p = 0; p < sync_probes; p++) {
+        for (int i = 0; i < EVENTS_PER_PROBE; i++) {
+            lens[i] = (size_t)snprintf(bufs[i], sizeof(bufs[i]), "msg event %d", c.delivered + i);
+            msgs[i] = bufs[i];
+        }
+        collector_send(&c, msgs, lens, EVENTS_PER_PROBE);
+    }
+    double sync_probe = (now_us() - start) / sync_probes;
+
+    double slow_probe, slow_push, down_probe, down_push;
+    collector_reset(&c, 1);
+    c.delay_us = 2000;
+    next_event = 0;
+    time_probes("slow collector", &c, probes, &slow_probe, &slow_push);
+    expect("slow collector: out of order", c.bad, 0);
+    collector_reset(&c, 0);
+    next_event = 0;
+    time_probes("collector down", &c, probes, &down_probe, &down_push);
+
+    if (slow_probe >= sync_probe) {
+        printf("FAIL: queued probe %.1f us, not faster than in-probe %.1f us\n",
+               slow_probe, sync_probe);
+        failures++;
+    }
+
+    printf("SIEM queue (%d probes of %d events)\n", probes, EVENTS_PER_PROBE);
+    printf("  %-28s %8.1f us per probe\n", "in probe, collector 2 ms", sync_probe);
+    printf("  %-28s %8.1f us per probe, slowest push %6.1f us\n",
+           "queued, collector 2 ms", slow_probe, slow_push);
+    printf("  %-28s %8.1f us per probe, slowest push %6.1f us\n",
+           "queued, collector down", down_probe, down_push);
+
+    unlink(spool_path);
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
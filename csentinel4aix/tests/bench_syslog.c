@@ -0,0 +1,347 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_syslog.c - Syslog transport against a local TCP collector
+ *
+ * A collector thread accepts connections on 127.0.0.1 and splits what
+ * it reads into RFC 6587 octet-counted frames. Checks that many probes'
+ * events arrive whole and in order over one connection, that the
+ * transport reconnects without losing messages when the collector drops
+ * the connection, and that a collector that is down is retried with
+ * backoff while messages wait. Then times events sent over the
+ * transport against a connection per event.
+ *
+ * Usage: bench_syslog [events]   (default: 5000)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "syslog_transport.h"
+
+#define MAX_CLIENTS 64
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+
+/* ============================================================
+ * Collector
+ * ============================================================ */
+
+typedef struct {
+    int listen_fd;
+    int port;
+    pthread_t thread;
+    volatile int stop;
+    volatile int drop_connections;  /* Set: close every client connection */
+    volatile int connections;
+    volatile int messages;
+    volatile int bad;               /* Unframed data or a message out of order */
+    int unordered;                  /* Set: connections may interleave */
+} collector_t;
+
+typedef struct {
+    int fd;
+    char buf[65536];
+    size_t len;
+} client_t;
+
+/* Consume whole frames; each message must be "... event N" in sequence */
+static void read_frames(collector_t *c, client_t *cl) {
+    size_t pos = 0;
+    for (;;) {
+        size_t p = pos, len = 0;
+        while (p < cl->len && cl->buf[p] >= '0' && cl->buf[p] <= '9') {
+            len = len * 10 + (size_t)(cl->buf[p++] - '0');
+        }
+        if (p == cl->len) break;
+        if (p == pos || cl->buf[p] != ' ') {
+            c->bad++;
+            cl->len = 0;
+            return;
+        }
+        if (p + 1 + len > cl->len) break;
+
+        char want[32];
+        int wlen = snprintf(want, sizeof(want), " event %d", c->messages);
+        if (len < (size_t)wlen ||
+            (!c->unordered && memcmp(cl->buf + p + 1 + len - wlen, want, wlen) != 0)) {
+            c->bad++;
+        }
+        c->messages++;
+        pos = p + 1 + len;
+    }
+    memmove(cl->buf, cl->buf + pos, cl->len - pos);
+    cl->len -= pos;
+}
+
+static void* collector_run(void *arg) {
+    collector_t *c = arg;
+    client_t *clients = calloc(MAX_CLIENTS, sizeof(client_t));
+    int nclients = 0;
+
+    while (!c->stop) {
+        struct pollfd fds[MAX_CLIENTS + 1];
+        fds[0].fd = c->listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < nclients; i++) {
+            fds[i + 1].fd = clients[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+        int polled = nclients;
+        if (poll(fds, polled + 1, 10) < 0) break;
+
+        if (c->drop_connections) {
+            for (int i = 0; i < nclients; i++) close(clients[i].fd);
+            nclients = 0;
+            c->drop_connections = 0;
+            continue;
+        }
+        /* Drain the backlog, or dropped SYNs would be retried a second later */
+        while ((fds[0].revents & POLLIN) && nclients < MAX_CLIENTS) {
+            int fd = accept(c->listen_fd, NULL, NULL);
+            if (fd < 0) break;
+            clients[nclients].fd = fd;
+            clients[nclients].len = 0;
+            nclients++;
+            c->connections++;
+        }
+        for (int i = 0; i < polled; i++) {
+            if (!(fds[i + 1].revents & (POLLIN | POLLHUP))) continue;
+            client_t *cl = &clients[i];
+            ssize_t n = recv(cl->fd, cl->buf + cl->len, sizeof(cl->buf) - cl->len, 0);
+            if (n <= 0) {
+                close(cl->fd);
+                cl->fd = -1;
+                continue;
+            }
+            cl->len += (size_t)n;
+            read_frames(c, cl);
+        }
+
+        /* Forget closed connections */
+        int kept = 0;
+        for (int i = 0; i < nclients; i++) {
+            if (clients[i].fd >= 0) clients[kept++] = clients[i];
+        }
+        nclients = kept;
+    }
+    for (int i = 0; i < nclients; i++) close(clients[i].fd);
+    free(clients);
+    return NULL;
+}
+
+/* Bound to a free port on loopback; collector_start() listens */
+static int collector_bind(collector_t *c) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(c, 0, sizeof(*c));
+    c->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (c->listen_fd < 0 || bind(c->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(c->listen_fd, (struct sockaddr *)&addr, &len) != 0) {
+        return -1;
+    }
+    c->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+static int collector_start(collector_t *c) {
+    fcntl(c->listen_fd, F_SETFL, O_NONBLOCK);
+    if (listen(c->listen_fd, SOMAXCONN) != 0) return -1;
+    return pthread_create(&c->thread, NULL, collector_run, c);
+}
+
+static void collector_stop(collector_t *c) {
+    c->stop = 1;
+    pthread_join(c->thread, NULL);
+    close(c->listen_fd);
+}
+
+/* Wait (up to 2 s) for the collector to have read count messages */
+static int wait_messages(collector_t *c, int count) {
+    for (int i = 0; i < 2000 && c->messages < count; i++) usleep(1000);
+    return c->messages == count;
+}
+
+/* ============================================================
+ * Checks
+ * ============================================================ */
+
+static int next_event = 0;
+
+static void queue_events(syslog_transport_t *t, int count) {
+    for (int i = 0; i < count; i++) {
+        char msg[256];
+        int len = snprintf(msg, sizeof(msg),
+                           "<13>1 2026-01-22T16:30:00Z aixhost csentinel - - - "
+                           "CEF:0|LibrePower|C-Sentinel|0.6.0|9|Fingerprint|1|msg=x event %d",
+                           next_event++);
+        syslog_transport_send(t, msg, (size_t)len);
+    }
+}
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+static void check_transport(void) {
+    collector_t c;
+    syslog_transport_t t;
+
+    if (collector_bind(&c) != 0 || collector_start(&c) != 0) {
+        printf("FAIL: cannot start collector\n");
+        failures++;
+        return;
+    }
+    syslog_transport_init(&t, "localhost", c.port, 1);
+
+    /* 50 probes of 40 events: one connection */
+    next_event = 0;
+    for (int probe = 0; probe < 50; probe++) {
+        queue_events(&t, 40);
+        expect("flush", syslog_transport_flush(&t), 0);
+    }
+    wait_messages(&c, 2000);
+    expect("messages", c.messages, 2000);
+    expect("connections", c.connections, 1);
+
+    /* The collector restarts between probes: reconnect, nothing lost */
+    c.drop_connections = 1;
+    for (int i = 0; i < 1000 && c.drop_connections; i++) usleep(1000);
+    usleep(10000);
+    queue_events(&t, 40);
+    expect("flush after drop", syslog_transport_flush(&t), 0);
+    wait_messages(&c, 2040);
+    expect("messages after drop", c.messages, 2040);
+    expect("connections after drop", c.connections, 2);
+    expect("unframed or out of order", c.bad, 0);
+    syslog_transport_close(&t);
+    collector_stop(&c);
+
+    /* Collector down: back off, keep the messages, deliver when it is up */
+    if (collector_bind(&c) != 0) {
+        printf("FAIL: cannot bind collector\n");
+        failures++;
+        return;
+    }
+    syslog_transport_init(&t, "127.0.0.1", c.port, 1);
+    next_event = 0;
+    queue_events(&t, 10);
+    expect("flush while down", syslog_transport_flush(&t), -1);
+    expect("flush while backing off", syslog_transport_flush(&t), -1);
+    expect("attempts while backing off", (long)t.connect_failures, 1);
+    static char too_big[SYSLOG_MAX_PENDING];
+    memset(too_big, 'x', sizeof(too_big));
+    expect("send over the limit", syslog_transport_send(&t, too_big, sizeof(too_big)), -1);
+    expect("refused", (long)t.refused, 1);
+    expect("dropped while down", (long)t.dropped, 0);
+    if (collector_start(&c) != 0) {
+        printf("FAIL: cannot start collector\n");
+        failures++;
+        return;
+    }
+    usleep((SYSLOG_BACKOFF_MIN_MS + 100) * 1000);
+    queue_events(&t, 10);
+    expect("flush once up", syslog_transport_flush(&t), 0);
+    wait_messages(&c, 20);
+    expect("messages once up", c.messages, 20);
+    expect("unframed or out of order", c.bad, 0);
+    syslog_transport_close(&t);
+    collector_stop(&c);
+}
+
+/* The old way: connect, send and close for every event */
+static void send_one_connection(int port, int event) {
+    struct sockaddr_in addr;
+    char msg[256], framed[300];
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int len = snprintf(msg, sizeof(msg),
+                       "<13>1 2026-01-22T16:30:00Z aixhost csentinel - - - "
+                       "CEF:0|LibrePower|C-Sentinel|0.6.0|9|Fingerprint|1|msg=x event %d", event);
+    int flen = snprintf(framed, sizeof(framed), "%d %s", len, msg);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+        send(fd, framed, (size_t)flen, 0) != flen) {
+        failures++;
+    }
+    close(fd);
+}
+
+int main(int argc, char *argv[]) {
+    int events = argc > 1 ? atoi(argv[1]) : 5000;
+    if (events < 1) events = 1;
+
+    check_transport();
+
+    collector_t c;
+    if (collector_bind(&c) != 0 || collector_start(&c) != 0) {
+        printf("FAIL: cannot start collector\n");
+        return 1;
+    }
+
+    double start = now_us();
+    c.unordered = 1;
+    for (int i = 0; i < events; i++) send_one_connection(c.port, i);
+    wait_messages(&c, events);
+    c.unordered = 0;
+    double per_event = now_us() - start;
+    int per_event_conns = c.connections;
+
+    syslog_transport_t t;
+    syslog_transport_init(&t, "127.0.0.1", c.port, 1);
+    next_event = events;
+    start = now_us();
+    for (int sent = 0; sent < events; sent += 40) {
+        queue_events(&t, sent + 40 <= events ? 40 : events - sent);
+        syslog_transport_flush(&t);
+    }
+    wait_messages(&c, 2 * events);
+    double batched = now_us() - start;
+    expect("timed messages", c.messages, 2 * events);
+    expect("timed: unframed or out of order", c.bad, 0);
+
+    printf("Syslog transport (%d events, TCP to 127.0.0.1)\n", events);
+    printf("  %-22s %8.1f us per event, %5d connections\n",
+           "connection per event", per_event / events, per_event_conns);
+    printf("  %-22s %8.1f us per event, %5d connections\n",
+           "transport, 40 a flush", batched / events, c.connections - per_event_conns);
+
+    syslog_transport_close(&t);
+    collector_stop(&c);
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,438 @@
+/*
+ * C-Sentinel - Semantic Observability for UNIX Systems
+ * Copyright (c) 2025 William Murray
+ *
+ * Licensed under the MIT License.
+ * See LICENSE file for details.
+ *
+ * https://github.com/williamofai/c-sentinel
+ *
+ * bench_webhook.c - Webhook alerts against a local stub HTTP server
+ *
+ * A server thread on 127.0.0.1 reads HTTP/1.1 requests and answers in
+ * the way it is told: Content-Length, chunked, "Connection: close",
+ * closing the connection silently after the response, or 503. Checks
+ * that alerts go out over one kept-alive connection, that queued alerts
+ * are posted together (one attachment each), that a stale connection is
+ * replaced without posting twice, that failed posts keep their alerts
+ * (the oldest dropped once a 5xx leaves the queue full), and that
+ * quotes in alert text arrive escaped. Then times alerts posted one by
+ * one and in batches against running curl for each.
+ *
+ * Usage: bench_webhook [alerts]   (default: 500)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "alert.h"
+#include "http_client.h"
+
+#define MAX_CLIENTS 64
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static int failures = 0;
+
+/* ============================================================
+ * Stub server
+ * ============================================================ */
+
+typedef enum {
+    REPLY_LENGTH = 0,       /* Content-Length, kept alive */
+    REPLY_CHUNKED,          /* Chunked body, kept alive */
+    REPLY_CLOSE,            /* "Connection: close" */
+    REPLY_DROP,             /* Kept alive, then closed without a word */
+    REPLY_503,
+    REPLY_NONE,             /* Request taken, connection closed unanswered */
+    REPLY_STALL             /* Request taken, never answered */
+} reply_mode_t;
+
+typedef struct {
+    int listen_fd;
+    int port;
+    pthread_t thread;
+    volatile int stop;
+    volatile reply_mode_t mode;
+    volatile int connections;
+    volatile int requests;
+    volatile int alerts;        /* Attachments received */
+    volatile int bad;           /* Malformed request */
+    volatile int escaped;       /* Requests with \"quoted\" text */
+} server_t;
+
+typedef struct {
+    int fd;
+    char buf[262144];
+    size_t len;
+} client_t;
+
+static int count_of(const char *s, size_t len, const char *needle) {
+    int n = 0;
+    size_t nlen = strlen(needle);
+    for (const char *p = s; (p = memmem(p, len - (size_t)(p - s), needle, nlen)) != NULL; p += nlen) {
+        n++;
+    }
+    return n;
+}
+
+/* Answer every whole request in the buffer; returns 0, or -1 to close */
+static int serve_requests(server_t *s, client_t *cl) {
+    for (;;) {
+        char *end = memmem(cl->buf, cl->len, "\r\n\r\n", 4);
+        if (!end) return 0;
+        size_t head = (size_t)(end - cl->buf) + 4;
+
+        char *cl_hdr = memmem(cl->buf, head, "Content-Length: ", 16);
+        if (strncmp(cl->buf, "POST /hooks/alert HTTP/1.1\r\n", 28) != 0 || !cl_hdr ||
+            !memmem(cl->buf, head, "Host: 127.0.0.1:", 16)) {
+            s->bad++;
+            return -1;
+        }
+        size_t body = strtoul(cl_hdr + 16, NULL, 10);
+        if (head + body > cl->len) return 0;
+
+        s->requests++;
+        s->alerts += count_of(cl->buf + head, body, "\"footer\"");
+        if (count_of(cl->buf + head, body, "\\\"quoted\\\"")) s->escaped++;
+        memmove(cl->buf, cl->buf + head + body, cl->len - head - body);
+        cl->len -= head + body;
+
+        /* Read once: the mode may change as soon as the reply is out */
+        reply_mode_t mode = s->mode;
+        const char *reply;
+        if (mode == REPLY_NONE) return -1;
+        if (mode == REPLY_STALL) continue;
+        switch (mode) {
+            case REPLY_CHUNKED:
+                reply = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "2\r\nok\r\n0\r\n\r\n";
+                break;
+            case REPLY_CLOSE:
+                reply = "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok";
+                break;
+            case REPLY_503:
+                reply = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+                break;
+            default:
+                reply = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+                break;
+        }
+        if (send(cl->fd, reply, strlen(reply), MSG_NOSIGNAL) < 0) return -1;
+        if (mode == REPLY_CLOSE || mode == REPLY_DROP) return -1;
+    }
+}
+
+static void* server_run(void *arg) {
+    server_t *s = arg;
+    client_t *clients = calloc(MAX_CLIENTS, sizeof(client_t));
+    int nclients = 0;
+
+    while (!s->stop) {
+        struct pollfd fds[MAX_CLIENTS + 1];
+        fds[0].fd = s->listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < nclients; i++) {
+            fds[i + 1].fd = clients[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+        int polled = nclients;
+        if (poll(fds, polled + 1, 10) < 0) break;
+
+        while ((fds[0].revents & POLLIN) && nclients < MAX_CLIENTS) {
+            int fd = accept(s->listen_fd, NULL, NULL);
+            if (fd < 0) break;
+            clients[nclients].fd = fd;
+            clients[nclients].len = 0;
+            nclients++;
+            s->connections++;
+        }
+        for (int i = 0; i < polled; i++) {
+            if (!(fds[i + 1].revents & (POLLIN | POLLHUP))) continue;
+            client_t *cl = &clients[i];
+            ssize_t n = recv(cl->fd, cl->buf + cl->len, sizeof(cl->buf) - cl->len, 0);
+            if (n > 0) cl->len += (size_t)n;
+            if (n <= 0 || serve_requests(s, cl) != 0) {
+                close(cl->fd);
+                cl->fd = -1;
+            }
+        }
+
+        int kept = 0;
+        for (int i = 0; i < nclients; i++) {
+            if (clients[i].fd >= 0) clients[kept++] = clients[i];
+        }
+        nclients = kept;
+    }
+    for (int i = 0; i < nclients; i++) close(clients[i].fd);
+    free(clients);
+    return NULL;
+}
+
+static int server_start(server_t *s) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(s, 0, sizeof(*s));
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (s->listen_fd < 0 || bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(s->listen_fd, (struct sockaddr *)&addr, &len) != 0) {
+        return -1;
+    }
+    s->port = ntohs(addr.sin_port);
+    fcntl(s->listen_fd, F_SETFL, O_NONBLOCK);
+    if (listen(s->listen_fd, SOMAXCONN) != 0) return -1;
+    return pthread_create(&s->thread, NULL, server_run, s);
+}
+
+static void server_stop(server_t *s) {
+    s->stop = 1;
+    pthread_join(s->thread, NULL);
+    close(s->listen_fd);
+}
+
+/* ============================================================
+ * Checks
+ * ============================================================ */
+
+static void make_alert(alert_t *a, int seq) {
+    memset(a, 0, sizeof(*a));
+    a->severity = seq % 2 ? ALERT_CRITICAL : ALERT_WARNING;
+    a->timestamp = 1760000000 + seq;
+    snprintf(a->hostname, sizeof(a->hostname), "aixhost%d", seq % 8);
+    snprintf(a->title, sizeof(a->title), "CRITICAL on aixhost%d", seq % 8);
+    snprintf(a->message, sizeof(a->message),
+             "Issues detected:\n• %d zombie process(es)\n• it's \"quoted\"\n", seq % 5);
+    a->zombie_count = seq % 5;
+    a->memory_percent = 42.5;
+    a->load_avg = 1.25;
+}
+
+static void expect(const char *what, long got, long expected) {
+    if (got != expected) {
+        printf("FAIL: %s = %ld, expected %ld\n", what, got, expected);
+        failures++;
+    }
+}
+
+static void check_webhook(const char *url, server_t *s) {
+    alert_t a;
+    int ok = 0;
+
+    /* One connection for many alerts */
+    for (int i = 0; i < 100; i++) {
+        make_alert(&a, i);
+        ok += alert_send_webhook(url, &a) == 200;
+    }
+    expect("posted", ok, 100);
+    expect("requests", s->requests, 100);
+    expect("connections", s->connections, 1);
+    expect("escaped quotes", s->escaped, 100);
+
+    /* Queued alerts go out together; a full queue posts on its own */
+    for (int i = 0; i < 20; i++) {
+        make_alert(&a, i);
+        alert_queue_webhook(url, &a);
+    }
+    expect("batch of 20", alert_flush_webhooks(), 200);
+    for (int i = 0; i < ALERT_QUEUE_MAX + 8; i++) {
+        make_alert(&a, i);
+        alert_queue_webhook(url, &a);
+    }
+    expect("rest of 40", alert_flush_webhooks(), 200);
+    expect("nothing queued", alert_flush_webhooks(), 0);
+    expect("requests after batches", s->requests, 103);
+    expect("alerts after batches", s->alerts, 160);
+
+    /* Chunked replies keep the connection too */
+    s->mode = REPLY_CHUNKED;
+    for (int i = 0; i < 10; i++) {
+        make_alert(&a, i);
+        ok += alert_send_webhook(url, &a) == 200;
+    }
+    expect("connections after chunked", s->connections, 1);
+
+    /* "Connection: close": the first still goes over the kept-alive one */
+    s->mode = REPLY_CLOSE;
+    int connections = s->connections;
+    for (int i = 0; i < 5; i++) {
+        make_alert(&a, i);
+        ok += alert_send_webhook(url, &a) == 200;
+    }
+    expect("connections after close", s->connections - connections, 4);
+
+    /* Closed silently while idle: noticed, reconnected, posted once */
+    s->mode = REPLY_DROP;
+    for (int i = 0; i < 5; i++) {
+        make_alert(&a, i);
+        ok += alert_send_webhook(url, &a) == 200;
+        usleep(20000);
+    }
+    expect("posted through all replies", ok, 120);
+    expect("requests after drops", s->requests, 123);
+
+    /* A server error keeps the alert for the next post */
+    s->mode = REPLY_503;
+    make_alert(&a, 1);
+    expect("503", alert_send_webhook(url, &a), 503);
+    s->mode = REPLY_LENGTH;
+    int alerts = s->alerts;
+    make_alert(&a, 2);
+    expect("after 503", alert_send_webhook(url, &a), 200);
+    expect("alerts retried with the next", s->alerts - alerts, 2);
+
+    /* A queue kept full by 5xx replies drops its oldest, never overruns */
+    s->mode = REPLY_503;
+    int requests = s->requests;
+    for (int i = 0; i < ALERT_QUEUE_MAX + 8; i++) {
+        make_alert(&a, i);
+        alert_queue_webhook(url, &a);
+    }
+    expect("posts while full", s->requests - requests, 8);
+    s->mode = REPLY_LENGTH;
+    alerts = s->alerts;
+    expect("flush after 503s", alert_flush_webhooks(), 200);
+    expect("alerts kept of a full queue", s->alerts - alerts, ALERT_QUEUE_MAX);
+    expect("malformed requests", s->bad, 0);
+}
+
+/* A request the server may have handled is never sent twice */
+static void check_resend(const char *url, server_t *s) {
+    http_client_t c;
+    const char *body = "{\"text\":\"resend\"}";
+
+    s->mode = REPLY_LENGTH;
+    if (http_client_init(&c, url) != 0 ||
+        http_client_post(&c, "application/json", body, strlen(body)) != 200) {
+        expect("resend setup", 0, 1);
+        return;
+    }
+
+    /* Closed without a byte of reply: resent once on a new connection */
+    s->mode = REPLY_NONE;
+    int requests = s->requests;
+    expect("closed unanswered", http_client_post(&c, "application/json", body, strlen(body)), -1);
+    expect("resent after close", s->requests - requests, 2);
+
+    /* Timed out on a kept-alive connection: not resent */
+    s->mode = REPLY_LENGTH;
+    expect("reconnect", http_client_post(&c, "application/json", body, strlen(body)), 200);
+    s->mode = REPLY_STALL;
+    requests = s->requests;
+    expect("stalled", http_client_post(&c, "application/json", body, strlen(body)), -1);
+    expect("not resent after timeout", s->requests - requests, 1);
+    s->mode = REPLY_LENGTH;
+    http_client_close(&c);
+}
+
+static void check_urls(void) {
+    http_client_t c;
+    expect("port and query", http_client_init(&c, "http://hooks.example:8080?a=1"), 0);
+    expect("port", c.port, 8080);
+    expect("path from query", strcmp(c.path, "/?a=1"), 0);
+    expect("default path", http_client_init(&c, "http://hooks.example") == 0 && strcmp(c.path, "/") == 0, 1);
+    expect("bad scheme", http_client_init(&c, "ftp://hooks.example/"), -1);
+    expect("bad port", http_client_init(&c, "http://hooks.example:0/"), -1);
+#ifndef HAVE_OPENSSL
+    expect("https without TLS", http_client_init(&c, "https://hooks.example/"), -1);
+#endif
+}
+
+int main(int argc, char *argv[]) {
+    int alerts = argc > 1 ? atoi(argv[1]) : 500;
+    if (alerts < 1) alerts = 1;
+
+    server_t s;
+    char url[128];
+    if (server_start(&s) != 0) {
+        printf("FAIL: cannot start server\n");
+        return 1;
+    }
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/hooks/alert", s.port);
+
+    check_urls();
+    check_webhook(url, &s);
+    check_resend(url, &s);
+
+    /* Server down: the post fails and the alert waits */
+    server_stop(&s);
+    alert_t a;
+    make_alert(&a, 0);
+    alert_webhook_close();
+    expect("server down", alert_send_webhook(url, &a), -1);
+    alert_webhook_close();
+
+    if (server_start(&s) != 0) {
+        printf("FAIL: cannot restart server\n");
+        return 1;
+    }
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/hooks/alert", s.port);
+
+    /* The old way: a shell and curl per alert, if curl is here */
+    double per_curl = -1;
+    int curls = alerts < 100 ? alerts : 100;
+    if (system("command -v curl >/dev/null 2>&1") == 0) {
+        char json[512], cmd[1024];
+        double start = now_us();
+        for (int i = 0; i < curls; i++) {
+            snprintf(json, sizeof(json), "{\"attachments\": [{\"title\": \"alert %d\", \"footer\": \"C-Sentinel\"}]}", i);
+            snprintf(cmd, sizeof(cmd),
+                     "curl -s -X POST -H 'Content-Type: application/json' -d '%s' '%s' >/dev/null 2>&1",
+                     json, url);
+            if (system(cmd) != 0) failures++;
+        }
+        per_curl = (now_us() - start) / curls;
+    }
+
+    int before = s.requests;
+    double start = now_us();
+    for (int i = 0; i < alerts; i++) {
+        make_alert(&a, i);
+        if (alert_send_webhook(url, &a) != 200) failures++;
+    }
+    double one_by_one = (now_us() - start) / alerts;
+    expect("timed requests", s.requests - before, alerts);
+
+    before = s.requests;
+    int received = s.alerts;
+    start = now_us();
+    for (int i = 0; i < alerts; i++) {
+        make_alert(&a, i);
+        alert_queue_webhook(url, &a);
+    }
+    if (alert_flush_webhooks() != 200) failures++;
+    double batched = (now_us() - start) / alerts;
+    expect("timed batched alerts", s.alerts - received, alerts);
+
+    printf("Webhook alerts (%d alerts, HTTP to 127.0.0.1)\n", alerts);
+    if (per_curl >= 0) {
+        printf("  %-26s %8.1f us per alert (%d alerts)\n", "curl per alert", per_curl, curls);
+    } else {
+        printf("  %-26s %8s\n", "curl per alert", "(no curl)");
+    }
+    printf("  %-26s %8.1f us per alert\n", "kept-alive, one per post", one_by_one);
+    printf("  %-26s %8.1f us per alert, %d posts\n", "kept-alive, batched", batched,
+           s.requests - before);
+
+    alert_webhook_close();
+    server_stop(&s);
+    if (failures) printf("%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}